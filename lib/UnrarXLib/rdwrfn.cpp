@@ -208,22 +208,30 @@ void ComprDataIO::UnpWrite(byte *Addr,uint Count)
   UnpWrSize=Count;
   if (UnpackToMemory)
   {
-    while(UnpackToMemorySize < (int)Count)
+    // a window flush can be larger than the reader's buffer, so hand it over in pieces
+    uint Written=0;
+    while (Written < Count)
     {
-      hBufferEmpty->Set();
-      while(! hBufferFilled->WaitMSec(1)) 
-        if (hQuit->WaitMSec(1))
-          return;
-    }
-    
-    if (! hSeek->WaitMSec(1)) // we are seeking
-    {
-      memcpy(UnpackToMemoryAddr,Addr,Count);
-      UnpackToMemoryAddr+=Count;
-      UnpackToMemorySize-=Count;
+      while(UnpackToMemorySize <= 0)
+      {
+        hBufferEmpty->Set();
+        while(! hBufferFilled->WaitMSec(1)) 
+          if (hQuit->WaitMSec(1))
+          {
+            bQuit = true; // stop unpacking the rest of the file
+            return;
+          }
+      }
+
+      if (hSeek->WaitMSec(1)) // we are seeking
+        return;
+
+      uint Size=Min(Count-Written,(uint)UnpackToMemorySize);
+      memcpy(UnpackToMemoryAddr,Addr+Written,Size);
+      UnpackToMemoryAddr+=Size;
+      UnpackToMemorySize-=Size;
+      Written+=Size;
     }
-    else
-      return;
   }
   else
     if (!TestMode)
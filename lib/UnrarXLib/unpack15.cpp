@@ -120,6 +120,14 @@ void Unpack::Unpack15(bool Solid)
     }
   }
   OldUnpWriteBuf();
+
+  if (UnpIO->UnpackToMemorySize > -1)
+  {
+    UnpIO->hBufferEmpty->Set();
+    while (! UnpIO->hBufferFilled->WaitMSec(1))
+      if (UnpIO->hQuit->WaitMSec(1))
+        return;
+  }
 }
 
 
@@ -163,6 +163,14 @@ void Unpack::Unpack20(bool Solid)
   }
   ReadLastTables();
   OldUnpWriteBuf();
+
+  if (UnpIO->UnpackToMemorySize > -1)
+  {
+    UnpIO->hBufferEmpty->Set();
+    while (! UnpIO->hBufferFilled->WaitMSec(1))
+      if (UnpIO->hQuit->WaitMSec(1))
+        return;
+  }
 }
 
 
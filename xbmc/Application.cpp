@@ -282,11 +282,7 @@
 #include "games/windows/GUIWindowGames.h"
 #include "input/IInputHandler.h"
 
-#ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
 
 #ifdef TARGET_WINDOWS
 #include <shlobj.h>
@@ -315,6 +311,7 @@
 
 #include "storage/MediaManager.h"
 #include "utils/JobManager.h"
+#include "utils/LibraryWatcher.h"
 #include "utils/SaveFileStateJob.h"
 #include "utils/AlarmClock.h"
 #include "utils/RssReader.h"
@@ -1543,6 +1540,8 @@ bool CApplication::Initialize()
 
   CAddonMgr::Get().StartServices(true);
 
+  CLibraryWatcher::Get().Start();
+
   CLog::Log(LOGNOTICE, "initialize done");
 
   m_bInitializing = false;
@@ -2310,8 +2309,8 @@ void CApplication::Render()
 
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
-  // isn't called)
-  g_infoManager.ResetCache();
+  // isn't called). Only conditions depending on state that changed are re-evaluated.
+  g_infoManager.ResetChangedCache();
   lock.Leave();
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -3402,10 +3401,8 @@ bool CApplication::Cleanup()
 
     CLog::Log(LOGNOTICE, "unload sections");
 
-#ifdef HAS_PERFORMANCE_SAMPLE
     CLog::Log(LOGNOTICE, "performance statistics");
     m_perfStats.DumpStats();
-#endif
 
     //  Shutdown as much as possible of the
     //  application, to reduce the leaks dumped
@@ -3418,6 +3415,7 @@ bool CApplication::Cleanup()
     g_LangCodeExpander.Clear();
     g_charsetConverter.clear();
     g_directoryCache.Clear();
+    CDVDFileInfo::ClearThumbCodecCache(true);
     CButtonTranslator::GetInstance().Clear();
 #ifdef HAS_EVENT_SERVER
     CEventServer::RemoveInstance();
@@ -3490,6 +3488,8 @@ void CApplication::Stop(int exitCode)
     CJobManager::GetInstance().CancelJobs();
 
     // stop scanning before we kill the network and so on
+    CLibraryWatcher::Get().Stop();
+
     if (m_musicInfoScanner->IsScanning())
       m_musicInfoScanner->Stop();
 
@@ -5612,6 +5612,31 @@ void CApplication::StartMusicScan(const CStdString &strDirectory, int flags)
   m_musicInfoScanner->Start(strDirectory, flags);
 }
 
+void CApplication::StartVideoScan(const std::set<std::string> &directories)
+{
+  if (m_videoInfoScanner->IsScanning())
+    return;
+
+  // changes to watched sources are picked up quietly
+  m_videoInfoScanner->ShowDialog(false);
+
+  m_videoInfoScanner->Start(directories);
+}
+
+void CApplication::StartMusicScan(const std::set<std::string> &directories)
+{
+  if (m_musicInfoScanner->IsScanning())
+    return;
+
+  int flags = CMusicInfoScanner::SCAN_BACKGROUND;
+  if (CSettings::Get().GetBool("musiclibrary.downloadinfo"))
+    flags |= CMusicInfoScanner::SCAN_ONLINE;
+
+  m_musicInfoScanner->ShowDialog(false);
+
+  m_musicInfoScanner->Start(directories, flags);
+}
+
 void CApplication::StartMusicAlbumScan(const CStdString& strDirectory,
                                        bool refresh)
 {
@@ -5756,12 +5781,10 @@ CNetwork& CApplication::getNetwork()
 {
   return *m_network;
 }
-#ifdef HAS_PERFORMANCE_SAMPLE
 CPerformanceStats &CApplication::GetPerformanceStats()
 {
   return m_perfStats;
 }
-#endif
 
 bool CApplication::SetLanguage(const CStdString &strLanguage)
 {
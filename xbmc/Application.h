@@ -28,6 +28,8 @@
 #include "utils/GlobalsHandling.h"
 
 #include <map>
+#include <set>
+#include <string>
 
 class CAction;
 class CFileItem;
@@ -59,9 +61,7 @@ class CPlayerController;
 #include "win32/WIN32Util.h"
 #endif
 #include "utils/Stopwatch.h"
-#ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceStats.h"
-#endif
 #include "windowing/XBMC_events.h"
 #include "threads/Thread.h"
 
@@ -243,6 +243,8 @@ public:
 
   void StartVideoScan(const CStdString &path, bool scanAll = false);
   void StartMusicScan(const CStdString &path, int flags = 0);
+  void StartVideoScan(const std::set<std::string> &directories);
+  void StartMusicScan(const std::set<std::string> &directories);
   void StartMusicAlbumScan(const CStdString& strDirectory, bool refresh=false);
   void StartMusicArtistScan(const CStdString& strDirectory, bool refresh=false);
 
@@ -257,9 +259,7 @@ public:
   static bool OnEvent(XBMC_Event& newEvent);
 
   CNetwork& getNetwork();
-#ifdef HAS_PERFORMANCE_SAMPLE
   CPerformanceStats &GetPerformanceStats();
-#endif
 
 #ifdef HAS_DVD_DRIVE
   MEDIA_DETECT::CAutorun* m_Autorun;
@@ -462,9 +462,7 @@ protected:
   CPlayerController *m_playerController;
   CInertialScrollingHandler *m_pInertialScrollingHandler;
   CNetwork    *m_network;
-#ifdef HAS_PERFORMANCE_SAMPLE
   CPerformanceStats m_perfStats;
-#endif
 
 #ifdef HAS_EVENT_SERVER
   std::map<std::string, std::map<int, float> > m_lastAxisMap;
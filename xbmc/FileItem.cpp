@@ -19,6 +19,7 @@
  */
 
 #include "FileItem.h"
+#include "FileItemListSnapshot.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -2080,29 +2081,8 @@ void CFileItemList::Archive(CArchive& ar)
 
     ar << (int)(m_items.size() - i);
 
-    ar << m_fastLookup;
-
-    ar << (int)m_sortDescription.sortBy;
-    ar << (int)m_sortDescription.sortOrder;
-    ar << (int)m_sortDescription.sortAttributes;
-    ar << m_sortIgnoreFolders;
-    ar << (int)m_cacheToDisc;
-
-    ar << (int)m_sortDetails.size();
-    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
-    {
-      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
-      ar << (int)details.m_sortDescription.sortBy;
-      ar << (int)details.m_sortDescription.sortOrder;
-      ar << (int)details.m_sortDescription.sortAttributes;
-      ar << details.m_buttonLabel;
-      ar << details.m_labelMasks.m_strLabelFile;
-      ar << details.m_labelMasks.m_strLabelFolder;
-      ar << details.m_labelMasks.m_strLabel2File;
-      ar << details.m_labelMasks.m_strLabel2Folder;
-    }
-
-    ar << m_content;
+    bool fastLookup = m_fastLookup;
+    ArchiveProperties(ar, fastLookup);
 
     for (; i < (int)m_items.size(); ++i)
     {
@@ -2140,6 +2120,49 @@ void CFileItemList::Archive(CArchive& ar)
       m_items.reserve(iSize);
 
     bool fastLookup=false;
+    ArchiveProperties(ar, fastLookup);
+
+    for (int i = 0; i < iSize; ++i)
+    {
+      CFileItemPtr pItem(new CFileItem);
+      ar >> *pItem;
+      Add(pItem);
+    }
+
+    SetFastLookup(fastLookup);
+  }
+}
+
+void CFileItemList::ArchiveProperties(CArchive& ar, bool &fastLookup)
+{
+  if (ar.IsStoring())
+  {
+    ar << fastLookup;
+
+    ar << (int)m_sortDescription.sortBy;
+    ar << (int)m_sortDescription.sortOrder;
+    ar << (int)m_sortDescription.sortAttributes;
+    ar << m_sortIgnoreFolders;
+    ar << (int)m_cacheToDisc;
+
+    ar << (int)m_sortDetails.size();
+    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
+    {
+      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
+      ar << (int)details.m_sortDescription.sortBy;
+      ar << (int)details.m_sortDescription.sortOrder;
+      ar << (int)details.m_sortDescription.sortAttributes;
+      ar << details.m_buttonLabel;
+      ar << details.m_labelMasks.m_strLabelFile;
+      ar << details.m_labelMasks.m_strLabelFolder;
+      ar << details.m_labelMasks.m_strLabel2File;
+      ar << details.m_labelMasks.m_strLabel2Folder;
+    }
+
+    ar << m_content;
+  }
+  else
+  {
     ar >> fastLookup;
 
     int tempint;
@@ -2173,15 +2196,6 @@ void CFileItemList::Archive(CArchive& ar)
     }
 
     ar >> m_content;
-
-    for (int i = 0; i < iSize; ++i)
-    {
-      CFileItemPtr pItem(new CFileItem);
-      ar >> *pItem;
-      Add(pItem);
-    }
-
-    SetFastLookup(fastLookup);
   }
 }
 
@@ -2689,8 +2703,23 @@ void CFileItemList::StackFiles()
 
 bool CFileItemList::Load(int windowID)
 {
+  return LoadPage(0, UINT_MAX, windowID);
+}
+
+bool CFileItemList::LoadPage(unsigned int first, unsigned int count, int windowID)
+{
+  CStdString cacheFile(GetDiscFileCache(windowID));
+  CFileItemListSnapshot snapshot;
+  if (snapshot.Open(cacheFile) && snapshot.Load(*this, first, count))
+  {
+    CLog::Log(LOGDEBUG,"Loading items: %i, directory: %s sort method: %i, ascending: %s", Size(), CURL::GetRedacted(GetPath()).c_str(), m_sortDescription.sortBy,
+      m_sortDescription.sortOrder == SortOrderAscending ? "true" : "false");
+    return true;
+  }
+
+  // caches written before snapshots were introduced
   CFile file;
-  if (file.Open(GetDiscFileCache(windowID)))
+  if (file.Open(cacheFile))
   {
     CArchive ar(&file, CArchive::load);
     ar >> *this;
@@ -2712,14 +2741,9 @@ bool CFileItemList::Save(int windowID)
 
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]", CURL::GetRedacted(GetPath()).c_str());
 
-  CFile file;
-  if (file.OpenForWrite(GetDiscFileCache(windowID), true)) // overwrite always
+  if (CFileItemListSnapshot::Save(*this, GetDiscFileCache(windowID))) // overwrite always
   {
-    CArchive ar(&file, CArchive::store);
-    ar << *this;
     CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s", iSize, m_sortDescription.sortBy, m_sortDescription.sortOrder == SortOrderAscending ? "true" : "false");
-    ar.Close();
-    file.Close();
     return true;
   }
 
@@ -536,6 +536,7 @@ typedef void (*FILEITEMFILLFUNC) (CFileItemPtr &item);
   */
 class CFileItemList : public CFileItem
 {
+  friend class CFileItemListSnapshot;
 public:
   enum CACHE_TYPE { CACHE_NEVER = 0, CACHE_IF_SLOW, CACHE_ALWAYS };
 
@@ -606,6 +607,19 @@ public:
    */
   bool Load(int windowID = 0);
 
+  /*! \brief load a CFileItemList from the cache, fully decoding only the items of one page
+
+   Items outside [first, first + count) only carry path, folder flag, labels, icon and thumb,
+   which is enough to count and skip them. Caches written by older versions are loaded completely.
+
+   \param first index of the first item to decode
+   \param count number of items to decode
+   \param windowID id of the window that's loading this list (defaults to 0)
+   \return true if we loaded from the cache, false otherwise.
+   \sa Load, CFileItemListSnapshot::GetSummary
+   */
+  bool LoadPage(unsigned int first, unsigned int count, int windowID = 0);
+
   /*! \brief save a CFileItemList to the cache
    
    The file list may be cached based on which window we're viewing in, as different
@@ -664,6 +678,12 @@ private:
   void FillSortFields(FILEITEMFILLFUNC func);
   CStdString GetDiscFileCache(int windowID) const;
 
+  /*! \brief (de)serialize the list properties following the item count in Archive()
+   \param fastLookup receives the stored fast lookup state when loading, it is applied once the items are added
+   \sa CFileItemListSnapshot
+   */
+  void ArchiveProperties(CArchive& ar, bool &fastLookup);
+
   /*!
    \brief stack files in a CFileItemList
    \sa Stack
@@ -0,0 +1,379 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItemListSnapshot.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <map>
+
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace XFILE;
+
+#define SNAPSHOT_MAGIC      0x53494658 // "XFIS"
+#define SNAPSHOT_BYTEORDER  0x01020304
+#define SNAPSHOT_ALIGN      8
+
+#define ENTRY_FOLDER        0x01
+
+struct CFileItemListSnapshot::Header
+{
+  uint32_t magic;
+  uint32_t byteOrder;
+  uint32_t version;
+  uint32_t count;
+  uint32_t listOffset;
+  uint32_t listSize;
+  uint32_t stringsOffset;
+  uint32_t stringsSize;
+  uint32_t indexOffset;
+  uint32_t reserved;
+};
+
+struct CFileItemListSnapshot::Entry
+{
+  uint32_t path;
+  uint32_t label;
+  uint32_t label2;
+  uint32_t icon;
+  uint32_t thumb;
+  uint32_t flags;
+  uint32_t offset;
+  uint32_t size;
+};
+
+/* string table with duplicates folded, offset 0 is always the empty string */
+class CSnapshotStrings
+{
+public:
+  CSnapshotStrings() : m_data(1, '\0') {}
+
+  uint32_t Add(const std::string &str)
+  {
+    if (str.empty())
+      return 0;
+    std::map<std::string, uint32_t>::const_iterator it = m_offsets.find(str);
+    if (it != m_offsets.end())
+      return it->second;
+    uint32_t offset = m_data.size();
+    m_data.insert(m_data.end(), str.begin(), str.end());
+    m_data.push_back('\0');
+    m_offsets.insert(std::make_pair(str, offset));
+    return offset;
+  }
+
+  std::vector<char> m_data;
+
+private:
+  std::map<std::string, uint32_t> m_offsets;
+};
+
+static void Align(std::vector<uint8_t> &buffer)
+{
+  buffer.resize((buffer.size() + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1), 0);
+}
+
+CFileItemListSnapshot::CFileItemListSnapshot() :
+  m_data(NULL),
+  m_size(0),
+  m_mapped(false)
+{
+}
+
+CFileItemListSnapshot::~CFileItemListSnapshot()
+{
+  Close();
+}
+
+bool CFileItemListSnapshot::Save(CFileItemList &items, const std::string &path)
+{
+  CSingleLock lock(items.m_lock);
+
+  // a parent folder item is never cached, same as CFileItemList::Archive
+  unsigned int first = 0;
+  if (!items.m_items.empty() && items.m_items[0]->IsParentFolder())
+    first = 1;
+  unsigned int count = items.m_items.size() - first;
+
+  std::vector<uint8_t> list;
+  {
+    CArchive ar(list);
+    items.CFileItem::Archive(ar);
+    bool fastLookup = items.m_fastLookup;
+    items.ArchiveProperties(ar, fastLookup);
+  }
+
+  CSnapshotStrings strings;
+  std::vector<Entry> index(count);
+  std::vector<uint8_t> blobs;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    CFileItem &item = *items.m_items[first + i];
+    Entry &entry = index[i];
+    entry.path   = strings.Add(item.GetPath());
+    entry.label  = strings.Add(item.GetLabel());
+    entry.label2 = strings.Add(item.GetLabel2());
+    entry.icon   = strings.Add(item.GetIconImage());
+    entry.thumb  = strings.Add(item.GetArt("thumb"));
+    entry.flags  = item.m_bIsFolder ? ENTRY_FOLDER : 0;
+    entry.offset = blobs.size();
+    {
+      CArchive ar(blobs);
+      ar << item;
+    }
+    entry.size = blobs.size() - entry.offset;
+  }
+
+  std::vector<uint8_t> data(sizeof(Header), 0);
+  Header header;
+  header.magic      = SNAPSHOT_MAGIC;
+  header.byteOrder  = SNAPSHOT_BYTEORDER;
+  header.version    = Version;
+  header.count      = count;
+  header.reserved   = 0;
+
+  header.listOffset = data.size();
+  header.listSize   = list.size();
+  data.insert(data.end(), list.begin(), list.end());
+  Align(data);
+
+  header.stringsOffset = data.size();
+  header.stringsSize   = strings.m_data.size();
+  data.insert(data.end(), strings.m_data.begin(), strings.m_data.end());
+  Align(data);
+
+  header.indexOffset = data.size();
+  uint32_t blobsOffset = header.indexOffset + count * sizeof(Entry);
+  for (unsigned int i = 0; i < count; ++i)
+    index[i].offset += blobsOffset;
+  if (count)
+  {
+    const uint8_t *entries = (const uint8_t*)&index[0];
+    data.insert(data.end(), entries, entries + count * sizeof(Entry));
+  }
+  data.insert(data.end(), blobs.begin(), blobs.end());
+  memcpy(&data[0], &header, sizeof(header));
+
+  CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  bool ret = file.Write(&data[0], data.size()) == (int)data.size();
+  file.Close();
+  if (!ret)
+    CFile::Delete(path);
+  return ret;
+}
+
+bool CFileItemListSnapshot::Open(const std::string &path)
+{
+  Close();
+
+#ifdef TARGET_POSIX
+  // caches live in special://temp, map them straight from disk when we can
+  CStdString local = CSpecialProtocol::TranslatePath(path);
+  if (URIUtils::IsHD(local))
+  {
+    int fd = open(local.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+    {
+      void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        m_data = (const uint8_t*)data;
+        m_size = st.st_size;
+        m_mapped = true;
+      }
+    }
+    close(fd);
+  }
+#endif
+
+  if (!m_data)
+  {
+    CFile file;
+    if (!file.Open(path))
+      return false;
+    int64_t length = file.GetLength();
+    if (length < (int64_t)sizeof(Header) || length > 0x7fffffff)
+      return false;
+    m_buffer.resize((size_t)length);
+    if (file.Read(&m_buffer[0], m_buffer.size()) != m_buffer.size())
+    {
+      m_buffer.clear();
+      return false;
+    }
+    m_data = &m_buffer[0];
+    m_size = m_buffer.size();
+  }
+
+  if (!Validate())
+  {
+    Close();
+    return false;
+  }
+
+  m_items.resize(GetHeader()->count);
+  return true;
+}
+
+void CFileItemListSnapshot::Close()
+{
+#ifdef TARGET_POSIX
+  if (m_mapped)
+    munmap((void*)m_data, m_size);
+#endif
+  m_data = NULL;
+  m_size = 0;
+  m_mapped = false;
+  m_buffer.clear();
+  m_items.clear();
+}
+
+bool CFileItemListSnapshot::Validate() const
+{
+  const Header *header = GetHeader();
+  if (header->magic != SNAPSHOT_MAGIC || header->byteOrder != SNAPSHOT_BYTEORDER)
+    return false;
+  if (header->version != Version)
+  {
+    CLog::Log(LOGDEBUG, "%s - snapshot version %u, expected %u", __FUNCTION__, header->version, Version);
+    return false;
+  }
+
+  uint64_t size = m_size;
+  if ((uint64_t)header->listOffset + header->listSize > size ||
+      (uint64_t)header->stringsOffset + header->stringsSize > size ||
+      header->stringsSize == 0 || m_data[header->stringsOffset + header->stringsSize - 1] != '\0' ||
+      (uint64_t)header->indexOffset + (uint64_t)header->count * sizeof(Entry) > size ||
+      header->indexOffset % SNAPSHOT_ALIGN)
+    return false;
+
+  for (unsigned int i = 0; i < header->count; ++i)
+  {
+    const Entry *entry = GetEntry(i);
+    if ((uint64_t)entry->offset + entry->size > size ||
+        entry->path >= header->stringsSize || entry->label >= header->stringsSize ||
+        entry->label2 >= header->stringsSize || entry->icon >= header->stringsSize ||
+        entry->thumb >= header->stringsSize)
+      return false;
+  }
+  return true;
+}
+
+const CFileItemListSnapshot::Header *CFileItemListSnapshot::GetHeader() const
+{
+  return (const Header*)m_data;
+}
+
+const CFileItemListSnapshot::Entry *CFileItemListSnapshot::GetEntry(unsigned int item) const
+{
+  return (const Entry*)(m_data + GetHeader()->indexOffset) + item;
+}
+
+const char *CFileItemListSnapshot::GetString(uint32_t offset) const
+{
+  return (const char*)m_data + GetHeader()->stringsOffset + offset;
+}
+
+unsigned int CFileItemListSnapshot::Size() const
+{
+  return m_data ? GetHeader()->count : 0;
+}
+
+CFileItemPtr CFileItemListSnapshot::GetSummary(unsigned int item) const
+{
+  if (item >= Size())
+    return CFileItemPtr();
+
+  const Entry *entry = GetEntry(item);
+  CFileItemPtr pItem(new CFileItem(GetString(entry->path), (entry->flags & ENTRY_FOLDER) != 0));
+  pItem->SetLabel(GetString(entry->label));
+  pItem->SetLabel2(GetString(entry->label2));
+  pItem->SetIconImage(GetString(entry->icon));
+  if (entry->thumb)
+    pItem->SetArt("thumb", GetString(entry->thumb));
+  return pItem;
+}
+
+CFileItemPtr CFileItemListSnapshot::Get(unsigned int item)
+{
+  if (item >= Size())
+    return CFileItemPtr();
+
+  if (!m_items[item])
+  {
+    const Entry *entry = GetEntry(item);
+    CFileItemPtr pItem(new CFileItem);
+    CArchive ar(m_data + entry->offset, entry->size);
+    ar >> *pItem;
+    m_items[item] = pItem;
+  }
+  return m_items[item];
+}
+
+void CFileItemListSnapshot::DecodeList(CFileItemList &items, bool &fastLookup) const
+{
+  const Header *header = GetHeader();
+  CArchive ar(m_data + header->listOffset, header->listSize);
+
+  items.CFileItem::Archive(ar);
+  items.ArchiveProperties(ar, fastLookup);
+}
+
+bool CFileItemListSnapshot::Load(CFileItemList &items, unsigned int first /* = 0 */, unsigned int count /* = UINT_MAX */)
+{
+  if (!m_data)
+    return false;
+
+  CSingleLock lock(items.m_lock);
+
+  CFileItemPtr pParent;
+  if (!items.IsEmpty() && items.m_items[0]->IsParentFolder())
+    pParent.reset(new CFileItem(*items.m_items[0]));
+
+  items.SetFastLookup(false);
+  items.Clear();
+
+  bool fastLookup = false;
+  DecodeList(items, fastLookup);
+
+  unsigned int size = Size();
+  items.m_items.reserve(size + (pParent ? 1 : 0));
+  if (pParent)
+    items.m_items.push_back(pParent);
+  for (unsigned int i = 0; i < size; ++i)
+    items.Add(i >= first && i - first < count ? Get(i) : GetSummary(i));
+
+  items.SetFastLookup(fastLookup);
+  return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "FileItem.h"
+
+/*!
+ \brief Read only, lazily decoded snapshot of a CFileItemList on disk
+
+ A snapshot is a single block that can be mapped into memory as is:
+
+   header | list blob | string table | item index | item blobs
+
+ The list blob carries the CFileItemList properties, each item blob one
+ CFileItem, both written by the same CArchive code as CFileItemList::Archive. The item index holds the position of
+ every item blob plus string table offsets for the fields needed to display
+ an item (path, labels, icon, thumb), so a view can be filled from the index
+ alone and the full items decoded on demand.
+
+ Snapshots are versioned, files with a different magic, version or byte
+ order are rejected by Open() and the caller falls back to CArchive.
+ */
+class CFileItemListSnapshot
+{
+public:
+  CFileItemListSnapshot();
+  ~CFileItemListSnapshot();
+
+  /*! \brief write a snapshot of the list, replacing any existing file */
+  static bool Save(CFileItemList &items, const std::string &path);
+
+  /*! \brief map a snapshot into memory
+   \return false if the file doesn't exist or isn't a snapshot of the current version
+   */
+  bool Open(const std::string &path);
+  void Close();
+  bool IsOpen() const { return m_data != NULL; }
+
+  /*! \brief number of items in the snapshot, not counting a parent folder item */
+  unsigned int Size() const;
+
+  /*! \brief item with only path, folder flag, labels, icon and thumb filled in, cheap to create */
+  CFileItemPtr GetSummary(unsigned int item) const;
+
+  /*! \brief fully decoded item, decoded on first access and kept for later calls */
+  CFileItemPtr Get(unsigned int item);
+
+  /*! \brief replace the contents of the list with the snapshot
+   Only the items in [first, first + count) are fully decoded, the others are summaries.
+   \sa CFileItemList::Load, CFileItemList::LoadPage, GetSummary
+   */
+  bool Load(CFileItemList &items, unsigned int first = 0, unsigned int count = UINT_MAX);
+
+  static const uint32_t Version = 1;
+
+private:
+  struct Header;
+  struct Entry;
+
+  const Header *GetHeader() const;
+  const Entry *GetEntry(unsigned int item) const;
+  const char *GetString(uint32_t offset) const;
+  bool Validate() const;
+  void DecodeList(CFileItemList &items, bool &fastLookup) const;
+
+  const uint8_t *m_data;
+  size_t m_size;
+  bool m_mapped;
+  std::vector<uint8_t> m_buffer;
+  std::vector<CFileItemPtr> m_items;
+};
@@ -71,6 +71,7 @@
 #include "storage/MediaManager.h"
 #include "utils/TimeUtils.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "utils/log.h"
 
 #include "pvr/PVRManager.h"
@@ -126,6 +127,8 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowInfo = false;
   m_fps = 0.0f;
   m_AVInfoValid = false;
+  memset(&m_categoryState, 0, sizeof(m_categoryState));
+  m_changedCategories = CATEGORY_ALL;
   ResetLibraryBools();
 }
 
@@ -145,6 +148,7 @@ bool CGUIInfoManager::OnMessage(CGUIMessage &message)
       if (m_currentFile->IsSamePath(item.get()))
       {
         m_currentFile->UpdateInfo(*item);
+        SetCategoriesChanged(CATEGORY_PLAYER);
         return true;
       }
     }
@@ -932,7 +936,7 @@ int CGUIInfoManager::TranslateSingleString(const CStdString &strCondition, bool
         {
           std::string paramCopy = param;
           StringUtils::ToLower(paramCopy);
-          return AddMultiInfo(GUIInfo(SYSTEM_GET_BOOL, ConditionalStringParameter(paramCopy, true)));
+          return AddMultiInfo(GUIInfo(SYSTEM_GET_BOOL, AddSettingHandle(paramCopy)));
         }
         for (size_t i = 0; i < sizeof(system_param) / sizeof(infomap); i++)
         {
@@ -2888,7 +2892,7 @@ bool CGUIInfoManager::GetMultiInfoBool(const GUIInfo &info, int contextWindow, c
         bReturn = g_alarmClock.HasAlarm(m_stringParameters[info.GetData1()]);
         break;
       case SYSTEM_GET_BOOL:
-        bReturn = CSettings::Get().GetBool(m_stringParameters[info.GetData1()]);
+        bReturn = CSettings::Get().GetBool(m_settingHandles[info.GetData1()]);
         break;
       case SYSTEM_HAS_CORE_ID:
         bReturn = g_cpuInfo.HasCoreId(info.GetData1());
@@ -4275,10 +4279,25 @@ bool CGUIInfoManager::GetDisplayAfterSeek()
   return false;
 }
 
+int CGUIInfoManager::AddSettingHandle(const std::string &settingId)
+{
+  // resolve the setting once so that evaluating the condition every frame
+  // neither looks up the identifier nor locks the settings
+  CSettingHandle handle = CSettings::Get().GetHandle(settingId);
+  for (unsigned int i = 0; i < m_settingHandles.size(); i++)
+  {
+    if (m_settingHandles[i] == handle)
+      return (int)i;
+  }
+  m_settingHandles.push_back(handle);
+  return (int)m_settingHandles.size() - 1;
+}
+
 void CGUIInfoManager::Clear()
 {
   CSingleLock lock(m_critInfo);
   m_skinVariableStrings.clear();
+  CGUIInfoLabel::ClearCache();
 
   /*
     Erase any info bools that are unused. We do this repeatedly as each run
@@ -5241,7 +5260,7 @@ bool CGUIInfoManager::GetItemBool(const CGUIListItem *item, int condition) const
   return false;
 }
 
-void CGUIInfoManager::ResetCache()
+unsigned int CGUIInfoManager::ResetCache()
 {
   // reset any animation triggers as well
   m_containerMoves.clear();
@@ -5249,6 +5268,166 @@ void CGUIInfoManager::ResetCache()
   CSingleLock lock(m_critInfo);
   for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
     (*i)->SetDirty();
+  return m_bools.size();
+}
+
+unsigned int CGUIInfoManager::ResetChangedCache()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+
+  // there's no notification for window and system state, assume it always changes
+  unsigned int changed = GetChangedCategories() | CATEGORY_WINDOW | CATEGORY_SYSTEM;
+  long flagged;
+  do
+  {
+    flagged = m_changedCategories;
+  } while (cas(&m_changedCategories, flagged, 0) != flagged);
+  changed |= flagged;
+
+  // mark the infobools depending on what changed as dirty
+  unsigned int dirty = 0;
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->SetDirty(changed))
+      dirty++;
+  }
+  return dirty;
+}
+
+void CGUIInfoManager::SetCategoriesChanged(unsigned int categories)
+{
+  long changed;
+  do
+  {
+    changed = m_changedCategories;
+  } while (cas(&m_changedCategories, changed, changed | categories) != changed);
+}
+
+unsigned int CGUIInfoManager::GetChangedCategories()
+{
+  CategoryState state;
+  state.playing = g_application.m_pPlayer->IsPlaying();
+  state.playlist = g_playlistPlayer.GetCurrentPlaylist();
+  state.song = g_playlistPlayer.GetCurrentSong();
+  const int playlists[2] = { PLAYLIST_MUSIC, PLAYLIST_VIDEO };
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    state.size[i] = g_playlistPlayer.GetPlaylist(playlists[i]).size();
+    state.shuffled[i] = g_playlistPlayer.IsShuffled(playlists[i]);
+    state.repeat[i] = g_playlistPlayer.GetRepeat(playlists[i]);
+  }
+  state.scanningMusic = g_application.IsMusicScanning();
+  state.scanningVideo = g_application.IsVideoScanning();
+  state.minute = time(NULL) / 60;
+
+  const CategoryState &last = m_categoryState;
+  unsigned int changed = 0;
+  // time, chapters, cache level etc. change continuously during playback
+  if (state.playing || last.playing)
+    changed |= CATEGORY_PLAYER | CATEGORY_PLAYLIST;
+  if (state.playlist != last.playlist || state.song != last.song)
+    changed |= CATEGORY_PLAYLIST;
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    if (state.size[i] != last.size[i] || state.shuffled[i] != last.shuffled[i] || state.repeat[i] != last.repeat[i])
+      changed |= CATEGORY_PLAYLIST;
+  }
+  if (state.scanningMusic != last.scanningMusic || state.scanningVideo != last.scanningVideo)
+    changed |= CATEGORY_LIBRARY;
+  if (state.minute != last.minute)
+    changed |= CATEGORY_TIME;
+
+  m_categoryState = state;
+  return changed;
+}
+
+unsigned int CGUIInfoManager::GetBoolCategories(int condition) const
+{
+  condition = abs(condition);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  { // take the categories of the wrapped info
+    unsigned int index = condition - MULTI_INFO_START;
+    if (index >= m_multiInfo.size())
+      return CATEGORY_ALL;
+    condition = abs(m_multiInfo[index].m_info);
+  }
+
+  if (condition >= LISTITEM_START && condition <= LISTITEM_END)
+    return CATEGORY_WINDOW;
+
+  switch (condition)
+  {
+  case SYSTEM_ALWAYS_TRUE:
+  case SYSTEM_ALWAYS_FALSE:
+  case SYSTEM_PLATFORM_LINUX:
+  case SYSTEM_PLATFORM_WINDOWS:
+  case SYSTEM_PLATFORM_DARWIN:
+  case SYSTEM_PLATFORM_DARWIN_OSX:
+  case SYSTEM_PLATFORM_DARWIN_IOS:
+  case SYSTEM_PLATFORM_DARWIN_ATV2:
+  case SYSTEM_PLATFORM_ANDROID:
+  case SYSTEM_PLATFORM_LINUX_RASPBERRY_PI:
+    return 0;
+  // player bools that are set from outside the player, or depend on the time since they were set
+  case PLAYER_VOLUME:
+  case PLAYER_MUTED:
+  case PLAYER_SHOWINFO:
+  case PLAYER_SHOWCODEC:
+  case PLAYER_SHOWTIME:
+  case PLAYER_SEEKING:
+  case PLAYER_DISPLAY_AFTER_SEEK:
+  case VIDEOPLAYER_USING_OVERLAYS:
+    return CATEGORY_SYSTEM;
+  case VIDEOPLAYER_ISFULLSCREEN:
+  case SKIN_HAS_VIDEO_OVERLAY:
+  case SKIN_HAS_MUSIC_OVERLAY:
+    return CATEGORY_PLAYER | CATEGORY_WINDOW;
+  case SKIN_BOOL:
+  case SKIN_STRING:
+  case SKIN_THEME:
+  case SKIN_COLOUR_THEME:
+  case SKIN_HAS_THEME:
+  case SKIN_ASPECT_RATIO:
+    return CATEGORY_SKIN;
+  case SYSTEM_TIME:
+  case SYSTEM_DATE:
+    return CATEGORY_TIME;
+  case SYSTEM_CURRENT_WINDOW:
+  case SYSTEM_CURRENT_CONTROL:
+  case WINDOW_PROPERTY:
+  case WINDOW_IS_TOPMOST:
+  case WINDOW_IS_VISIBLE:
+  case WINDOW_NEXT:
+  case WINDOW_PREVIOUS:
+  case WINDOW_IS_MEDIA:
+  case WINDOW_IS_ACTIVE:
+  case CONTROL_GET_LABEL:
+  case CONTROL_IS_ENABLED:
+  case CONTROL_IS_VISIBLE:
+  case CONTROL_GROUP_HAS_FOCUS:
+  case CONTROL_HAS_FOCUS:
+    return CATEGORY_WINDOW;
+  default:
+    break;
+  }
+
+  if (condition >= PLAYER_HAS_MEDIA && condition <= PLAYER_HAS_GAME)
+    return CATEGORY_PLAYER;
+  if (condition >= MUSICPLAYER_TITLE && condition <= MUSICPLAYER_CHANNEL_GROUP)
+    return CATEGORY_PLAYER | CATEGORY_PLAYLIST;
+  if (condition >= VIDEOPLAYER_TITLE && condition <= VIDEOPLAYER_AUDIO_LANG)
+    return CATEGORY_PLAYER;
+  if (condition >= CONTAINER_CAN_FILTER && condition <= CONTAINER_TOTALTIME)
+    return CATEGORY_WINDOW;
+  if (condition >= PLAYLIST_LENGTH && condition <= PLAYLIST_ISREPEATONE)
+    return CATEGORY_PLAYLIST;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_IS_SCANNING_MUSIC)
+    return CATEGORY_LIBRARY;
+
+  // anything else, including string comparisons of arbitrary labels
+  return CATEGORY_ALL;
 }
 
 // Called from tuxbox service thread to update current status
@@ -5448,6 +5627,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  SetCategoriesChanged(CATEGORY_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5457,6 +5637,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  SetCategoriesChanged(CATEGORY_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
@@ -35,6 +35,7 @@
 #include "interfaces/info/InfoBool.h"
 #include "interfaces/info/SkinVariable.h"
 #include "cores/IPlayer.h"
+#include "settings/lib/SettingHandle.h"
 
 #include <list>
 #include <map>
@@ -812,7 +813,26 @@ public:
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
-  void ResetCache();
+  /*! \brief Mark all info bools dirty, forcing them to be re-evaluated
+   \return the number of info bools marked dirty
+   \sa ResetChangedCache
+   */
+  unsigned int ResetCache();
+
+  /*! \brief Mark dirty only the info bools that depend on state that changed since the last call
+   Called once per frame. Window and system state is assumed to change every frame, player,
+   playlist, library, skin setting and time of day state only when it did.
+   \return the number of info bools marked dirty
+   \sa SetCategoriesChanged, INFO::InfoCategory
+   */
+  unsigned int ResetChangedCache();
+
+  /*! \brief Flag state as changed, so info bools depending on it are re-evaluated next frame
+   Safe to call from any thread while holding other locks.
+   \param categories bitmask of INFO::InfoCategory values
+   */
+  void SetCategoriesChanged(unsigned int categories);
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   CStdString GetItemLabel(const CFileItem *item, int info, CStdString *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, CStdString *fallback = NULL);
@@ -851,6 +871,10 @@ protected:
   friend class INFO::InfoSingle;
   bool GetBool(int condition, int contextWindow = 0, const CGUIListItem *item=NULL);
   int TranslateSingleString(const CStdString &strCondition, bool &listItemDependent);
+  /*! \brief Categories of state a condition from TranslateSingleString depends on
+   \return bitmask of INFO::InfoCategory values, CATEGORY_ALL if not known
+   */
+  unsigned int GetBoolCategories(int condition) const;
 
   // routines for window retrieval
   bool CheckWindowCondition(CGUIWindow *window, int condition) const;
@@ -904,9 +928,14 @@ protected:
    */
   bool GetEpgInfoTag(EPG::CEpgInfoTag& tag) const;
 
+  int AddSettingHandle(const std::string &settingId);
+
   // Conditional string parameters are stored here
   CStdStringArray m_stringParameters;
 
+  // Handles of the settings queried by skin conditions (System.GetBool)
+  std::vector<CSettingHandle> m_settingHandles;
+
   // Array of multiple information mapped to a single integer lookup
   std::vector<GUIInfo> m_multiInfo;
   std::vector<std::string> m_listitemProperties;
@@ -942,6 +971,23 @@ protected:
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+
+  // state not flagged through SetCategoriesChanged, compared between frames
+  struct CategoryState
+  {
+    bool playing;
+    int playlist;
+    int song;
+    int size[2];
+    bool shuffled[2];
+    int repeat[2];
+    bool scanningMusic;
+    bool scanningVideo;
+    time_t minute;
+  };
+  unsigned int GetChangedCategories();
+  CategoryState m_categoryState;
+  volatile long m_changedCategories;
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
@@ -35,6 +35,7 @@ namespace ADDON
 {
   typedef std::vector<AddonPtr> VECADDONS;
   typedef std::vector<AddonPtr>::iterator IVECADDONS;
+  typedef std::map<std::string, std::string> ADDONHASHES; ///< addon id -> hash of its repository entry
 
 // utils
 const CStdString    TranslateType(const TYPE &type, bool pretty=false);
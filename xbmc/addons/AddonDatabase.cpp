@@ -93,7 +93,7 @@ void CAddonDatabase::CreateTables()
               "checksum text, lastcheck text)\n");
 
   CLog::Log(LOGINFO, "create addonlinkrepo table");
-  m_pDS->exec("CREATE TABLE addonlinkrepo (idRepo integer, idAddon integer)\n");
+  m_pDS->exec("CREATE TABLE addonlinkrepo (idRepo integer, idAddon integer, hash text)\n");
 
   CLog::Log(LOGINFO, "create disabled table");
   m_pDS->exec("CREATE TABLE disabled (id integer primary key, addonID text)\n");
@@ -128,10 +128,14 @@ void CAddonDatabase::UpdateTables(int version)
   {
     m_pDS->exec("CREATE TABLE package (id integer primary key, addonID text, filename text, hash text)\n");
   }
+  if (version < 17)
+  {
+    m_pDS->exec("ALTER TABLE addonlinkrepo ADD hash text\n");
+  }
 }
 
 int CAddonDatabase::AddAddon(const AddonPtr& addon,
-                             int idRepo)
+                             int idRepo, const std::string& hash /* = "" */)
 {
   try
   {
@@ -156,7 +160,7 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
     m_pDS->exec(sql.c_str());
     int idAddon = (int)m_pDS->lastinsertid();
 
-    sql = PrepareSQL("insert into addonlinkrepo (idRepo, idAddon) values (%i,%i)",idRepo,idAddon);
+    sql = PrepareSQL("insert into addonlinkrepo (idRepo, idAddon, hash) values (%i,%i,'%s')",idRepo,idAddon,hash.c_str());
     m_pDS->exec(sql.c_str());
 
     const InfoMap &info = addon->ExtraInfo();
@@ -418,7 +422,20 @@ void CAddonDatabase::DeleteRepository(int idRepo)
   }
 }
 
-int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons, const CStdString& checksum)
+void CAddonDatabase::DeleteAddon(int idAddon)
+{
+  CStdString sql = PrepareSQL("delete from addon where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonextra where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from dependencies where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonlinkrepo where idAddon=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+}
+
+int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons, const CStdString& checksum,
+                                  const ADDONHASHES& hashes /* = ADDONHASHES() */)
 {
   try
   {
@@ -427,19 +444,66 @@ int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons,
 
     CStdString sql;
     int idRepo = GetRepoChecksum(id,sql);
+
+    // the addons we have of this repository, with the hashes they were stored with
+    map<string, pair<int, string> > stored;
     if (idRepo > -1)
-      DeleteRepository(idRepo);
+    {
+      sql = PrepareSQL("select addon.addonID, addon.id, addonlinkrepo.hash from addonlinkrepo "
+                       "join addon on addon.id=addonlinkrepo.idAddon where addonlinkrepo.idRepo=%i", idRepo);
+      m_pDS->query(sql.c_str());
+      while (!m_pDS->eof())
+      {
+        stored[m_pDS->fv(0).get_asString()] = make_pair(m_pDS->fv(1).get_asInt(), m_pDS->fv(2).get_asString());
+        m_pDS->next();
+      }
+      m_pDS->close();
+    }
 
     BeginTransaction();
 
     CDateTime time = CDateTime::GetCurrentDateTime();
-    sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
-    m_pDS->exec(sql.c_str());
-    idRepo = (int)m_pDS->lastinsertid();
+    if (idRepo > -1)
+    {
+      sql = PrepareSQL("update repo set checksum='%s', lastcheck='%s' where id=%i",checksum.c_str(),time.GetAsDBDateTime().c_str(),idRepo);
+      m_pDS->exec(sql.c_str());
+    }
+    else
+    {
+      sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
+      m_pDS->exec(sql.c_str());
+      idRepo = (int)m_pDS->lastinsertid();
+    }
+
+    unsigned int added = 0, changed = 0;
     for (unsigned int i=0;i<addons.size();++i)
-      AddAddon(addons[i],idRepo);
+    {
+      ADDONHASHES::const_iterator hash = hashes.find(addons[i]->ID());
+      string newHash = hash != hashes.end() ? hash->second : "";
+
+      map<string, pair<int, string> >::iterator old = stored.find(addons[i]->ID());
+      if (old != stored.end())
+      {
+        bool unchanged = !newHash.empty() && newHash == old->second.second;
+        int idAddon = old->second.first;
+        stored.erase(old);
+        if (unchanged)
+          continue;
+        DeleteAddon(idAddon);
+        changed++;
+      }
+      else
+        added++;
+      AddAddon(addons[i],idRepo,newHash);
+    }
+
+    // whatever is left is gone from the repository
+    for (map<string, pair<int, string> >::const_iterator it = stored.begin(); it != stored.end(); ++it)
+      DeleteAddon(it->second.first);
 
     CommitTransaction();
+    CLog::Log(LOGDEBUG, "%s - repo '%s': %u added, %u changed, %u removed, %u unchanged", __FUNCTION__, id.c_str(),
+              added, changed, (unsigned int)stored.size(), (unsigned int)addons.size() - added - changed);
     return idRepo;
   }
   catch (...)
@@ -750,6 +814,29 @@ bool CAddonDatabase::HasDisabledAddons()
   return false;
 }
 
+bool CAddonDatabase::GetDisabled(std::set<std::string> &addons)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query("select addonID from disabled");
+    while (!m_pDS->eof())
+    {
+      addons.insert(m_pDS->fv(0).get_asString());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CAddonDatabase::BlacklistAddon(const CStdString& addonID,
                                     const CStdString& version)
 {
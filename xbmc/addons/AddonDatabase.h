@@ -25,6 +25,9 @@
 #include "utils/StdString.h"
 #include "FileItem.h"
 
+#include <set>
+#include <string>
+
 /**
 * Class - IAddonDatabaseCallback
 * This callback should be inherited by any class which requires notification
@@ -59,7 +62,7 @@ public:
   static bool RegisterAddonDatabaseCallback(ADDON::TYPE type, IAddonDatabaseCallback* cb);
   static void UnregisterAddonDatabaseCallback(ADDON::TYPE type);
 
-  int AddAddon(const ADDON::AddonPtr& item, int idRepo);
+  int AddAddon(const ADDON::AddonPtr& item, int idRepo, const std::string& hash = "");
   bool GetAddon(const CStdString& addonID, ADDON::AddonPtr& addon);
   bool GetAddons(ADDON::VECADDONS& addons, const ADDON::TYPE &type = ADDON::ADDON_UNKNOWN);
 
@@ -72,7 +75,17 @@ public:
    \return true if a repo was found, false otherwise.
    */
   bool GetRepoForAddon(const CStdString& addonID, CStdString& repo);
-  int AddRepository(const CStdString& id, const ADDON::VECADDONS& addons, const CStdString& checksum);
+  /*! \brief Store the addons of a repository.
+   Only the addons which were added or removed, or whose hash changed since they were
+   last stored, are written. Addons without a hash are always written.
+   \param id id of the repository
+   \param addons all addons of the repository
+   \param checksum checksum of the repository
+   \param hashes the hashes of the repository entries of the addons
+   \return the id of the repository on success, -1 on failure
+   \sa CRepository::GetEntryHash */
+  int AddRepository(const CStdString& id, const ADDON::VECADDONS& addons, const CStdString& checksum,
+                    const ADDON::ADDONHASHES& hashes = ADDON::ADDONHASHES());
   void DeleteRepository(const CStdString& id);
   void DeleteRepository(int id);
   int GetRepoChecksum(const std::string& id, std::string& checksum);
@@ -113,6 +126,12 @@ public:
    \sa DisableAddon, IsAddonDisabled */
   bool HasDisabledAddons();
 
+  /*! \brief Retrieve the ids of all addons disabled via DisableAddon.
+   \param addons [out] the ids of the disabled addons
+   \return true on success, false on failure
+   \sa DisableAddon, IsAddonDisabled */
+  bool GetDisabled(std::set<std::string> &addons);
+
   /*! @deprecated only here to allow clean upgrades from earlier pvr versions
    */
   bool IsSystemPVRAddonEnabled(const CStdString &addonID);
@@ -167,10 +186,11 @@ protected:
   virtual void CreateAnalytics();
   virtual void UpdateTables(int version);
   virtual int GetMinSchemaVersion() const { return 15; }
-  virtual int GetSchemaVersion() const { return 16; }
+  virtual int GetSchemaVersion() const { return 17; }
   const char *GetBaseDBName() const { return "Addons"; }
 
   bool GetAddon(int id, ADDON::AddonPtr& addon);
+  void DeleteAddon(int idAddon);
 
   /* keep in sync with the select in GetAddon */
   enum _AddonFields
@@ -23,6 +23,7 @@
 #include "utils/StringUtils.h"
 #include "utils/JobManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "FileItem.h"
 #include "LangInfo.h"
 #include "settings/AdvancedSettings.h"
@@ -316,6 +317,10 @@ bool CAddonMgr::Init()
 
 void CAddonMgr::DeInit()
 {
+  {
+    CSingleLock lock(m_critSection);
+    InvalidateRegistry();
+  }
   if (m_cpluff)
     m_cpluff->destroy();
   delete m_cpluff;
@@ -326,10 +331,7 @@ void CAddonMgr::DeInit()
 
 bool CAddonMgr::HasAddons(const TYPE &type, bool enabled /*= true*/)
 {
-  // TODO: This isn't particularly efficient as we create an addon type for each addon using the Factory, just so
-  //       we can check addon dependencies in the addon constructor.
-  VECADDONS addons;
-  return GetAddons(type, addons, enabled);
+  return !GetRegistry()->GetAddons(type, enabled).empty();
 }
 
 bool CAddonMgr::GetAllAddons(VECADDONS &addons, bool enabled /*= true*/, bool allowRepos /* = false */)
@@ -432,47 +434,89 @@ bool CAddonMgr::HasOutdatedAddons()
 
 bool CAddonMgr::GetAddons(const TYPE &type, VECADDONS &addons, bool enabled /* = true */)
 {
+  GetRegistry()->CopyAddons(type, enabled, addons);
+
+  // get a pointer to a running pvrclient if it's already started, or we won't be able to change settings
+  if (enabled && type == ADDON_PVRDLL && g_PVRManager.IsStarted())
+  {
+    for (VECADDONS::iterator it = addons.begin(); it != addons.end(); ++it)
+    {
+      AddonPtr pvrAddon;
+      if (g_PVRClients->GetClient((*it)->ID(), pvrAddon))
+        *it = pvrAddon;
+    }
+  }
+
+  if (enabled && type == ADDON_GAMEDLL)
+  {
+    for (VECADDONS::iterator it = addons.begin(); it != addons.end(); ++it)
+    {
+      GameClientPtr gameClient;
+      if (CGameManager::Get().GetClient((*it)->ID(), gameClient))
+        *it = gameClient;
+    }
+  }
+
+  return addons.size() > 0;
+}
+
+AddonRegistryPtr CAddonMgr::GetRegistry()
+{
+  AddonRegistryPtr registry = boost::atomic_load(&m_registry);
+  if (registry)
+    return registry;
+
   CSingleLock lock(m_critSection);
-  addons.clear();
+  // another thread may have built it while we were waiting
+  registry = boost::atomic_load(&m_registry);
+  if (!registry)
+  {
+    registry = BuildRegistry();
+    boost::atomic_store(&m_registry, registry);
+  }
+  return registry;
+}
+
+AddonRegistryPtr CAddonMgr::BuildRegistry()
+{
+  boost::shared_ptr<CAddonRegistry> registry(new CAddonRegistry);
+  if (!m_cpluff || !m_cp_context)
+    return registry;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  // one query instead of one per addon for those we haven't seen yet
+  std::set<std::string> disabled;
+  m_database.GetDisabled(disabled);
+
   cp_status_t status;
   int num;
-  CStdString ext_point(TranslateType(type));
-  cp_extension_t **exts = m_cpluff->get_extensions_info(m_cp_context, ext_point.c_str(), &status, &num);
-  for(int i=0; i <num; i++)
+  cp_extension_t **exts = m_cpluff->get_extensions_info(m_cp_context, NULL, &status, &num);
+  for (int i = 0; i < num; i++)
   {
     const cp_extension_t *props = exts[i];
-    if (IsAddonDisabled(props->plugin->identifier) != enabled)
-    {
-      // get a pointer to a running pvrclient if it's already started, or we won't be able to change settings
-      if (TranslateType(props->ext_point_id) == ADDON_PVRDLL &&
-          enabled &&
-          g_PVRManager.IsStarted())
-      {
-        AddonPtr pvrAddon;
-        if (g_PVRClients->GetClient(props->plugin->identifier, pvrAddon))
-        {
-          addons.push_back(pvrAddon);
-          continue;
-        }
-      }
+    if (TranslateType(props->ext_point_id) == ADDON_UNKNOWN)
+      continue;
 
-      if (enabled && TranslateType(props->ext_point_id) == ADDON_GAMEDLL)
-      {
-        GameClientPtr gameClient;
-        if (CGameManager::Get().GetClient(props->plugin->identifier, gameClient))
-        {
-          addons.push_back(gameClient);
-          continue;
-        }
-      }
+    AddonPtr addon(Factory(props));
+    if (!addon)
+      continue;
 
-      AddonPtr addon(Factory(props));
-      if (addon)
-        addons.push_back(addon);
-    }
+    std::map<std::string, bool>::const_iterator it = m_disabled.find(addon->ID());
+    if (it == m_disabled.end())
+      it = m_disabled.insert(make_pair(addon->ID(), disabled.find(addon->ID()) != disabled.end())).first;
+    registry->Add(addon, it->second);
   }
-  m_cpluff->release_info(m_cp_context, exts);
-  return addons.size() > 0;
+  if (exts)
+    m_cpluff->release_info(m_cp_context, exts);
+
+  CLog::Log(LOGDEBUG, "ADDONS: built registry of %u addons in %u ms", registry->Size(), XbmcThreads::SystemClockMillis() - start);
+  return registry;
+}
+
+void CAddonMgr::InvalidateRegistry()
+{
+  boost::atomic_store(&m_registry, AddonRegistryPtr());
 }
 
 bool CAddonMgr::GetAddon(const CStdString &str, AddonPtr &addon, const TYPE &type/*=ADDON_UNKNOWN*/, bool enabledOnly /*= true*/)
@@ -590,6 +634,7 @@ void CAddonMgr::FindAddons()
     if (m_cpluff && m_cp_context)
     {
       m_cpluff->scan_plugins(m_cp_context, CP_SP_UPGRADE);
+      InvalidateRegistry();
       SetChanged();
     }
   }
@@ -601,6 +646,10 @@ void CAddonMgr::RemoveAddon(const CStdString& ID)
   if (m_cpluff && m_cp_context)
   {
     m_cpluff->uninstall_plugin(m_cp_context,ID.c_str());
+    {
+      CSingleLock lock(m_critSection);
+      InvalidateRegistry();
+    }
     SetChanged();
     NotifyObservers(ObservableMessageAddons);
   }
@@ -612,6 +661,7 @@ bool CAddonMgr::DisableAddon(const std::string& ID, bool disable)
   if (m_database.DisableAddon(ID, disable))
   {
     m_disabled[ID] = disable;
+    InvalidateRegistry();
     return true;
   }
 
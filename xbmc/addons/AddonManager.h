@@ -26,6 +26,7 @@
 #include <map>
 #include <deque>
 #include "AddonDatabase.h"
+#include "AddonRegistry.h"
 
 class DllLibCPluff;
 extern "C"
@@ -92,7 +93,22 @@ namespace ADDON
      */
     bool GetAddon(const CStdString &id, AddonPtr &addon, const TYPE &type = ADDON_UNKNOWN, bool enabledOnly = true);
     bool HasAddons(const TYPE &type, bool enabled = true);
+    /*! \brief Retrieve the installed addons of a type
+     The addons are copies made from the current registry snapshot, which the caller may change.
+     \param type the type of addons to retrieve.
+     \param addons [out] the retrieved addons.
+     \param enabled whether to retrieve the enabled or the disabled addons - defaults to true.
+     \return true if any addons were retrieved.
+     \sa GetRegistry
+     */
     bool GetAddons(const TYPE &type, VECADDONS &addons, bool enabled = true);
+    /*! \brief Retrieve a snapshot of the installed addons
+     The snapshot is built on first use after addons were installed, removed, enabled or
+     disabled. Until then it's shared by all callers without taking any lock.
+     \return the current snapshot, which stays valid for as long as it is held.
+     Its addons are shared, use GetAddons() for addons that may be changed.
+     */
+    AddonRegistryPtr GetRegistry();
     bool GetAllAddons(VECADDONS &addons, bool enabled = true, bool allowRepos = false);
     void AddToUpdateableAddons(AddonPtr &pAddon);
     void RemoveFromUpdateableAddons(AddonPtr &pAddon);    
@@ -211,6 +227,11 @@ namespace ADDON
     AddonPtr Factory(const cp_extension_t *props);
     bool CheckUserDirs(const cp_cfg_element_t *element);
 
+    /*! \brief Build a snapshot of the installed addons, with m_critSection held */
+    AddonRegistryPtr BuildRegistry();
+    /*! \brief Drop the current snapshot so the next reader builds a new one, with m_critSection held */
+    void InvalidateRegistry();
+
     // private construction, and no assignements; use the provided singleton methods
     CAddonMgr();
     CAddonMgr(const CAddonMgr&);
@@ -218,6 +239,7 @@ namespace ADDON
     virtual ~CAddonMgr();
 
     std::map<std::string, bool> m_disabled;
+    AddonRegistryPtr m_registry; ///< only accessed through boost::atomic_load and boost::atomic_store
     static std::map<TYPE, IAddonMgrCallback*> m_managers;
     CCriticalSection m_critSection;
     CAddonDatabase m_database;
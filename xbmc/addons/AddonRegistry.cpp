@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AddonRegistry.h"
+#include "AddonManager.h"
+#include "utils/StringUtils.h"
+
+using namespace std;
+
+namespace ADDON
+{
+
+static const VECADDONS empty;
+
+void CAddonRegistry::Add(const AddonPtr &addon, bool disabled)
+{
+  if (disabled)
+  {
+    m_disabled[addon->Type()].push_back(addon);
+    m_disabledIDs.insert(addon->ID());
+  }
+  else
+    m_enabled[addon->Type()].push_back(addon);
+
+  if (!addon->Props().broken.empty())
+    m_brokenIDs.insert(addon->ID());
+  m_size++;
+}
+
+const VECADDONS &CAddonRegistry::GetAddons(const TYPE &type, bool enabled) const
+{
+  const map<TYPE, VECADDONS> &addons = enabled ? m_enabled : m_disabled;
+  map<TYPE, VECADDONS>::const_iterator it = addons.find(type);
+  if (it == addons.end())
+    return empty;
+  return it->second;
+}
+
+void CAddonRegistry::CopyAddons(const TYPE &type, bool enabled, VECADDONS &addons) const
+{
+  const VECADDONS &shared = GetAddons(type, enabled);
+  addons.clear();
+  addons.reserve(shared.size());
+  for (VECADDONS::const_iterator it = shared.begin(); it != shared.end(); ++it)
+    addons.push_back(Copy(*it));
+}
+
+AddonPtr CAddonRegistry::Copy(const AddonPtr &addon)
+{
+  // copies of dll addons share the library of the original and the pvr, game
+  // and visualisation clients don't implement Clone(), so those are created
+  // anew from their properties. Built in screensavers are plain addons.
+  switch (addon->Type())
+  {
+    case ADDON_SCREENSAVER:
+      if (StringUtils::StartsWithNoCase(addon->ID(), "screensaver.xbmc.builtin."))
+        break;
+      // fall through
+    case ADDON_VIZ:
+    case ADDON_PVRDLL:
+    case ADDON_GAMEDLL:
+      {
+        AddonProps props(addon->Props());
+        AddonPtr copy = CAddonMgr::AddonFromProps(props);
+        if (copy)
+          return copy;
+      }
+      break;
+    default:
+      break;
+  }
+  return addon->Clone();
+}
+
+}; /* namespace ADDON */
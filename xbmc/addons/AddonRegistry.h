@@ -0,0 +1,89 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "Addon.h"
+
+namespace ADDON
+{
+  class CAddonRegistry;
+  typedef boost::shared_ptr<const CAddonRegistry> AddonRegistryPtr;
+
+  /**
+  * Class - CAddonRegistry
+  * An immutable snapshot of the installed addons by type,
+  * along with their disabled and broken state.
+  * CAddonMgr builds a new one whenever addons are installed,
+  * removed, enabled or disabled, and hands the current one
+  * out to any number of readers without locking.
+  *
+  * The addons are shared by everyone holding the snapshot,
+  * so they must not be changed or used directly - callers
+  * get their own copies through CopyAddons() instead.
+  */
+  class CAddonRegistry
+  {
+  public:
+    CAddonRegistry() : m_size(0) {};
+
+    /*! \brief Add an addon while building the registry
+     \param addon the addon, added for its type.
+     \param disabled whether the addon is disabled.
+     */
+    void Add(const AddonPtr &addon, bool disabled);
+
+    /*! \brief Retrieve the addons of a type
+     \param type the type of addons.
+     \param enabled whether to retrieve the enabled or the disabled addons.
+     \return the addons in the order they were added.
+     */
+    const VECADDONS &GetAddons(const TYPE &type, bool enabled) const;
+
+    /*! \brief Retrieve copies of the addons of a type
+     The copies belong to the caller, which may change, create or destroy them.
+     \param type the type of addons.
+     \param enabled whether to retrieve the enabled or the disabled addons.
+     \param addons [out] the copies, in the order the addons were added.
+     */
+    void CopyAddons(const TYPE &type, bool enabled, VECADDONS &addons) const;
+
+    /*! \brief Copy an addon of the registry
+     \param addon the addon to copy.
+     \return a new addon of the same class.
+     */
+    static AddonPtr Copy(const AddonPtr &addon);
+
+    bool IsDisabled(const std::string &id) const { return m_disabledIDs.find(id) != m_disabledIDs.end(); }
+    bool IsBroken(const std::string &id) const { return m_brokenIDs.find(id) != m_brokenIDs.end(); }
+    unsigned int Size() const { return m_size; }
+
+  private:
+    std::map<TYPE, VECADDONS> m_enabled;
+    std::map<TYPE, VECADDONS> m_disabled;
+    std::set<std::string> m_disabledIDs;
+    std::set<std::string> m_brokenIDs;
+    unsigned int m_size;
+  };
+
+}; /* namespace ADDON */
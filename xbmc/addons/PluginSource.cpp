@@ -45,6 +45,15 @@ CPluginSource::CPluginSource(const cp_extension_t *ext)
     provides = CAddonMgr::Get().GetExtValue(ext->configuration, "provides");
     if (!provides.empty())
       Props().extrainfo.insert(make_pair("provides", provides));
+
+    // python plugins may opt in to having their interpreter kept around and
+    // reused, optionally keeping some of their module level globals
+    CStdString reuse = CAddonMgr::Get().GetExtValue(ext->configuration, "@reuseinterpreter");
+    if (!reuse.empty())
+      Props().extrainfo.insert(make_pair("reuseinterpreter", reuse));
+    CStdString keep = CAddonMgr::Get().GetExtValue(ext->configuration, "@keepglobals");
+    if (!keep.empty())
+      Props().extrainfo.insert(make_pair("keepglobals", keep));
   }
   SetProvides(provides);
 }
@@ -29,6 +29,7 @@
 #include "pvr/PVRManager.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/md5.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/XBMCTinyXML.h"
@@ -166,10 +167,44 @@ string CRepository::GetAddonHash(const AddonPtr& addon) const
        x = y; \
   }
 
-VECADDONS CRepository::Parse(const DirInfo& dir)
+// number of index entries handed to the addon manager at once
+#define PARSE_BATCH_SIZE 100
+
+static void ParseEntries(const vector<string> &entries, CRepositoryIndexReader &reader, const CRepository::DirInfo& dir, VECADDONS &result, ADDONHASHES *hashes)
 {
-  VECADDONS result;
+  // the prolog carries the encoding declaration of the index
+  string xml = reader.GetProlog() + "<addons>";
+  for (vector<string>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    xml += *it;
+  xml += "</addons>";
+
   CXBMCTinyXML doc;
+  if (!doc.Parse(xml, reader.GetCharset()) || !doc.RootElement())
+  {
+    CLog::Log(LOGERROR, "%s - failed to parse entries of %s", __FUNCTION__, dir.info.c_str());
+    return;
+  }
+
+  if (hashes)
+  {
+    const TiXmlElement *element = doc.RootElement()->FirstChildElement("addon");
+    for (vector<string>::const_iterator it = entries.begin(); it != entries.end() && element; ++it)
+    {
+      // of entries with the same version the first one is kept, as in MergeAddons
+      const char *id = element->Attribute("id");
+      const char *version = element->Attribute("version");
+      if (id && version)
+        hashes->insert(make_pair(CRepository::GetHashKey(id, AddonVersion(version)), CRepository::GetEntryHash(dir, *it)));
+      element = element->NextSiblingElement("addon");
+    }
+  }
+
+  CAddonMgr::Get().AddonsFromRepoXML(doc.RootElement(), result);
+}
+
+VECADDONS CRepository::Parse(const DirInfo& dir, ADDONHASHES *hashes /* = NULL */)
+{
+  VECADDONS result;
 
   string file = dir.info;
   if (dir.compressed)
@@ -182,9 +217,22 @@ VECADDONS CRepository::Parse(const DirInfo& dir)
     file = url.Get();
   }
 
-  if (doc.LoadFile(file) && doc.RootElement())
+  CRepositoryIndexReader reader;
+  if (reader.Open(file))
   {
-    CAddonMgr::Get().AddonsFromRepoXML(doc.RootElement(), result);
+    vector<string> entries;
+    string entry;
+    while (reader.ReadEntry(entry))
+    {
+      entries.push_back(entry);
+      if (entries.size() >= PARSE_BATCH_SIZE)
+      {
+        ParseEntries(entries, reader, dir, result, hashes);
+        entries.clear();
+      }
+    }
+    ParseEntries(entries, reader, dir, result, hashes);
+
     for (IVECADDONS i = result.begin(); i != result.end(); ++i)
     {
       AddonPtr addon = *i;
@@ -210,6 +258,190 @@ VECADDONS CRepository::Parse(const DirInfo& dir)
   return result;
 }
 
+string CRepository::GetHashKey(const string& id, const AddonVersion& version)
+{
+  return id + "-" + version.asString();
+}
+
+string CRepository::GetEntryHash(const DirInfo& dir, const string& entry)
+{
+  // the paths of the addon are built from the directory info
+  XBMC::XBMC_MD5 md5;
+  md5.append(dir.datadir);
+  md5.append(dir.zipped ? "zip" : "dir");
+  md5.append(entry);
+  CStdString digest;
+  md5.getDigest(digest);
+  return digest;
+}
+
+CRepositoryIndexReader::CRepositoryIndexReader()
+  : m_pos(0), m_eof(true), m_root(false)
+{
+}
+
+bool CRepositoryIndexReader::Open(const string& file)
+{
+  Close();
+  if (!m_file.Open(file))
+    return false;
+  m_eof = false;
+  return true;
+}
+
+void CRepositoryIndexReader::Close()
+{
+  m_file.Close();
+  m_buffer.clear();
+  m_prolog.clear();
+  m_pos = 0;
+  m_eof = true;
+  m_root = false;
+}
+
+string CRepositoryIndexReader::GetCharset()
+{
+  return m_file.GetContentCharset();
+}
+
+bool CRepositoryIndexReader::Fill()
+{
+  if (m_eof)
+    return false;
+
+  // drop what has been read already before growing the buffer
+  if (m_pos > 0)
+  {
+    m_buffer.erase(0, m_pos);
+    m_pos = 0;
+  }
+
+  char temp[16384];
+  unsigned int read = m_file.Read(temp, sizeof(temp));
+  if (read == 0)
+  {
+    m_eof = true;
+    return false;
+  }
+  m_buffer.append(temp, read);
+  return true;
+}
+
+size_t CRepositoryIndexReader::FindTagEnd(size_t pos) const
+{
+  // attribute values may hold a '>'
+  char quote = 0;
+  for (; pos < m_buffer.size(); ++pos)
+  {
+    char c = m_buffer[pos];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '"' || c == '\'')
+      quote = c;
+    else if (c == '>')
+      return pos + 1;
+  }
+  return string::npos;
+}
+
+size_t CRepositoryIndexReader::SkipMarkup(size_t pos) const
+{
+  static const char *sections[][2] = { { "<!--", "-->" }, { "<![CDATA[", "]]>" }, { "<?", "?>" } };
+
+  size_t left = m_buffer.size() - pos;
+  for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++)
+  {
+    size_t length = strlen(sections[i][0]);
+    if (left < length && m_buffer.compare(pos, left, sections[i][0], left) == 0)
+      return string::npos;
+    if (m_buffer.compare(pos, length, sections[i][0]) == 0)
+    {
+      size_t end = m_buffer.find(sections[i][1], pos + length);
+      return end != string::npos ? end + strlen(sections[i][1]) : string::npos;
+    }
+  }
+  if (m_buffer.compare(pos, 2, "<!") == 0)
+    return FindTagEnd(pos);
+  return pos;
+}
+
+size_t CRepositoryIndexReader::FindElementEnd(size_t pos) const
+{
+  int depth = 0;
+  while ((pos = m_buffer.find('<', pos)) != string::npos)
+  {
+    size_t end = SkipMarkup(pos);
+    if (end == string::npos)
+      return string::npos;
+    if (end == pos)
+    {
+      if ((end = FindTagEnd(pos)) == string::npos)
+        return string::npos;
+      if (m_buffer[pos + 1] == '/')
+        depth--;
+      else if (m_buffer[end - 2] != '/')
+        depth++;
+      if (depth == 0)
+        return end;
+    }
+    pos = end;
+  }
+  return string::npos;
+}
+
+bool CRepositoryIndexReader::ReadEntry(string& entry)
+{
+  while (true)
+  {
+    size_t pos = m_pos;
+    while ((pos = m_buffer.find('<', pos)) != string::npos)
+    {
+      size_t end = SkipMarkup(pos);
+      if (end == string::npos)
+        break;
+      if (end == pos)
+      {
+        size_t name = pos + 1;
+        while (name < m_buffer.size() && !isspace((unsigned char)m_buffer[name]) && m_buffer[name] != '/' && m_buffer[name] != '>')
+          name++;
+        if (name == m_buffer.size())
+          break;
+
+        // keep the xml declaration and anything else in front of the root for ParseEntries
+        if (!m_root)
+        {
+          m_prolog = m_buffer.substr(0, pos);
+          m_root = true;
+        }
+
+        if (m_buffer.compare(pos, name - pos, "<addon") == 0)
+        {
+          if ((end = FindElementEnd(pos)) == string::npos)
+            break;
+          entry = m_buffer.substr(pos, end - pos);
+          m_pos = end;
+          return true;
+        }
+
+        // step into any other element, like the <addons> root
+        if ((end = FindTagEnd(pos)) == string::npos)
+          break;
+      }
+      pos = end;
+      if (m_root)
+        m_pos = pos;
+    }
+    if (pos == string::npos && m_root)
+      m_pos = m_buffer.size();
+
+    if (!Fill())
+      return false;
+  }
+}
+
 CRepositoryUpdateJob::CRepositoryUpdateJob(const VECADDONS &repos)
   : m_repos(repos)
 {
@@ -355,12 +587,27 @@ VECADDONS CRepositoryUpdateJob::GrabAddons(RepositoryPtr& repo)
   if (checksum != reposum || checksum.empty())
   {
     map<string, AddonPtr> uniqueAddons;
+    ADDONHASHES hashes;
     for (CRepository::DirList::const_iterator it = repo->m_dirs.begin(); it != repo->m_dirs.end(); ++it)
     {
       if (ShouldCancel(0, 0))
         return addons;
-      VECADDONS addons2 = CRepository::Parse(*it);
+      ADDONHASHES hashes2;
+      VECADDONS addons2 = CRepository::Parse(*it, &hashes2);
       MergeAddons(uniqueAddons, addons2);
+
+      // keep the hashes of the entries which made it into the merged list,
+      // an index may list other versions of the same add-on as well
+      for (VECADDONS::const_iterator i = addons2.begin(); i != addons2.end(); ++i)
+      {
+        if (uniqueAddons[(*i)->ID()] != *i)
+          continue;
+        ADDONHASHES::const_iterator hash = hashes2.find(CRepository::GetHashKey((*i)->ID(), (*i)->Version()));
+        if (hash != hashes2.end())
+          hashes[(*i)->ID()] = hash->second;
+        else
+          hashes.erase((*i)->ID());
+      }
     }
 
     if (uniqueAddons.empty())
@@ -381,7 +628,7 @@ VECADDONS CRepositoryUpdateJob::GrabAddons(RepositoryPtr& repo)
       {
         for (map<string, AddonPtr>::const_iterator i = uniqueAddons.begin(); i != uniqueAddons.end(); ++i)
           addons.push_back(i->second);
-        database.AddRepository(repo->ID(),addons,reposum);
+        database.AddRepository(repo->ID(),addons,reposum,hashes);
       }
     }
   }
@@ -20,6 +20,7 @@
  */
 
 #include "Addon.h"
+#include "filesystem/File.h"
 #include "utils/Job.h"
 
 namespace ADDON
@@ -57,12 +58,74 @@ namespace ADDON
     typedef std::vector<DirInfo> DirList;
     DirList m_dirs;
 
-    static VECADDONS Parse(const DirInfo& dir);
+    /*! \brief Parse the addons of a repository index.
+     \param dir the repository directory whose index to parse.
+     \param hashes [out] if given, the hashes of the index entries of the returned addons, keyed by GetHashKey.
+     \return the addons in the index.
+     \sa GetEntryHash
+     */
+    static VECADDONS Parse(const DirInfo& dir, ADDONHASHES *hashes = NULL);
     static std::string FetchChecksum(const std::string& url);
+
+    /*! \brief Get the key of an addon in the hashes returned by Parse.
+     An index may list several versions of an addon, so the key is made up of its id and version.
+     */
+    static std::string GetHashKey(const std::string& id, const AddonVersion& version);
+
+    /*! \brief Get the hash of an index entry.
+     The hash changes whenever the entry or anything else the addon is built from changes.
+     \param dir the repository directory the entry was read from.
+     \param entry the xml of the entry, as read by CRepositoryIndexReader.
+     \return the hash of the entry.
+     */
+    static std::string GetEntryHash(const DirInfo& dir, const std::string& entry);
   private:
     CRepository(const CRepository &rhs);
   };
 
+  /*!
+   \brief Reads the <addon> entries of a repository index one at a time.
+   Only the entry being read is kept in memory, so large indexes are never
+   loaded as a whole. Comments, CDATA sections and processing instructions are
+   skipped, and attribute values may hold a '>'.
+   */
+  class CRepositoryIndexReader
+  {
+  public:
+    CRepositoryIndexReader();
+
+    bool Open(const std::string& file);
+    void Close();
+
+    /*! \brief Read the next entry of the index.
+     \param entry [out] the xml of the <addon> element.
+     \return true if an entry was read, false at the end of the index.
+     */
+    bool ReadEntry(std::string& entry);
+
+    /*! \brief Everything in front of the root element, like the xml declaration.
+     Valid once the first entry was read. The entries are parsed with it in front,
+     so the encoding declared by the index is used.
+     */
+    const std::string& GetProlog() const { return m_prolog; }
+
+    /*! \brief The charset the index was served with, if any. */
+    std::string GetCharset();
+
+  private:
+    bool Fill();
+    size_t FindTagEnd(size_t pos) const;
+    size_t SkipMarkup(size_t pos) const;
+    size_t FindElementEnd(size_t pos) const;
+
+    XFILE::CFile m_file;
+    std::string m_buffer;
+    std::string m_prolog;
+    size_t m_pos;
+    bool m_eof;
+    bool m_root;
+  };
+
   class CRepositoryUpdateJob : public CJob
   {
   public:
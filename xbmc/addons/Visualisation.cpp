@@ -19,7 +19,6 @@
  */
 #include "system.h"
 #include "Visualisation.h"
-#include "utils/fft.h"
 #include "GUIInfoManager.h"
 #include "Application.h"
 #include "guilib/GraphicContext.h"
@@ -281,10 +280,12 @@ void CVisualisation::OnAudioData(const float* pAudioData, int iAudioDataLength)
   if (m_bWantsFreq)
   {
     const float *psAudioData = ptrAudioBuffer->Get();
-    memcpy(m_fFreq, psAudioData, AUDIO_BUFFER_SIZE * sizeof(float));
+    // the transform takes AUDIO_BUFFER_SIZE stereo frames, pad the samples with silence
+    memcpy(m_fSamples, psAudioData, AUDIO_BUFFER_SIZE * sizeof(float));
+    memset(m_fSamples + AUDIO_BUFFER_SIZE, 0, AUDIO_BUFFER_SIZE * sizeof(float));
 
     // FFT the data
-    twochanwithwindow(m_fFreq, AUDIO_BUFFER_SIZE);
+    m_transform.CalcStereoPower(m_fSamples, m_fFreq);
 
     // Normalize the data
     float fMinData = (float)AUDIO_BUFFER_SIZE * AUDIO_BUFFER_SIZE * 3 / 8 * 0.5 * 0.5; // 3/8 for the Hann window, 0.5 as minimum amplitude
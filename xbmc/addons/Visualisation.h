@@ -23,6 +23,7 @@
 #include "cores/IAudioCallback.h"
 #include "include/xbmc_vis_types.h"
 #include "guilib/IRenderingCallback.h"
+#include "utils/fft.h"
 
 #include <map>
 #include <list>
@@ -55,8 +56,8 @@ namespace ADDON
                        , public IRenderingCallback
   {
   public:
-    CVisualisation(const ADDON::AddonProps &props) : CAddonDll<DllVisualisation, Visualisation, VIS_PROPS>(props) {}
-    CVisualisation(const cp_extension_t *ext) : CAddonDll<DllVisualisation, Visualisation, VIS_PROPS>(ext) {}
+    CVisualisation(const ADDON::AddonProps &props) : CAddonDll<DllVisualisation, Visualisation, VIS_PROPS>(props), m_transform(AUDIO_BUFFER_SIZE, true) {}
+    CVisualisation(const cp_extension_t *ext) : CAddonDll<DllVisualisation, Visualisation, VIS_PROPS>(ext), m_transform(AUDIO_BUFFER_SIZE, true) {}
     virtual void OnInitialize(int iChannels, int iSamplesPerSec, int iBitsPerSample);
     virtual void OnAudioData(const float* pAudioData, int iAudioDataLength);
     bool Create(int x, int y, int w, int h, void *device);
@@ -102,7 +103,9 @@ namespace ADDON
     std::list<CAudioBuffer*> m_vecBuffers;
     int m_iNumBuffers;        // Number of Audio buffers
     bool m_bWantsFreq;
+    float m_fSamples[2*AUDIO_BUFFER_SIZE];      // Input of the transform
     float m_fFreq[2*AUDIO_BUFFER_SIZE];         // Frequency data
+    CRealFFT m_transform;
     bool m_bCalculate_Freq;       // True if the vis wants freq data
 
     // track information
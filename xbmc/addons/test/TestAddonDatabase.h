@@ -0,0 +1,66 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "addons/AddonDatabase.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+/*!
+ \brief An add-on database of its own in special://temp for the tests.
+ Open() creates it, or upgrades an older version found under the same name,
+ and Delete() removes it again.
+ */
+class CTestAddonDatabase : public CAddonDatabase
+{
+public:
+  CTestAddonDatabase(const std::string &name)
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    m_settings.name = name;
+  }
+
+  virtual bool Open()
+  {
+    return Update(m_settings);
+  }
+
+  void Delete()
+  {
+    Close();
+    XFILE::CFile::Delete(GetPath(GetSchemaVersion()));
+  }
+
+  /*! \brief Path of the database file of a schema version */
+  std::string GetPath(int version) const
+  {
+    return URIUtils::AddFileToFolder(m_settings.host, StringUtils::Format("%s%i.db", m_settings.name.c_str(), version));
+  }
+
+  using CAddonDatabase::GetSchemaVersion;
+
+private:
+  DatabaseSettings m_settings;
+};
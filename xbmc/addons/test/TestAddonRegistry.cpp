@@ -0,0 +1,184 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addons/AddonManager.h"
+#include "addons/AddonRegistry.h"
+#include "addons/PluginSource.h"
+#include "games/GameClient.h"
+#include "TestAddonDatabase.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace ADDON;
+
+static const int addonCount = 500;
+
+class TestAddonRegistry : public testing::Test
+{
+protected:
+  // a mix of plugins and scripts, every 10th disabled and every 50th broken
+  virtual void SetUp()
+  {
+    for (int i = 0; i < addonCount; i++)
+    {
+      AddonProps props(StringUtils::Format("addon.test.registry%03i", i), i % 2 ? ADDON_SCRIPT : ADDON_PLUGIN, "1.0.0", "");
+      props.name = StringUtils::Format("Test add-on %i", i);
+      props.path = StringUtils::Format("special://temp/addons/%s/", props.id.c_str());
+      if (i % 50 == 0)
+        props.broken = "Generated broken";
+      m_manifests.push_back(props);
+    }
+  }
+
+  AddonRegistryPtr Build()
+  {
+    boost::shared_ptr<CAddonRegistry> registry(new CAddonRegistry);
+    for (unsigned int i = 0; i < m_manifests.size(); i++)
+      registry->Add(CAddonMgr::AddonFromProps(m_manifests[i]), i % 10 == 0);
+    return registry;
+  }
+
+  VECADDONPROPS m_manifests;
+};
+
+TEST_F(TestAddonRegistry, Lookup)
+{
+  AddonRegistryPtr registry = Build();
+  EXPECT_EQ((unsigned int)addonCount, registry->Size());
+
+  const VECADDONS &plugins = registry->GetAddons(ADDON_PLUGIN, true);
+  ASSERT_EQ(200U, plugins.size());
+  EXPECT_EQ("addon.test.registry002", plugins[0]->ID());
+  EXPECT_EQ("addon.test.registry498", plugins.back()->ID());
+  EXPECT_EQ(50U, registry->GetAddons(ADDON_PLUGIN, false).size());
+  EXPECT_EQ(250U, registry->GetAddons(ADDON_SCRIPT, true).size());
+  EXPECT_TRUE(registry->GetAddons(ADDON_SCRIPT, false).empty());
+  EXPECT_TRUE(registry->GetAddons(ADDON_SKIN, true).empty());
+
+  EXPECT_TRUE(registry->IsDisabled("addon.test.registry010"));
+  EXPECT_FALSE(registry->IsDisabled("addon.test.registry011"));
+  EXPECT_TRUE(registry->IsBroken("addon.test.registry050"));
+  EXPECT_FALSE(registry->IsBroken("addon.test.registry051"));
+  EXPECT_FALSE(registry->IsDisabled("addon.test.unknown"));
+}
+
+TEST_F(TestAddonRegistry, Snapshot)
+{
+  AddonRegistryPtr registry = Build();
+  AddonPtr addon = registry->GetAddons(ADDON_SCRIPT, true)[0];
+
+  // readers holding the old snapshot are unaffected by a rebuild
+  AddonRegistryPtr held = registry;
+  m_manifests.pop_back();
+  registry = Build();
+  EXPECT_EQ((unsigned int)addonCount, held->Size());
+  EXPECT_EQ((unsigned int)addonCount - 1, registry->Size());
+  EXPECT_EQ(addon, held->GetAddons(ADDON_SCRIPT, true)[0]);
+  EXPECT_NE(addon, registry->GetAddons(ADDON_SCRIPT, true)[0]);
+}
+
+TEST_F(TestAddonRegistry, Copies)
+{
+  AddonRegistryPtr registry = Build();
+  const VECADDONS &shared = registry->GetAddons(ADDON_PLUGIN, true);
+  VECADDONS copies;
+  registry->CopyAddons(ADDON_PLUGIN, true, copies);
+  ASSERT_EQ(shared.size(), copies.size());
+  for (unsigned int i = 0; i < copies.size(); i++)
+  {
+    EXPECT_NE(shared[i], copies[i]);
+    EXPECT_EQ(shared[i]->ID(), copies[i]->ID());
+    EXPECT_TRUE(boost::dynamic_pointer_cast<CPluginSource>(copies[i]));
+  }
+
+  // changing a copy leaves the registry alone
+  copies[0]->Props().name = "Changed";
+  EXPECT_EQ("Test add-on 2", shared[0]->Name());
+
+  // dll clients don't implement Clone(), they are created anew instead of
+  // being cut down to their base class
+  AddonProps props("game.test.registry", ADDON_GAMEDLL, "1.0.0", "");
+  props.path = "special://temp/addons/game.test.registry/";
+  CAddonRegistry clients;
+  clients.Add(CAddonMgr::AddonFromProps(props), false);
+  clients.CopyAddons(ADDON_GAMEDLL, true, copies);
+  ASSERT_EQ(1U, copies.size());
+  EXPECT_NE(clients.GetAddons(ADDON_GAMEDLL, true)[0], copies[0]);
+  EXPECT_TRUE(boost::dynamic_pointer_cast<GAME::CGameClient>(copies[0]));
+}
+
+TEST_F(TestAddonRegistry, ManagerSnapshot)
+{
+  // without cpluff the manager builds empty snapshots, which is enough to
+  // see them being shared until they are dropped
+  CAddonMgr &manager = CAddonMgr::Get();
+  AddonRegistryPtr registry = manager.GetRegistry();
+  ASSERT_TRUE(registry);
+  EXPECT_EQ(0U, registry->Size());
+  EXPECT_EQ(registry, manager.GetRegistry());
+
+  // like installing, removing, enabling or disabling add-ons
+  manager.DeInit();
+  AddonRegistryPtr rebuilt = manager.GetRegistry();
+  ASSERT_TRUE(rebuilt);
+  EXPECT_NE(registry, rebuilt);
+  EXPECT_EQ(rebuilt, manager.GetRegistry());
+
+  VECADDONS addons;
+  EXPECT_FALSE(manager.GetAddons(ADDON_PLUGIN, addons));
+}
+
+TEST_F(TestAddonRegistry, DisabledFromDatabase)
+{
+  // the disabled state comes from an add-on database, as in CAddonMgr
+  CTestAddonDatabase database("TestAddonRegistry");
+  ASSERT_TRUE(database.Open());
+  for (unsigned int i = 0; i < m_manifests.size(); i += 10)
+    database.DisableAddon(m_manifests[i].id);
+
+  // what every GetAddons call used to do once cpluff listed the addons:
+  // query the disabled state of each addon and create it anew
+  std::vector<std::string> expected;
+  for (unsigned int i = 0; i < m_manifests.size(); i++)
+  {
+    if (m_manifests[i].type == ADDON_PLUGIN && !database.IsAddonDisabled(m_manifests[i].id))
+      expected.push_back(m_manifests[i].id);
+  }
+
+  // the registry is built with a single query for the disabled addons
+  std::set<std::string> disabled;
+  database.GetDisabled(disabled);
+  boost::shared_ptr<CAddonRegistry> registry(new CAddonRegistry);
+  for (unsigned int i = 0; i < m_manifests.size(); i++)
+    registry->Add(CAddonMgr::AddonFromProps(m_manifests[i]), disabled.find(m_manifests[i].id) != disabled.end());
+  database.Delete();
+
+  VECADDONS addons;
+  registry->CopyAddons(ADDON_PLUGIN, true, addons);
+  std::vector<std::string> ids;
+  for (unsigned int i = 0; i < addons.size(); i++)
+    ids.push_back(addons[i]->ID());
+  std::sort(expected.begin(), expected.end());
+  std::sort(ids.begin(), ids.end());
+  EXPECT_TRUE(expected == ids);
+}
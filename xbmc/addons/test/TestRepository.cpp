@@ -0,0 +1,306 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addons/AddonManager.h"
+#include "addons/Repository.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "TestAddonDatabase.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <map>
+
+using namespace ADDON;
+
+static const int addonCount = 1000;
+
+static std::string GenerateEntry(int i, const char *version)
+{
+  return StringUtils::Format(
+    "<addon id=\"plugin.test.repo%04i\" name=\"Test add-on %i\" version=\"%s\" provider-name=\"Team XBMC\">\n"
+    "  <requires>\n"
+    "    <import addon=\"xbmc.python\" version=\"2.1.0\"/>\n"
+    "  </requires>\n"
+    "  <extension point=\"xbmc.python.pluginsource\" library=\"default.py\">\n"
+    "    <provides>video</provides>\n"
+    "  </extension>\n"
+    "  <extension point=\"xbmc.addon.metadata\">\n"
+    "    <summary lang=\"en\">Generated add-on %i</summary>\n"
+    "    <platform>all</platform>\n"
+    "  </extension>\n"
+    "</addon>\n", i, i, version, i);
+}
+
+/*!
+ \brief An add-on database at schema version 16, before addonlinkrepo had hashes.
+ */
+class CTestAddonDatabase16 : public CTestAddonDatabase
+{
+public:
+  CTestAddonDatabase16(const std::string &name) : CTestAddonDatabase(name) {}
+
+  bool Create()
+  {
+    return Open() &&
+           ExecuteQuery("DROP TABLE addonlinkrepo") &&
+           ExecuteQuery("CREATE TABLE addonlinkrepo (idRepo integer, idAddon integer)");
+  }
+
+  virtual int GetSchemaVersion() const { return 16; }
+};
+
+class TestRepositoryIndex : public testing::Test
+{
+protected:
+  // the second version changes every 10th add-on, drops the last 20 and adds 30
+  virtual void SetUp()
+  {
+    std::string v1 = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<addons>\n";
+    std::string v2 = v1;
+    for (int i = 0; i < addonCount; i++)
+      v1 += GenerateEntry(i, "1.0.0");
+    for (int i = 0; i < addonCount + 30; i++)
+    {
+      if (i >= addonCount - 20 && i < addonCount)
+        continue;
+      v2 += GenerateEntry(i, i % 10 == 0 && i < addonCount ? "1.0.1" : "1.0.0");
+    }
+    v1 += "</addons>\n";
+    v2 += "</addons>\n";
+
+    m_v1 = Write("repo-v1.xml", v1);
+    m_v2 = Write("repo-v2.xml", v2);
+
+    m_dir.info = m_v1;
+    m_dir.datadir = "file://" + CSpecialProtocol::TranslatePath("special://temp/repo/");
+    m_dir.zipped = true;
+
+    // CRepository::Parse hands the entries to cpluff
+    ASSERT_TRUE(CAddonMgr::Get().Init());
+  }
+
+  virtual void TearDown()
+  {
+    CAddonMgr::Get().DeInit();
+    XFILE::CFile::Delete(m_v1);
+    XFILE::CFile::Delete(m_v2);
+  }
+
+  // serve the index from a file:// repository
+  std::string Write(const char *name, const std::string &content)
+  {
+    std::string path = "file://" + CSpecialProtocol::TranslatePath(std::string("special://temp/") + name);
+    XFILE::CFile file;
+    EXPECT_TRUE(file.OpenForWrite(path, true));
+    EXPECT_EQ((int)content.size(), file.Write(content.c_str(), content.size()));
+    file.Close();
+    return path;
+  }
+
+  // parse the index and store it as the add-ons of the test repository
+  void Store(CAddonDatabase &database, const std::string &index, const CRepository::DirInfo &dir)
+  {
+    CRepository::DirInfo info = dir;
+    info.info = index;
+    ADDONHASHES entryHashes;
+    VECADDONS addons = CRepository::Parse(info, &entryHashes);
+    EXPECT_EQ(addons.size(), entryHashes.size());
+
+    ADDONHASHES hashes;
+    for (VECADDONS::const_iterator it = addons.begin(); it != addons.end(); ++it)
+      hashes[(*it)->ID()] = entryHashes[CRepository::GetHashKey((*it)->ID(), (*it)->Version())];
+    EXPECT_LT(-1, database.AddRepository("repository.test", addons, index, hashes));
+  }
+
+  // add-on id -> row of the add-on in the database
+  std::map<std::string, int> GetRows(CAddonDatabase &database)
+  {
+    std::map<std::string, int> rows;
+    for (int i = 0; i < addonCount + 30; i++)
+    {
+      std::string id = StringUtils::Format("plugin.test.repo%04i", i);
+      CStdString row = database.GetSingleValue(database.PrepareSQL("select addon.id from addon join addonlinkrepo "
+                                                                   "on addon.id=addonlinkrepo.idAddon where addon.addonID='%s'", id.c_str()));
+      if (!row.empty())
+        rows[id] = atoi(row.c_str());
+    }
+    return rows;
+  }
+
+  std::string m_v1;
+  std::string m_v2;
+  CRepository::DirInfo m_dir;
+};
+
+TEST_F(TestRepositoryIndex, ReadEntries)
+{
+  CRepositoryIndexReader reader;
+  ASSERT_TRUE(reader.Open(m_v1));
+
+  std::string entry;
+  ASSERT_TRUE(reader.ReadEntry(entry));
+  EXPECT_EQ(GenerateEntry(0, "1.0.0"), entry + "\n");
+  EXPECT_EQ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", reader.GetProlog());
+
+  // entries spanning the read chunks come out whole
+  int count = 1;
+  while (reader.ReadEntry(entry))
+  {
+    EXPECT_EQ(GenerateEntry(count, "1.0.0"), entry + "\n");
+    count++;
+  }
+  EXPECT_EQ(addonCount, count);
+  EXPECT_FALSE(reader.ReadEntry(entry));
+
+  EXPECT_FALSE(reader.Open(m_v1 + ".missing"));
+}
+
+TEST_F(TestRepositoryIndex, ReadMarkup)
+{
+  // comments and CDATA sections may hold anything, attribute values may hold a '>'
+  std::string first = "<addon id=\"plugin.test.markup1\" name=\"Caf\xe9 > bar\" version=\"1.0.0\" provider-name=\"Team XBMC\">"
+                      "<extension point=\"xbmc.python.pluginsource\" library=\"default.py\"><provides>video</provides></extension>"
+                      "<extension point=\"xbmc.addon.metadata\"><description><![CDATA[</addon>]]></description>"
+                      "<!-- </addon> --><platform>all</platform></extension></addon>";
+  std::string second = "<addon id=\"plugin.test.markup2\" name=\"Second\" version=\"1.0.0\" provider-name=\"Team XBMC\">"
+                       "<extension point=\"xbmc.python.pluginsource\" library=\"default.py\"/></addon>";
+  std::string index = Write("repo-markup.xml",
+                            "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"
+                            "<!-- <addon id=\"plugin.test.comment\"/> -->\n"
+                            "<addons>\n" + first + "\n<![CDATA[<addon id=\"plugin.test.cdata\"/>]]>\n" + second + "\n</addons>\n");
+
+  CRepositoryIndexReader reader;
+  ASSERT_TRUE(reader.Open(index));
+  std::string entry;
+  ASSERT_TRUE(reader.ReadEntry(entry));
+  EXPECT_EQ(first, entry);
+  ASSERT_TRUE(reader.ReadEntry(entry));
+  EXPECT_EQ(second, entry);
+  EXPECT_FALSE(reader.ReadEntry(entry));
+  reader.Close();
+
+  // the entries are parsed in the encoding the index declares
+  CRepository::DirInfo dir = m_dir;
+  dir.info = index;
+  VECADDONS addons = CRepository::Parse(dir);
+  ASSERT_EQ(2U, addons.size());
+  EXPECT_EQ("plugin.test.markup1", addons[0]->ID());
+  EXPECT_EQ("Caf\xc3\xa9 > bar", addons[0]->Name());
+  EXPECT_EQ("plugin.test.markup2", addons[1]->ID());
+
+  XFILE::CFile::Delete(index);
+}
+
+TEST_F(TestRepositoryIndex, DuplicateVersions)
+{
+  // the hash of each version is kept, not the one of the last entry of an id
+  std::string newest = GenerateEntry(5, "1.0.1");
+  std::string oldest = GenerateEntry(5, "1.0.0");
+  std::string index = Write("repo-versions.xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<addons>\n" + newest + oldest + "</addons>\n");
+
+  CRepository::DirInfo dir = m_dir;
+  dir.info = index;
+  ADDONHASHES hashes;
+  VECADDONS addons = CRepository::Parse(dir, &hashes);
+  ASSERT_EQ(2U, addons.size());
+  ASSERT_EQ(2U, hashes.size());
+  std::string newestHash = CRepository::GetEntryHash(dir, newest.substr(0, newest.size() - 1));
+  std::string oldestHash = CRepository::GetEntryHash(dir, oldest.substr(0, oldest.size() - 1));
+  EXPECT_NE(newestHash, oldestHash);
+  EXPECT_EQ(newestHash, hashes[CRepository::GetHashKey("plugin.test.repo0005", AddonVersion("1.0.1"))]);
+  EXPECT_EQ(oldestHash, hashes[CRepository::GetHashKey("plugin.test.repo0005", AddonVersion("1.0.0"))]);
+
+  XFILE::CFile::Delete(index);
+}
+
+TEST_F(TestRepositoryIndex, AddRepository)
+{
+  CTestAddonDatabase database("TestRepositoryIndex");
+  ASSERT_TRUE(database.Open());
+
+  Store(database, m_v1, m_dir);
+  std::map<std::string, int> before = GetRows(database);
+  ASSERT_EQ((size_t)addonCount, before.size());
+
+  Store(database, m_v2, m_dir);
+  std::map<std::string, int> after = GetRows(database);
+  ASSERT_EQ((size_t)addonCount + 30 - 20, after.size());
+
+  // only the changed and added add-ons got new rows
+  int written = 0;
+  for (std::map<std::string, int>::const_iterator it = after.begin(); it != after.end(); ++it)
+  {
+    std::map<std::string, int>::const_iterator old = before.find(it->first);
+    if (old == before.end() || old->second != it->second)
+      written++;
+  }
+  EXPECT_EQ(98 + 30, written);
+  EXPECT_EQ(before["plugin.test.repo0001"], after["plugin.test.repo0001"]);
+  EXPECT_NE(before["plugin.test.repo0010"], after["plugin.test.repo0010"]);
+
+  AddonPtr addon;
+  ASSERT_TRUE(database.GetAddon("plugin.test.repo0010", addon));
+  EXPECT_EQ("1.0.1", addon->Version().asString());
+  EXPECT_TRUE(database.GetAddon("plugin.test.repo1029", addon));
+
+  // removed add-ons are deleted with everything that refers to them
+  EXPECT_FALSE(database.GetAddon("plugin.test.repo0999", addon));
+  EXPECT_EQ("1010", database.GetSingleValue("select count(*) from addonlinkrepo"));
+  EXPECT_EQ("1010", database.GetSingleValue("select count(*) from addon"));
+  EXPECT_EQ("1010", database.GetSingleValue("select count(*) from dependencies"));
+
+  // moving the repository changes the paths of all add-ons
+  CRepository::DirInfo moved = m_dir;
+  moved.datadir += "moved/";
+  Store(database, m_v2, moved);
+  std::map<std::string, int> relocated = GetRows(database);
+  ASSERT_EQ(after.size(), relocated.size());
+  EXPECT_NE(after["plugin.test.repo0001"], relocated["plugin.test.repo0001"]);
+
+  database.Delete();
+}
+
+TEST_F(TestRepositoryIndex, UpdateSchema)
+{
+  // a repository stored before there were hashes
+  CTestAddonDatabase16 old("TestRepositoryIndexSchema");
+  ASSERT_TRUE(old.Create());
+  ASSERT_TRUE(old.ExecuteQuery("insert into repo (id,addonID,checksum,lastcheck) values (1,'repository.test','old','')"));
+  ASSERT_TRUE(old.ExecuteQuery("insert into addon (id,type,name,summary,description,stars,path,icon,changelog,fanart,addonID,version,author,disclaimer) "
+                               "values (1,'xbmc.python.pluginsource','Old','','',0,'','','','','plugin.test.repo0001','1.0.0','','')"));
+  ASSERT_TRUE(old.ExecuteQuery("insert into addonlinkrepo (idRepo,idAddon) values (1,1)"));
+  old.Close();
+
+  CTestAddonDatabase database("TestRepositoryIndexSchema");
+  ASSERT_TRUE(database.Open());
+  EXPECT_EQ("", database.GetSingleValue("select hash from addonlinkrepo where idAddon=1"));
+
+  // add-ons stored without a hash are written again
+  Store(database, m_v1, m_dir);
+  EXPECT_EQ((size_t)addonCount, GetRows(database).size());
+  EXPECT_NE("1", database.GetSingleValue("select addon.id from addon where addonID='plugin.test.repo0001'"));
+  EXPECT_EQ("1", database.GetSingleValue("select count(*) from repo"));
+
+  database.Delete();
+  old.Delete();
+}
@@ -28,6 +28,7 @@ using namespace ActiveAE;
 
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/TraceRecorder.h"
 #include "windowing/WindowingFactory.h"
 
 #define MAX_CACHE_LEVEL 0.5   // total cache time of stream in seconds
@@ -1619,6 +1620,84 @@ void CActiveAE::UnconfigureSink()
 }
 
 
+bool CActiveAE::MixStream(CSampleBuffer *out, CSampleBuffer *mix, bool perSample, float &volume, float rgain, float fadingStep, int &fadingSamples, CAELimiter &limiter)
+{
+  CSampleBuffer *src = mix ? mix : out;
+  int nb_floats = src->pkt->nb_samples * src->pkt->config.channels / src->pkt->planes;
+  int nb_loops = 1;
+  if (perSample)
+  {
+    nb_floats = out->pkt->config.channels / out->pkt->planes;
+    nb_loops = out->pkt->nb_samples;
+  }
+
+  bool needClamp = false;
+  for(int i=0; i<nb_loops; i++)
+  {
+    if (fadingSamples > 0)
+    {
+      volume += fadingStep;
+      fadingSamples--;
+    }
+
+    // volume for stream
+    float streamVolume = volume * rgain;
+    if(nb_loops > 1)
+      streamVolume *= limiter.Run((float**)src->pkt->data, src->pkt->config.channels, i*nb_floats, src->pkt->planes > 1);
+
+    if (!mix)
+    {
+      for(int j=0; j<out->pkt->planes; j++)
+      {
+#ifdef __SSE__
+        CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, streamVolume, nb_floats);
+#else
+        float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
+        for (int k = 0; k < nb_floats; ++k)
+        {
+          fbuffer[k] *= streamVolume;
+        }
+#endif
+      }
+      continue;
+    }
+
+    for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
+    {
+      float *dst = (float*)out->pkt->data[j]+i*nb_floats;
+      float *fsrc = (float*)mix->pkt->data[j]+i*nb_floats;
+#ifdef __SSE__
+      CAEUtil::SSEMulAddArray(dst, fsrc, streamVolume, nb_floats);
+      for (int k = 0; k < nb_floats; ++k)
+      {
+        if (fabs(dst[k]) > 1.0f)
+        {
+          needClamp = true;
+          break;
+        }
+      }
+#else
+      for (int k = 0; k < nb_floats; ++k)
+      {
+        dst[k] += fsrc[k] * streamVolume;
+        if (fabs(dst[k]) > 1.0f)
+          needClamp = true;
+      }
+#endif
+    }
+  }
+  return needClamp;
+}
+
+void CActiveAE::ClampStream(CSampleBuffer *out)
+{
+  int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
+  for(int i=0; i<out->pkt->planes; i++)
+  {
+    CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
+  }
+}
+
 bool CActiveAE::RunStages()
 {
   bool busy = false;
@@ -1688,6 +1767,7 @@ bool CActiveAE::RunStages()
     // mix streams and sounds sounds
     if (m_mode != MODE_RAW)
     {
+      TRACE_SCOPE("ActiveAE::Mix");
       CSampleBuffer *out = NULL;
       if (!m_sounds_playing.empty() && m_streams.empty())
       {
@@ -1727,166 +1807,55 @@ bool CActiveAE::RunStages()
         {
           (*it)->m_started = true;
 
-          if (!out)
-          {
-            out = (*it)->m_resampleBuffers->m_outputSamples.front();
-            (*it)->m_resampleBuffers->m_outputSamples.pop_front();
-
-            int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
-            int nb_loops = 1;
-            float fadingStep = 0.0f;
-
-            // fading
-            if ((*it)->m_fadingSamples == -1)
-            {
-              (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              (*it)->m_volume = (*it)->m_fadingBase;
-            }
-            if ((*it)->m_fadingSamples > 0)
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-              float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
-              int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              fadingStep = delta / samples;
-            }
-
-            // for stream amplification, 
-            // turned off downmix normalization,
-            // or if sink format is float (in order to prevent from clipping)
-            // we need to run on a per sample basis
-            if ((*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize || (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT))
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-            }
-
-            for(int i=0; i<nb_loops; i++)
-            {
-              if ((*it)->m_fadingSamples > 0)
-              {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
-              }
-
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
+          CSampleBuffer *mix = (*it)->m_resampleBuffers->m_outputSamples.front();
+          (*it)->m_resampleBuffers->m_outputSamples.pop_front();
 
-              for(int j=0; j<out->pkt->planes; j++)
-              {
-#ifdef __SSE__
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
-            }
+          // fading
+          float fadingStep = 0.0f;
+          if ((*it)->m_fadingSamples == -1)
+          {
+            (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
+            (*it)->m_volume = (*it)->m_fadingBase;
           }
-          else
+          bool fading = (*it)->m_fadingSamples > 0;
+          if (fading)
           {
-            CSampleBuffer *mix = NULL;
-            mix = (*it)->m_resampleBuffers->m_outputSamples.front();
-            (*it)->m_resampleBuffers->m_outputSamples.pop_front();
-
-            int nb_floats = mix->pkt->nb_samples * mix->pkt->config.channels / mix->pkt->planes;
-            int nb_loops = 1;
-            float fadingStep = 0.0f;
-
-            // fading
-            if ((*it)->m_fadingSamples == -1)
-            {
-              (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              (*it)->m_volume = (*it)->m_fadingBase;
-            }
-            if ((*it)->m_fadingSamples > 0)
-            {
-              nb_floats = mix->pkt->config.channels / mix->pkt->planes;
-              nb_loops = mix->pkt->nb_samples;
-              float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
-              int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              fadingStep = delta / samples;
-            }
+            float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
+            int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
+            fadingStep = delta / samples;
+          }
 
-            // for streams amplification of turned off downmix normalization
-            // we need to run on a per sample basis
-            if ((*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize)
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-            }
+          // for stream amplification,
+          // turned off downmix normalization,
+          // or for the first stream if sink format is float (in order to prevent from clipping)
+          // we need to run on a per sample basis
+          bool perSample = fading || (*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize;
+          if (!out)
+          {
+            perSample = perSample || (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT);
+            out = mix;
+            mix = NULL;
+          }
 
-            for(int i=0; i<nb_loops; i++)
-            {
-              if ((*it)->m_fadingSamples > 0)
-              {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
-              }
+          if (MixStream(out, mix, perSample, (*it)->m_volume, (*it)->m_rgain, fadingStep, (*it)->m_fadingSamples, (*it)->m_limiter))
+            needClamp = true;
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
+          if (fading && (*it)->m_fadingSamples == 0)
+          {
+            // set variables being polled via stream interface
+            CSingleLock lock((*it)->m_streamLock);
+            (*it)->m_streamFading = false;
+          }
 
-              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
-              {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#ifdef __SSE__
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
-              }
-            }
+          if (mix)
             mix->Return();
-          }
           busy = true;
         }
       }// for
 
       // finally clamp samples
       if(out && needClamp)
-      {
-        int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
-        for(int i=0; i<out->pkt->planes; i++)
-        {
-          CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
-        }
-      }
+        ClampStream(out);
 
       // process output buffer, gui sounds, encode, viz
       if (out)
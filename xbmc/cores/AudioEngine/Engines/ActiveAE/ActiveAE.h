@@ -39,6 +39,7 @@ extern "C" {
 
 class IAESink;
 class IAEEncoder;
+class CAELimiter;
 
 namespace ActiveAE
 {
@@ -231,6 +232,18 @@ public:
   virtual void KeepConfiguration(unsigned int millis);
   virtual void DeviceChange();
 
+  // sample memory does not depend on engine state, buffer pools can be used without a running engine
+  static uint8_t **AllocSoundSample(SampleConfig &config, int &samples, int &bytes_per_sample, int &planes, int &linesize);
+  static void FreeSoundSample(uint8_t **data);
+
+  /*! \brief mix stage of the engine, also used by offline rendering
+   Scales out in place if mix is NULL, otherwise adds mix to out. Volume and
+   fading state are advanced per sample when perSample is set, which also runs
+   the limiter. Returns true if samples left the [-1, 1] range.
+   */
+  static bool MixStream(CSampleBuffer *out, CSampleBuffer *mix, bool perSample, float &volume, float rgain, float fadingStep, int &fadingSamples, CAELimiter &limiter);
+  static void ClampStream(CSampleBuffer *out);
+
   virtual void RegisterAudioCallback(IAudioCallback* pCallback);
   virtual void UnregisterAudioCallback();
 
@@ -240,8 +253,6 @@ public:
 
 protected:
   void PlaySound(CActiveAESound *sound);
-  uint8_t **AllocSoundSample(SampleConfig &config, int &samples, int &bytes_per_sample, int &planes, int &linesize);
-  void FreeSoundSample(uint8_t **data);
   float GetDelay(CActiveAEStream *stream) { return m_stats.GetDelay(stream); }
   float GetCacheTime(CActiveAEStream *stream) { return m_stats.GetCacheTime(stream); }
   float GetCacheTotal(CActiveAEStream *stream) { return m_stats.GetCacheTotal(stream); }
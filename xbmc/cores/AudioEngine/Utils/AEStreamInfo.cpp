@@ -21,6 +21,10 @@
 #include "AEStreamInfo.h"
 #include "utils/log.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define IEC61937_PREAMBLE1 0xF872
 #define IEC61937_PREAMBLE2 0x4E1F
 #define DTS_PREAMBLE_14BE  0x1FFFE800
@@ -43,6 +47,12 @@ static const uint8_t  AC3Channels   [] = {2, 1, 2, 3, 3, 4, 4, 5};
 static const uint8_t  DTSChannels   [] = {1, 2, 2, 2, 2, 3, 3, 4, 4, 5, 6, 6, 6, 7, 8, 8};
 static const uint8_t  THDChanMap    [] = {2, 1, 1, 2, 2, 2, 2, 1, 1, 2, 2, 1, 1};
 
+/* the first 16 bits of every sync word we can lock onto, used to find candidates */
+static const uint16_t AC3SyncWords   [] = {0x0B77};
+static const uint16_t DTSSyncWords   [] = {DTS_PREAMBLE_14BE >> 16, DTS_PREAMBLE_14LE >> 16, DTS_PREAMBLE_16BE >> 16, DTS_PREAMBLE_16LE >> 16};
+static const uint16_t TrueHDSyncWords[] = {0xF872}; /* found 4 bytes into a major audio unit */
+static const uint16_t DetectSyncWords[] = {0x0B77, DTS_PREAMBLE_14BE >> 16, DTS_PREAMBLE_14LE >> 16, DTS_PREAMBLE_16BE >> 16, DTS_PREAMBLE_16LE >> 16};
+
 static const uint32_t DTSSampleRates[DTS_SFREQ_COUNT] =
 {
   0     ,
@@ -63,6 +73,65 @@ static const uint32_t DTSSampleRates[DTS_SFREQ_COUNT] =
   192000
 };
 
+/*
+  Returns the first position below "positions" where one of the big endian 16 bit words starts,
+  or "positions" if there is none. data[positions] must still be readable. This is only a cheap
+  pre-filter, the sync functions still do the full header validation on every candidate.
+*/
+static unsigned int FindSyncCandidate(const uint8_t *data, unsigned int positions, const uint16_t *words, unsigned int count)
+{
+  unsigned int i = 0;
+
+#ifdef __SSE2__
+  __m128i hi[5], lo[5];
+  if (count <= 5)
+  {
+    for (unsigned int w = 0; w < count; ++w)
+    {
+      hi[w] = _mm_set1_epi8((char)(words[w] >> 8  ));
+      lo[w] = _mm_set1_epi8((char)(words[w] & 0xFF));
+    }
+
+    for (; i + 16 <= positions; i += 16)
+    {
+      __m128i first  = _mm_loadu_si128((const __m128i*)(data + i    ));
+      __m128i second = _mm_loadu_si128((const __m128i*)(data + i + 1));
+      __m128i match  = _mm_setzero_si128();
+      for (unsigned int w = 0; w < count; ++w)
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpeq_epi8(first, hi[w]), _mm_cmpeq_epi8(second, lo[w])));
+
+      unsigned int mask = _mm_movemask_epi8(match);
+      if (mask)
+      {
+        while (!(mask & 1))
+        {
+          mask >>= 1;
+          ++i;
+        }
+        return i;
+      }
+    }
+  }
+#endif
+
+  for (; i < positions; ++i)
+  {
+    uint16_t word = data[i] << 8 | data[i + 1];
+    for (unsigned int w = 0; w < count; ++w)
+      if (word == words[w])
+        return i;
+  }
+
+  return positions;
+}
+
+/* finds the next offset DetectType needs to look at, TrueHD is matched 4 bytes in */
+static unsigned int FindDetectCandidate(const uint8_t *data, unsigned int positions)
+{
+  unsigned int next = FindSyncCandidate(data, positions, DetectSyncWords, sizeof(DetectSyncWords) / sizeof(uint16_t));
+  return FindSyncCandidate(data + 4, next, TrueHDSyncWords, 1);
+}
+
 CAEStreamInfo::CAEStreamInfo() :
   m_bufferSize    (0),
   m_skipBytes     (0),
@@ -240,6 +309,14 @@ unsigned int CAEStreamInfo::DetectType(uint8_t *data, unsigned int size)
 
   while (size > 8)
   {
+    /* skip straight to the next offset that could start a sync word */
+    unsigned int next = FindDetectCandidate(data, size - 8);
+    size    -= next;
+    skipped += next;
+    data    += next;
+    if (size <= 8)
+      break;
+
     /* if it could be DTS */
     unsigned int header = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
     if (header == DTS_PREAMBLE_14LE ||
@@ -296,6 +373,12 @@ unsigned int CAEStreamInfo::SyncAC3(uint8_t *data, unsigned int size)
   for (; size - skip > 7; ++skip, ++data)
   {
     /* search for an ac3 sync word */
+    unsigned int next = FindSyncCandidate(data, size - skip - 7, AC3SyncWords, 1);
+    skip += next;
+    data += next;
+    if (size - skip <= 7)
+      break;
+
     if (data[0] != 0x0b || data[1] != 0x77)
       continue;
 
@@ -453,6 +536,13 @@ unsigned int CAEStreamInfo::SyncDTS(uint8_t *data, unsigned int size)
   unsigned int skip = 0;
   for (; size - skip > 13; ++skip, ++data)
   {
+    /* search for a dts sync word */
+    unsigned int next = FindSyncCandidate(data, size - skip - 13, DTSSyncWords, sizeof(DTSSyncWords) / sizeof(uint16_t));
+    skip += next;
+    data += next;
+    if (size - skip <= 13)
+      break;
+
     unsigned int header = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
     unsigned int hd_sync = 0;
     bool match = true;
@@ -648,9 +738,20 @@ unsigned int CAEStreamInfo::SyncTrueHD(uint8_t *data, unsigned int size)
   /* if MLP */
   for (; left; ++skip, ++data, --left)
   {
-    /* if we dont have sync and there is less the 8 bytes, then break out */
-    if (!m_hasSync && left < 8)
-      return size;
+    if (!m_hasSync)
+    {
+      /* if we dont have sync and there is less the 8 bytes, then break out */
+      if (left < 8)
+        return size;
+
+      /* only a major audio unit can give us sync, skip to the next one */
+      unsigned int next = FindSyncCandidate(data + 4, left - 7, TrueHDSyncWords, 1);
+      skip += next;
+      data += next;
+      left -= next;
+      if (left < 8)
+        return size;
+    }
 
     /* if its a major audio unit */
     uint16_t length   = ((data[0] & 0x0F) << 8 | data[1]) << 1;
@@ -0,0 +1,234 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEStreamInfo.h"
+#include "utils/Stopwatch.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+typedef std::vector<uint8_t> Buffer;
+
+/* deterministic generator so failures can be reproduced */
+static uint32_t g_seed;
+
+static uint8_t RandomByte()
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return (uint8_t)(g_seed >> 16);
+}
+
+/* random bytes that can never start a sync word */
+static void AppendGarbage(Buffer &out, unsigned int size)
+{
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    uint8_t b = RandomByte();
+    if (b == 0x0B || b == 0x1F || b == 0x7F || b == 0xF8 || b == 0xFE || b == 0xFF)
+      b = 0x00;
+    out.push_back(b);
+  }
+}
+
+/* garbage with sync words followed by headers that must be rejected */
+static void AppendNearMisses(Buffer &out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    AppendGarbage(out, RandomByte());
+
+    /* ac3 with a reserved sample rate */
+    static const uint8_t ac3[] = {0x0B, 0x77, 0x00, 0x00, 0xC0, 0x40, 0x40, 0x00};
+    /* 14bit dts without the extended sync bits */
+    static const uint8_t dts[] = {0x1F, 0xFF, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    /* truehd major sync with a reserved sample rate */
+    static const uint8_t thd[] = {0x01, 0xE0, 0x00, 0x00, 0xF8, 0x72, 0x6F, 0xBA, 0xF0, 0x00, 0x00, 0x0F};
+
+    switch (i % 3)
+    {
+      case 0: out.insert(out.end(), ac3, ac3 + sizeof(ac3)); break;
+      case 1: out.insert(out.end(), dts, dts + sizeof(dts)); break;
+      case 2: out.insert(out.end(), thd, thd + sizeof(thd)); AppendGarbage(out, 20); break;
+    }
+  }
+}
+
+/* 48kHz stereo AC3 frame, 320 bytes at 80kbit */
+static Buffer MakeAC3Frame()
+{
+  Buffer frame;
+  AppendGarbage(frame, 320);
+  frame[0] = 0x0B;
+  frame[1] = 0x77;
+  frame[4] = 0x0A;     /* fscod 0, frmsizecod 10 */
+  frame[5] = 8 << 3;   /* bsid 8 */
+  frame[6] = 2 << 5;   /* acmod 2 */
+
+  /* crc2 covers everything after the sync word, pick the byte order that validates */
+  frame[318] = frame[319] = 0;
+  uint16_t crc = av_crc(av_crc_get_table(AV_CRC_16_ANSI), 0, &frame[2], 316);
+  frame[318] = crc >> 8;
+  frame[319] = crc & 0xFF;
+  if (av_crc(av_crc_get_table(AV_CRC_16_ANSI), 0, &frame[2], 318))
+  {
+    frame[318] = crc & 0xFF;
+    frame[319] = crc >> 8;
+  }
+  return frame;
+}
+
+/* 48kHz stereo 16bit BE DTS core with 512 samples, optionally followed by a DTS-HD extension */
+static Buffer MakeDTSFrame(bool hd)
+{
+  static const uint8_t header[] = {0x7F, 0xFE, 0x80, 0x01, 0xFC, 0x3C, 0x3F, 0xF0, 0xB4, 0x00, 0x00};
+  static const uint8_t hdHeader[] = {0x64, 0x58, 0x20, 0x25, 0x00, 0x00, 0x00, 0xFF, 0xE0};
+
+  Buffer frame;
+  frame.insert(frame.end(), header, header + sizeof(header));
+  AppendGarbage(frame, 1024 - sizeof(header));
+  if (hd)
+  {
+    frame.insert(frame.end(), hdHeader, hdHeader + sizeof(hdHeader));
+    AppendGarbage(frame, 2048 - sizeof(hdHeader));
+  }
+  return frame;
+}
+
+/* 48kHz TrueHD major audio unit with two substreams */
+static Buffer MakeTrueHDFrame()
+{
+  static const uint8_t header[] = {0x01, 0xE0, 0x00, 0x00, 0xF8, 0x72, 0x6F, 0xBA, 0x00, 0x00, 0x00, 0x0F};
+
+  Buffer frame;
+  frame.insert(frame.end(), header, header + sizeof(header));
+  AppendGarbage(frame, 960 - sizeof(header));
+  frame[20] = 0x20;
+
+  AVCRC table[1024];
+  av_crc_init(table, 0, 16, 0x2D, sizeof(table));
+  frame[28] = frame[29] = 0;
+  uint16_t crc = av_crc(table, 0, &frame[4], 24);
+  frame[30] = crc & 0xFF;
+  frame[31] = crc >> 8;
+  return frame;
+}
+
+/* feed the stream in chunks smaller than a frame and collect the packets that come out */
+static std::vector<Buffer> Parse(CAEStreamInfo &info, const Buffer &stream, unsigned int chunkSize)
+{
+  std::vector<Buffer> packets;
+  uint8_t *buffer = NULL;
+  unsigned int bufferSize = 0;
+
+  unsigned int pos = 0;
+  while (pos < stream.size())
+  {
+    unsigned int size = std::min(chunkSize, (unsigned int)stream.size() - pos);
+    unsigned int packetSize = bufferSize;
+    int used = info.AddData(const_cast<uint8_t*>(&stream[pos]), size, &buffer, &packetSize);
+    if (packetSize)
+    {
+      packets.push_back(Buffer(buffer, buffer + packetSize));
+      bufferSize = packetSize;
+    }
+    pos += used;
+
+    if (!used && !packetSize)
+      break;
+  }
+
+  delete[] buffer;
+  return packets;
+}
+
+static void CheckGarbagePrefixes(const Buffer &frame, unsigned int frames, CAEStreamInfo::DataType type, unsigned int sampleRate)
+{
+  static const unsigned int prefixes[] = {1, 3, 7, 13, 255, 4095, 10000};
+  static const unsigned int chunks  [] = {37, 128, 319};
+
+  for (unsigned int p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); ++p)
+  {
+    for (unsigned int c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+    {
+      g_seed = prefixes[p];
+
+      Buffer stream;
+      AppendGarbage(stream, prefixes[p]);
+      AppendNearMisses(stream, prefixes[p] / 64);
+      for (unsigned int i = 0; i <= frames; ++i)
+        stream.insert(stream.end(), frame.begin(), frame.end());
+
+      CAEStreamInfo info;
+      std::vector<Buffer> packets = Parse(info, stream, chunks[c]);
+
+      SCOPED_TRACE(StringUtils::Format("prefix %u, chunk %u", prefixes[p], chunks[c]));
+      EXPECT_TRUE(info.IsValid());
+      EXPECT_EQ(type, info.GetDataType());
+      EXPECT_EQ(sampleRate, info.GetSampleRate());
+      ASSERT_GE(packets.size(), frames);
+      for (unsigned int i = 0; i < frames; ++i)
+        EXPECT_TRUE(packets[i] == frame);
+    }
+  }
+}
+
+TEST(TestAEStreamInfo, AC3GarbagePrefix)
+{
+  g_seed = 1;
+  CheckGarbagePrefixes(MakeAC3Frame(), 4, CAEStreamInfo::STREAM_TYPE_AC3, 48000);
+}
+
+TEST(TestAEStreamInfo, DTSGarbagePrefix)
+{
+  g_seed = 2;
+  CheckGarbagePrefixes(MakeDTSFrame(false), 4, CAEStreamInfo::STREAM_TYPE_DTS_512, 48000);
+}
+
+TEST(TestAEStreamInfo, DTSHDGarbagePrefix)
+{
+  g_seed = 3;
+  CheckGarbagePrefixes(MakeDTSFrame(true), 4, CAEStreamInfo::STREAM_TYPE_DTSHD, 48000);
+}
+
+TEST(TestAEStreamInfo, TrueHDGarbagePrefix)
+{
+  g_seed = 4;
+  CheckGarbagePrefixes(MakeTrueHDFrame(), 4, CAEStreamInfo::STREAM_TYPE_TRUEHD, 48000);
+}
+
+TEST(TestAEStreamInfo, GarbageThroughput)
+{
+  g_seed = 5;
+  Buffer stream;
+  AppendNearMisses(stream, 64 * 1024);
+  AppendGarbage(stream, 16 * 1024 * 1024 - stream.size());
+
+  CAEStreamInfo info;
+  CStopWatch watch;
+  watch.StartZero();
+  std::vector<Buffer> packets = Parse(info, stream, 4096);
+  float elapsed = watch.GetElapsedSeconds();
+
+  EXPECT_FALSE(info.IsValid());
+  EXPECT_TRUE(packets.empty());
+  RecordProperty("MBPerSecond", (int)(stream.size() / (1024 * 1024) / std::max(elapsed, 0.001f)));
+}
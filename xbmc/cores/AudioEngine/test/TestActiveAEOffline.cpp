@@ -0,0 +1,372 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAE.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResample.h"
+#include "cores/AudioEngine/Utils/AELimiter.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <ctime>
+#include <math.h>
+#include <vector>
+
+using namespace ActiveAE;
+
+static AEAudioFormat MakeFormat(AEDataFormat dataFormat, unsigned int sampleRate, AEStdChLayout layout, unsigned int frames)
+{
+  AEAudioFormat format;
+  format.m_dataFormat    = dataFormat;
+  format.m_sampleRate    = sampleRate;
+  format.m_channelLayout = CAEChannelInfo(layout);
+  format.m_frames        = frames;
+  format.m_frameSamples  = frames * format.m_channelLayout.Count();
+  format.m_frameSize     = format.m_channelLayout.Count() * (CAEUtil::DataFormatToBits(dataFormat) >> 3);
+  return format;
+}
+
+/*
+ Runs the stages of CActiveAE::RunStages without the engine thread or a sink:
+ per stream resampling/remapping, the engine's own mix stage, conversion to the
+ sink format and a capture buffer in place of the sink. Every stage is timed
+ in process cpu time.
+*/
+class COfflineRenderer
+{
+public:
+  enum Stage
+  {
+    STAGE_RESAMPLE,
+    STAGE_MIX,
+    STAGE_SINK,
+    STAGE_CAPTURE,
+    STAGE_MAX
+  };
+
+  COfflineRenderer(const AEAudioFormat &internalFormat, const AEAudioFormat &sinkFormat, AEQuality quality, bool upmix) :
+    m_captured(0),
+    m_internalFormat(internalFormat),
+    m_sinkFormat(sinkFormat),
+    m_quality(quality),
+    m_upmix(upmix)
+  {
+    for (int i = 0; i < STAGE_MAX; i++)
+      m_clocks[i] = 0;
+
+    m_sinkBuffers = new CActiveAEBufferPoolResample(internalFormat, sinkFormat, quality);
+    m_sinkBuffers->Create(500, true, false);
+  }
+
+  ~COfflineRenderer()
+  {
+    for (std::vector<Stream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+      (*it)->resample->Flush();
+      delete (*it)->resample;
+      delete (*it)->input;
+      delete *it;
+    }
+    m_sinkBuffers->Flush();
+    delete m_sinkBuffers;
+  }
+
+  /* sine on every channel, channel n runs at (n + 1) * frequency */
+  void AddStream(AEAudioFormat format, float frequency, float amplify = 1.0f)
+  {
+    Stream *stream = new Stream;
+    format.m_frames = m_internalFormat.m_frames * ((float)format.m_sampleRate / m_internalFormat.m_sampleRate);
+    stream->input = new CActiveAEBufferPool(format);
+    stream->input->Create(500);
+    stream->resample = new CActiveAEBufferPoolResample(stream->input->m_format, m_internalFormat, m_quality);
+    stream->resample->Create(500, false, m_upmix);
+    stream->resample->m_fillPackets = true;
+    stream->limiter.SetAmplification(amplify);
+    stream->limiter.SetSamplerate(m_internalFormat.m_sampleRate);
+    stream->amplify = amplify;
+    stream->volume = 1.0f;
+    stream->fadingSamples = 0;
+    stream->frequency = frequency;
+    stream->position = 0;
+    m_streams.push_back(stream);
+  }
+
+  static float Sample(const AEAudioFormat &format, float frequency, int channel, int64_t position)
+  {
+    return (float)(0.5 * sin(2.0 * M_PI * frequency * (channel + 1) * position / format.m_sampleRate));
+  }
+
+  /* run until at least the given number of frames reached the capture buffer */
+  bool Render(unsigned int frames)
+  {
+    if (m_streams.empty())
+      return false;
+
+    while (m_captured < frames)
+    {
+      bool allStreamsReady = true;
+
+      clock_t start = clock();
+      for (std::vector<Stream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+      {
+        Stream *stream = *it;
+        if (!stream->resample->m_outputSamples.empty())
+          continue;
+
+        if (stream->resample->m_inputSamples.empty() && !stream->input->m_freeSamples.empty())
+        {
+          CSampleBuffer *buffer = stream->input->GetFreeBuffer();
+          Fill(*stream, *buffer->pkt);
+          stream->resample->m_inputSamples.push_back(buffer);
+        }
+        stream->resample->ResampleBuffers();
+
+        if (stream->resample->m_outputSamples.empty())
+          allStreamsReady = false;
+      }
+      m_clocks[STAGE_RESAMPLE] += clock() - start;
+
+      if (!allStreamsReady)
+        continue;
+
+      CSampleBuffer *out = Mix();
+
+      start = clock();
+      m_sinkBuffers->m_inputSamples.push_back(out);
+      while (m_sinkBuffers->ResampleBuffers() && m_sinkBuffers->m_outputSamples.empty()) {}
+      m_clocks[STAGE_SINK] += clock() - start;
+
+      start = clock();
+      while (!m_sinkBuffers->m_outputSamples.empty())
+      {
+        CSampleBuffer *buffer = m_sinkBuffers->m_outputSamples.front();
+        m_sinkBuffers->m_outputSamples.pop_front();
+        CSoundPacket *pkt = buffer->pkt;
+        unsigned int bytes = pkt->nb_samples * pkt->bytes_per_sample * pkt->config.channels / pkt->planes;
+        for (int i = 0; i < pkt->planes; i++)
+          m_capture.insert(m_capture.end(), pkt->data[i], pkt->data[i] + bytes);
+        m_captured += pkt->nb_samples;
+        buffer->Return();
+      }
+      m_clocks[STAGE_CAPTURE] += clock() - start;
+    }
+    return true;
+  }
+
+  /* cpu milliseconds spent in a stage per second of rendered audio */
+  double CpuPerSecond(Stage stage) const
+  {
+    double seconds = (double)m_captured / m_internalFormat.m_sampleRate;
+    if (seconds <= 0.0)
+      return 0.0;
+    return m_clocks[stage] * 1000.0 / CLOCKS_PER_SEC / seconds;
+  }
+
+  std::vector<uint8_t> m_capture;
+  unsigned int m_captured;
+
+private:
+  struct Stream
+  {
+    CActiveAEBufferPool *input;
+    CActiveAEBufferPoolResample *resample;
+    CAELimiter limiter;
+    float amplify;
+    float volume;
+    int fadingSamples;
+    float frequency;
+    int64_t position;
+  };
+
+  void Fill(Stream &stream, CSoundPacket &pkt)
+  {
+    const AEAudioFormat &format = stream.input->m_format;
+    int channels = pkt.config.channels;
+    for (int s = 0; s < pkt.max_nb_samples; s++, stream.position++)
+    {
+      for (int c = 0; c < channels; c++)
+      {
+        float value = Sample(format, stream.frequency, c, stream.position);
+        switch (format.m_dataFormat)
+        {
+          case AE_FMT_FLOATP:
+            ((float*)pkt.data[c])[s] = value;
+            break;
+          case AE_FMT_FLOAT:
+            ((float*)pkt.data[0])[s * channels + c] = value;
+            break;
+          case AE_FMT_S16NE:
+            ((int16_t*)pkt.data[0])[s * channels + c] = (int16_t)(value * 32767.0f);
+            break;
+          default:
+            break;
+        }
+      }
+    }
+    pkt.nb_samples = pkt.max_nb_samples;
+  }
+
+  /* the mix stage of CActiveAE::RunStages, without fading */
+  CSampleBuffer* Mix()
+  {
+    CSampleBuffer *out = NULL;
+    bool needClamp = false;
+
+    clock_t start = clock();
+    for (std::vector<Stream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+      Stream *stream = *it;
+      CSampleBuffer *mix = stream->resample->m_outputSamples.front();
+      stream->resample->m_outputSamples.pop_front();
+
+      bool perSample = stream->amplify != 1.0f || !stream->resample->m_normalize;
+      if (!out)
+      {
+        perSample = perSample || m_sinkFormat.m_dataFormat == AE_FMT_FLOAT;
+        out = mix;
+        mix = NULL;
+      }
+
+      if (CActiveAE::MixStream(out, mix, perSample, stream->volume, 1.0f, 0.0f, stream->fadingSamples, stream->limiter))
+        needClamp = true;
+
+      if (mix)
+        mix->Return();
+    }
+
+    if (needClamp)
+      CActiveAE::ClampStream(out);
+    m_clocks[STAGE_MIX] += clock() - start;
+    return out;
+  }
+
+  AEAudioFormat m_internalFormat;
+  AEAudioFormat m_sinkFormat;
+  AEQuality m_quality;
+  bool m_upmix;
+  std::vector<Stream*> m_streams;
+  CActiveAEBufferPoolResample *m_sinkBuffers;
+  clock_t m_clocks[STAGE_MAX];
+};
+
+/* least squares fit of a sine at a known frequency, returns amplitude and the residual rms */
+static void FitSine(const float *data, unsigned int stride, unsigned int count, float frequency, unsigned int sampleRate, double &amplitude, double &residual)
+{
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    double phase = 2.0 * M_PI * frequency * i / sampleRate;
+    double s = sin(phase), c = cos(phase), y = data[i * stride];
+    ss += s * s; sc += s * c; cc += c * c;
+    ys += y * s; yc += y * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+  amplitude = sqrt(a * a + b * b);
+
+  double err = 0;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    double phase = 2.0 * M_PI * frequency * i / sampleRate;
+    double e = data[i * stride] - (a * sin(phase) + b * cos(phase));
+    err += e * e;
+  }
+  residual = sqrt(err / count);
+}
+
+TEST(TestActiveAEOffline, StereoUpmix51)
+{
+  AEAudioFormat internal = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_5_1, 1024);
+  COfflineRenderer renderer(internal, internal, AE_QUALITY_MID, true);
+  AEAudioFormat input = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0, 0);
+  renderer.AddStream(input, 440.0f);
+  ASSERT_TRUE(renderer.Render(48000));
+
+  // FL FR FC LFE BL BR, centre and lfe get half of each front channel
+  const float *out = (const float*)&renderer.m_capture[0];
+  for (unsigned int i = 0; i < renderer.m_captured; i++)
+  {
+    float left  = COfflineRenderer::Sample(input, 440.0f, 0, i);
+    float right = COfflineRenderer::Sample(input, 440.0f, 1, i);
+    SCOPED_TRACE(StringUtils::Format("frame %u", i));
+    ASSERT_NEAR(left,                   out[i * 6 + 0], 1e-5);
+    ASSERT_NEAR(right,                  out[i * 6 + 1], 1e-5);
+    ASSERT_NEAR(0.5f * (left + right),  out[i * 6 + 2], 1e-5);
+    ASSERT_NEAR(0.5f * (left + right),  out[i * 6 + 3], 1e-5);
+    ASSERT_NEAR(left,                   out[i * 6 + 4], 1e-5);
+    ASSERT_NEAR(right,                  out[i * 6 + 5], 1e-5);
+  }
+}
+
+TEST(TestActiveAEOffline, Resample44100To48000)
+{
+  AEAudioFormat internal = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0, 1024);
+  COfflineRenderer renderer(internal, internal, AE_QUALITY_MID, false);
+  renderer.AddStream(MakeFormat(AE_FMT_S16NE, 44100, AE_CH_LAYOUT_2_0, 0), 1000.0f);
+  ASSERT_TRUE(renderer.Render(48000 * 2));
+
+  // skip the filter delay, then both channels must be clean sines at the same pitch
+  const float *out = (const float*)&renderer.m_capture[0];
+  unsigned int skip = 4800;
+  unsigned int count = renderer.m_captured - skip;
+  for (int c = 0; c < 2; c++)
+  {
+    double amplitude, residual;
+    FitSine(out + skip * 2 + c, 2, count, 1000.0f * (c + 1), 48000, amplitude, residual);
+    SCOPED_TRACE(StringUtils::Format("channel %d", c));
+    EXPECT_NEAR(0.5, amplitude, 0.005);
+    EXPECT_LT(residual, 0.001);
+  }
+}
+
+TEST(TestActiveAEOffline, MixThroughput)
+{
+  static const struct
+  {
+    AEDataFormat format;
+    unsigned int rate;
+    AEStdChLayout layout;
+    float amplify;
+  } streams[] =
+  {
+    { AE_FMT_S16NE,  44100, AE_CH_LAYOUT_2_0, 1.0f },
+    { AE_FMT_FLOAT,  48000, AE_CH_LAYOUT_5_1, 1.0f },
+    { AE_FMT_FLOATP, 96000, AE_CH_LAYOUT_2_0, 4.0f },
+    { AE_FMT_S16NE,  32000, AE_CH_LAYOUT_1_0, 2.0f },
+  };
+
+  AEAudioFormat internal = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_5_1, 1024);
+  AEAudioFormat sink = MakeFormat(AE_FMT_S16NE, 48000, AE_CH_LAYOUT_5_1, 1024);
+  COfflineRenderer renderer(internal, sink, AE_QUALITY_MID, true);
+  for (unsigned int i = 0; i < sizeof(streams) / sizeof(streams[0]); i++)
+    renderer.AddStream(MakeFormat(streams[i].format, streams[i].rate, streams[i].layout, 0), 220.0f * (i + 1), streams[i].amplify);
+
+  ASSERT_TRUE(renderer.Render(48000 * 30));
+  EXPECT_EQ(renderer.m_captured * sink.m_frameSize, renderer.m_capture.size());
+
+  // values are cpu microseconds per second of audio
+  RecordProperty("ResampleUs", (int)(renderer.CpuPerSecond(COfflineRenderer::STAGE_RESAMPLE) * 1000));
+  RecordProperty("MixUs",      (int)(renderer.CpuPerSecond(COfflineRenderer::STAGE_MIX) * 1000));
+  RecordProperty("SinkUs",     (int)(renderer.CpuPerSecond(COfflineRenderer::STAGE_SINK) * 1000));
+  RecordProperty("CaptureUs",  (int)(renderer.CpuPerSecond(COfflineRenderer::STAGE_CAPTURE) * 1000));
+}
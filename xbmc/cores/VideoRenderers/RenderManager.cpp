@@ -31,6 +31,7 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/TraceRecorder.h"
 
 #include "Application.h"
 #include "ApplicationMessenger.h"
@@ -156,7 +157,7 @@ static double wrap(double x, double minimum, double maximum)
   return x;
 }
 
-void CXBMCRenderManager::WaitPresentTime(double presenttime)
+bool CXBMCRenderManager::WaitPresentTime(double presenttime)
 {
   double frametime;
   int fps = g_VideoReferenceClock.GetRefreshRate(&frametime);
@@ -164,7 +165,7 @@ void CXBMCRenderManager::WaitPresentTime(double presenttime)
   {
     /* smooth video not enabled */
     CDVDClock::WaitAbsoluteClock(presenttime * DVD_TIME_BASE);
-    return;
+    return false;
   }
 
   double clock     = CDVDClock::WaitAbsoluteClock(presenttime * DVD_TIME_BASE) / DVD_TIME_BASE;
@@ -203,6 +204,7 @@ void CXBMCRenderManager::WaitPresentTime(double presenttime)
   g_VideoReferenceClock.SetFineAdjust(1.0 - avgerror * 0.01 - m_presentcorr * 0.01);
 
   //printf("%f %f % 2.0f%% % f % f\n", presenttime, clock, m_presentcorr * 100, error, error_org);
+  return true;
 }
 
 CStdString CXBMCRenderManager::GetVSyncState()
@@ -219,6 +221,12 @@ CStdString CXBMCRenderManager::GetVSyncState()
   return state;
 }
 
+CRenderStats CXBMCRenderManager::GetFrameStatistics()
+{
+  CSingleLock lock(m_presentlock);
+  return m_stats;
+}
+
 bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation, int buffers)
 {
 
@@ -353,6 +361,7 @@ void CXBMCRenderManager::FrameMove()
 
     if(m_presentstep == PRESENT_FLIP)
     {
+      TRACE_SCOPE("RenderManager::Flip");
       m_pRenderer->FlipPage(m_presentsource);
       m_presentstep = PRESENT_FRAME;
       m_presentevent.notifyAll();
@@ -372,16 +381,22 @@ void CXBMCRenderManager::FrameMove()
 
 void CXBMCRenderManager::FrameFinish()
 {
+  TRACE_SCOPE("RenderManager::FrameFinish");
+
   /* wait for this present to be valid */
   SPresent& m = m_Queue[m_presentsource];
 
+  bool synced = false;
   if(g_graphicsContext.IsFullScreenVideo())
-    WaitPresentTime(m.timestamp);
+    synced = WaitPresentTime(m.timestamp);
 
   { CSingleLock lock(m_presentlock);
 
     if(m_presentstep == PRESENT_FRAME)
     {
+      if(m_stats.IsEnabled())
+        m_stats.OnPresented(m_presentsource, GetPresentTime(), synced, wrap(m_presenterr, -0.5, 0.5));
+
       if( m.presentmethod == PRESENT_METHOD_BOB
       ||  m.presentmethod == PRESENT_METHOD_WEAVE)
         m_presentstep = PRESENT_FRAME2;
@@ -426,10 +441,15 @@ unsigned int CXBMCRenderManager::PreInit()
   }
 
   UpdateDisplayLatency();
+  m_vsyncSetting = CSettings::Get().GetHandle("videoscreen.vsync");
 
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
 
+  { CSingleLock lock2(m_presentlock);
+    m_stats.Reset(g_advancedSettings.m_videoFrameStatistics);
+  }
+
   return m_pRenderer->PreInit();
 }
 
@@ -439,6 +459,17 @@ void CXBMCRenderManager::UnInit()
 
   m_bIsStarted = false;
 
+  { CSingleLock lock2(m_presentlock);
+    if(m_stats.IsEnabled())
+    {
+      const CRenderHistogram& late = m_stats.GetLateness();
+      CLog::Log(LOGDEBUG, "CRenderManager::UnInit - frames presented:%u skipped:%u discarded:%u dropped:%u, late p50:%.1fms p99:%.1fms max:%.1fms"
+                , m_stats.GetCount(RENDER_FRAME_PRESENTED), m_stats.GetCount(RENDER_FRAME_SKIPPED)
+                , m_stats.GetCount(RENDER_FRAME_DISCARDED), m_stats.GetCount(RENDER_FRAME_DROPPED)
+                , late.GetPercentile(50), late.GetPercentile(99), late.GetMaximum());
+    }
+  }
+
   m_overlays.Flush();
   g_fontManager.Unload("__subtitle__");
   g_fontManager.Unload("__subtitleborder__");
@@ -629,8 +660,10 @@ void CXBMCRenderManager::SetViewMode(int iViewMode)
     m_pRenderer->SetViewMode(iViewMode);
 }
 
-void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0LL*/, int source /*= -1*/, EFIELDSYNC sync /*= FS_NONE*/)
+void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0LL*/, int source /*= -1*/, EFIELDSYNC sync /*= FS_NONE*/, double pts /*= 0.0*/, double clock /*= 0.0*/)
 {
+  TRACE_SCOPE("RenderManager::FlipPage");
+
   { CSharedLock lock(m_sharedSection);
 
     if(bStop)
@@ -688,7 +721,11 @@ void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0L
     CSingleLock lock2(m_presentlock);
 
     if(m_free.empty())
+    {
+      if(m_stats.IsEnabled())
+        m_stats.OnDropped(timestamp, GetPresentTime(), pts, clock);
       return;
+    }
 
     if(source < 0)
       source = m_free.front();
@@ -699,6 +736,9 @@ void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0L
     m.presentmethod = presentmethod;
     requeue(m_queued, m_free);
 
+    if(m_stats.IsEnabled())
+      m_stats.OnQueued(source, timestamp, GetPresentTime(), pts, clock);
+
     /* signal to any waiters to check state */
     if(m_presentstep == PRESENT_IDLE)
     {
@@ -728,7 +768,7 @@ float CXBMCRenderManager::GetMaximumFPS()
 {
   float fps;
 
-  if (CSettings::Get().GetInt("videoscreen.vsync") != VSYNC_DISABLED)
+  if (CSettings::Get().GetInt(m_vsyncSetting) != VSYNC_DISABLED)
   {
     fps = (float)g_VideoReferenceClock.GetRefreshRate();
     if (fps <= 0) fps = g_graphicsContext.GetFPS();
@@ -1057,6 +1097,8 @@ void CXBMCRenderManager::PrepareNextRender()
     /* skip late frames */
     while(m_queued.front() != idx)
     {
+      if(m_stats.IsEnabled())
+        m_stats.OnSkipped(m_queued.front());
       requeue(m_discard, m_queued);
       m_QueueSkip++;
     }
@@ -1075,7 +1117,11 @@ void CXBMCRenderManager::DiscardBuffer()
   CSingleLock lock2(m_presentlock);
 
   while(!m_queued.empty())
+  {
+    if(m_stats.IsEnabled())
+      m_stats.OnDiscarded(m_queued.front());
     requeue(m_discard, m_queued);
+  }
 
   if(m_presentstep == PRESENT_READY)
     m_presentstep   = PRESENT_IDLE;
@@ -28,7 +28,9 @@
 #include "threads/SharedSection.h"
 #include "threads/Thread.h"
 #include "settings/VideoSettings.h"
+#include "settings/lib/SettingHandle.h"
 #include "OverlayRenderer.h"
+#include "RenderStats.h"
 #include <deque>
 #include "PlatformDefs.h"
 
@@ -100,8 +102,10 @@ public:
    * @param timestamp of frame delivered with AddVideoPicture
    * @param source depreciated
    * @param sync signals frame, top, or bottom field
+   * @param pts source pts of the frame in seconds, only used for the frame statistics
+   * @param clock player clock the pts was compared to in seconds, only used for the frame statistics
    */
-  void FlipPage(volatile bool& bStop, double timestamp = 0.0, int source = -1, EFIELDSYNC sync = FS_NONE);
+  void FlipPage(volatile bool& bStop, double timestamp = 0.0, int source = -1, EFIELDSYNC sync = FS_NONE, double pts = 0.0, double clock = 0.0);
   unsigned int PreInit();
   void UnInit();
   bool Flush();
@@ -122,7 +126,7 @@ public:
 
   RESOLUTION GetResolution();
 
-  static float GetMaximumFPS();
+  float GetMaximumFPS();
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
   int    GetSkippedFrames()  { return m_QueueSkip; }
@@ -135,10 +139,17 @@ public:
   EINTERLACEMETHOD AutoInterlaceMethod(EINTERLACEMETHOD mInt);
 
   static double GetPresentTime();
-  void  WaitPresentTime(double presenttime);
+  bool  WaitPresentTime(double presenttime);
 
   CStdString GetVSyncState();
 
+  /**
+   * Frame pacing statistics of the current or last playback. They are only
+   * collected if enabled with <framestatistics> in the video section of
+   * advancedsettings.xml.
+   */
+  CRenderStats GetFrameStatistics();
+
   void UpdateResolution();
 
   bool RendererHandlesPresent() const;
@@ -238,11 +249,12 @@ protected:
   double     m_errorbuff[ERRORBUFFSIZE];
   int        m_errorindex;
   EPRESENTSTEP     m_presentstep;
+  CSettingHandle   m_vsyncSetting;
   int        m_presentsource;
   XbmcThreads::ConditionVariable  m_presentevent;
   CCriticalSection m_presentlock;
   CEvent     m_flushEvent;
-
+  CRenderStats m_stats;
 
   OVERLAY::CRenderer m_overlays;
 
@@ -0,0 +1,271 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RenderStats.h"
+#include "filesystem/File.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+CRenderHistogram::CRenderHistogram(double minimum, double maximum, unsigned int buckets)
+  : m_lower(minimum)
+  , m_width((maximum - minimum) / buckets)
+  , m_buckets(buckets, 0)
+{
+  Reset();
+}
+
+void CRenderHistogram::Reset()
+{
+  fill(m_buckets.begin(), m_buckets.end(), 0);
+  m_count   = 0;
+  m_sum     = 0.0;
+  m_minimum = 0.0;
+  m_maximum = 0.0;
+}
+
+void CRenderHistogram::Add(double value)
+{
+  int bucket = (int)floor((value - m_lower) / m_width);
+  bucket = max(0, min((int)m_buckets.size() - 1, bucket));
+  m_buckets[bucket]++;
+
+  if (m_count == 0 || value < m_minimum)
+    m_minimum = value;
+  if (m_count == 0 || value > m_maximum)
+    m_maximum = value;
+  m_sum += value;
+  m_count++;
+}
+
+double CRenderHistogram::GetPercentile(double percent) const
+{
+  if (m_count == 0)
+    return 0.0;
+
+  unsigned int target = (unsigned int)ceil(percent / 100.0 * m_count);
+  target = max(1U, min(m_count, target));
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < m_buckets.size(); i++)
+  {
+    count += m_buckets[i];
+    if (count >= target)
+    {
+      // the last bucket also holds the outliers above it
+      if (i == m_buckets.size() - 1)
+        return m_maximum;
+      return max(m_minimum, min(m_maximum, m_lower + (i + 1) * m_width));
+    }
+  }
+  return m_maximum;
+}
+
+CRenderStats::CRenderStats()
+  : m_lateness(-100.0, 400.0, 1000)
+  , m_interval(0.0, 500.0, 1000)
+  , m_queuetime(-200.0, 1000.0, 2400)
+  , m_avoffset(-500.0, 500.0, 2000)
+  , m_vsyncerror(-0.5, 0.5, 100)
+{
+  Reset(false);
+}
+
+void CRenderStats::Reset(bool enabled)
+{
+  m_enabled     = enabled;
+  m_sequence    = 0;
+  m_lastpresent = 0.0;
+  m_stored      = 0;
+  memset(m_results, 0, sizeof(m_results));
+
+  m_pending.clear();
+  m_frames.clear();
+  if (m_enabled)
+    m_frames.reserve(RENDERSTATS_FRAMES);
+  else
+    vector<SRenderFrameRecord>().swap(m_frames);
+
+  m_lateness.Reset();
+  m_interval.Reset();
+  m_queuetime.Reset();
+  m_avoffset.Reset();
+  m_vsyncerror.Reset();
+}
+
+void CRenderStats::OnQueued(int buffer, double due, double now, double pts, double clock)
+{
+  // a buffer handed over again without being presented, e.g. after the
+  // renderer was reconfigured
+  OnDiscarded(buffer);
+
+  SRenderFrameRecord record;
+  record.sequence  = m_sequence++;
+  record.result    = RENDER_FRAME_QUEUED;
+  record.buffer    = buffer;
+  record.pts       = pts;
+  record.clock     = clock;
+  record.queued    = now;
+  record.due       = due;
+  record.presented = 0.0;
+  record.synced    = false;
+  record.error     = 0.0;
+  m_pending.push_back(record);
+  m_results[RENDER_FRAME_QUEUED]++;
+
+  m_queuetime.Add((due - now) * 1000.0);
+  if (pts != 0.0 || clock != 0.0)
+    m_avoffset.Add((pts - clock) * 1000.0);
+}
+
+void CRenderStats::OnDropped(double due, double now, double pts, double clock)
+{
+  SRenderFrameRecord record;
+  record.sequence  = m_sequence++;
+  record.result    = RENDER_FRAME_DROPPED;
+  record.buffer    = -1;
+  record.pts       = pts;
+  record.clock     = clock;
+  record.queued    = now;
+  record.due       = due;
+  record.presented = 0.0;
+  record.synced    = false;
+  record.error     = 0.0;
+  m_results[RENDER_FRAME_DROPPED]++;
+  Store(record);
+}
+
+void CRenderStats::OnSkipped(int buffer)
+{
+  for (vector<SRenderFrameRecord>::iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+  {
+    if (it->buffer == buffer)
+    {
+      Finish(it, RENDER_FRAME_SKIPPED);
+      return;
+    }
+  }
+}
+
+void CRenderStats::OnDiscarded(int buffer)
+{
+  for (vector<SRenderFrameRecord>::iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+  {
+    if (it->buffer == buffer)
+    {
+      Finish(it, RENDER_FRAME_DISCARDED);
+      return;
+    }
+  }
+}
+
+void CRenderStats::OnPresented(int buffer, double now, bool synced, double error)
+{
+  for (vector<SRenderFrameRecord>::iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+  {
+    if (it->buffer != buffer)
+      continue;
+
+    it->presented = now;
+    it->synced    = synced;
+    it->error     = synced ? error : 0.0;
+
+    m_lateness.Add((now - it->due) * 1000.0);
+    if (m_lastpresent > 0.0)
+      m_interval.Add((now - m_lastpresent) * 1000.0);
+    m_lastpresent = now;
+    if (synced)
+      m_vsyncerror.Add(error);
+
+    Finish(it, RENDER_FRAME_PRESENTED);
+    return;
+  }
+}
+
+void CRenderStats::Finish(vector<SRenderFrameRecord>::iterator it, ERenderFrameResult result)
+{
+  it->result = result;
+  m_results[RENDER_FRAME_QUEUED]--;
+  m_results[result]++;
+  Store(*it);
+  m_pending.erase(it);
+}
+
+void CRenderStats::Store(const SRenderFrameRecord &record)
+{
+  if (m_frames.size() < RENDERSTATS_FRAMES)
+    m_frames.push_back(record);
+  else
+    m_frames[m_stored % RENDERSTATS_FRAMES] = record;
+  m_stored++;
+}
+
+void CRenderStats::GetFrames(vector<SRenderFrameRecord> &frames, unsigned int count) const
+{
+  frames.clear();
+  count = min(count, (unsigned int)m_frames.size());
+  frames.reserve(count);
+  for (unsigned int i = m_stored - count; i != m_stored; i++)
+    frames.push_back(m_frames[i % RENDERSTATS_FRAMES]);
+}
+
+bool CRenderStats::WriteCSV(const string &path) const
+{
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGERROR, "CRenderStats::WriteCSV - unable to open %s", path.c_str());
+    return false;
+  }
+
+  string csv = "sequence,result,buffer,pts,clock,queued,due,presented,latems,synced,vsyncerror\n";
+  vector<SRenderFrameRecord> frames;
+  GetFrames(frames);
+  for (vector<SRenderFrameRecord>::const_iterator it = frames.begin(); it != frames.end(); ++it)
+  {
+    double late = it->result == RENDER_FRAME_PRESENTED ? (it->presented - it->due) * 1000.0 : 0.0;
+    csv += StringUtils::Format("%u,%s,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%d,%.4f\n",
+                               it->sequence, GetResultName(it->result), it->buffer,
+                               it->pts, it->clock, it->queued, it->due, it->presented,
+                               late, it->synced ? 1 : 0, it->error);
+  }
+
+  bool written = file.Write(csv.c_str(), csv.size()) == (int)csv.size();
+  file.Close();
+  return written;
+}
+
+const char* CRenderStats::GetResultName(ERenderFrameResult result)
+{
+  switch (result)
+  {
+    case RENDER_FRAME_QUEUED:    return "queued";
+    case RENDER_FRAME_PRESENTED: return "presented";
+    case RENDER_FRAME_SKIPPED:   return "skipped";
+    case RENDER_FRAME_DISCARDED: return "discarded";
+    case RENDER_FRAME_DROPPED:   return "dropped";
+    default:                     return "unknown";
+  }
+}
@@ -0,0 +1,150 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+/*
+ Per frame accounting of the render queue, to diagnose judder without the
+ debug overlay. CXBMCRenderManager reports every frame handed to FlipPage and
+ what became of it, the last RENDERSTATS_FRAMES of those are kept along with
+ histograms over the whole playback.
+
+ All times are in seconds of the absolute clock CXBMCRenderManager uses. The
+ class does no locking of its own, the render manager calls it with its
+ present lock held.
+*/
+
+#define RENDERSTATS_FRAMES 1024
+
+enum ERenderFrameResult
+{
+  RENDER_FRAME_QUEUED = 0,  // not yet presented
+  RENDER_FRAME_PRESENTED,   // flipped to the screen
+  RENDER_FRAME_SKIPPED,     // late, a newer frame was already due
+  RENDER_FRAME_DISCARDED,   // thrown away on a flush or seek
+  RENDER_FRAME_DROPPED,     // no free buffer when it was handed over
+  RENDER_FRAME_RESULTS
+};
+
+struct SRenderFrameRecord
+{
+  unsigned int       sequence;
+  ERenderFrameResult result;
+  int                buffer;
+  double             pts;        // source pts
+  double             clock;      // player clock when the frame was handed over
+  double             queued;     // when the frame was handed over
+  double             due;        // when it should be presented
+  double             presented;  // when it was presented, 0.0 if it wasn't
+  bool               synced;     // presented in sync with the reference clock
+  double             error;      // distance from the vblank target, in frames
+};
+
+class CRenderHistogram
+{
+public:
+  /**
+   * values outside of [minimum, maximum] are counted in the first or last
+   * bucket, the exact extremes are kept apart
+   */
+  CRenderHistogram(double minimum, double maximum, unsigned int buckets);
+
+  void Reset();
+  void Add(double value);
+
+  unsigned int GetCount() const { return m_count; }
+  double GetMinimum() const     { return m_count ? m_minimum : 0.0; }
+  double GetMaximum() const     { return m_count ? m_maximum : 0.0; }
+  double GetAverage() const     { return m_count ? m_sum / m_count : 0.0; }
+
+  /**
+   * the value below which the given percentage of the samples fall, to the
+   * resolution of the buckets
+   */
+  double GetPercentile(double percent) const;
+
+private:
+  double m_lower;
+  double m_width;
+  std::vector<unsigned int> m_buckets;
+
+  unsigned int m_count;
+  double m_sum;
+  double m_minimum;
+  double m_maximum;
+};
+
+class CRenderStats
+{
+public:
+  CRenderStats();
+
+  /* drops all records, and starts or stops collecting them */
+  void Reset(bool enabled);
+  bool IsEnabled() const { return m_enabled; }
+
+  /* pts and clock are 0.0 if the player didn't give them */
+  void OnQueued(int buffer, double due, double now, double pts, double clock);
+  void OnDropped(double due, double now, double pts, double clock);
+  void OnSkipped(int buffer);
+  void OnDiscarded(int buffer);
+  void OnPresented(int buffer, double now, bool synced, double error);
+
+  unsigned int GetCount(ERenderFrameResult result) const { return m_results[result]; }
+
+  /* presented - due, in ms */
+  const CRenderHistogram& GetLateness() const   { return m_lateness; }
+  /* presented - previous presented, in ms */
+  const CRenderHistogram& GetInterval() const   { return m_interval; }
+  /* due - queued, in ms */
+  const CRenderHistogram& GetQueueTime() const  { return m_queuetime; }
+  /* pts - clock, in ms, of the frames the player gave them for */
+  const CRenderHistogram& GetAVOffset() const   { return m_avoffset; }
+  /* vblank error of the frames presented in sync, in frames */
+  const CRenderHistogram& GetVSyncError() const { return m_vsyncerror; }
+
+  /* the most recent finished frames, oldest first, at most count of them */
+  void GetFrames(std::vector<SRenderFrameRecord> &frames, unsigned int count = RENDERSTATS_FRAMES) const;
+
+  bool WriteCSV(const std::string &path) const;
+
+  static const char* GetResultName(ERenderFrameResult result);
+
+private:
+  void Finish(std::vector<SRenderFrameRecord>::iterator it, ERenderFrameResult result);
+  void Store(const SRenderFrameRecord &record);
+
+  bool m_enabled;
+  unsigned int m_sequence;
+  unsigned int m_results[RENDER_FRAME_RESULTS];
+  double m_lastpresent;
+
+  std::vector<SRenderFrameRecord> m_pending;
+  std::vector<SRenderFrameRecord> m_frames;
+  unsigned int m_stored;
+
+  CRenderHistogram m_lateness;
+  CRenderHistogram m_interval;
+  CRenderHistogram m_queuetime;
+  CRenderHistogram m_avoffset;
+  CRenderHistogram m_vsyncerror;
+};
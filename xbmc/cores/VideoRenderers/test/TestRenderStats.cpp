@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/RenderStats.h"
+#include "filesystem/File.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// plays a 24 fps timeline on a display of the given refresh rate, each frame
+// being presented at the first vblank after it's due, as CXBMCRenderManager
+// does with three buffers
+static void Play(CRenderStats &stats, double refresh, int frames, bool synced = true)
+{
+  for (int i = 0; i < frames; i++)
+  {
+    int buffer = i % 3;
+    double due = 10.0 + i / 24.0;
+    double pts = i / 24.0;
+    stats.OnQueued(buffer, due, due - 0.1, pts, pts - 0.02);
+
+    double vblank = ceil((due - 10.0) * refresh - 1e-9);
+    double presented = 10.0 + vblank / refresh;
+    stats.OnPresented(buffer, presented, synced, 0.1);
+  }
+}
+
+TEST(TestRenderStats, Histogram)
+{
+  CRenderHistogram histogram(0.0, 100.0, 100);
+  EXPECT_EQ(0U, histogram.GetCount());
+  EXPECT_EQ(0.0, histogram.GetPercentile(50));
+
+  for (int i = 0; i < 100; i++)
+    histogram.Add(i + 0.5);
+  EXPECT_EQ(100U, histogram.GetCount());
+  EXPECT_DOUBLE_EQ(50.0, histogram.GetAverage());
+  EXPECT_DOUBLE_EQ(50.0, histogram.GetPercentile(50));
+  EXPECT_DOUBLE_EQ(90.0, histogram.GetPercentile(90));
+  EXPECT_DOUBLE_EQ(99.0, histogram.GetPercentile(99));
+  EXPECT_DOUBLE_EQ(99.5, histogram.GetPercentile(100));
+  EXPECT_DOUBLE_EQ(1.0, histogram.GetPercentile(0));
+
+  // outliers land in the outer buckets, but keep their values as extremes
+  histogram.Add(-10.0);
+  histogram.Add(1000.0);
+  EXPECT_DOUBLE_EQ(-10.0, histogram.GetMinimum());
+  EXPECT_DOUBLE_EQ(1000.0, histogram.GetMaximum());
+  EXPECT_DOUBLE_EQ(1000.0, histogram.GetPercentile(100));
+
+  histogram.Reset();
+  EXPECT_EQ(0U, histogram.GetCount());
+  EXPECT_EQ(0.0, histogram.GetMaximum());
+}
+
+TEST(TestRenderStats, Cadence)
+{
+  // 24 fps on 24 Hz is presented evenly
+  CRenderStats stats;
+  stats.Reset(true);
+  Play(stats, 24.0, 240);
+  EXPECT_EQ(240U, stats.GetCount(RENDER_FRAME_PRESENTED));
+  EXPECT_EQ(0U, stats.GetCount(RENDER_FRAME_QUEUED));
+  EXPECT_EQ(239U, stats.GetInterval().GetCount());
+  EXPECT_NEAR(41.7, stats.GetInterval().GetMinimum(), 0.1);
+  EXPECT_NEAR(41.7, stats.GetInterval().GetMaximum(), 0.1);
+  EXPECT_NEAR(0.0, stats.GetLateness().GetMaximum(), 0.01);
+  EXPECT_NEAR(100.0, stats.GetQueueTime().GetPercentile(50), 0.5);
+  EXPECT_NEAR(20.0, stats.GetAVOffset().GetPercentile(50), 0.5);
+  EXPECT_EQ(240U, stats.GetVSyncError().GetCount());
+
+  // on 60 Hz it's 3:2 pulldown, which shows as two distinct intervals
+  stats.Reset(true);
+  Play(stats, 60.0, 240);
+  EXPECT_EQ(240U, stats.GetCount(RENDER_FRAME_PRESENTED));
+  EXPECT_NEAR(33.3, stats.GetInterval().GetPercentile(25), 0.5);
+  EXPECT_NEAR(50.0, stats.GetInterval().GetPercentile(75), 0.5);
+  EXPECT_NEAR(33.3, stats.GetInterval().GetMinimum(), 0.1);
+  EXPECT_NEAR(50.0, stats.GetInterval().GetMaximum(), 0.1);
+  EXPECT_NEAR(8.3, stats.GetLateness().GetMaximum(), 0.1);
+
+  // frames not presented in sync have no vblank error
+  stats.Reset(true);
+  Play(stats, 60.0, 10, false);
+  EXPECT_EQ(0U, stats.GetVSyncError().GetCount());
+}
+
+TEST(TestRenderStats, Results)
+{
+  CRenderStats stats;
+  stats.Reset(true);
+
+  stats.OnQueued(0, 1.00, 0.90, 0.0, 0.0);
+  stats.OnQueued(1, 1.04, 0.94, 0.0, 0.0);
+  stats.OnQueued(2, 1.08, 0.98, 0.0, 0.0);
+  stats.OnDropped(1.12, 1.02, 0.0, 0.0);
+  EXPECT_EQ(3U, stats.GetCount(RENDER_FRAME_QUEUED));
+  EXPECT_EQ(1U, stats.GetCount(RENDER_FRAME_DROPPED));
+
+  // the render thread was late, the first frame is skipped
+  stats.OnSkipped(0);
+  stats.OnPresented(1, 1.05, false, 0.0);
+  // a seek throws away the rest
+  stats.OnDiscarded(2);
+  // as well as frames of buffers which are handed over again
+  stats.OnQueued(0, 2.00, 1.90, 0.0, 0.0);
+  stats.OnQueued(0, 2.04, 1.94, 0.0, 0.0);
+  // frames which aren't known are ignored
+  stats.OnPresented(5, 2.0, false, 0.0);
+  stats.OnSkipped(5);
+
+  EXPECT_EQ(1U, stats.GetCount(RENDER_FRAME_QUEUED));
+  EXPECT_EQ(1U, stats.GetCount(RENDER_FRAME_PRESENTED));
+  EXPECT_EQ(1U, stats.GetCount(RENDER_FRAME_SKIPPED));
+  EXPECT_EQ(2U, stats.GetCount(RENDER_FRAME_DISCARDED));
+  EXPECT_EQ(1U, stats.GetCount(RENDER_FRAME_DROPPED));
+  EXPECT_EQ(0U, stats.GetAVOffset().GetCount());
+
+  // in the order they finished
+  std::vector<SRenderFrameRecord> frames;
+  stats.GetFrames(frames);
+  ASSERT_EQ(5U, frames.size());
+  EXPECT_EQ(3U, frames[0].sequence);
+  EXPECT_EQ(RENDER_FRAME_DROPPED, frames[0].result);
+  EXPECT_EQ(0U, frames[1].sequence);
+  EXPECT_EQ(RENDER_FRAME_SKIPPED, frames[1].result);
+  EXPECT_EQ(1U, frames[2].sequence);
+  EXPECT_EQ(RENDER_FRAME_PRESENTED, frames[2].result);
+  EXPECT_DOUBLE_EQ(1.05, frames[2].presented);
+  EXPECT_NEAR(10.0, stats.GetLateness().GetMaximum(), 0.001);
+  EXPECT_EQ(RENDER_FRAME_DISCARDED, frames[3].result);
+  EXPECT_EQ(4U, frames[4].sequence);
+  EXPECT_EQ(RENDER_FRAME_DISCARDED, frames[4].result);
+
+  stats.GetFrames(frames, 2);
+  ASSERT_EQ(2U, frames.size());
+  EXPECT_EQ(4U, frames[1].sequence);
+
+  stats.Reset(false);
+  EXPECT_FALSE(stats.IsEnabled());
+  EXPECT_EQ(0U, stats.GetCount(RENDER_FRAME_PRESENTED));
+  stats.GetFrames(frames);
+  EXPECT_TRUE(frames.empty());
+}
+
+TEST(TestRenderStats, Ring)
+{
+  CRenderStats stats;
+  stats.Reset(true);
+  Play(stats, 60.0, 3000);
+  EXPECT_EQ(3000U, stats.GetCount(RENDER_FRAME_PRESENTED));
+
+  // only the most recent frames are kept, the histograms cover all of them
+  std::vector<SRenderFrameRecord> frames;
+  stats.GetFrames(frames);
+  ASSERT_EQ((size_t)RENDERSTATS_FRAMES, frames.size());
+  for (unsigned int i = 0; i < frames.size(); i++)
+    EXPECT_EQ(3000 - RENDERSTATS_FRAMES + i, frames[i].sequence);
+  EXPECT_EQ(2999U, stats.GetInterval().GetCount());
+}
+
+TEST(TestRenderStats, WriteCSV)
+{
+  CRenderStats stats;
+  stats.Reset(true);
+  Play(stats, 60.0, 100);
+  stats.OnDropped(20.0, 19.9, 0.0, 0.0);
+
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".csv");
+  ASSERT_TRUE(file != NULL);
+  file->Close();
+  std::string path = XBMC_TEMPFILEPATH(file);
+  EXPECT_TRUE(stats.WriteCSV(path));
+
+  FILE *csv = fopen(path.c_str(), "r");
+  ASSERT_TRUE(csv != NULL);
+  char line[256];
+  std::vector<std::string> lines;
+  while (fgets(line, sizeof(line), csv))
+    lines.push_back(line);
+  fclose(csv);
+  XBMC_DELETETEMPFILE(file);
+
+  ASSERT_EQ(102U, lines.size());
+  EXPECT_EQ(0U, lines[0].find("sequence,result,"));
+  EXPECT_EQ(0U, lines[1].find("0,presented,0,0.000000,-0.020000,9.900000,10.000000,10.000000,0.000,1,0.1000"));
+  EXPECT_EQ(0U, lines[101].find("100,dropped,-1,"));
+}
@@ -53,6 +53,9 @@
 #include "TextureCache.h"
 #include "Util.h"
 #include "utils/LangCodeExpander.h"
+#include "threads/SingleLock.h"
+
+#include <list>
 
 
 bool CDVDFileInfo::GetFileDuration(const CStdString &path, int& duration)
@@ -93,7 +96,233 @@ int DegreeToOrientation(int degrees)
   }
 }
 
-bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails)
+/* number of idle thumb decoders kept around for files with the same codec parameters */
+#define THUMB_CODEC_CACHE_SIZE 4
+
+/*
+ Keyframe only thumb extraction always uses ffmpeg, so a decoder that was opened
+ for one file can be flushed and handed to the next file with identical stream
+ parameters instead of going through avcodec_open2 again. Extraction runs on
+ several job workers at once, so a decoder is owned by a single caller until it
+ is released back to the cache.
+*/
+class CThumbCodecCache
+{
+public:
+  CThumbCodecCache() : m_enabled(true) {}
+
+  /* frees the idle decoders, decoders still in use are freed on Release() */
+  void Clear(bool disable)
+  {
+    CSingleLock lock(m_section);
+    for (std::list<Entry>::iterator it = m_codecs.begin(); it != m_codecs.end(); ++it)
+      delete it->codec;
+    m_codecs.clear();
+    m_enabled = !disable;
+  }
+
+  CDVDVideoCodec* Acquire(CDVDStreamInfo &hint)
+  {
+    {
+      CSingleLock lock(m_section);
+      for (std::list<Entry>::iterator it = m_codecs.begin(); it != m_codecs.end(); ++it)
+      {
+        if (it->hint.Equal(hint, true))
+        {
+          CDVDVideoCodec *codec = it->codec;
+          m_codecs.erase(it);
+          return codec;
+        }
+      }
+    }
+
+    // only decode keyframes, anything else is wasted work for a thumbnail
+    CDVDCodecOptions options;
+    options.m_keys.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    return CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, options);
+  }
+
+  void Release(CDVDStreamInfo &hint, CDVDVideoCodec *codec)
+  {
+    CSingleLock lock(m_section);
+    if (!m_enabled)
+    {
+      delete codec;
+      return;
+    }
+
+    codec->Reset();
+    Entry entry;
+    entry.hint.Assign(hint, true);
+    entry.codec = codec;
+    m_codecs.push_front(entry);
+
+    if (m_codecs.size() > THUMB_CODEC_CACHE_SIZE)
+    {
+      delete m_codecs.back().codec;
+      m_codecs.pop_back();
+    }
+  }
+
+private:
+  struct Entry
+  {
+    CDVDStreamInfo  hint;
+    CDVDVideoCodec *codec;
+  };
+
+  CCriticalSection m_section;
+  std::list<Entry> m_codecs;
+  bool             m_enabled;
+};
+
+/* no destructor cleanup, the decoders have to be gone before ffmpeg is torn down, see ClearThumbCodecCache() */
+static CThumbCodecCache g_thumbCodecCache;
+
+void CDVDFileInfo::ClearThumbCodecCache(bool bShutdown /* = false */)
+{
+  g_thumbCodecCache.Clear(bShutdown);
+}
+
+/* decode the first usable picture after seeking to nSeekTo, returns the number of packets read */
+static int DecodeThumbPicture(CDVDDemux *pDemuxer, int nVideoStream, CDVDVideoCodec *pVideoCodec, int nSeekTo, bool &bKeyframesOnly, DVDVideoPicture &picture)
+{
+  int packetsTried = 0;
+  int iDecoderState = VC_ERROR;
+
+  memset(&picture, 0, sizeof(picture));
+
+  if (!pDemuxer->SeekTime(nSeekTo, true))
+    return packetsTried;
+
+  pVideoCodec->Reset();
+
+  // num streams * 80 frames, should get a valid frame, if not abort.
+  int abort_index = pDemuxer->GetNrOfStreams() * 80;
+  int fallback_index = abort_index / 2;
+  do
+  {
+    // some streams only carry recovery points instead of real keyframes,
+    // give up on keyframe only decoding if nothing came out after half the budget
+    if (bKeyframesOnly && abort_index < fallback_index)
+    {
+      CLog::Log(LOGDEBUG, "%s - no keyframe after %d packets, decoding all frames", __FUNCTION__, packetsTried);
+      pVideoCodec->SetDropState(false);
+      bKeyframesOnly = false;
+    }
+
+    DemuxPacket* pPacket = pDemuxer->Read();
+    packetsTried++;
+
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId != nVideoStream)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    iDecoderState = pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+    if (iDecoderState & VC_ERROR)
+      break;
+
+    if (iDecoderState & VC_PICTURE)
+    {
+      memset(&picture, 0, sizeof(DVDVideoPicture));
+      if (pVideoCodec->GetPicture(&picture))
+      {
+        if(!(picture.iFlags & DVP_FLAG_DROPPED))
+          break;
+      }
+    }
+
+  } while (abort_index--);
+
+  if (!(iDecoderState & VC_PICTURE) || (picture.iFlags & DVP_FLAG_DROPPED))
+    memset(&picture, 0, sizeof(picture));
+
+  return packetsTried;
+}
+
+/* scale the picture to thumb size as BGRA, the caller owns the returned buffer */
+static uint8_t* ScaleThumbPicture(const DVDVideoPicture &picture, const CDVDStreamInfo &hint, unsigned int &nWidth, unsigned int &nHeight)
+{
+  nWidth = g_advancedSettings.GetThumbSize();
+  double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
+  if(hint.forced_aspect && hint.aspect != 0)
+    aspect = hint.aspect;
+  nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
+
+  struct SwsContext *context = sws_getContext(picture.iWidth, picture.iHeight,
+        PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  if (!context)
+    return NULL;
+
+  uint8_t *pOutBuf = new uint8_t[nWidth * nHeight * 4];
+  uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
+  int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
+  uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
+  int     dstStride[] = { (int)nWidth*4, 0, 0, 0 };
+  sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+  sws_freeContext(context);
+
+  return pOutBuf;
+}
+
+/* rough measure of detail, black frames and fades score close to zero */
+static double ScoreThumbPicture(const uint8_t *pBuf, unsigned int nWidth, unsigned int nHeight)
+{
+  double sum = 0.0, sumSq = 0.0;
+  unsigned int count = 0;
+  for (unsigned int y = 0; y < nHeight; y += 4)
+  {
+    const uint8_t *row = pBuf + y * nWidth * 4;
+    for (unsigned int x = 0; x < nWidth; x += 4)
+    {
+      const uint8_t *pixel = row + x * 4;
+      double luma = 0.114 * pixel[0] + 0.587 * pixel[1] + 0.299 * pixel[2];
+      sum   += luma;
+      sumSq += luma * luma;
+      count++;
+    }
+  }
+
+  if (!count)
+    return 0.0;
+
+  double mean = sum / count;
+  return sumSq / count - mean * mean;
+}
+
+bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, bool bKeyframesOnly /* = false */)
+{
+  std::vector<double> positions(1, 1.0 / 3.0);
+  std::vector<CTextureDetails> thumbs(1, details);
+  bool bOk = ExtractFrames(strPath, positions, false, thumbs, pStreamDetails, bKeyframesOnly);
+  details = thumbs[0];
+  return bOk;
+}
+
+bool CDVDFileInfo::ExtractBestThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, unsigned int candidates, bool bKeyframesOnly /* = true */)
+{
+  if (candidates == 0)
+    return false;
+
+  // stay clear of intros and credits
+  std::vector<double> positions;
+  for (unsigned int i = 0; i < candidates; i++)
+    positions.push_back(0.2 + 0.6 * (i + 1) / (candidates + 1));
+
+  std::vector<CTextureDetails> thumbs(1, details);
+  bool bOk = ExtractFrames(strPath, positions, true, thumbs, pStreamDetails, bKeyframesOnly);
+  details = thumbs[0];
+  return bOk;
+}
+
+bool CDVDFileInfo::ExtractFrames(const CStdString &strPath, const std::vector<double> &positions, bool bPickBest, std::vector<CTextureDetails> &details, CStreamDetails *pStreamDetails, bool bKeyframesOnly)
 {
   std::string redactPath = CURL::GetRedacted(strPath);
   unsigned int nTime = XbmcThreads::SystemClockMillis();
@@ -186,8 +415,9 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     }
   }
 
-  bool bOk = false;
+  std::vector<bool> extracted(details.size(), false);
   int packetsTried = 0;
+  int framesDecoded = 0;
 
   if (nVideoStream != -1)
   {
@@ -196,7 +426,11 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == AV_CODEC_ID_MPEG2VIDEO || hint.codec == AV_CODEC_ID_MPEG1VIDEO)
+    if (bKeyframesOnly)
+    {
+      pVideoCodec = g_thumbCodecCache.Acquire(hint);
+    }
+    else if (hint.codec == AV_CODEC_ID_MPEG2VIDEO || hint.codec == AV_CODEC_ID_MPEG1VIDEO)
     {
       // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
       CDVDCodecOptions dvdOptions;
@@ -210,88 +444,71 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     if (pVideoCodec)
     {
       int nTotalLen = pDemuxer->GetStreamLength();
-      int nSeekTo = nTotalLen / 3;
+      int orientation = DegreeToOrientation(hint.orientation);
+      bool bReusable = bKeyframesOnly;
 
-      CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, redactPath.c_str());
-      if (pDemuxer->SeekTime(nSeekTo, true))
+      uint8_t *pBestBuf = NULL;
+      unsigned int nBestWidth = 0, nBestHeight = 0;
+      double bestScore = -1.0;
+
+      for (unsigned int i = 0; i < positions.size(); i++)
       {
-        int iDecoderState = VC_ERROR;
-        DVDVideoPicture picture;
+        int nSeekTo = (int)(nTotalLen * positions[i]);
 
-        memset(&picture, 0, sizeof(picture));
+        CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, redactPath.c_str());
 
-        // num streams * 80 frames, should get a valid frame, if not abort.
-        int abort_index = pDemuxer->GetNrOfStreams() * 80;
-        do
+        DVDVideoPicture picture;
+        packetsTried += DecodeThumbPicture(pDemuxer, nVideoStream, pVideoCodec, nSeekTo, bKeyframesOnly, picture);
+        if (!picture.iWidth || !picture.iHeight)
         {
-          DemuxPacket* pPacket = pDemuxer->Read();
-          packetsTried++;
-
-          if (!pPacket)
-            break;
-
-          if (pPacket->iStreamId != nVideoStream)
-          {
-            CDVDDemuxUtils::FreeDemuxPacket(pPacket);
-            continue;
-          }
-
-          iDecoderState = pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
-          CDVDDemuxUtils::FreeDemuxPacket(pPacket);
-
-          if (iDecoderState & VC_ERROR)
-            break;
-
-          if (iDecoderState & VC_PICTURE)
-          {
-            memset(&picture, 0, sizeof(DVDVideoPicture));
-            if (pVideoCodec->GetPicture(&picture))
-            {
-              if(!(picture.iFlags & DVP_FLAG_DROPPED))
-                break;
-            }
-          }
+          CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, redactPath.c_str(), packetsTried);
+          continue;
+        }
+        framesDecoded++;
 
-        } while (abort_index--);
+        unsigned int nWidth, nHeight;
+        uint8_t *pOutBuf = ScaleThumbPicture(picture, hint, nWidth, nHeight);
+        if (!pOutBuf)
+          continue;
 
-        if (iDecoderState & VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
+        if (bPickBest)
         {
+          double score = ScoreThumbPicture(pOutBuf, nWidth, nHeight);
+          if (score > bestScore)
           {
-            unsigned int nWidth = g_advancedSettings.GetThumbSize();
-            double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
-            if(hint.forced_aspect && hint.aspect != 0)
-              aspect = hint.aspect;
-            unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
-
-            uint8_t *pOutBuf = new uint8_t[nWidth * nHeight * 4];
-            struct SwsContext *context = sws_getContext(picture.iWidth, picture.iHeight,
-                  PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-
-            if (context)
-            {
-              uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
-              int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
-              uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-              int     dstStride[] = { (int)nWidth*4, 0, 0, 0 };
-              int orientation = DegreeToOrientation(hint.orientation);
-              sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              sws_freeContext(context);
-
-              details.width = nWidth;
-              details.height = nHeight;
-              CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
-              bOk = true;
-            }
-
-            delete [] pOutBuf;
+            delete [] pBestBuf;
+            pBestBuf    = pOutBuf;
+            nBestWidth  = nWidth;
+            nBestHeight = nHeight;
+            bestScore   = score;
           }
+          else
+            delete [] pOutBuf;
         }
         else
         {
-          CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, redactPath.c_str(), packetsTried);
+          details[i].width = nWidth;
+          details[i].height = nHeight;
+          CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details[i].file));
+          extracted[i] = true;
+          delete [] pOutBuf;
         }
       }
-      delete pVideoCodec;
+
+      if (pBestBuf)
+      {
+        details[0].width = nBestWidth;
+        details[0].height = nBestHeight;
+        CPicture::CacheTexture(pBestBuf, nBestWidth, nBestHeight, nBestWidth * 4, orientation, nBestWidth, nBestHeight, CTextureCache::GetCachedPath(details[0].file));
+        extracted[0] = true;
+        delete [] pBestBuf;
+      }
+
+      // a decoder that had to fall back to full decoding can't be handed out as keyframe only
+      if (bReusable && bKeyframesOnly)
+        g_thumbCodecCache.Release(hint, pVideoCodec);
+      else
+        delete pVideoCodec;
     }
   }
 
@@ -300,15 +517,20 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
   delete pInputStream;
 
-  if(!bOk)
+  bool bOk = true;
+  for (unsigned int i = 0; i < details.size(); i++)
   {
-    XFILE::CFile file;
-    if(file.OpenForWrite(CTextureCache::GetCachedPath(details.file)))
-      file.Close();
+    if(!extracted[i])
+    {
+      bOk = false;
+      XFILE::CFile file;
+      if(file.OpenForWrite(CTextureCache::GetCachedPath(details[i].file)))
+        file.Close();
+    }
   }
 
   unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, redactPath.c_str(), packetsTried);
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract %d frames from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, framesDecoded, redactPath.c_str(), packetsTried);
   return bOk;
 }
 
@@ -22,6 +22,8 @@
 
 #include "utils/StdString.h"
 
+#include <vector>
+
 class CFileItem;
 class CDVDDemux;
 class CStreamDetails;
@@ -33,7 +35,18 @@ class CDVDFileInfo
 {
 public:
   // Extract a thumbnail immage from the media at strPath, optionally populating a streamdetails class with the data
-  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails);
+  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, bool bKeyframesOnly = false);
+
+  /** \brief Decode several candidate frames while opening the media only once and keep the one with the most detail as thumbnail.
+  *   \param candidates Number of frames to decode, spread over the middle of the media.
+  *   \param bKeyframesOnly Only decode keyframes, decoders are then reused across files with the same codec parameters.
+  */
+  static bool ExtractBestThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, unsigned int candidates, bool bKeyframesOnly = true);
+
+  /** \brief Free the decoders kept for keyframe only extraction.
+  *   \param bShutdown Stop caching decoders, has to be called before ffmpeg is unloaded.
+  */
+  static void ClearThumbCodecCache(bool bShutdown = false);
 
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
@@ -50,4 +63,7 @@ public:
   *   \param[out] details The external subtitle file's StreamDetails.
   */
   static bool AddExternalSubtitleToDetails(const CStdString &path, CStreamDetails &details, const std::string& filename, const std::string& subfilename = "");
+
+private:
+  static bool ExtractFrames(const CStdString &strPath, const std::vector<double> &positions, bool bPickBest, std::vector<CTextureDetails> &details, CStreamDetails *pStreamDetails, bool bKeyframesOnly);
 };
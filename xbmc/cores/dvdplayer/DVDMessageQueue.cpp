@@ -24,11 +24,84 @@
 #include "threads/SingleLock.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/TraceRecorder.h"
+
+#include <string.h>
 
 using namespace std;
 
+// slot in the per type counters, -1 for types not known to the queue
+static inline int TypeIndex(CDVDMsg* msg)
+{
+  int index = msg->GetMessageType() - CDVDMsg::NONE;
+  if (index < 0 || index >= MSGQ_TYPES)
+    return -1;
+  return index;
+}
+
+// moves the reference of an item into an empty slot
+static inline void MoveItem(DVDMessageListItem& to, DVDMessageListItem& from)
+{
+  to.message   = from.message;
+  to.priority  = from.priority;
+  to.time      = from.time;
+  from.message = NULL;
+}
+
+void CDVDMessageRing::PushBack(const DVDMessageListItem& item)
+{
+  if (m_count == m_slots.size())
+  {
+    std::vector<DVDMessageListItem> slots(max((size_t)16, m_slots.size() * 2));
+    for (size_t i = 0; i < m_count; i++)
+      MoveItem(slots[i], At(i));
+    m_slots.swap(slots);
+    m_head = 0;
+  }
+  m_slots[(m_head + m_count) % m_slots.size()] = item;
+  m_count++;
+}
+
+CDVDMsg* CDVDMessageRing::PopFront()
+{
+  DVDMessageListItem& item = m_slots[m_head];
+  CDVDMsg* msg = item.message;
+  item.message = NULL;
+  m_head = (m_head + 1) % m_slots.size();
+  m_count--;
+  return msg;
+}
+
+void CDVDMessageRing::Remove(CDVDMsg::Message type)
+{
+  // compact the remaining messages towards the front, keeping their order
+  size_t kept = 0;
+  for (size_t i = 0; i < m_count; i++)
+  {
+    DVDMessageListItem& item = At(i);
+    if (type == CDVDMsg::NONE || item.message->IsType(type))
+    {
+      item.message->Release();
+      item.message = NULL;
+    }
+    else if (kept != i)
+      MoveItem(At(kept++), item);
+    else
+      kept++;
+  }
+  m_count = kept;
+  if (m_count == 0)
+    m_head = 0;
+}
+
 CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
 {
+  m_traceName     = CTraceRecorder::Get().Intern("MessageQueue(" + owner + ")");
+  m_iCount        = 0;
+  memset(m_typeCount, 0, sizeof(m_typeCount));
+  ResetLatency();
+
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bInitialized  = false;
@@ -55,18 +128,26 @@ void CDVDMessageQueue::Init()
   m_bInitialized  = true;
   m_TimeBack      = DVD_NOPTS_VALUE;
   m_TimeFront     = DVD_NOPTS_VALUE;
+  ResetLatency();
 }
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  for(SList::iterator it = m_list.begin(); it != m_list.end();)
+  for (RingMap::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+    it->second.Remove(type);
+
+  int index = type - CDVDMsg::NONE;
+  if (type == CDVDMsg::NONE)
   {
-    if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
-      it = m_list.erase(it);
-    else
-      ++it;
+    m_iCount = 0;
+    memset(m_typeCount, 0, sizeof(m_typeCount));
+  }
+  else if (index >= 0 && index < MSGQ_TYPES)
+  {
+    m_iCount -= m_typeCount[index];
+    m_typeCount[index] = 0;
   }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
@@ -91,7 +172,9 @@ void CDVDMessageQueue::End()
 {
   CSingleLock lock(m_section);
 
+  LogLatency();
   Flush();
+  m_rings.clear();
 
   m_bInitialized  = false;
   m_iDataSize     = 0;
@@ -115,14 +198,12 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
-  {
-    if(priority <= it->priority)
-      break;
-    ++it;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  m_rings[priority].PushBack(DVDMessageListItem(pMsg, priority, CurrentHostCounter()));
+  m_iCount++;
+  TRACE_COUNTER(m_traceName, m_iCount);
+  int index = TypeIndex(pMsg);
+  if (index >= 0)
+    m_typeCount[index]++;
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
   {
@@ -160,7 +241,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_iCount == 0 && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -170,9 +251,14 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    // the highest priority with queued messages
+    RingMap::reverse_iterator ring = m_rings.rbegin();
+    while (ring != m_rings.rend() && ring->second.Empty())
+      ++ring;
+
+    if(ring != m_rings.rend() && ring->first >= priority && !m_bCaching)
     {
-      DVDMessageListItem& item(m_list.back());
+      DVDMessageListItem& item(ring->second.Front());
       priority = item.priority;
 
       if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
@@ -191,8 +277,22 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
           m_bEmptied = false;
       }
 
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
+      int index = TypeIndex(item.message);
+      if (index >= 0)
+      {
+        m_typeCount[index]--;
+
+        int64_t waited = CurrentHostCounter() - item.time;
+        Latency& latency = m_latency[index];
+        latency.count++;
+        latency.total += waited;
+        if (waited > latency.peak)
+          latency.peak = waited;
+      }
+      m_iCount--;
+      TRACE_COUNTER(m_traceName, m_iCount);
+
+      *pMsg = ring->second.PopFront();
 
       ret = MSGQ_OK;
       break;
@@ -228,14 +328,47 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
   if (!m_bInitialized)
     return 0;
 
-  unsigned count = 0;
-  for(SList::iterator it = m_list.begin(); it != m_list.end();++it)
+  int index = type - CDVDMsg::NONE;
+  if (index < 0 || index >= MSGQ_TYPES)
+    return 0;
+
+  return m_typeCount[index];
+}
+
+void CDVDMessageQueue::GetLatency(CDVDMsg::Message type, unsigned &count, double &average, double &peak) const
+{
+  CSingleLock lock(m_section);
+
+  count   = 0;
+  average = 0.0;
+  peak    = 0.0;
+
+  int index = type - CDVDMsg::NONE;
+  if (index < 0 || index >= MSGQ_TYPES || m_latency[index].count == 0)
+    return;
+
+  double frequency = (double)CurrentHostFrequency() / 1000.0;
+  count   = m_latency[index].count;
+  average = m_latency[index].total / frequency / count;
+  peak    = m_latency[index].peak / frequency;
+}
+
+void CDVDMessageQueue::ResetLatency()
+{
+  memset(m_latency, 0, sizeof(m_latency));
+}
+
+void CDVDMessageQueue::LogLatency() const
+{
+  unsigned count;
+  double average, peak;
+  for (int i = 0; i < MSGQ_TYPES; i++)
   {
-    if(it->message->IsType(type))
-      count++;
+    GetLatency((CDVDMsg::Message)(CDVDMsg::NONE + i), count, average, peak);
+    if (count > 0)
+      CLog::Log(LOGDEBUG, "CDVDMessageQueue(%s)::End - type %d: %u messages, %.2f ms average, %.2f ms peak in queue",
+                m_owner.c_str(), CDVDMsg::NONE + i, count, average, peak);
   }
-
-  return count;
 }
 
 void CDVDMessageQueue::WaitUntilEmpty()
@@ -22,21 +22,24 @@
 
 #include "DVDMessage.h"
 #include <string>
-#include <list>
+#include <map>
+#include <vector>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
 struct DVDMessageListItem
 {
-  DVDMessageListItem(CDVDMsg* msg, int prio)
+  DVDMessageListItem(CDVDMsg* msg, int prio, int64_t queued = 0)
   {
     message  = msg->Acquire();
     priority = prio;
+    time     = queued;
   }
   DVDMessageListItem()
   {
     message  = NULL;
     priority = 0;
+    time     = 0;
   }
   DVDMessageListItem(const DVDMessageListItem& item)
   {
@@ -45,6 +48,7 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    time     = item.time;
   }
  ~DVDMessageListItem()
   {
@@ -61,13 +65,46 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    time     = item.time;
     return *this;
   }
 
   CDVDMsg* message;
   int      priority;
+  int64_t  time;     // host counter when the message was queued
 };
 
+/**
+ * Growable ring of the queued messages of one priority, oldest first.
+ * Slots are reused, so once the ring has grown to what the stream needs
+ * queuing a message doesn't allocate.
+ */
+class CDVDMessageRing
+{
+public:
+  CDVDMessageRing() : m_head(0), m_count(0) {}
+
+  bool   Empty() const { return m_count == 0; }
+  size_t Size() const  { return m_count; }
+
+  void PushBack(const DVDMessageListItem& item);
+  DVDMessageListItem& Front() { return m_slots[m_head]; }
+  /* hands the reference the ring held on the front message to the caller */
+  CDVDMsg* PopFront();
+  DVDMessageListItem& At(size_t index) { return m_slots[(m_head + index) % m_slots.size()]; }
+
+  /* removes the messages of the given type, CDVDMsg::NONE for all */
+  void Remove(CDVDMsg::Message type);
+
+private:
+  std::vector<DVDMessageListItem> m_slots;
+  size_t m_head;
+  size_t m_count;
+};
+
+// number of message types, as CDVDMsg::Message runs from NONE to SUBTITLE_CLUTCHANGE
+#define MSGQ_TYPES (CDVDMsg::SUBTITLE_CLUTCHANGE - CDVDMsg::NONE + 1)
+
 enum MsgQueueReturnCode
 {
   MSGQ_OK               = 1,
@@ -109,6 +146,16 @@ public:
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
+
+  /**
+   * Time the messages of a type spent in the queue since Init.
+   * type,      message type from DVDMessage.h
+   * count,     outputs the number of messages taken from the queue
+   * average,   outputs the average time in ms between Put and Get
+   * peak,      outputs the longest time in ms between Put and Get
+   */
+  void GetLatency(CDVDMsg::Message type, unsigned &count, double &average, double &peak) const;
+
   void WaitUntilEmpty();
 
   // non messagequeue related functions
@@ -139,8 +186,22 @@ private:
   int m_iMaxDataSize;
   bool m_bEmptied;
   std::string m_owner;
+  const char* m_traceName;
+
+  void ResetLatency();
+  void LogLatency() const;
 
-  typedef std::list<DVDMessageListItem> SList;
-  SList m_list;
+  typedef std::map<int, CDVDMessageRing> RingMap;
+  RingMap  m_rings;                    // by priority, highest is served first
+  unsigned m_iCount;                   // messages in all rings
+  unsigned m_typeCount[MSGQ_TYPES];    // messages in all rings, by type
+
+  struct Latency
+  {
+    unsigned count;
+    int64_t  total;
+    int64_t  peak;
+  };
+  Latency  m_latency[MSGQ_TYPES];
 };
 
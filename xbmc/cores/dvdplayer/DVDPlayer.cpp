@@ -55,11 +55,7 @@
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #endif
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "xbmc/utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
+#include "utils/PerformanceSample.h"
 #include "settings/AdvancedSettings.h"
 #include "FileItem.h"
 #include "GUIUserMessages.h"
@@ -67,6 +63,7 @@
 #include "settings/MediaSettings.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
+#include "utils/TraceRecorder.h"
 #include "utils/StreamDetails.h"
 #include "pvr/PVRManager.h"
 #include "pvr/channels/PVRChannel.h"
@@ -833,6 +830,7 @@ void CDVDPlayer::OpenDefaultStreams(bool reset)
 
 bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
 {
+  TRACE_SCOPE("DVDPlayer::ReadPacket");
 
   // check if we should read from subtitle demuxer
   if( m_pSubtitleDemuxer && m_dvdPlayerSubtitle.AcceptsData() )
@@ -1322,6 +1320,8 @@ bool CDVDPlayer::CheckDelayedChannelEntry(void)
 
 void CDVDPlayer::ProcessPacket(CDemuxStream* pStream, DemuxPacket* pPacket)
 {
+    TRACE_SCOPE("DVDPlayer::ProcessPacket");
+
     /* process packet if it belongs to selected stream. for dvd's don't allow automatic opening of streams*/
     StreamLock lock(this);
 
@@ -28,6 +28,7 @@
 #include "video/VideoReferenceClock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
+#include "utils/TraceRecorder.h"
 #include "utils/MathUtils.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
@@ -262,7 +263,11 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe)
       if (dts != DVD_NOPTS_VALUE)
         m_audioClock = dts;
 
-      int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      int len;
+      {
+        TRACE_SCOPE("DVDPlayerAudio::Decode");
+        len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      }
       if (len < 0 || len > m_decode.size)
       {
         /* if error, we skip the packet */
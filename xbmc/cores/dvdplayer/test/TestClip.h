@@ -0,0 +1,192 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+/*
+ Synthetic media for the dvdplayer tests, generated with ffmpeg into a
+ temporary file so no binary fixtures have to be shipped.
+*/
+
+#include "utils/TimeUtils.h"
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavutil/imgutils.h"
+}
+
+#define CLIP_SECONDS   20
+#define CLIP_FPS       25
+#define CLIP_WIDTH     640
+#define CLIP_HEIGHT    360
+#define CLIP_RATE      48000
+
+inline static double ElapsedMs(int64_t start)
+{
+  return (double)(CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency();
+}
+
+inline static bool EncodeFrame(AVFormatContext *format, AVStream *stream, AVFrame *frame)
+{
+  AVPacket packet;
+  av_init_packet(&packet);
+  packet.data = NULL;
+  packet.size = 0;
+
+  int got = 0;
+  int ret;
+  if (stream->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+    ret = avcodec_encode_video2(stream->codec, &packet, frame, &got);
+  else
+    ret = avcodec_encode_audio2(stream->codec, &packet, frame, &got);
+
+  if (ret < 0 || !got)
+    return false;
+
+  if (packet.pts != (int64_t)AV_NOPTS_VALUE)
+    packet.pts = av_rescale_q(packet.pts, stream->codec->time_base, stream->time_base);
+  if (packet.dts != (int64_t)AV_NOPTS_VALUE)
+    packet.dts = av_rescale_q(packet.dts, stream->codec->time_base, stream->time_base);
+  packet.stream_index = stream->index;
+
+  return av_interleaved_write_frame(format, &packet) == 0;
+}
+
+inline static AVStream* AddStream(AVFormatContext *format, AVCodecID id)
+{
+  AVCodec *codec = avcodec_find_encoder(id);
+  if (!codec)
+    return NULL;
+
+  AVStream *stream = avformat_new_stream(format, codec);
+  if (!stream)
+    return NULL;
+
+  AVCodecContext *context = stream->codec;
+  if (codec->type == AVMEDIA_TYPE_VIDEO)
+  {
+    context->width          = CLIP_WIDTH;
+    context->height         = CLIP_HEIGHT;
+    context->pix_fmt        = PIX_FMT_YUV420P;
+    context->time_base.num  = 1;
+    context->time_base.den  = CLIP_FPS;
+    context->gop_size       = 12;
+    context->max_b_frames   = 2;
+    context->bit_rate       = 2000000;
+  }
+  else
+  {
+    context->sample_fmt     = AV_SAMPLE_FMT_S16;
+    context->sample_rate    = CLIP_RATE;
+    context->channels       = 2;
+    context->channel_layout = AV_CH_LAYOUT_STEREO;
+    context->time_base.num  = 1;
+    context->time_base.den  = CLIP_RATE;
+    context->bit_rate       = 192000;
+  }
+
+  if (format->oformat->flags & AVFMT_GLOBALHEADER)
+    context->flags |= CODEC_FLAG_GLOBAL_HEADER;
+
+  if (avcodec_open2(context, codec, NULL) < 0)
+    return NULL;
+
+  stream->time_base = context->time_base;
+  return stream;
+}
+
+/* write a matroska clip with mpeg4 video and mp2 audio, moving gradients keep the encoder honest */
+inline static bool GenerateClip(const std::string &path, int seconds = CLIP_SECONDS)
+{
+  av_register_all();
+
+  AVFormatContext *format = NULL;
+  if (avformat_alloc_output_context2(&format, NULL, "matroska", path.c_str()) < 0 || !format)
+    return false;
+
+  AVStream *video = AddStream(format, AV_CODEC_ID_MPEG4);
+  AVStream *audio = AddStream(format, AV_CODEC_ID_MP2);
+  bool ok = video && audio
+         && avio_open(&format->pb, path.c_str(), AVIO_FLAG_WRITE) >= 0
+         && avformat_write_header(format, NULL) >= 0;
+
+  AVFrame *picture = av_frame_alloc();
+  AVFrame *samples = av_frame_alloc();
+  if (ok)
+  {
+    picture->width  = CLIP_WIDTH;
+    picture->height = CLIP_HEIGHT;
+    picture->format = PIX_FMT_YUV420P;
+    av_image_alloc(picture->data, picture->linesize, CLIP_WIDTH, CLIP_HEIGHT, PIX_FMT_YUV420P, 32);
+
+    int frameSize = audio->codec->frame_size;
+    std::vector<int16_t> pcm(frameSize * 2);
+    samples->nb_samples     = frameSize;
+    samples->format         = AV_SAMPLE_FMT_S16;
+    samples->channel_layout = AV_CH_LAYOUT_STEREO;
+    avcodec_fill_audio_frame(samples, 2, AV_SAMPLE_FMT_S16, (uint8_t*)&pcm[0], pcm.size() * sizeof(int16_t), 0);
+
+    int64_t sample = 0;
+    for (int i = 0; i < seconds * CLIP_FPS; i++)
+    {
+      for (int y = 0; y < CLIP_HEIGHT; y++)
+        for (int x = 0; x < CLIP_WIDTH; x++)
+          picture->data[0][y * picture->linesize[0] + x] = x + y + i * 3;
+      for (int y = 0; y < CLIP_HEIGHT / 2; y++)
+        for (int x = 0; x < CLIP_WIDTH / 2; x++)
+        {
+          picture->data[1][y * picture->linesize[1] + x] = 128 + y + i * 2;
+          picture->data[2][y * picture->linesize[2] + x] = 64 + x + i * 5;
+        }
+      picture->pts = i;
+      EncodeFrame(format, video, picture);
+
+      // keep the audio at most one frame ahead of the video
+      while (sample * CLIP_FPS < (int64_t)(i + 1) * CLIP_RATE)
+      {
+        for (int s = 0; s < frameSize; s++)
+          pcm[s * 2] = pcm[s * 2 + 1] = (int16_t)(8000 * ((sample + s) % 109) / 109);
+        samples->pts = sample;
+        EncodeFrame(format, audio, samples);
+        sample += frameSize;
+      }
+    }
+
+    // drain delayed frames
+    while (EncodeFrame(format, video, NULL)) {}
+    while (EncodeFrame(format, audio, NULL)) {}
+
+    av_write_trailer(format);
+    av_freep(&picture->data[0]);
+  }
+
+  av_frame_free(&picture);
+  av_frame_free(&samples);
+  for (unsigned int i = 0; i < format->nb_streams; i++)
+    avcodec_close(format->streams[i]->codec);
+  if (format->pb)
+    avio_close(format->pb);
+  avformat_free_context(format);
+  return ok;
+}
@@ -0,0 +1,276 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ Headless demux/decode test. A clip is generated with ffmpeg, then demuxed
+ into CDVDMessageQueues and decoded on one thread per stream. This covers the
+ input stream, demuxer, queue and codec layers only: CDVDPlayer,
+ CDVDPlayerAudio/Video, the clock, the audio sink and the renderer are not
+ involved.
+*/
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDMessage.h"
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDStreamInfo.h"
+#include "cores/dvdplayer/DVDCodecs/DVDCodecs.h"
+#include "cores/dvdplayer/DVDCodecs/DVDFactoryCodec.h"
+#include "cores/dvdplayer/DVDCodecs/Audio/DVDAudioCodec.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemux.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDFactoryDemuxer.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStream.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDFactoryInputStream.h"
+#include "filesystem/File.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+#include "test/TestUtils.h"
+#include "TestClip.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+/* pulls packets off a queue the same way CDVDPlayerAudio/Video do and decodes them until end of stream */
+class CQueueDecoder : public CThread
+{
+public:
+  CQueueDecoder(const std::string &name) :
+    CThread(name.c_str()),
+    m_messageQueue(name),
+    m_audioCodec(NULL),
+    m_videoCodec(NULL),
+    m_frames(0)
+  {
+  }
+
+  virtual ~CQueueDecoder()
+  {
+    StopThread();
+    delete m_audioCodec;
+    delete m_videoCodec;
+  }
+
+  bool OpenStream(CDemuxStream *stream)
+  {
+    CDVDStreamInfo hint(*stream, true);
+    hint.software = true;
+    if (stream->type == STREAM_AUDIO)
+    {
+      m_audioCodec = CDVDFactoryCodec::CreateAudioCodec(hint);
+      m_messageQueue.SetMaxDataSize(6 * 1024 * 1024);
+    }
+    else
+    {
+      std::vector<ERenderFormat> formats;
+      formats.push_back(RENDER_FMT_YUV420P);
+      m_videoCodec = CDVDFactoryCodec::CreateVideoCodec(hint, 0, formats);
+      m_messageQueue.SetMaxDataSize(40 * 1024 * 1024);
+    }
+    m_messageQueue.SetMaxTimeSize(8.0);
+    m_messageQueue.Init();
+    return m_audioCodec || m_videoCodec;
+  }
+
+  CDVDMessageQueue m_messageQueue;
+  unsigned int     m_frames;
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      CDVDMsg* pMsg;
+      MsgQueueReturnCode ret = m_messageQueue.Get(&pMsg, 1000);
+
+      // a stalled producer is reported by the test, keep waiting for the eof
+      if (ret == MSGQ_TIMEOUT)
+        continue;
+      if (MSGQ_IS_ERROR(ret))
+        break;
+
+      if (pMsg->IsType(CDVDMsg::GENERAL_EOF))
+      {
+        pMsg->Release();
+        break;
+      }
+
+      if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+      {
+        DemuxPacket* pPacket = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+        if (m_videoCodec)
+          DecodeVideo(pPacket);
+        else
+          DecodeAudio(pPacket);
+      }
+      pMsg->Release();
+    }
+  }
+
+private:
+  void DecodeVideo(DemuxPacket* pPacket)
+  {
+    int iDecoderState = m_videoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+    while (!(iDecoderState & VC_ERROR))
+    {
+      if (iDecoderState & VC_PICTURE)
+      {
+        DVDVideoPicture picture;
+        memset(&picture, 0, sizeof(picture));
+        if (m_videoCodec->GetPicture(&picture) && !(picture.iFlags & DVP_FLAG_DROPPED))
+          m_frames++;
+        m_videoCodec->ClearPicture(&picture);
+      }
+
+      if (iDecoderState & VC_BUFFER)
+        break;
+
+      iDecoderState = m_videoCodec->Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+    }
+  }
+
+  void DecodeAudio(DemuxPacket* pPacket)
+  {
+    uint8_t *data = pPacket->pData;
+    int size = pPacket->iSize;
+    while (size > 0)
+    {
+      int len = m_audioCodec->Decode(data, size);
+      if (len < 0)
+        break;
+      data += len;
+      size -= len;
+
+      DVDAudioFrame frame;
+      m_audioCodec->GetData(frame);
+      if (frame.size)
+        m_frames++;
+
+      if (len == 0)
+        break;
+    }
+  }
+
+  CDVDAudioCodec *m_audioCodec;
+  CDVDVideoCodec *m_videoCodec;
+};
+
+class TestDVDDemuxDecode : public testing::Test
+{
+protected:
+  TestDVDDemuxDecode() : m_clip(NULL) {}
+
+  virtual void SetUp()
+  {
+    m_clip = XBMC_CREATETEMPFILE(".mkv");
+    ASSERT_TRUE(m_clip != NULL);
+    m_clip->Close();
+    m_path = XBMC_TEMPFILEPATH(m_clip);
+    ASSERT_TRUE(GenerateClip(m_path));
+  }
+
+  virtual void TearDown()
+  {
+    if (m_clip)
+      XBMC_DELETETEMPFILE(m_clip);
+  }
+
+  XFILE::CFile *m_clip;
+  std::string   m_path;
+};
+
+/* longest the demuxer may wait for the decoders to make room in the queues */
+#define QUEUE_FULL_TIMEOUT_MS 10000
+
+TEST_F(TestDVDDemuxDecode, DecodeClip)
+{
+  CDVDInputStream *input = CDVDFactoryInputStream::CreateInputStream(NULL, m_path, "");
+  ASSERT_TRUE(input != NULL);
+  ASSERT_TRUE(input->Open(m_path.c_str(), ""));
+  CDVDDemux *demuxer = CDVDFactoryDemuxer::CreateDemuxer(input);
+  ASSERT_TRUE(demuxer != NULL);
+
+  CQueueDecoder audio("audio");
+  CQueueDecoder video("video");
+  int audioStream = -1, videoStream = -1;
+  for (int i = 0; i < demuxer->GetNrOfStreams(); i++)
+  {
+    CDemuxStream *stream = demuxer->GetStream(i);
+    if (stream->type == STREAM_AUDIO && audioStream < 0 && audio.OpenStream(stream))
+      audioStream = i;
+    else if (stream->type == STREAM_VIDEO && videoStream < 0 && video.OpenStream(stream))
+      videoStream = i;
+  }
+  ASSERT_GE(audioStream, 0);
+  ASSERT_GE(videoStream, 0);
+
+  audio.Create();
+  video.Create();
+
+  bool stalled = false;
+
+  while (true)
+  {
+    // same back pressure as CDVDPlayer::Process, but without a clock to pace it
+    int64_t wait = CurrentHostCounter();
+    while (audio.m_messageQueue.IsFull() || video.m_messageQueue.IsFull())
+    {
+      if (ElapsedMs(wait) > QUEUE_FULL_TIMEOUT_MS)
+      {
+        stalled = true;
+        break;
+      }
+      CThread::Sleep(1);
+    }
+    if (stalled)
+      break;
+
+    DemuxPacket *pPacket = demuxer->Read();
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId == audioStream)
+      audio.m_messageQueue.Put(new CDVDMsgDemuxerPacket(pPacket));
+    else if (pPacket->iStreamId == videoStream)
+      video.m_messageQueue.Put(new CDVDMsgDemuxerPacket(pPacket));
+    else
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  }
+
+  audio.m_messageQueue.Put(new CDVDMsgGeneralEOF());
+  video.m_messageQueue.Put(new CDVDMsgGeneralEOF());
+  if (stalled)
+  {
+    // the decoders are stuck, don't wait for them to reach the eof
+    audio.m_messageQueue.Abort();
+    video.m_messageQueue.Abort();
+  }
+  // the decoders exit on their own once they reach the eof
+  while (audio.IsRunning() || video.IsRunning())
+    CThread::Sleep(1);
+
+  delete demuxer;
+  delete input;
+
+  ASSERT_FALSE(stalled) << "decoders stopped draining the queues for " << QUEUE_FULL_TIMEOUT_MS << " ms";
+  EXPECT_GE(video.m_frames, (unsigned int)(CLIP_SECONDS * CLIP_FPS * 9 / 10));
+  EXPECT_GT(audio.m_frames, 0u);
+}
@@ -0,0 +1,121 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDFileInfo.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/StdString.h"
+#include "utils/StringUtils.h"
+#include "utils/StreamDetails.h"
+#include "utils/URIUtils.h"
+#include "test/TestUtils.h"
+#include "TextureCache.h"
+#include "TestClip.h"
+
+#include "gtest/gtest.h"
+
+#define THUMB_CLIP_SECONDS 4
+#define THUMB_FILES        4
+
+class TestDVDFileInfo : public testing::Test
+{
+protected:
+  TestDVDFileInfo() : m_clip(NULL) {}
+
+  virtual void SetUp()
+  {
+    m_clip = XBMC_CREATETEMPFILE(".mkv");
+    ASSERT_TRUE(m_clip != NULL);
+    m_clip->Close();
+    m_path = XBMC_TEMPFILEPATH(m_clip);
+    ASSERT_TRUE(GenerateClip(m_path, THUMB_CLIP_SECONDS));
+    XFILE::CDirectory::Create(URIUtils::GetDirectory(CTextureCache::GetCachedPath(ThumbFile(0))));
+  }
+
+  virtual void TearDown()
+  {
+    for (unsigned int i = 0; i < THUMB_FILES; i++)
+      XFILE::CFile::Delete(CTextureCache::GetCachedPath(ThumbFile(i)));
+    if (m_clip)
+      XBMC_DELETETEMPFILE(m_clip);
+  }
+
+  static CStdString ThumbFile(unsigned int i)
+  {
+    return StringUtils::Format("dvdfileinfotest/thumb%u.jpg", i);
+  }
+
+  bool Extract(unsigned int i, bool bKeyframesOnly, CTextureDetails &details)
+  {
+    details.file = ThumbFile(i);
+    return CDVDFileInfo::ExtractThumb(m_path, details, NULL, bKeyframesOnly);
+  }
+
+  XFILE::CFile *m_clip;
+  std::string   m_path;
+};
+
+TEST_F(TestDVDFileInfo, ExtractThumb)
+{
+  CStreamDetails streamDetails;
+  CTextureDetails details;
+  details.file = ThumbFile(0);
+  EXPECT_TRUE(CDVDFileInfo::ExtractThumb(m_path, details, &streamDetails, true));
+  EXPECT_GT(details.width, 0u);
+  EXPECT_GT(details.height, 0u);
+  EXPECT_TRUE(XFILE::CFile::Exists(CTextureCache::GetCachedPath(details.file)));
+  EXPECT_EQ(CLIP_WIDTH, streamDetails.GetVideoWidth());
+  EXPECT_EQ(CLIP_HEIGHT, streamDetails.GetVideoHeight());
+}
+
+TEST_F(TestDVDFileInfo, ExtractBestThumb)
+{
+  CTextureDetails details;
+  details.file = ThumbFile(0);
+  EXPECT_TRUE(CDVDFileInfo::ExtractBestThumb(m_path, details, NULL, 5, true));
+  EXPECT_GT(details.width, 0u);
+  EXPECT_TRUE(XFILE::CFile::Exists(CTextureCache::GetCachedPath(details.file)));
+}
+
+TEST_F(TestDVDFileInfo, ClearThumbCodecCache)
+{
+  CTextureDetails details;
+  EXPECT_TRUE(Extract(0, true, details));
+
+  // the cached decoder is gone, extraction has to open a new one
+  CDVDFileInfo::ClearThumbCodecCache();
+  EXPECT_TRUE(Extract(1, true, details));
+
+  // after shutdown decoders are freed on release instead of being cached
+  CDVDFileInfo::ClearThumbCodecCache(true);
+  EXPECT_TRUE(Extract(2, true, details));
+  EXPECT_TRUE(Extract(3, true, details));
+
+  CDVDFileInfo::ClearThumbCodecCache();
+}
+
+TEST_F(TestDVDFileInfo, ExtractThumbFullDecode)
+{
+  CTextureDetails details;
+  EXPECT_TRUE(Extract(0, false, details));
+  EXPECT_GT(details.width, 0u);
+  EXPECT_GT(details.height, 0u);
+  EXPECT_TRUE(XFILE::CFile::Exists(CTextureCache::GetCachedPath(details.file)));
+}
@@ -0,0 +1,277 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDMessage.h"
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+static CDVDMsg* Packet(int size, double dts)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->dts   = dts;
+  packet->pts   = DVD_NOPTS_VALUE;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+static CDVDMsg* Value(int value)
+{
+  return new CDVDMsgInt(CDVDMsg::PLAYER_SETSPEED, value);
+}
+
+// takes the next message, returns its value or -1 for anything else
+static int GetValue(CDVDMessageQueue &queue, int &priority)
+{
+  CDVDMsg* msg = NULL;
+  if (queue.Get(&msg, 0, priority) != MSGQ_OK)
+    return -1;
+  int value = -1;
+  if (msg->IsType(CDVDMsg::PLAYER_SETSPEED))
+    value = static_cast<CDVDMsgInt*>(msg)->m_value;
+  msg->Release();
+  return value;
+}
+
+static int GetValue(CDVDMessageQueue &queue)
+{
+  int priority = 0;
+  return GetValue(queue, priority);
+}
+
+class TestDVDMessageQueue : public testing::Test
+{
+protected:
+  TestDVDMessageQueue() : m_queue("test") {}
+
+  virtual void SetUp()
+  {
+    m_queue.Init();
+  }
+
+  virtual void TearDown()
+  {
+    m_queue.End();
+  }
+
+  CDVDMessageQueue m_queue;
+};
+
+TEST_F(TestDVDMessageQueue, Priority)
+{
+  // higher priorities first, in order of arrival within a priority
+  m_queue.Put(Value(1));
+  m_queue.Put(Value(2));
+  m_queue.Put(Value(10), 1);
+  m_queue.Put(Value(3));
+  m_queue.Put(Value(11), 1);
+  m_queue.Put(Value(20), 2);
+
+  int priority = 0;
+  EXPECT_EQ(20, GetValue(m_queue, priority));
+  EXPECT_EQ(2, priority);
+  EXPECT_EQ(10, GetValue(m_queue));
+  EXPECT_EQ(11, GetValue(m_queue));
+  EXPECT_EQ(1, GetValue(m_queue, priority));
+  EXPECT_EQ(0, priority);
+  EXPECT_EQ(2, GetValue(m_queue));
+  EXPECT_EQ(3, GetValue(m_queue));
+  EXPECT_EQ(-1, GetValue(m_queue));
+}
+
+TEST_F(TestDVDMessageQueue, MinimumPriority)
+{
+  m_queue.Put(Value(1));
+  m_queue.Put(Value(10), 1);
+
+  int priority = 1;
+  EXPECT_EQ(10, GetValue(m_queue, priority));
+  priority = 1;
+  EXPECT_EQ(-1, GetValue(m_queue, priority));
+  priority = 0;
+  EXPECT_EQ(1, GetValue(m_queue, priority));
+}
+
+TEST_F(TestDVDMessageQueue, Wraparound)
+{
+  // keep the ring partly filled while its head moves around it, and grow it
+  // while it wraps
+  int next = 0, expected = 0;
+  for (int round = 0; round < 50; round++)
+  {
+    for (int i = 0; i < round % 7 + 3; i++)
+      m_queue.Put(Value(next++));
+    for (int i = 0; i < round % 5 + 2 && expected < next; i++)
+      EXPECT_EQ(expected++, GetValue(m_queue));
+  }
+  while (expected < next)
+    EXPECT_EQ(expected++, GetValue(m_queue));
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::PLAYER_SETSPEED));
+}
+
+TEST_F(TestDVDMessageQueue, Counters)
+{
+  for (int i = 0; i < 5; i++)
+    m_queue.Put(Packet(100, DVD_NOPTS_VALUE));
+  m_queue.Put(Value(1));
+  m_queue.Put(Value(2), 1);
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+
+  EXPECT_EQ(5U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(2U, m_queue.GetPacketCount(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(1U, m_queue.GetPacketCount(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(500, m_queue.GetDataSize());
+
+  EXPECT_EQ(2, GetValue(m_queue));
+  EXPECT_EQ(1U, m_queue.GetPacketCount(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(-1, GetValue(m_queue));
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(-1, GetValue(m_queue));
+  EXPECT_EQ(4U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(400, m_queue.GetDataSize());
+}
+
+TEST_F(TestDVDMessageQueue, Flush)
+{
+  m_queue.Put(Value(1));
+  m_queue.Put(Packet(100, DVD_NOPTS_VALUE));
+  m_queue.Put(Value(2));
+  m_queue.Put(Packet(100, DVD_NOPTS_VALUE));
+  m_queue.Put(Value(10), 1);
+  m_queue.Put(Value(3));
+
+  // the other messages are kept in order
+  m_queue.Flush();
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(4U, m_queue.GetPacketCount(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(0, m_queue.GetDataSize());
+  EXPECT_EQ(10, GetValue(m_queue));
+  EXPECT_EQ(1, GetValue(m_queue));
+  EXPECT_EQ(2, GetValue(m_queue));
+
+  m_queue.Put(Value(4));
+  EXPECT_EQ(3, GetValue(m_queue));
+  EXPECT_EQ(4, GetValue(m_queue));
+
+  m_queue.Put(Value(5));
+  m_queue.Put(Packet(100, DVD_NOPTS_VALUE), 1);
+  m_queue.Flush(CDVDMsg::NONE);
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(-1, GetValue(m_queue));
+}
+
+TEST_F(TestDVDMessageQueue, TimeSize)
+{
+  m_queue.SetMaxDataSize(10000);
+  m_queue.SetMaxTimeSize(8.0);
+  EXPECT_TRUE(m_queue.IsDataBased());
+
+  for (int i = 0; i <= 8; i++)
+    m_queue.Put(Packet(100, i * (double)DVD_TIME_BASE / 2));
+  EXPECT_FALSE(m_queue.IsDataBased());
+  EXPECT_EQ(4, m_queue.GetTimeSize());
+  EXPECT_EQ(50, m_queue.GetLevel());
+
+  // the back moves along as packets are taken
+  CDVDMsg* msg = NULL;
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+    msg->Release();
+  }
+  EXPECT_EQ(2, m_queue.GetTimeSize());
+  EXPECT_EQ(400, m_queue.GetDataSize());
+
+  m_queue.Flush();
+  EXPECT_TRUE(m_queue.IsDataBased());
+  EXPECT_EQ(0, m_queue.GetLevel());
+}
+
+TEST_F(TestDVDMessageQueue, Latency)
+{
+  unsigned count;
+  double average, peak;
+  m_queue.GetLatency(CDVDMsg::PLAYER_SETSPEED, count, average, peak);
+  EXPECT_EQ(0U, count);
+
+  m_queue.Put(Value(1));
+  m_queue.Put(Value(2));
+  Sleep(20);
+  EXPECT_EQ(1, GetValue(m_queue));
+  EXPECT_EQ(2, GetValue(m_queue));
+  m_queue.Put(Value(3));
+  EXPECT_EQ(3, GetValue(m_queue));
+
+  m_queue.GetLatency(CDVDMsg::PLAYER_SETSPEED, count, average, peak);
+  EXPECT_EQ(3U, count);
+  EXPECT_LE(20.0, peak);
+  EXPECT_LT(average, peak);
+  m_queue.GetLatency(CDVDMsg::DEMUXER_PACKET, count, average, peak);
+  EXPECT_EQ(0U, count);
+
+  // Init starts over
+  m_queue.Init();
+  m_queue.GetLatency(CDVDMsg::PLAYER_SETSPEED, count, average, peak);
+  EXPECT_EQ(0U, count);
+}
+
+class CDelayedPut : public CThread
+{
+public:
+  CDelayedPut(CDVDMessageQueue &queue, bool abort)
+    : CThread("DelayedPut"), m_queue(queue), m_abort(abort) {}
+
+protected:
+  virtual void Process()
+  {
+    Sleep(50);
+    if (m_abort)
+      m_queue.Abort();
+    else
+      m_queue.Put(Value(1));
+  }
+
+  CDVDMessageQueue &m_queue;
+  bool m_abort;
+};
+
+TEST_F(TestDVDMessageQueue, Wait)
+{
+  CDVDMsg* msg = NULL;
+  EXPECT_EQ(MSGQ_TIMEOUT, m_queue.Get(&msg, 10));
+  EXPECT_TRUE(msg == NULL);
+
+  CDelayedPut put(m_queue, false);
+  put.Create();
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 5000));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::PLAYER_SETSPEED));
+  msg->Release();
+  put.StopThread();
+
+  CDelayedPut abort(m_queue, true);
+  abort.Create();
+  EXPECT_EQ(MSGQ_ABORT, m_queue.Get(&msg, 5000));
+  abort.StopThread();
+}
@@ -159,6 +159,7 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
             CGUIDialogBusy* dialog = (CGUIDialogBusy*)g_windowManager.GetWindow(WINDOW_DIALOG_BUSY);
             dialog->Show();
 
+            CFileItemList partial(strPath);
             while(!get.Wait(10))
             {
               CSingleLock lock(g_graphicsContext);
@@ -168,6 +169,10 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
               if (progress > 0)
                 dialog->SetProgress(progress);
 
+              // let the caller show what we have so far
+              if (hints.partialCallback && pDirectory->GetPartialDirectory(partial))
+                hints.partialCallback->OnPartialDirectory(partial);
+
               if(dialog->IsCanceled())
               {
                 cancel = true;
@@ -36,11 +36,12 @@ public:
   class CHints
   {
   public:
-    CHints() : flags(DIR_FLAG_DEFAULTS)
+    CHints() : flags(DIR_FLAG_DEFAULTS), partialCallback(NULL)
     {
     };
     CStdString mask;
     int flags;
+    IPartialDirectoryCallback *partialCallback; ///< receives the items of a slow threaded fetch as they arrive
   };
 
   static bool GetDirectory(const CStdString& strPath
@@ -47,6 +47,23 @@ namespace XFILE
     DIR_FLAG_READ_CACHE    = (2 << 4), ///< Force reading from the directory cache (if available)
     DIR_FLAG_BYPASS_CACHE  = (2 << 5)  ///< Completely bypass the directory cache (no reading, no writing)
   };
+
+/*!
+ \ingroup filesystem
+ \brief Interface for showing the items of a slow directory before it is complete.
+ \sa IDirectory::GetPartialDirectory, CDirectory::CHints
+ */
+class IPartialDirectoryCallback
+{
+public:
+  virtual ~IPartialDirectoryCallback() {}
+  /*!
+   \brief Called from the thread which requested the directory while it is being fetched.
+   \param items all the items retrieved so far, in the order the directory delivered them.
+   */
+  virtual void OnPartialDirectory(const CFileItemList &items) = 0;
+};
+
 /*!
  \ingroup filesystem
  \brief Interface to the directory on a file system.
@@ -79,6 +96,14 @@ public:
    \sa GetDirectory
    */
   virtual void CancelDirectory() { };
+  /*!
+   \brief Retrieve the items the current directory fetch has delivered so far (if possible).
+   May be called from another thread while GetDirectory is running.
+   \param items the items delivered since the last call are appended to this list.
+   \return true if any items were appended.
+   \sa GetDirectory
+   */
+  virtual bool GetPartialDirectory(CFileItemList &items) { return false; };
   /*!
   \brief Create the directory
   \param strPath Directory to create.
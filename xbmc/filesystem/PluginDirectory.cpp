@@ -53,6 +53,7 @@ CPluginDirectory::CPluginDirectory()
 {
   m_listItems = new CFileItemList;
   m_fileResult = new CFileItem;
+  m_streamedItems = 0;
 }
 
 CPluginDirectory::~CPluginDirectory(void)
@@ -113,9 +114,13 @@ bool CPluginDirectory::StartScript(const CStdString& strPath, bool retrievingDir
 
   // clear out our status variables
   m_fileResult->Reset();
-  m_listItems->Clear();
-  m_listItems->SetPath(strPath);
-  m_listItems->SetLabel(m_addon->Name());
+  {
+    CSingleLock lock(m_handleLock);
+    m_listItems->Clear();
+    m_listItems->SetPath(strPath);
+    m_listItems->SetLabel(m_addon->Name());
+    m_streamedItems = 0;
+  }
   m_cancelled = false;
   m_success = false;
   m_totalItems = 0;
@@ -170,12 +175,13 @@ bool CPluginDirectory::GetPluginResult(const CStdString& strPath, CFileItem &res
 
 bool CPluginDirectory::AddItem(int handle, const CFileItem *item, int totalItems)
 {
+  CFileItemPtr pItem(new CFileItem(*item));
+
   CSingleLock lock(m_handleLock);
   CPluginDirectory *dir = dirFromHandle(handle);
   if (!dir)
     return false;
 
-  CFileItemPtr pItem(new CFileItem(*item));
   dir->m_listItems->Add(pItem);
   dir->m_totalItems = totalItems;
 
@@ -189,9 +195,7 @@ bool CPluginDirectory::AddItems(int handle, const CFileItemList *items, int tota
   if (!dir)
     return false;
 
-  CFileItemList pItemList;
-  pItemList.Copy(*items);
-  dir->m_listItems->Append(pItemList);
+  dir->m_listItems->Append(*items);
   dir->m_totalItems = totalItems;
 
   return !dir->m_cancelled;
@@ -412,11 +416,27 @@ bool CPluginDirectory::GetDirectory(const CStdString& strPath, CFileItemList& it
   bool success = StartScript(strPath, true);
 
   // append the items to the list
+  CSingleLock lock(m_handleLock);
   items.Assign(*m_listItems, true); // true to keep the current items
   m_listItems->Clear();
+  m_streamedItems = 0;
   return success;
 }
 
+bool CPluginDirectory::GetPartialDirectory(CFileItemList &items)
+{
+  CSingleLock lock(m_handleLock);
+  if (m_streamedItems >= m_listItems->Size())
+    return false;
+
+  // hand out what the script added since the last call, the items are shared
+  // as they don't change anymore once added
+  for (int i = m_streamedItems; i < m_listItems->Size(); i++)
+    items.Add(m_listItems->Get(i));
+  m_streamedItems = m_listItems->Size();
+  return true;
+}
+
 bool CPluginDirectory::RunScriptWithParams(const CStdString& strPath)
 {
   CURL url(strPath);
@@ -49,11 +49,17 @@ public:
   virtual bool Exists(const char* strPath) { return true; }
   virtual float GetProgress() const;
   virtual void CancelDirectory();
+  virtual bool GetPartialDirectory(CFileItemList &items);
   static bool RunScriptWithParams(const CStdString& strPath);
   static bool GetPluginResult(const CStdString& strPath, CFileItem &resultItem);
 
   // callbacks from python
   static bool AddItem(int handle, const CFileItem *item, int totalItems);
+  /*! \brief Add a batch of items to the listing of the given handle
+   The items are shared with the caller instead of being copied. The caller may
+   only change them afterwards while holding the gui lock, as they may be shown
+   before the listing is complete.
+   */
   static bool AddItems(int handle, const CFileItemList *items, int totalItems);
   static void EndOfDirectory(int handle, bool success, bool replaceListing, bool cacheToDisc);
   static void AddSortMethod(int handle, SORT_METHOD sortMethod, const CStdString &label2Mask);
@@ -83,5 +89,6 @@ private:
   bool          m_cancelled;    // set to true when we are cancelled
   bool          m_success;      // set by script in EndOfDirectory
   int    m_totalItems;   // set by script in AddDirectoryItem
+  int    m_streamedItems; // number of items already handed out by GetPartialDirectory
 };
 }
@@ -33,6 +33,8 @@
 #include "UnrarXLib/rar.hpp"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+
 #ifndef TARGET_POSIX
 #include <process.h>
 #endif
@@ -130,6 +132,9 @@ CRarFile::CRarFile()
   m_bUseFile = false;
   m_bOpen = false;
   m_bSeekable = true;
+  m_bPacked = false;
+  m_iVolume = -1;
+  m_bVolumeSeek = false;
 }
 
 CRarFile::~CRarFile()
@@ -145,6 +150,7 @@ CRarFile::~CRarFile()
   }
   else
   {
+    m_File.Close();
     CleanUp();
     if (m_pExtractThread)
     {
@@ -171,6 +177,17 @@ bool CRarFile::Open(const CURL& url)
   {
     if (items[i]->m_idepth == 0x30) // stored
     {
+      // read straight from the volumes when we know where the data is
+      if (g_RarManager.GetVolumeMap(m_strRarPath, m_strPathInRar, m_volumes))
+      {
+        m_iFileSize = items[i]->m_dwSize;
+        m_iFilePosition = 0;
+        m_iVolume = -1;
+        m_bVolumeSeek = true;
+        m_bOpen = true;
+        return true;
+      }
+
       if (!OpenInArchive())
         return false;
 
@@ -197,8 +214,19 @@ bool CRarFile::Open(const CURL& url)
     else
     {
       CFileInfo* info = g_RarManager.GetFileInRar(m_strRarPath,m_strPathInRar);
-      if ((!info || !CFile::Exists(info->m_strCachedPath)) && m_bFileOptions & EXFILE_NOCACHE)
+      bool bCached = info && CFile::Exists(info->m_strCachedPath);
+      if (!bCached && m_bFileOptions & EXFILE_NOCACHE)
         return false;
+
+      // unpack while reading rather than extracting the whole file first,
+      // unless it is cached already or depends on the files before it
+      if (!bCached && OpenInArchive())
+      {
+        m_iFileSize = items[i]->m_dwSize;
+        m_bOpen = true;
+        return true;
+      }
+
       m_bUseFile = true;
       CStdString strPathInCache;
 
@@ -278,9 +306,15 @@ unsigned int CRarFile::Read(void *lpBuf, int64_t uiBufSize)
   if (m_bUseFile)
     return m_File.Read(lpBuf,uiBufSize);
 
+  if (!m_volumes.empty())
+    return ReadVolumes(lpBuf,uiBufSize);
+
   if (m_iFilePosition >= GetLength()) // we are done
     return 0;
 
+  if (!m_pExtract) // a restart failed
+    return 0;
+
   if( !m_pExtract->GetDataIO().hBufferEmpty->WaitMSec(5000) )
   {
     CLog::Log(LOGERROR, "%s - Timeout waiting for buffer to empty", __FUNCTION__);
@@ -376,6 +410,8 @@ void CRarFile::Close()
   }
   else
   {
+    m_File.Close();
+    m_volumes.clear();
     CleanUp();
     if (m_pExtractThread)
     {
@@ -399,6 +435,40 @@ int64_t CRarFile::Seek(int64_t iFilePosition, int iWhence)
   if (m_bUseFile)
     return m_File.Seek(iFilePosition,iWhence);
 
+  if (!m_volumes.empty())
+  {
+    switch (iWhence)
+    {
+      case SEEK_CUR:
+        iFilePosition += m_iFilePosition;
+        break;
+      case SEEK_END:
+        iFilePosition += m_iFileSize;
+        break;
+      case SEEK_SET:
+        break;
+      default:
+        return -1;
+    }
+
+    if (iFilePosition < 0 || iFilePosition > m_iFileSize)
+      return -1;
+
+    // the volume is positioned on the next read
+    if (iFilePosition != m_iFilePosition)
+    {
+      m_iFilePosition = iFilePosition;
+      m_bVolumeSeek = true;
+    }
+    return m_iFilePosition;
+  }
+
+  if (!m_pExtract) // a restart failed
+    return -1;
+
+  if (m_bPacked)
+    return SeekPacked(iFilePosition,iWhence);
+
   if( !m_pExtract->GetDataIO().hBufferEmpty->WaitMSec(SEEKTIMOUT) )
   {
     CLog::Log(LOGERROR, "%s - Timeout waiting for buffer to empty", __FUNCTION__);
@@ -569,6 +639,130 @@ void CRarFile::InitFromUrl(const CURL& url)
 
 }
 
+unsigned int CRarFile::ReadVolumes(void* lpBuf, int64_t uiBufSize)
+{
+  uint8_t* pBuf = (uint8_t*)lpBuf;
+  int64_t iRead = 0;
+  while (iRead < uiBufSize && m_iFilePosition < m_iFileSize)
+  {
+    if (m_bVolumeSeek || m_iFilePosition >= m_volumes[m_iVolume].iStart + m_volumes[m_iVolume].iSize)
+    {
+      if (!SeekVolume())
+        break;
+    }
+
+    const SRarVolumePart& part = m_volumes[m_iVolume];
+    int64_t iToRead = std::min(uiBufSize - iRead, part.iStart + part.iSize - m_iFilePosition);
+    unsigned int iBytes = m_File.Read(pBuf + iRead, iToRead);
+    if (iBytes == 0)
+    {
+      CLog::Log(LOGERROR, "%s - unexpected end of %s", __FUNCTION__, part.strVolume.c_str());
+      break;
+    }
+    iRead += iBytes;
+    m_iFilePosition += iBytes;
+  }
+  return static_cast<unsigned int>(iRead);
+}
+
+bool CRarFile::SeekVolume()
+{
+  // the last part starting at or before the position, empty parts are skipped
+  unsigned int iFirst = 0, iLast = m_volumes.size();
+  while (iLast - iFirst > 1)
+  {
+    unsigned int iMiddle = (iFirst + iLast) / 2;
+    if (m_volumes[iMiddle].iStart <= m_iFilePosition)
+      iFirst = iMiddle;
+    else
+      iLast = iMiddle;
+  }
+
+  const SRarVolumePart& part = m_volumes[iFirst];
+  if ((int)iFirst != m_iVolume)
+  {
+    m_File.Close();
+    m_iVolume = -1;
+    if (!m_File.Open(part.strVolume))
+    {
+      CLog::Log(LOGERROR, "%s - failed to open volume %s", __FUNCTION__, part.strVolume.c_str());
+      return false;
+    }
+    m_iVolume = iFirst;
+  }
+
+  if (m_File.Seek(part.iOffset + m_iFilePosition - part.iStart) < 0)
+    return false;
+
+  m_bVolumeSeek = false;
+  return true;
+}
+
+int64_t CRarFile::SeekPacked(int64_t iFilePosition, int iWhence)
+{
+  switch (iWhence)
+  {
+    case SEEK_CUR:
+      iFilePosition += m_iFilePosition;
+      break;
+    case SEEK_END:
+      iFilePosition += m_iFileSize;
+      break;
+    case SEEK_SET:
+      break;
+    default:
+      return -1;
+  }
+
+  if (iFilePosition < 0)
+    return -1;
+
+  if (iFilePosition == m_iFilePosition)
+    return m_iFilePosition;
+
+  // nothing to unpack past the end, seeking back from there restarts
+  if (iFilePosition >= m_iFileSize)
+  {
+    m_iFilePosition = iFilePosition;
+    m_iBufferStart = iFilePosition;
+    m_iDataInBuffer = 0;
+    return m_iFilePosition;
+  }
+
+  // what was unpacked last is still in the buffer
+  int64_t iBufferEnd = m_iFilePosition + (m_iDataInBuffer > 0 ? m_iDataInBuffer : 0);
+  if (iFilePosition >= m_iBufferStart && iFilePosition < iBufferEnd)
+  {
+    m_szStartOfBuffer += iFilePosition - m_iFilePosition;
+    m_iDataInBuffer = iBufferEnd - iFilePosition;
+    m_iFilePosition = iFilePosition;
+    return m_iFilePosition;
+  }
+
+  // packed data can't be entered halfway, so unpack again from the start
+  if (iFilePosition < m_iBufferStart)
+  {
+    CleanUp();
+    if (!OpenInArchive())
+    {
+      CLog::Log(LOGERROR, "%s - failed to restart unpacking %s", __FUNCTION__, m_strPathInRar.c_str());
+      return -1;
+    }
+  }
+
+  std::vector<uint8_t> skip(MAXWINMEMSIZE);
+  while (m_iFilePosition < iFilePosition)
+  {
+    if (Read(&skip[0], std::min<int64_t>(skip.size(), iFilePosition - m_iFilePosition)) == 0)
+    {
+      CLog::Log(LOGERROR, "%s - failed to unpack up to %" PRId64, __FUNCTION__, iFilePosition);
+      return -1;
+    }
+  }
+
+  return m_iFilePosition;
+}
+
 void CRarFile::CleanUp()
 {
 #ifdef HAS_FILESYSTEM_RAR
@@ -720,6 +914,14 @@ bool CRarFile::OpenInArchive()
       m_pArc->SeekToNext();
     }
 
+    // files in solid archives need the ones before them unpacked first
+    m_bPacked = m_pArc->NewLhd.Method != 0x30;
+    if (m_bPacked && (m_pArc->NewLhd.Flags & LHD_SOLID))
+    {
+      CleanUp();
+      return false;
+    }
+
     m_szBuffer = new uint8_t[MAXWINMEMSIZE];
     m_szStartOfBuffer = m_szBuffer;
     m_pExtract->GetDataIO().SetUnpackToMemory(m_szBuffer,0);
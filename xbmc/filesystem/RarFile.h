@@ -26,6 +26,7 @@
 
 #include "File.h"
 #include "IFile.h"
+#include "RarManager.h"
 #include "threads/Thread.h"
 #include "threads/Event.h"
 
@@ -90,6 +91,9 @@ namespace XFILE
     void InitFromUrl(const CURL& url);
     bool OpenInArchive();
     void CleanUp();
+    unsigned int ReadVolumes(void* lpBuf, int64_t uiBufSize);
+    bool SeekVolume();
+    int64_t SeekPacked(int64_t iFilePosition, int iWhence);
 
     int64_t m_iFilePosition;
     int64_t m_iFileSize;
@@ -97,7 +101,11 @@ namespace XFILE
     bool m_bUseFile;
     bool m_bOpen;
     bool m_bSeekable;
-    CFile m_File; // for packed source
+    bool m_bPacked; // unpacked while reading, seeks restart from the beginning
+    CFile m_File; // the cached copy of a packed file, or the current volume
+    std::vector<SRarVolumePart> m_volumes; // where a stored file is, when read directly
+    int m_iVolume;
+    bool m_bVolumeSeek;
 #ifdef HAS_FILESYSTEM_RAR
     Archive* m_pArc;
     CommandData* m_pCmd;
@@ -34,6 +34,7 @@
 #include "dialogs/GUIDialogYesNo.h"
 #include "guilib/GUIWindowManager.h"
 #include "utils/StringUtils.h"
+#include "UnrarXLib/rar.hpp"
 
 #include <set>
 
@@ -406,6 +407,7 @@ void CRarManager::ClearCache(bool force)
   }
 
   m_ExFiles.clear();
+  m_volumeMaps.clear();
 #endif
 }
 
@@ -445,6 +447,120 @@ void CRarManager::ExtractArchive(const CStdString& strArchive, const CStdString&
 #endif
 }
 
+bool CRarManager::GetVolumeMap(const CStdString& strRarPath, const CStdString& strPathInRar,
+                               vector<SRarVolumePart>& parts)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  CSingleLock lock(m_CritSection);
+
+  pair<CStdString, CStdString> key(strRarPath, strPathInRar);
+  map<pair<CStdString, CStdString>, vector<SRarVolumePart> >::const_iterator it = m_volumeMaps.find(key);
+  if (it == m_volumeMaps.end())
+  {
+    // files that can't be mapped are remembered as well, so we only look once
+    vector<SRarVolumePart> volumeMap;
+    if (!BuildVolumeMap(strRarPath, strPathInRar, volumeMap))
+      volumeMap.clear();
+    it = m_volumeMaps.insert(make_pair(key, volumeMap)).first;
+  }
+
+  parts = it->second;
+  return !parts.empty();
+#else
+  return false;
+#endif
+}
+
+#ifdef HAS_FILESYSTEM_RAR
+static CStdString GetHeaderFileName(Archive& arc)
+{
+  CStdString strFileName;
+  if (wcslen(arc.NewLhd.FileNameW) > 0)
+    g_charsetConverter.wToUTF8(arc.NewLhd.FileNameW, strFileName);
+  else
+    g_charsetConverter.unknownToUTF8(arc.NewLhd.FileName, strFileName);
+
+  StringUtils::Replace(strFileName, '\\', '/');
+  return strFileName;
+}
+#endif
+
+bool CRarManager::BuildVolumeMap(const CStdString& strRarPath, const CStdString& strPathInRar,
+                                 vector<SRarVolumePart>& parts)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  try
+  {
+    InitCRC();
+
+    Archive arc;
+    if (!arc.WOpen(strRarPath.c_str(), NULL) || !arc.IsArchive(true))
+      return false;
+
+    while (true)
+    {
+      bool bFound = false;
+      while (arc.ReadHeader() > 0)
+      {
+        if (arc.GetHeaderType() == FILE_HEAD && GetHeaderFileName(arc) == strPathInRar)
+        {
+          bFound = true;
+          break;
+        }
+        arc.SeekToNext();
+      }
+      if (!bFound)
+        return false;
+
+      // only stored data can be read straight from the volumes
+      if (arc.NewLhd.Method != 0x30 || (arc.NewLhd.Flags & LHD_PASSWORD))
+        return false;
+
+      // the file must start in the first volume and continue in each of the next ones
+      if (((arc.NewLhd.Flags & LHD_SPLIT_BEFORE) != 0) != !parts.empty())
+        return false;
+
+      SRarVolumePart part;
+      part.strVolume = arc.FileName;
+      part.iOffset = arc.NextBlockPos - arc.NewLhd.FullPackSize;
+      part.iStart = parts.empty() ? 0 : parts.back().iStart + parts.back().iSize;
+      part.iSize = arc.NewLhd.FullPackSize;
+      parts.push_back(part);
+
+      if ((arc.NewLhd.Flags & LHD_SPLIT_AFTER) == 0)
+        return part.iStart + part.iSize == arc.NewLhd.FullUnpSize;
+
+      // same naming rules as MergeArchive: name.partNN.rar, falling back to name.rNN
+      char NextName[NM];
+      strcpy(NextName, arc.FileName);
+      NextVolumeName(NextName, (arc.NewMhd.Flags & MHD_NEWNUMBERING) == 0 || arc.OldFormat);
+      arc.Close();
+      if (!arc.Open(NextName))
+      {
+        strcpy(NextName, part.strVolume.c_str());
+        NextVolumeName(NextName, true);
+        if (!arc.Open(NextName))
+        {
+          CLog::Log(LOGDEBUG, "%s - missing volume after %s", __FUNCTION__, part.strVolume.c_str());
+          return false;
+        }
+      }
+      if (!arc.IsArchive(true))
+        return false;
+    }
+  }
+  catch (int rarErrCode)
+  {
+    CLog::Log(LOGERROR, "%s - UnrarXLib error code %d while mapping %s", __FUNCTION__, rarErrCode, strPathInRar.c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - unknown exception while mapping %s", __FUNCTION__, strPathInRar.c_str());
+  }
+#endif
+  return false;
+}
+
 int64_t CRarManager::CheckFreeSpace(const CStdString& strDrive)
 {
   ULARGE_INTEGER lTotalFreeBytes;
@@ -25,6 +25,7 @@
 #include "utils/StdString.h"
 #include "threads/CriticalSection.h"
 #include <map>
+#include <vector>
 #include "UnrarXLib/UnrarX.hpp"
 #include "utils/Stopwatch.h"
 
@@ -62,6 +63,15 @@ public:
   int m_iIsSeekable;
 };
 
+// where a part of a stored file lives in a (multi-volume) archive
+struct SRarVolumePart
+{
+  CStdString strVolume; // path of the volume holding this part
+  int64_t iOffset;      // start of the part's data in the volume
+  int64_t iStart;       // position of the part in the unpacked file
+  int64_t iSize;
+};
+
 class CRarManager
 {
 public:
@@ -79,12 +89,25 @@ public:
   void ClearCache(bool force=false);
   void ClearCachedFile(const CStdString& strRarPath, const CStdString& strPathInRar);
   void ExtractArchive(const CStdString& strArchive, const CStdString& strPath);
+  /*! \brief Get the parts of a stored file across the volumes of the archive
+   Fails for compressed and encrypted files, which have to be unpacked to be read.
+   \param strRarPath the first volume of the archive.
+   \param strPathInRar the file in the archive.
+   \param parts the parts of the file, ordered by their position in it.
+   \return true if the file's data may be read directly from the volumes.
+   */
+  bool GetVolumeMap(const CStdString& strRarPath, const CStdString& strPathInRar,
+                    std::vector<SRarVolumePart>& parts);
 protected:
 
   bool ListArchive(const CStdString& strRarPath, ArchiveList_struct* &pArchiveList);
   std::map<CStdString, std::pair<ArchiveList_struct*,std::vector<CFileInfo> > > m_ExFiles;
   CCriticalSection m_CritSection;
 
+  bool BuildVolumeMap(const CStdString& strRarPath, const CStdString& strPathInRar,
+                      std::vector<SRarVolumePart>& parts);
+  std::map<std::pair<CStdString, CStdString>, std::vector<SRarVolumePart> > m_volumeMaps;
+
   int64_t CheckFreeSpace(const CStdString& strDrive);
 };
 
@@ -44,6 +44,7 @@ CVirtualDirectory::CVirtualDirectory(void)
   m_flags = DIR_FLAG_ALLOW_PROMPT;
   m_allowNonLocalSources = true;
   m_allowThreads = true;
+  m_partialCallback = NULL;
 }
 
 CVirtualDirectory::~CVirtualDirectory(void)
@@ -78,7 +79,13 @@ bool CVirtualDirectory::GetDirectory(const CStdString& strPath, CFileItemList &i
   if (!bUseFileDirectories)
     flags |= DIR_FLAG_NO_FILE_DIRS;
   if (!strPath.empty() && strPath != "files://")
-    return CDirectory::GetDirectory(strPath, items, m_strFileMask, flags, m_allowThreads);
+  {
+    CDirectory::CHints hints;
+    hints.flags = flags;
+    hints.mask = m_strFileMask;
+    hints.partialCallback = m_partialCallback;
+    return CDirectory::GetDirectory(strPath, items, hints, m_allowThreads);
+  }
 
   // if strPath is blank, clear the list (to avoid parent items showing up)
   if (strPath.empty())
@@ -64,11 +64,19 @@ namespace XFILE
      \param allowThreads if true we allow threads, if false we don't.
      */
     void SetAllowThreads(bool allowThreads) { m_allowThreads = allowThreads; };
+
+    /*! \brief Set who is shown the items of slow directories before they are complete.
+     Only threaded fetches of directories which support it deliver partial results.
+     \param callback the receiver of the partial listings, NULL for none.
+     \sa IDirectory::GetPartialDirectory
+     */
+    void SetPartialDirectoryCallback(IPartialDirectoryCallback *callback) { m_partialCallback = callback; };
   protected:
     void CacheThumbs(CFileItemList &items);
 
     VECSOURCES m_vecSources;
     bool       m_allowNonLocalSources;
     bool       m_allowThreads;
+    IPartialDirectoryCallback *m_partialCallback;
   };
 }
@@ -20,11 +20,13 @@
 
 #include "ZipFile.h"
 #include "URL.h"
-#include "utils/URIUtils.h"
 
+#include <algorithm>
 #include <sys/stat.h>
 
-#define ZIP_CACHE_LIMIT 4*1024*1024
+// distance between checkpoints in uncompressed data, so any seek in a deflated
+// entry inflates at most this much
+#define ZIP_CHECKPOINT_INTERVAL 1024*1024
 
 using namespace XFILE;
 using namespace std;
@@ -34,8 +36,10 @@ CZipFile::CZipFile()
   m_szStringBuffer = NULL;
   m_szStartOfStringBuffer = NULL;
   m_iDataInStringBuffer = 0;
-  m_bCached = false;
   m_iRead = -1;
+  m_iNextCheckpoint = 0;
+  m_iWindowPos = 0;
+  m_iWindowFill = 0;
 }
 
 CZipFile::~CZipFile()
@@ -46,7 +50,6 @@ CZipFile::~CZipFile()
 
 bool CZipFile::Open(const CURL&url)
 {
-  CStdString strOpts = url.GetOptions();
   CURL url2(url);
   url2.SetOptions("");
   CStdString strPath = url2.Get();
@@ -65,25 +68,22 @@ bool CZipFile::Open(const CURL&url)
     return false;
   }
 
-  if (mZipItem.method != 0 && mZipItem.usize > ZIP_CACHE_LIMIT && strOpts != "?cache=no")
-  {
-    if (!CFile::Exists("special://temp/" + URIUtils::GetFileName(strPath)))
-    {
-      url2.SetOptions("?cache=no");
-      if (!CFile::Cache(url2.Get(), "special://temp/" + URIUtils::GetFileName(strPath)))
-        return false;
-    }
-    m_bCached = true;
-    return mFile.Open("special://temp/" + URIUtils::GetFileName(strPath));
-  }
-
   if (!mFile.Open(url.GetHostName())) // this is the zip-file, always open binary
   {
     CLog::Log(LOGERROR,"FileZip: unable to open zip file %s!",url.GetHostName().c_str());
     return false;
   }
   mFile.Seek(mZipItem.offset,SEEK_SET);
-  return InitDecompress();
+  if (!InitDecompress())
+    return false;
+
+  // large deflated entries are seeked in from checkpoints. They are only taken
+  // once the entry gets seeked in, reading it once (like CFile::Cache() does)
+  // doesn't need any
+  m_strCheckpoints.clear();
+  if (mZipItem.method == 8 && mZipItem.usize > ZIP_CHECKPOINT_INTERVAL)
+    m_strCheckpoints = strPath;
+  return true;
 }
 
 bool CZipFile::InitDecompress()
@@ -107,6 +107,9 @@ bool CZipFile::InitDecompress()
   m_ZStream.next_in = (Bytef*)m_szBuffer;
   m_ZStream.avail_in = 0;
   m_ZStream.total_out = 0;
+  m_iNextCheckpoint = ZIP_CHECKPOINT_INTERVAL;
+  m_iWindowPos = 0;
+  m_iWindowFill = 0;
 
   return true;
 }
@@ -118,16 +121,11 @@ int64_t CZipFile::GetLength()
 
 int64_t CZipFile::GetPosition()
 {
-  if (m_bCached)
-    return mFile.GetPosition();
-
   return m_iFilePos;
 }
 
 int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  if (m_bCached)
-    return mFile.Seek(iFilePosition,iWhence);
   if (mZipItem.method == 0) // this is easy
   {
     int64_t iResult;
@@ -164,73 +162,50 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
 
     }
   }
-  // here goes the stupid part..
   if (mZipItem.method == 8)
   {
-    char temp[131072];
     switch (iWhence)
     {
     case SEEK_SET:
-      if (iFilePosition == m_iFilePos)
-        return m_iFilePos; // mp3reader does this lots-of-times
-      if (iFilePosition > mZipItem.usize || iFilePosition < 0)
-        return -1;
-      // read until position in 128k blocks.. only way to do it due to format.
-      // can't start in the middle of data since then we'd have no clue where
-      // we are in uncompressed data..
-      if (iFilePosition < m_iFilePos)
-      {
-        m_iFilePos = 0;
-        m_iZipFilePos = 0;
-        inflateEnd(&m_ZStream);
-        inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
-        mFile.Seek(mZipItem.offset,SEEK_SET);
-        m_ZStream.next_in = (Bytef*)m_szBuffer;
-        m_ZStream.avail_in = 0;
-        m_ZStream.total_out = 0;
-        while (m_iFilePos < iFilePosition)
-        {
-          unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-          if (Read(temp,iToRead) != iToRead)
-            return -1;
-        }
-        return m_iFilePos;
-      }
-      else // seek forward
-        return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
       break;
-
     case SEEK_CUR:
-      if (iFilePosition < 0)
-        return Seek(m_iFilePos+iFilePosition,SEEK_SET); // can't rewind stream
-      // read until requested position, drop data
-      if (m_iFilePos+iFilePosition > mZipItem.usize)
-        return -1;
       iFilePosition += m_iFilePos;
-      while (m_iFilePos < iFilePosition)
-      {
-        unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
       break;
-
     case SEEK_END:
-      // now this is a nasty bastard, possibly takes lotsoftime
-      // uncompress, minding m_ZStream.total_out
-
-      while( (int)m_ZStream.total_out < mZipItem.usize+iFilePosition)
-      {
-        unsigned int iToRead = (mZipItem.usize+iFilePosition-m_ZStream.total_out > 131072)?131072:(int)(mZipItem.usize+iFilePosition-m_ZStream.total_out);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      iFilePosition += mZipItem.usize;
       break;
     default:
       return -1;
     }
+    if (iFilePosition == m_iFilePos)
+      return m_iFilePos; // mp3reader does this lots-of-times
+    if (iFilePosition > mZipItem.usize || iFilePosition < 0)
+      return -1;
+
+    if (!m_checkpoints && !m_strCheckpoints.empty())
+      m_checkpoints = g_ZipManager.GetCheckpoints(m_strCheckpoints);
+
+    // we can't start in the middle of data since then we'd have no clue where
+    // we are in uncompressed data, so restart from the closest checkpoint (or
+    // the start) unless the current position is closer
+    SZipCheckpoint checkpoint;
+    if (m_checkpoints)
+      m_checkpoints->Get(iFilePosition,checkpoint);
+    if (iFilePosition < m_iFilePos || checkpoint.out > m_iFilePos)
+    {
+      if (!RestoreCheckpoint(checkpoint))
+        return -1;
+    }
+
+    // read until position in 128k blocks, drop data
+    char temp[131072];
+    while (m_iFilePos < iFilePosition)
+    {
+      unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
+      if (Read(temp,iToRead) != iToRead)
+        return -1;
+    }
+    return m_iFilePos;
   }
   return -1;
 }
@@ -285,9 +260,6 @@ int CZipFile::Stat(const CURL& url, struct __stat64* buffer)
 
 unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
 {
-  if (m_bCached)
-    return mFile.Read(lpBuf,uiBufSize);
-
   // flush what might be left in the string buffer
   if (m_iDataInStringBuffer > 0)
   {
@@ -300,13 +272,14 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
   {
     uLong iDecompressed = 0;
     uLong prevOut = m_ZStream.total_out;
-    while (((int)iDecompressed < uiBufSize) && ((m_iZipFilePos < mZipItem.csize) || (m_bFlush)))
+    // inflate may stop at a block boundary with input left
+    while (((int)iDecompressed < uiBufSize) && ((m_iZipFilePos < mZipItem.csize) || (m_bFlush) || (m_ZStream.avail_in > 0)))
     {
       m_ZStream.next_out = (Bytef*)(lpBuf)+iDecompressed;
       m_ZStream.avail_out = static_cast<uInt>(uiBufSize-iDecompressed);
       if (m_bFlush) // need to flush buffer !
       {
-        int iMessage = inflate(&m_ZStream,Z_SYNC_FLUSH);
+        int iMessage = Inflate();
         m_bFlush = ((iMessage == Z_OK) && (m_ZStream.avail_out == 0))?true:false;
         if (!m_ZStream.avail_out) // flush filled buffer, get out of here
         {
@@ -324,7 +297,7 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
         }
       }
 
-      int iMessage = inflate(&m_ZStream,Z_SYNC_FLUSH);
+      int iMessage = Inflate();
       if (iMessage < 0)
       {
         Close();
@@ -334,6 +307,8 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
       m_bFlush = ((iMessage == Z_OK) && (m_ZStream.avail_out == 0))?true:false; // more info in input buffer
 
       iDecompressed = m_ZStream.total_out-prevOut;
+      if (iMessage == Z_STREAM_END)
+        break;
     }
     m_iFilePos += iDecompressed;
     return static_cast<unsigned int>(iDecompressed);
@@ -357,10 +332,11 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
 
 void CZipFile::Close()
 {
-  if (mZipItem.method == 8 && !m_bCached && m_iRead != -1)
+  if (mZipItem.method == 8 && m_iRead != -1)
     inflateEnd(&m_ZStream);
 
   mFile.Close();
+  m_checkpoints.reset();
 }
 /* CHANGED: JM - moved to CFile
 bool CZipFile::ReadString(char* szLine, int iLineLength)
@@ -450,6 +426,99 @@ bool CZipFile::FillBuffer()
   return true;
 }
 
+int CZipFile::Inflate()
+{
+  if (!m_checkpoints)
+    return inflate(&m_ZStream,Z_SYNC_FLUSH);
+
+  // stop at block boundaries, the only places we can restart inflating from
+  Bytef* out = m_ZStream.next_out;
+  int iMessage = inflate(&m_ZStream,Z_BLOCK);
+  if (iMessage >= 0)
+    UpdateCheckpoints(out,static_cast<unsigned int>(m_ZStream.next_out-out));
+  return iMessage;
+}
+
+void CZipFile::UpdateCheckpoints(const unsigned char* out, unsigned int size)
+{
+  // only the data right before the next checkpoint needs to be kept
+  int64_t iTotal = m_ZStream.total_out;
+  if (iTotal + (int64_t)sizeof(m_window) < m_iNextCheckpoint)
+    return;
+
+  if (size >= sizeof(m_window))
+  {
+    memcpy(m_window,out+size-sizeof(m_window),sizeof(m_window));
+    m_iWindowPos = 0;
+    m_iWindowFill = sizeof(m_window);
+  }
+  else
+  {
+    unsigned int iPart = std::min(size,(unsigned int)sizeof(m_window)-m_iWindowPos);
+    memcpy(m_window+m_iWindowPos,out,iPart);
+    memcpy(m_window,out+iPart,size-iPart);
+    m_iWindowPos = (m_iWindowPos+size) % sizeof(m_window);
+    m_iWindowFill = std::min(m_iWindowFill+size,(unsigned int)sizeof(m_window));
+  }
+
+  // checkpoints are taken at the end of a block that isn't the last one,
+  // with the full window (or everything when the entry starts within it)
+  if (iTotal < m_iNextCheckpoint || !(m_ZStream.data_type & 128) || (m_ZStream.data_type & 64))
+    return;
+  if (m_iWindowFill < sizeof(m_window) && m_iWindowFill < iTotal)
+    return;
+
+  SZipCheckpoint checkpoint;
+  checkpoint.out = iTotal;
+  checkpoint.in = m_iZipFilePos-m_ZStream.avail_in;
+  checkpoint.bits = m_ZStream.data_type & 7;
+  checkpoint.window.resize(m_iWindowFill);
+  unsigned int iStart = (m_iWindowPos+sizeof(m_window)-m_iWindowFill) % sizeof(m_window);
+  unsigned int iPart = std::min(m_iWindowFill,(unsigned int)sizeof(m_window)-iStart);
+  memcpy(&checkpoint.window[0],m_window+iStart,iPart);
+  memcpy(&checkpoint.window[0]+iPart,m_window,m_iWindowFill-iPart);
+  m_checkpoints->Add(checkpoint);
+
+  m_iNextCheckpoint = iTotal+ZIP_CHECKPOINT_INTERVAL;
+  m_iWindowPos = 0;
+  m_iWindowFill = 0;
+}
+
+bool CZipFile::RestoreCheckpoint(const SZipCheckpoint& checkpoint)
+{
+  inflateEnd(&m_ZStream);
+  if (inflateInit2(&m_ZStream,-MAX_WBITS) != Z_OK)
+  {
+    CLog::Log(LOGERROR,"FileZip: error initializing zlib!");
+    return false;
+  }
+  m_bFlush = false;
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
+
+  // a block may start in the middle of a byte
+  m_iZipFilePos = checkpoint.in-(checkpoint.bits ? 1 : 0);
+  if (mFile.Seek(mZipItem.offset+m_iZipFilePos,SEEK_SET) < 0)
+    return false;
+  if (checkpoint.bits)
+  {
+    unsigned char c;
+    if (mFile.Read(&c,1) != 1)
+      return false;
+    m_iZipFilePos++;
+    inflatePrime(&m_ZStream,checkpoint.bits,c >> (8-checkpoint.bits));
+  }
+  if (!checkpoint.window.empty())
+    inflateSetDictionary(&m_ZStream,&checkpoint.window[0],checkpoint.window.size());
+
+  m_ZStream.total_out = static_cast<uLong>(checkpoint.out);
+  m_iFilePos = checkpoint.out;
+  m_iNextCheckpoint = checkpoint.out+ZIP_CHECKPOINT_INTERVAL;
+  m_iWindowPos = 0;
+  m_iWindowFill = 0;
+  return true;
+}
+
 void CZipFile::DestroyBuffer(void* lpBuffer, int iBufSize)
 {
   if (!m_bFlush)
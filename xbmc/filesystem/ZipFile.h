@@ -50,6 +50,9 @@ namespace XFILE
     bool InitDecompress();
     bool FillBuffer();
     void DestroyBuffer(void* lpBuffer, int iBufSize);
+    int Inflate();
+    void UpdateCheckpoints(const unsigned char* out, unsigned int size);
+    bool RestoreCheckpoint(const SZipCheckpoint& checkpoint);
     CFile mFile;
     SZipEntry mZipItem;
     int64_t m_iFilePos; // position in _uncompressed_ data read
@@ -62,7 +65,12 @@ namespace XFILE
     int m_iDataInStringBuffer;
     int m_iRead;
     bool m_bFlush;
-    bool m_bCached;
+    boost::shared_ptr<CZipCheckpoints> m_checkpoints;
+    CStdString m_strCheckpoints; // entry to index from the first seek, empty if it is never indexed
+    int64_t m_iNextCheckpoint; // position from which a new checkpoint is wanted
+    unsigned char m_window[32768]; // the last 32k of uncompressed data, circular
+    unsigned int m_iWindowPos;
+    unsigned int m_iWindowFill;
   };
 }
 
@@ -27,6 +27,7 @@
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
 #include "SpecialProtocol.h"
+#include "threads/SingleLock.h"
 
 
 #ifndef min
@@ -38,6 +39,7 @@ using namespace std;
 
 CZipManager::CZipManager()
 {
+  mCheckpointUse = 0;
 }
 
 CZipManager::~CZipManager()
@@ -73,6 +75,8 @@ bool CZipManager::GetZipList(const CStdString& strPath, vector<SZipEntry>& items
       }
       mZipMap.erase(it);
       mZipDate.erase(it2);
+      CSingleLock lock(mCheckpointLock);
+      mZipCheckpoints.erase(strFile);
   }
 
   CFile mFile;
@@ -324,6 +328,71 @@ void CZipManager::release(const CStdString& strPath)
     mZipMap.erase(it);
     mZipDate.erase(it2);
   }
+  CSingleLock lock(mCheckpointLock);
+  mZipCheckpoints.erase(url.GetHostName());
+}
+
+boost::shared_ptr<CZipCheckpoints> CZipManager::GetCheckpoints(const CStdString& strPath)
+{
+  CURL url(strPath);
+  CSingleLock lock(mCheckpointLock);
+  boost::shared_ptr<CZipCheckpoints> checkpoints = mZipCheckpoints[url.GetHostName()][url.GetFileName()];
+  if (!checkpoints)
+  {
+    checkpoints.reset(new CZipCheckpoints);
+    mZipCheckpoints[url.GetHostName()][url.GetFileName()] = checkpoints;
+    checkpoints->mLastUse = ++mCheckpointUse;
+    ExpireCheckpoints();
+  }
+  else
+    checkpoints->mLastUse = ++mCheckpointUse;
+  return checkpoints;
+}
+
+void CZipManager::ExpireCheckpoints()
+{
+  // each checkpoint holds up to 32k of window, so only keep the most recently
+  // used entries. Files still reading an expired entry keep their reference.
+  while (true)
+  {
+    unsigned int iCount = 0;
+    map<CStdString,map<CStdString,boost::shared_ptr<CZipCheckpoints> > >::iterator oldestZip = mZipCheckpoints.end();
+    map<CStdString,boost::shared_ptr<CZipCheckpoints> >::iterator oldest;
+    for (map<CStdString,map<CStdString,boost::shared_ptr<CZipCheckpoints> > >::iterator it = mZipCheckpoints.begin(); it != mZipCheckpoints.end(); ++it)
+    {
+      for (map<CStdString,boost::shared_ptr<CZipCheckpoints> >::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+      {
+        iCount++;
+        if (oldestZip == mZipCheckpoints.end() || it2->second->mLastUse < oldest->second->mLastUse)
+        {
+          oldestZip = it;
+          oldest = it2;
+        }
+      }
+    }
+    if (iCount <= ZIP_CHECKPOINT_ENTRIES)
+      return;
+
+    oldestZip->second.erase(oldest);
+    if (oldestZip->second.empty())
+      mZipCheckpoints.erase(oldestZip);
+  }
+}
+
+bool CZipCheckpoints::Get(int64_t position, SZipCheckpoint& checkpoint) const
+{
+  CSingleLock lock(mLock);
+  map<int64_t,SZipCheckpoint>::const_iterator it = mCheckpoints.upper_bound(position);
+  if (it == mCheckpoints.begin())
+    return false;
+  checkpoint = (--it)->second;
+  return true;
+}
+
+void CZipCheckpoints::Add(const SZipCheckpoint& checkpoint)
+{
+  CSingleLock lock(mLock);
+  mCheckpoints.insert(make_pair(checkpoint.out,checkpoint));
 }
 
 
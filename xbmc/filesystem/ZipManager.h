@@ -28,12 +28,15 @@
 #define LHDR_SIZE 30
 #define CHDR_SIZE 46
 #define ECDREC_SIZE 22
+#define ZIP_CHECKPOINT_ENTRIES 16 // number of deflated entries whose checkpoints are kept
 
 #include  "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 #include <memory.h>
 #include <vector>
 #include <map>
+#include <boost/shared_ptr.hpp>
 
 struct SZipEntry {
   unsigned int header;
@@ -94,6 +97,37 @@ struct SZipEntry {
   }
 };
 
+// A point in a deflate stream from which inflating can be restarted
+struct SZipCheckpoint
+{
+  int64_t out; // position in uncompressed data
+  int64_t in;  // position in compressed data of the first full byte of the block
+  int bits;    // number of bits of the preceding byte that belong to the block
+  std::vector<unsigned char> window; // uncompressed data preceding out, at most 32k
+
+  SZipCheckpoint()
+  {
+    out = 0;
+    in = 0;
+    bits = 0;
+  }
+};
+
+// Checkpoints of a deflated zip entry, filled in as the entry is read and
+// shared by every CZipFile opening the entry
+class CZipCheckpoints
+{
+public:
+  CZipCheckpoints() : mLastUse(0) {}
+  bool Get(int64_t position, SZipCheckpoint& checkpoint) const; // last checkpoint at or before position
+  void Add(const SZipCheckpoint& checkpoint);
+private:
+  friend class CZipManager;
+  std::map<int64_t,SZipCheckpoint> mCheckpoints;
+  mutable CCriticalSection mLock;
+  unsigned int mLastUse; // CZipManager use counter when last handed out
+};
+
 class CZipManager
 {
 public:
@@ -105,11 +139,17 @@ public:
   bool ExtractArchive(const CStdString& strArchive, const CStdString& strPath);
   void CleanUp(const CStdString& strArchive, const CStdString& strPath); // deletes extracted archive. use with care!
   void release(const CStdString& strPath); // release resources used by list zip
+  boost::shared_ptr<CZipCheckpoints> GetCheckpoints(const CStdString& strPath); // keeps the last ZIP_CHECKPOINT_ENTRIES used entries
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
   std::map<CStdString,std::vector<SZipEntry> > mZipMap;
   std::map<CStdString,int64_t> mZipDate;
+  void ExpireCheckpoints();
+
+  std::map<CStdString,std::map<CStdString,boost::shared_ptr<CZipCheckpoints> > > mZipCheckpoints;
+  unsigned int mCheckpointUse;
+  CCriticalSection mCheckpointLock;
 };
 
 extern CZipManager g_ZipManager;
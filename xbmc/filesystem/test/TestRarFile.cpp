@@ -23,6 +23,7 @@
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/NFSFile.h"
+#include "filesystem/RarManager.h"
 #include "utils/URIUtils.h"
 #include "FileItem.h"
 #include "test/TestUtils.h"
@@ -250,7 +251,7 @@ TEST(TestRarFile, StoredRAR)
   EXPECT_EQ(20, file.GetPosition());
   EXPECT_TRUE(!memcmp("About\n-----\nXBMC is ", buf, sizeof(buf) - 1));
   EXPECT_EQ(0, file.Seek(0, SEEK_SET));
-  EXPECT_EQ(-100, file.Seek(-100, SEEK_SET));
+  EXPECT_EQ(-1, file.Seek(-100, SEEK_SET));
   file.Close();
 
   /* /testsymlink -> testdir/reffile.txt */
@@ -330,7 +331,7 @@ TEST(TestRarFile, StoredRAR)
   EXPECT_EQ(20, file.GetPosition());
   EXPECT_TRUE(!memcmp("About\n-----\nXBMC is ", buf, sizeof(buf) - 1));
   EXPECT_EQ(0, file.Seek(0, SEEK_SET));
-  EXPECT_EQ(-100, file.Seek(-100, SEEK_SET));
+  EXPECT_EQ(-1, file.Seek(-100, SEEK_SET));
   file.Close();
 
   /* /testdir/testemptysubdir */
@@ -408,7 +409,7 @@ TEST(TestRarFile, StoredRAR)
   EXPECT_EQ(20, file.GetPosition());
   EXPECT_TRUE(!memcmp("About\n-----\nXBMC is ", buf, sizeof(buf) - 1));
   EXPECT_EQ(0, file.Seek(0, SEEK_SET));
-  EXPECT_EQ(-100, file.Seek(-100, SEEK_SET));
+  EXPECT_EQ(-1, file.Seek(-100, SEEK_SET));
   file.Close();
 }
 
@@ -629,4 +630,110 @@ TEST(TestRarFile, NormalRAR)
   EXPECT_EQ(-1, file.Seek(-100, SEEK_SET));
   file.Close();
 }
+
+/* pattern.txt holds the numbers 0 to 999 as "%08d\n" lines, split over three
+ * volumes at 4000 and 7000 bytes, next to small.txt in the first volume.
+ */
+static void TestVolumes(const char *firstvolume)
+{
+  XFILE::CFile file;
+  char buf[20];
+  CStdString reffile, strrarpath, strpathinrar, strcached;
+  CFileItemList itemlist;
+
+  reffile = XBMC_REF_FILE_PATH(firstvolume);
+  URIUtils::CreateArchivePath(strrarpath, "rar", reffile, "");
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(strrarpath, itemlist));
+  ASSERT_EQ(2, itemlist.Size());
+  itemlist.Sort(SortByPath, SortOrderAscending);
+  strpathinrar = itemlist[0]->GetPath();
+  ASSERT_TRUE(StringUtils::EndsWith(strpathinrar, "/pattern.txt"));
+
+  ASSERT_TRUE(file.Open(strpathinrar));
+  EXPECT_EQ(9000, file.GetLength());
+
+  std::string content;
+  unsigned int size;
+  while ((size = file.Read(buf, sizeof(buf))) > 0)
+    content.append(buf, size);
+  ASSERT_EQ(9000U, content.size());
+  for (int i = 0; i < 1000; i++)
+    EXPECT_EQ(StringUtils::Format("%08d\n", i), content.substr(i * 9, 9));
+
+  /* seeks within and across the volumes, in both directions */
+  const int64_t positions[] = { 3995, 9, 6998, 4000, 8991, 0, 3999, 7000 };
+  for (unsigned int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    EXPECT_EQ(positions[i], file.Seek(positions[i]));
+    EXPECT_EQ(9U, file.Read(buf, 9));
+    EXPECT_EQ(positions[i] + 9, file.GetPosition());
+    EXPECT_EQ(content.substr(positions[i], 9), std::string(buf, 9));
+  }
+  EXPECT_EQ(8980, file.Seek(-20, SEEK_END));
+  EXPECT_EQ(4980, file.Seek(-4000, SEEK_CUR));
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_EQ(content.substr(4980, sizeof(buf)), std::string(buf, sizeof(buf)));
+  EXPECT_EQ(-1, file.Seek(9001));
+  EXPECT_EQ(5000, file.GetPosition());
+  file.Close();
+
+  /* stored files are read from the volumes, nothing is extracted */
+  EXPECT_FALSE(g_RarManager.GetPathInCache(strcached, reffile, "pattern.txt"));
+
+  strpathinrar = itemlist[1]->GetPath();
+  ASSERT_TRUE(StringUtils::EndsWith(strpathinrar, "/small.txt"));
+  ASSERT_TRUE(file.Open(strpathinrar));
+  EXPECT_EQ(24, file.GetLength());
+  EXPECT_EQ(24U, file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(!memcmp("This file is not split.\n", buf, 24));
+  file.Close();
+}
+
+TEST(TestRarFile, StoredVolumes)
+{
+  TestVolumes("xbmc/filesystem/test/refRARvolumes.part1.rar");
+}
+
+TEST(TestRarFile, StoredVolumesOldNaming)
+{
+  TestVolumes("xbmc/filesystem/test/refRARvolumesold.rar");
+}
+
+TEST(TestRarFile, NormalRARSeek)
+{
+  XFILE::CFile file, reffile;
+  char buf[32], refbuf[32];
+  CStdString refrar, strrarpath, strpathinrar, strcached;
+  CFileItemList itemlist;
+
+  ASSERT_TRUE(reffile.Open(XBMC_REF_FILE_PATH("xbmc/filesystem/test/reffile.txt")));
+  refrar = XBMC_REF_FILE_PATH("xbmc/filesystem/test/refRARnormal.rar");
+  URIUtils::CreateArchivePath(strrarpath, "rar", refrar, "");
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(strrarpath, itemlist));
+  itemlist.Sort(SortByPath, SortOrderAscending);
+  strpathinrar = itemlist[1]->GetPath();
+  ASSERT_TRUE(StringUtils::EndsWith(strpathinrar, "/reffile.txt"));
+
+  /* compressed files are unpacked while reading, backward seeks unpack again */
+  ASSERT_TRUE(file.Open(strpathinrar));
+  ASSERT_EQ(reffile.GetLength(), file.GetLength());
+  const int64_t positions[] = { 1500, 10, 800, 799, 0, 1600, 1584, 400 };
+  for (unsigned int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    EXPECT_EQ(positions[i], file.Seek(positions[i]));
+    EXPECT_EQ(positions[i], reffile.Seek(positions[i]));
+    unsigned int size = reffile.Read(refbuf, sizeof(refbuf));
+    EXPECT_EQ(size, file.Read(buf, sizeof(buf)));
+    EXPECT_EQ(reffile.GetPosition(), file.GetPosition());
+    EXPECT_TRUE(!memcmp(refbuf, buf, size));
+  }
+  EXPECT_EQ(reffile.GetLength(), file.Seek(0, SEEK_END));
+  EXPECT_EQ(0U, file.Read(buf, sizeof(buf)));
+  EXPECT_EQ(12, file.Seek(12));
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(!memcmp("XBMC is an award-winning free an", buf, sizeof(buf)));
+
+  EXPECT_FALSE(g_RarManager.GetPathInCache(strcached, refrar, "reffile.txt"));
+  file.Close();
+}
 #endif /*HAS_FILESYSTEM_RAR*/
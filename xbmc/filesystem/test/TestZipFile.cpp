@@ -20,13 +20,16 @@
 
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
+#include "filesystem/ZipManager.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "FileItem.h"
 #include "settings/Settings.h"
 #include "test/TestUtils.h"
+#include "utils/Stopwatch.h"
 
 #include <errno.h>
+#include <zlib.h>
 
 #include "gtest/gtest.h"
 
@@ -213,3 +216,235 @@ TEST_F(TestZipFile, CorruptedFile)
   file->Close();
   XBMC_DELETETEMPFILE(file);
 }
+
+static void AppendLE(std::string& str, unsigned int value, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    str += (char)((value >> (8 * i)) & 0xff);
+}
+
+/* Creates a zip with a single deflated entry "seek.txt" holding 6MB of text,
+ * large enough to be seeked in from several checkpoints.
+ */
+static XFILE::CFile *CreateSeekZip(std::string& content)
+{
+  content.clear();
+  unsigned int seed = 1;
+  const char *words[] = { "xbmc", "zip", "seek", "inflate", "window", "block", "media", "subtitle" };
+  while (content.size() < 6 * 1024 * 1024)
+  {
+    seed = seed * 1103515245 + 12345;
+    content += StringUtils::Format("%08u %s %s %u\n", (unsigned int)content.size(),
+                                   words[(seed >> 16) & 7], words[(seed >> 20) & 7], seed % 1000);
+  }
+  content.resize(6 * 1024 * 1024);
+
+  std::string data(compressBound(content.size()), '\0');
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return NULL;
+  stream.next_in = (Bytef*)content.data();
+  stream.avail_in = content.size();
+  stream.next_out = (Bytef*)&data[0];
+  stream.avail_out = data.size();
+  int result = deflate(&stream, Z_FINISH);
+  data.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END)
+    return NULL;
+
+  unsigned int crc = crc32(0, (const Bytef*)content.data(), content.size());
+  std::string name = "seek.txt", zip;
+  AppendLE(zip, 0x04034b50, 4); // local header
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 8, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0x21, 2);
+  AppendLE(zip, crc, 4);
+  AppendLE(zip, data.size(), 4);
+  AppendLE(zip, content.size(), 4);
+  AppendLE(zip, name.size(), 2);
+  AppendLE(zip, 0, 2);
+  zip += name + data;
+  unsigned int central = zip.size();
+  AppendLE(zip, 0x02014b50, 4); // central header
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 8, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0x21, 2);
+  AppendLE(zip, crc, 4);
+  AppendLE(zip, data.size(), 4);
+  AppendLE(zip, content.size(), 4);
+  AppendLE(zip, name.size(), 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 4);
+  AppendLE(zip, 0, 4);
+  zip += name;
+  unsigned int centralSize = zip.size() - central;
+  AppendLE(zip, 0x06054b50, 4); // end of central directory
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 1, 2);
+  AppendLE(zip, 1, 2);
+  AppendLE(zip, centralSize, 4);
+  AppendLE(zip, central, 4);
+  AppendLE(zip, 0, 2);
+
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".zip");
+  if (file && file->Write(zip.data(), zip.size()) != (int)zip.size())
+  {
+    XBMC_DELETETEMPFILE(file);
+    return NULL;
+  }
+  if (file)
+    file->Close();
+  return file;
+}
+
+TEST_F(TestZipFile, RandomSeek)
+{
+  std::string content;
+  XFILE::CFile *zip;
+  ASSERT_TRUE((zip = CreateSeekZip(content)) != NULL);
+  CStdString strpathinzip;
+  URIUtils::CreateArchivePath(strpathinzip, "zip", XBMC_TEMPFILEPATH(zip), "seek.txt");
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(strpathinzip));
+  ASSERT_EQ((int64_t)content.size(), file.GetLength());
+
+  char buf[4096];
+  unsigned int seed = 7;
+  for (int i = 0; i < 200; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    int64_t position = seed % (content.size() - sizeof(buf));
+    ASSERT_EQ(position, file.Seek(position)) << "seek " << i;
+    ASSERT_EQ(sizeof(buf), file.Read(buf, sizeof(buf))) << "seek " << i;
+    ASSERT_TRUE(!memcmp(content.data() + position, buf, sizeof(buf))) << "seek " << i << " to " << position;
+  }
+
+  // relative seeks go through the same checkpoints
+  EXPECT_EQ(1000, file.Seek(1000, SEEK_SET));
+  EXPECT_EQ(3000000, file.Seek(2999000, SEEK_CUR));
+  EXPECT_EQ(2000000, file.Seek(-1000000, SEEK_CUR));
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(!memcmp(content.data() + 2000000, buf, sizeof(buf)));
+  EXPECT_EQ((int64_t)content.size() - 10, file.Seek(-10, SEEK_END));
+  EXPECT_EQ(10U, file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(!memcmp(content.data() + content.size() - 10, buf, 10));
+  EXPECT_EQ(-1, file.Seek(1, SEEK_END));
+  file.Close();
+
+  XBMC_DELETETEMPFILE(zip);
+}
+
+TEST_F(TestZipFile, SeekTiming)
+{
+  std::string content;
+  XFILE::CFile *zip;
+  ASSERT_TRUE((zip = CreateSeekZip(content)) != NULL);
+  CStdString strpathinzip;
+  URIUtils::CreateArchivePath(strpathinzip, "zip", XBMC_TEMPFILEPATH(zip), "seek.txt");
+
+  char buf[4096];
+  CStopWatch watch;
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(strpathinzip));
+
+  // the first seek to the end inflates the whole entry, leaving checkpoints behind
+  watch.StartZero();
+  int64_t end = content.size() - sizeof(buf);
+  ASSERT_EQ(end, file.Seek(end));
+  float first = watch.GetElapsedMilliseconds();
+
+  // seeking back to just before the end only inflates from the last checkpoint
+  static const int seeks = 20;
+  watch.StartZero();
+  for (int i = 0; i < seeks; i++)
+  {
+    ASSERT_EQ(end - i, file.Seek(end - i));
+    ASSERT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+    ASSERT_TRUE(!memcmp(content.data() + end - i, buf, sizeof(buf)));
+  }
+  float backward = watch.GetElapsedMilliseconds() / seeks;
+  file.Close();
+
+  // the checkpoints are kept for the next time the entry is opened
+  ASSERT_TRUE(file.Open(strpathinzip));
+  watch.StartZero();
+  ASSERT_EQ(end, file.Seek(end));
+  float reopened = watch.GetElapsedMilliseconds();
+  ASSERT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(!memcmp(content.data() + end, buf, sizeof(buf)));
+  file.Close();
+
+  RecordProperty("FirstSeekUs", (int)(first * 1000));
+  RecordProperty("BackwardSeekUs", (int)(backward * 1000));
+  RecordProperty("ReopenedSeekUs", (int)(reopened * 1000));
+
+  XBMC_DELETETEMPFILE(zip);
+}
+
+TEST_F(TestZipFile, CheckpointsOnSeek)
+{
+  std::string content;
+  XFILE::CFile *zip;
+  ASSERT_TRUE((zip = CreateSeekZip(content)) != NULL);
+  CStdString strpathinzip;
+  URIUtils::CreateArchivePath(strpathinzip, "zip", XBMC_TEMPFILEPATH(zip), "seek.txt");
+
+  // reading the entry once doesn't index it
+  char buf[131072];
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(strpathinzip));
+  while (file.Read(buf, sizeof(buf)) > 0);
+  file.Close();
+
+  SZipCheckpoint checkpoint;
+  EXPECT_FALSE(g_ZipManager.GetCheckpoints(strpathinzip)->Get(content.size(), checkpoint));
+
+  // seeking does
+  ASSERT_TRUE(file.Open(strpathinzip));
+  ASSERT_EQ((int64_t)content.size() - 1, file.Seek(-1, SEEK_END));
+  file.Close();
+  EXPECT_TRUE(g_ZipManager.GetCheckpoints(strpathinzip)->Get(content.size(), checkpoint));
+  g_ZipManager.release(strpathinzip);
+
+  // so does seeking in an entry opened without caching
+  ASSERT_TRUE(file.Open(strpathinzip + "?cache=no"));
+  ASSERT_EQ((int64_t)content.size() - 1, file.Seek(-1, SEEK_END));
+  EXPECT_EQ(1U, file.Read(buf, sizeof(buf)));
+  EXPECT_EQ(content[content.size() - 1], buf[0]);
+  file.Close();
+  EXPECT_TRUE(g_ZipManager.GetCheckpoints(strpathinzip)->Get(content.size(), checkpoint));
+
+  g_ZipManager.release(strpathinzip);
+  XBMC_DELETETEMPFILE(zip);
+}
+
+TEST_F(TestZipFile, CheckpointsExpire)
+{
+  CStdString strzip = "special://temp/checkpoints.zip";
+  CStdString strpathinzip;
+  URIUtils::CreateArchivePath(strpathinzip, "zip", strzip, "first.txt");
+  boost::shared_ptr<CZipCheckpoints> first = g_ZipManager.GetCheckpoints(strpathinzip);
+  EXPECT_EQ(first, g_ZipManager.GetCheckpoints(strpathinzip));
+
+  // only the most recently used entries keep their checkpoints
+  for (int i = 0; i < ZIP_CHECKPOINT_ENTRIES; i++)
+  {
+    CStdString strother;
+    URIUtils::CreateArchivePath(strother, "zip", strzip, StringUtils::Format("entry%i.txt", i));
+    g_ZipManager.GetCheckpoints(strother);
+  }
+  EXPECT_NE(first, g_ZipManager.GetCheckpoints(strpathinzip));
+
+  g_ZipManager.release(strpathinzip);
+}
@@ -23,9 +23,18 @@
 #include "libsquish/squish.h"
 #include "utils/log.h"
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #ifndef NO_XBMC_FILESYSTEM
 #include "filesystem/File.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include <boost/shared_ptr.hpp>
 using namespace XFILE;
 #else
 #include "SimpleFS.h"
@@ -33,6 +42,196 @@ using namespace XFILE;
 
 using namespace std;
 
+namespace
+{
+  // height of the bands the image is split into for compression, a multiple of the 4 pixel block size
+  const unsigned int band_height = 32;
+
+  // number of 4 pixel block rows sampled to pick the format of large images
+  const unsigned int sample_block_rows = 32;
+
+  int GetSquishFlags(unsigned int format)
+  {
+    switch (format)
+    {
+    case XB_FMT_DXT3:
+      return squish::kDxt3 | squish::kSourceBGRA;
+    case XB_FMT_DXT5:
+      return squish::kDxt5 | squish::kSourceBGRA;
+    case XB_FMT_DXT1:
+    default:
+      return squish::kDxt1 | squish::kSourceBGRA;
+    }
+  }
+
+  /*! \brief Compress the given band of an image into its place in the output.
+   Bands start on block rows and blocks are compressed independently of each
+   other, so the result is identical to compressing the whole image at once.
+   */
+  void CompressBand(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch,
+                    unsigned char *dxt, int flags, unsigned int band)
+  {
+    unsigned int top = band * band_height;
+    unsigned int bytesPerBlock = (flags & squish::kDxt1) ? 8 : 16;
+    squish::CompressImage(brga + top * pitch, width, min(band_height, height - top), pitch,
+                          dxt + (top / 4) * ((width + 3) / 4) * bytesPerBlock, flags);
+  }
+
+#ifndef NO_XBMC_FILESYSTEM
+  /*! \brief Bands of an image shared between the compressing thread and its helper jobs.
+   Whoever is free takes the next band. The compressing thread takes bands as
+   well, so the image is done even if no worker is available for the helpers.
+   */
+  class CBandCompressor
+  {
+  public:
+    CBandCompressor(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *dxt, int flags)
+      : m_brga(brga), m_width(width), m_height(height), m_pitch(pitch), m_dxt(dxt), m_flags(flags),
+        m_bands((height + band_height - 1) / band_height), m_nextBand(0), m_doneBands(0)
+    {
+    }
+
+    /*! \brief Compress bands until there are none left.
+     */
+    void Help()
+    {
+      while (true)
+      {
+        unsigned int band;
+        {
+          CSingleLock lock(m_section);
+          if (m_nextBand == m_bands)
+            return;
+          band = m_nextBand++;
+        }
+        CompressBand(m_brga, m_width, m_height, m_pitch, m_dxt, m_flags, band);
+
+        CSingleLock lock(m_section);
+        if (++m_doneBands == m_bands)
+          m_done.Set();
+      }
+    }
+
+    /*! \brief Compress bands until there are none left and wait for the helpers to finish theirs.
+     */
+    void Run()
+    {
+      Help();
+      m_done.Wait();
+    }
+
+    unsigned int GetBands() const { return m_bands; }
+
+  private:
+    unsigned char const *m_brga;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_pitch;
+    unsigned char *m_dxt;
+    int m_flags;
+    unsigned int m_bands;
+    unsigned int m_nextBand;
+    unsigned int m_doneBands;
+    CCriticalSection m_section;
+    CEvent m_done;
+  };
+
+  class CBandCompressJob : public CJob
+  {
+  public:
+    CBandCompressJob(const boost::shared_ptr<CBandCompressor> &compressor) : m_compressor(compressor) {}
+
+    virtual const char *GetType() const { return "ddsband"; }
+    virtual bool DoWork()
+    {
+      m_compressor->Help();
+      return true;
+    }
+
+  private:
+    // helpers may only get to run after the image is done, so they share ownership of the bands
+    boost::shared_ptr<CBandCompressor> m_compressor;
+  };
+#endif
+
+  /*! \brief Compress an image, spreading its bands over the job manager's workers.
+   */
+  void CompressImage(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch,
+                     unsigned char *dxt, int flags)
+  {
+#ifndef NO_XBMC_FILESYSTEM
+    boost::shared_ptr<CBandCompressor> compressor(new CBandCompressor(brga, width, height, pitch, dxt, flags));
+    unsigned int threads = min(compressor->GetBands(), (unsigned int)max(g_cpuInfo.getCPUCount(), 1));
+    if (threads > 1)
+    {
+      vector<unsigned int> jobs;
+      for (unsigned int i = 1; i < threads; i++)
+        jobs.push_back(CJobManager::GetInstance().AddJob(new CBandCompressJob(compressor), NULL));
+      compressor->Run();
+
+      // drop the helpers that didn't get a worker in time
+      for (vector<unsigned int>::const_iterator i = jobs.begin(); i != jobs.end(); ++i)
+        CJobManager::GetInstance().CancelJob(*i);
+      return;
+    }
+#endif
+    squish::CompressImage(brga, width, height, pitch, dxt, flags);
+  }
+
+  /*! \brief Representative part of an image to estimate the error of the DXT formats on.
+   Small images are sampled completely, so the estimate is exact and the
+   compressed sample is the compressed image. Large images are sampled by
+   evenly spaced block rows.
+   */
+  class CCompressionSample
+  {
+  public:
+    CCompressionSample(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch)
+      : m_brga(brga), m_width(width), m_height(height), m_pitch(pitch)
+    {
+      unsigned int blockRows = height / 4;
+      if (blockRows > sample_block_rows)
+      {
+        unsigned int step = blockRows / sample_block_rows;
+        m_pitch = width * 4;
+        m_height = sample_block_rows * 4;
+        m_buffer.resize(m_height * m_pitch);
+        for (unsigned int row = 0; row < sample_block_rows; row++)
+        {
+          for (unsigned int y = 0; y < 4; y++)
+            memcpy(&m_buffer[(row * 4 + y) * m_pitch], brga + (row * step * 4 + y) * pitch, m_pitch);
+        }
+        m_brga = &m_buffer[0];
+      }
+    }
+
+    /*! \brief Whether the sample is the whole image.
+     */
+    bool IsComplete() const { return m_buffer.empty(); }
+
+    /*! \brief Compress the sample into the given format and compute the error.
+     \return the compressed sample
+     */
+    unsigned char const *Compress(unsigned int format, double &colorMSE, double &alphaMSE)
+    {
+      int flags = GetSquishFlags(format);
+      vector<unsigned char> &dxt = m_dxt[format];
+      dxt.resize(squish::GetStorageRequirements(m_width, m_height, flags));
+      CompressImage(m_brga, m_width, m_height, m_pitch, &dxt[0], flags);
+      squish::ComputeMSE(m_brga, m_width, m_height, m_pitch, &dxt[0], flags, colorMSE, alphaMSE);
+      return &dxt[0];
+    }
+
+  private:
+    unsigned char const *m_brga;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_pitch;
+    vector<unsigned char> m_buffer;
+    map<unsigned int, vector<unsigned char> > m_dxt;
+  };
+}
+
 CDDSImage::CDDSImage()
 {
   m_data = NULL;
@@ -163,60 +362,51 @@ unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int
 
 bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
 {
-  // first try DXT1, which is only 4bits/pixel
-  Allocate(width, height, XB_FMT_DXT1);
-
-  squish::CompressImage(brga, width, height, pitch, m_data, squish::kDxt1 | squish::kSourceBGRA);
-  const char *fourCC = NULL;
+  // pick the format on a sample of the image, so that the image is compressed only once
+  CCompressionSample sample(brga, width, height, pitch);
+  unsigned char const *dxt = NULL;
+  unsigned int format = 0;
+  double colorMSE = 0, alphaMSE = 0;
 
-  double colorMSE, alphaMSE;
-  squish::ComputeMSE(brga, width, height, pitch, m_data, squish::kDxt1 | squish::kSourceBGRA, colorMSE, alphaMSE);
-  if (!maxMSE || (colorMSE < maxMSE && alphaMSE < maxMSE))
-    fourCC = "DXT1";
+  // first try DXT1, which is only 4bits/pixel
+  if (!maxMSE)
+    format = XB_FMT_DXT1;
   else
   {
-    if (alphaMSE == 0)
-    { // no alpha channel, so DXT5YCoCg is going to be the best DXT5 format
-      /*        squish::CompressImage(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA);
-       squish::ComputeMSE(brga, width, height, pitch, m_data, squish::kDxt5 | squish::kSourceBGRA, colorMSE, alphaMSE);
-       if (colorMSE < maxMSE && alphaMSE < maxMSE)
-       { // success - use it
-       compressedSize = squish::GetStorageRequirements(width, height, squish::kDxt5);
-       format = XB_FMT_DXT5_YCoCg;
-       }
-       */
-    }
-    if (alphaMSE > 0)
+    dxt = sample.Compress(XB_FMT_DXT1, colorMSE, alphaMSE);
+    if (colorMSE < maxMSE && alphaMSE < maxMSE)
+      format = XB_FMT_DXT1;
+    else if (alphaMSE > 0)
     { // try DXT3 and DXT5 - use whichever is better (color is the same as DXT1, but alpha will be different)
-      Allocate(width, height, XB_FMT_DXT3);
-      squish::CompressImage(brga, width, height, pitch, m_data, squish::kDxt3 | squish::kSourceBGRA);
-      squish::ComputeMSE(brga, width, height, pitch, m_data, squish::kDxt3 | squish::kSourceBGRA, colorMSE, alphaMSE);
+      dxt = sample.Compress(XB_FMT_DXT3, colorMSE, alphaMSE);
       if (colorMSE < maxMSE)
       { // color is fine, test DXT5 as well
         double dxt5MSE;
-        unsigned char *data2 = new unsigned char[GetStorageRequirements(width, height, XB_FMT_DXT5)];
-        squish::CompressImage(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA);
-        squish::ComputeMSE(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA, colorMSE, dxt5MSE);
-        if (alphaMSE < maxMSE && alphaMSE < dxt5MSE)
-          fourCC = "DXT3";
-        else if (dxt5MSE < maxMSE)
+        if (alphaMSE < maxMSE)
+          format = XB_FMT_DXT3;
+        unsigned char const *dxt5 = sample.Compress(XB_FMT_DXT5, colorMSE, dxt5MSE);
+        if (dxt5MSE < maxMSE && dxt5MSE <= alphaMSE)
         { // DXT5 passes
-          fourCC = "DXT5";
-          std::swap(m_data, data2);
+          format = XB_FMT_DXT5;
+          dxt = dxt5;
           alphaMSE = dxt5MSE;
         }
-        delete[] data2;
       }
     }
   }
-  if (fourCC)
+  if (!format)
   {
-    memcpy(&m_desc.pixelFormat.fourcc, fourCC, 4);
-    CLog::Log(LOGDEBUG, "%s - using %s (min error is: %2.2f:%2.2f)", __FUNCTION__, fourCC, colorMSE, alphaMSE);
-    return true;
+    CLog::Log(LOGDEBUG, "%s - no format suitable (min error is: %2.2f:%2.2f)", __FUNCTION__, colorMSE, alphaMSE);
+    return false;
   }
-  CLog::Log(LOGDEBUG, "%s - no format suitable (min error is: %2.2f:%2.2f)", __FUNCTION__, colorMSE, alphaMSE);
-  return false;
+
+  Allocate(width, height, format);
+  if (dxt && sample.IsComplete())
+    memcpy(m_data, dxt, m_desc.linearSize);
+  else
+    CompressImage(brga, width, height, pitch, m_data, GetSquishFlags(format));
+  CLog::Log(LOGDEBUG, "%s - using %s (min error is: %2.2f:%2.2f)", __FUNCTION__, GetFourCC(format), colorMSE, alphaMSE);
+  return true;
 }
 
 bool CDDSImage::Decompress(unsigned char *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *dxt, unsigned int format)
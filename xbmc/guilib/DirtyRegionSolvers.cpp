@@ -21,6 +21,9 @@
 #include "DirtyRegionSolvers.h"
 #include "GraphicContext.h"
 #include <stdio.h>
+#include <algorithm>
+#include <float.h>
+#include <math.h>
 
 void CUnionDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
 {
@@ -81,3 +84,216 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+// the grid is limited to this many cells per axis so that large areas stay cheap to index
+#define SPATIAL_MAX_CELLS 32
+
+CSpatialDirtyRegionSolver::CSpatialDirtyRegionSolver(float passCost, unsigned int maxRegions)
+{
+  m_passCost   = std::max(passCost, 0.0f);
+  m_maxRegions = maxRegions;
+  // regions further apart than this are rarely worth merging
+  m_margin     = sqrtf(m_passCost);
+  m_cellSize   = 1.0f;
+  m_cols       = 0;
+  m_rows       = 0;
+  m_stamp      = 0;
+}
+
+float CSpatialDirtyRegionSolver::MergeCost(const CRect &a, const CRect &b) const
+{
+  // separately the overlap is filled twice and we pay for an extra pass
+  CRect merged(a);
+  merged.Union(b);
+  return merged.Area() - a.Area() - b.Area() - m_passCost;
+}
+
+void CSpatialDirtyRegionSolver::InitGrid(const CRect &bounds)
+{
+  m_bounds   = bounds;
+  // with cells twice the margin most lookups only touch a few cells
+  m_cellSize = std::max(std::max(bounds.Width(), bounds.Height()) / SPATIAL_MAX_CELLS, std::max(m_margin * 2, 1.0f));
+  m_cols     = std::min((int)(bounds.Width() / m_cellSize) + 1, SPATIAL_MAX_CELLS);
+  m_rows     = std::min((int)(bounds.Height() / m_cellSize) + 1, SPATIAL_MAX_CELLS);
+
+  m_grid.resize(m_cols * m_rows);
+  for (unsigned int i = 0; i < m_grid.size(); i++)
+    m_grid[i].clear();
+
+  m_regions.clear();
+  m_merged.clear();
+  m_visited.clear();
+  m_stamp = 0;
+}
+
+void CSpatialDirtyRegionSolver::GetCells(const CRect &rect, int &col1, int &row1, int &col2, int &row2) const
+{
+  col1 = std::max((int)((rect.x1 - m_bounds.x1) / m_cellSize), 0);
+  row1 = std::max((int)((rect.y1 - m_bounds.y1) / m_cellSize), 0);
+  col2 = std::min((int)((rect.x2 - m_bounds.x1) / m_cellSize), m_cols - 1);
+  row2 = std::min((int)((rect.y2 - m_bounds.y1) / m_cellSize), m_rows - 1);
+}
+
+void CSpatialDirtyRegionSolver::Insert(unsigned int region)
+{
+  int col1, row1, col2, row2;
+  GetCells(m_regions[region], col1, row1, col2, row2);
+  for (int row = row1; row <= row2; row++)
+  {
+    for (int col = col1; col <= col2; col++)
+      m_grid[row * m_cols + col].push_back(region);
+  }
+}
+
+int CSpatialDirtyRegionSolver::FindMerge(const CRect &rect)
+{
+  CRect area(rect.x1 - m_margin, rect.y1 - m_margin, rect.x2 + m_margin, rect.y2 + m_margin);
+  int col1, row1, col2, row2;
+  GetCells(area, col1, row1, col2, row2);
+
+  int   bestRegion = -1;
+  float bestCost   = 0.0f;
+
+  m_stamp++;
+  for (int row = row1; row <= row2; row++)
+  {
+    for (int col = col1; col <= col2; col++)
+    {
+      // drop the merged regions from the cell as we go
+      std::vector<unsigned int> &cell = m_grid[row * m_cols + col];
+      unsigned int size = 0;
+      for (unsigned int i = 0; i < cell.size(); i++)
+      {
+        unsigned int region = cell[i];
+        if (m_merged[region])
+          continue;
+        cell[size++] = region;
+        if (m_visited[region] == m_stamp)
+          continue;
+        m_visited[region] = m_stamp;
+
+        float cost = MergeCost(rect, m_regions[region]);
+        if (cost < bestCost)
+        {
+          bestRegion = region;
+          bestCost   = cost;
+        }
+      }
+      cell.resize(size);
+    }
+  }
+  return bestRegion;
+}
+
+void CSpatialDirtyRegionSolver::FindPartner(const std::vector<CRect> &regions, unsigned int region,
+                                            std::vector<unsigned int> &partner, std::vector<float> &cost) const
+{
+  partner[region] = region;
+  cost[region]    = FLT_MAX;
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    if (i == region)
+      continue;
+    float mergeCost = MergeCost(regions[region], regions[i]);
+    if (mergeCost < cost[region])
+    {
+      partner[region] = i;
+      cost[region]    = mergeCost;
+    }
+  }
+}
+
+void CSpatialDirtyRegionSolver::LimitRegions(std::vector<CRect> &regions) const
+{
+  if (m_maxRegions == 0 || regions.size() <= m_maxRegions)
+    return;
+
+  // the cheapest merge for every region, kept up to date as regions are merged
+  std::vector<unsigned int> partner(regions.size());
+  std::vector<float> cost(regions.size());
+  for (unsigned int i = 0; i < regions.size(); i++)
+    FindPartner(regions, i, partner, cost);
+
+  while (regions.size() > m_maxRegions)
+  {
+    unsigned int a = 0;
+    for (unsigned int i = 1; i < regions.size(); i++)
+    {
+      if (cost[i] < cost[a])
+        a = i;
+    }
+    unsigned int b = partner[a];
+    if (b < a)
+      std::swap(a, b);
+
+    // merge b into a and move the last region into its place
+    unsigned int last = regions.size() - 1;
+    regions[a].Union(regions[b]);
+    regions[b] = regions[last];
+    partner[b] = partner[last];
+    cost[b]    = cost[last];
+    regions.pop_back();
+    partner.pop_back();
+    cost.pop_back();
+
+    for (unsigned int i = 0; i < regions.size(); i++)
+    {
+      if (i == a)
+        continue;
+      if (partner[i] == a || partner[i] == b)
+        FindPartner(regions, i, partner, cost);
+      else
+      {
+        if (partner[i] == last)
+          partner[i] = b;
+        float mergeCost = MergeCost(regions[i], regions[a]);
+        if (mergeCost < cost[i])
+        {
+          partner[i] = a;
+          cost[i]    = mergeCost;
+        }
+      }
+    }
+    FindPartner(regions, a, partner, cost);
+  }
+}
+
+void CSpatialDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  CRect bounds;
+  for (unsigned int i = 0; i < input.size(); i++)
+    bounds.Union(input[i]);
+  if (bounds.IsEmpty())
+    return;
+
+  InitGrid(bounds);
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    if (input[i].IsEmpty())
+      continue;
+
+    // a merged region may reach neighbours that weren't worth merging before
+    CRect region(input[i]);
+    for (int j = FindMerge(region); j >= 0; j = FindMerge(region))
+    {
+      m_merged[j] = true;
+      region.Union(m_regions[j]);
+    }
+
+    m_regions.push_back(region);
+    m_merged.push_back(false);
+    m_visited.push_back(0);
+    Insert(m_regions.size() - 1);
+  }
+
+  std::vector<CRect> regions;
+  for (unsigned int i = 0; i < m_regions.size(); i++)
+  {
+    if (!m_merged[i])
+      regions.push_back(m_regions[i]);
+  }
+  LimitRegions(regions);
+
+  for (unsigned int i = 0; i < regions.size(); i++)
+    output.push_back(CDirtyRegion(regions[i]));
+}
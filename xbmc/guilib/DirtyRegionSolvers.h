@@ -21,6 +21,8 @@
 
 #include "IDirtyRegionSolver.h"
 
+#include <vector>
+
 class CUnionDirtyRegionSolver : public IDirtyRegionSolver
 {
 public:
@@ -48,3 +50,45 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Merges regions whenever filling the extra pixels is cheaper than another rendering pass.
+
+ Regions are only compared with their neighbours, which are found through a
+ grid over the dirty area, so many small regions are solved in about linear
+ time. If more than maxRegions remain, the cheapest pairs are merged until the
+ limit is met.
+ */
+class CSpatialDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  /*!
+   \param passCost the cost of a rendering pass, expressed in pixels that could be filled instead
+   \param maxRegions the maximum number of regions to output, 0 for no limit
+   */
+  CSpatialDirtyRegionSolver(float passCost = 16384.0f, unsigned int maxRegions = 8);
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+private:
+  float MergeCost(const CRect &a, const CRect &b) const;
+  void InitGrid(const CRect &bounds);
+  void GetCells(const CRect &rect, int &col1, int &row1, int &col2, int &row2) const;
+  void Insert(unsigned int region);
+  int FindMerge(const CRect &rect);
+  void FindPartner(const std::vector<CRect> &regions, unsigned int region,
+                   std::vector<unsigned int> &partner, std::vector<float> &cost) const;
+  void LimitRegions(std::vector<CRect> &regions) const;
+
+  float m_passCost;
+  unsigned int m_maxRegions;
+  float m_margin;
+
+  CRect m_bounds;
+  float m_cellSize;
+  int m_cols;
+  int m_rows;
+  std::vector< std::vector<unsigned int> > m_grid;
+  std::vector<CRect> m_regions;
+  std::vector<bool> m_merged;
+  std::vector<unsigned int> m_visited;
+  unsigned int m_stamp;
+};
@@ -19,18 +19,25 @@
  */
 
 #include "DirtyRegionTracker.h"
+#include "filesystem/File.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include <stdio.h>
 
+#define TRACE_PATH        "special://temp/dirtyregions.txt"
+#define TRACE_BUFFER_SIZE 65536
+
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
   m_buffering = buffering;
   m_solver = NULL;
+  m_trace = NULL;
 }
 
 CDirtyRegionTracker::~CDirtyRegionTracker()
 {
+  CloseTrace();
   delete m_solver;
 }
 
@@ -38,8 +45,29 @@ void CDirtyRegionTracker::SelectAlgorithm()
 {
   delete m_solver;
 
+  CloseTrace();
+  if (g_advancedSettings.m_guiRecordDirtyRegions)
+  {
+    m_trace = new XFILE::CFile();
+    if (m_trace->OpenForWrite(TRACE_PATH, true))
+    {
+      CLog::Log(LOGNOTICE, "guilib: Recording dirty regions to %s", TRACE_PATH);
+      m_traceBuffer = "# dirty regions recorded by CDirtyRegionTracker, one frame per line as x1,y1,x2,y2 rectangles\n";
+    }
+    else
+    {
+      CLog::Log(LOGERROR, "guilib: Unable to record dirty regions to %s", TRACE_PATH);
+      CloseTrace();
+    }
+  }
+
   switch (g_advancedSettings.m_guiAlgorithmDirtyRegions)
   {
+    case DIRTYREGION_SOLVER_SPATIAL:
+      CLog::Log(LOGDEBUG, "guilib: Spatial cost reduction as algorithm for solving rendering passes");
+      m_solver = new CSpatialDirtyRegionSolver(g_advancedSettings.m_guiDirtyRegionPassCost,
+                                               g_advancedSettings.m_guiDirtyRegionMaxPasses);
+      break;
     case DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE:
       CLog::Log(LOGDEBUG, "guilib: Fill viewport on change for solving rendering passes");
       m_solver = new CFillViewportOnChangeRegionSolver();
@@ -75,12 +103,45 @@ CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
 {
   CDirtyRegionList output;
 
+  if (m_trace && !m_markedRegions.empty())
+    RecordRegions();
+
   if (m_solver)
     m_solver->Solve(m_markedRegions, output);
 
   return output;
 }
 
+void CDirtyRegionTracker::RecordRegions()
+{
+  for (CDirtyRegionList::const_iterator i = m_markedRegions.begin(); i != m_markedRegions.end(); ++i)
+  {
+    if (i != m_markedRegions.begin())
+      m_traceBuffer += ' ';
+    m_traceBuffer += StringUtils::Format("%g,%g,%g,%g", i->x1, i->y1, i->x2, i->y2);
+  }
+  m_traceBuffer += '\n';
+
+  if (m_traceBuffer.size() >= TRACE_BUFFER_SIZE)
+  {
+    m_trace->Write(m_traceBuffer.c_str(), m_traceBuffer.size());
+    m_traceBuffer.clear();
+  }
+}
+
+void CDirtyRegionTracker::CloseTrace()
+{
+  if (!m_trace)
+    return;
+
+  if (!m_traceBuffer.empty())
+    m_trace->Write(m_traceBuffer.c_str(), m_traceBuffer.size());
+  m_traceBuffer.clear();
+  m_trace->Close();
+  delete m_trace;
+  m_trace = NULL;
+}
+
 void CDirtyRegionTracker::CleanMarkedRegions()
 {
   int buffering = g_advancedSettings.m_guiVisualizeDirtyRegions ? 20 : m_buffering;
@@ -22,6 +22,13 @@
 #include "IDirtyRegionSolver.h"
 #include "DirtyRegionSolvers.h"
 
+#include <string>
+
+namespace XFILE
+{
+  class CFile;
+}
+
 #if defined(TARGET_DARWIN_IOS)
 #define DEFAULT_BUFFERING 4
 #else
@@ -41,7 +48,15 @@ public:
   void CleanMarkedRegions();
 
 private:
+  /*! \brief Append the regions handed to the solver as a line of the trace.
+   The trace has the format the dirty region solver tests replay.
+   */
+  void RecordRegions();
+  void CloseTrace();
+
   CDirtyRegionList m_markedRegions;
   int m_buffering;
   IDirtyRegionSolver *m_solver;
+  XFILE::CFile *m_trace;
+  std::string m_traceBuffer;
 };
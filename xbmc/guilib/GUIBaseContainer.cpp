@@ -162,7 +162,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
   {
     if (!item->GetFocusedLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_focusedLayout);
+      CGUIListItemLayout *layout = m_focusedLayoutPool.Acquire(*m_focusedLayout);
       item->SetFocusedLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -189,7 +189,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
+      CGUIListItemLayout *layout = m_layoutPool.Acquire(*m_layout);
       item->SetLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -814,6 +814,8 @@ void CGUIBaseContainer::AllocResources()
 void CGUIBaseContainer::FreeResources(bool immediately)
 {
   CGUIControl::FreeResources(immediately);
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
   if (m_listProvider)
   {
     if (immediately)
@@ -830,6 +832,8 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   { // free memory of items
     for (iItems it = m_items.begin(); it != m_items.end(); ++it)
       (*it)->FreeMemory();
+    m_layoutPool.Clear();
+    m_focusedLayoutPool.Clear();
   }
   // and recalculate the layout
   CalculateLayout();
@@ -1061,11 +1065,20 @@ void CGUIBaseContainer::Reset()
   m_wasReset = true;
   m_items.clear();
   m_lastItem.reset();
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
   ResetAutoScrolling();
 }
 
 void CGUIBaseContainer::LoadLayout(TiXmlElement *layout)
 {
+  // pooled and bound layouts are matched by the address of the layout they were
+  // copied from, and the layouts move when the vectors below grow
+  for (iItems it = m_items.begin(); it != m_items.end(); ++it)
+    (*it)->FreeMemory();
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
+
   TiXmlElement *itemElement = layout->FirstChildElement("itemlayout");
   while (itemElement)
   { // we have a new item layout
@@ -1106,20 +1119,35 @@ void CGUIBaseContainer::SetRenderOffset(const CPoint &offset)
 
 void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
 {
+  // keep at most as many free layouts as there are items in the cache window
+  int window = (keepStart < keepEnd) ? keepEnd - keepStart + 1 : (int)m_items.size() - (keepStart - keepEnd - 1);
+  m_layoutPool.SetCapacity(std::max(window, 0));
+  m_focusedLayoutPool.SetCapacity(std::max(window, 0));
+
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
     for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
   }
   else
   { // wrapping
     for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
   }
 }
 
+void CGUIBaseContainer::ReleaseLayouts(CGUIListItem *item)
+{
+  if (!item->GetLayout() && !item->GetFocusedLayout())
+    return;
+  CGUIListItemLayout *layout, *focusedLayout;
+  item->ReleaseLayouts(layout, focusedLayout);
+  m_layoutPool.Release(layout, m_layout);
+  m_focusedLayoutPool.Release(focusedLayout, m_focusedLayout);
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -128,6 +128,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void ReleaseLayouts(CGUIListItem *item);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -151,6 +152,10 @@ protected:
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
 
+  // layouts released by items that left the cache window, rebound to items scrolling into view
+  CGUIListItemLayoutPool m_layoutPool;
+  CGUIListItemLayoutPool m_focusedLayoutPool;
+
   void ScrollToOffset(int offset);
   void SetContainerMoving(int direction);
   void UpdateScrollOffset(unsigned int currentTime);
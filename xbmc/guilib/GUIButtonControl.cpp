@@ -118,7 +118,7 @@ void CGUIButtonControl::ProcessText(unsigned int currentTime)
   CRect label2RenderRect = m_label2.GetRenderRect();
 
   bool changed = m_label.SetMaxRect(m_posX, m_posY, m_width, m_height);
-  changed |= m_label.SetText(m_info.GetLabel(m_parentID));
+  changed |= m_label.SetInfoText(m_info, m_parentID);
   changed |= m_label.SetScrolling(HasFocus());
 
   // render the second label if it exists
@@ -629,6 +629,16 @@ void CGUIControl::SetInitialVisibility()
   MarkDirtyRegion();
 }
 
+void CGUIControl::ResetVisibility()
+{
+  if (m_visibleCondition)
+  {
+    m_visibleFromSkinCondition = true;
+    m_visible = VISIBLE;
+    MarkDirtyRegion();
+  }
+}
+
 void CGUIControl::SetVisibleCondition(const CStdString &expression, const CStdString &allowHiddenFocus)
 {
   if (expression == "true")
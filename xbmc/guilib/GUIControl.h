@@ -212,6 +212,11 @@ public:
   void SetEnableCondition(const CStdString &expression);
   virtual void UpdateVisibility(const CGUIListItem *item = NULL);
   virtual void SetInitialVisibility();
+  /*! \brief Return conditional visibility to the state of a newly created control.
+   Used when a control is recycled for a different list item, so visible/hidden
+   animations run as they would for a fresh copy.
+   */
+  virtual void ResetVisibility();
   virtual void SetEnabled(bool bEnable);
   virtual void SetInvalid() { m_bInvalidated = true; };
   virtual void SetPulseOnSelect(bool pulse) { m_pulseOnSelect = pulse; };
@@ -305,6 +305,13 @@ void CGUIControlGroup::SetInitialVisibility()
     (*it)->SetInitialVisibility();
 }
 
+void CGUIControlGroup::ResetVisibility()
+{
+  CGUIControl::ResetVisibility();
+  for (iControls it = m_children.begin(); it != m_children.end(); ++it)
+    (*it)->ResetVisibility();
+}
+
 void CGUIControlGroup::QueueAnimation(ANIMATION_TYPE animType)
 {
   CGUIControl::QueueAnimation(animType);
@@ -55,6 +55,7 @@ public:
   virtual void UnfocusFromPoint(const CPoint &point);
 
   virtual void SetInitialVisibility();
+  virtual void ResetVisibility();
 
   virtual bool IsAnimating(ANIMATION_TYPE anim);
   virtual bool HasAnimation(ANIMATION_TYPE anim);
@@ -27,10 +27,16 @@
 #include "GUIListItem.h"
 #include "utils/StringUtils.h"
 #include "addons/Skin.h"
+#include "threads/SingleLock.h"
+#include <boost/shared_ptr.hpp>
+#include <map>
 
 using namespace std;
 using ADDON::CAddonMgr;
 
+// bound for the number of compiled labels and markup templates cached, above which the cache starts over
+#define MAX_CACHED_LABELS 2048
+
 CGUIInfoBool::CGUIInfoBool(bool value)
 {
   m_value = value;
@@ -136,9 +142,68 @@ void CGUIInfoLabel::SetLabel(const CStdString &label, const CStdString &fallback
   Parse(label, context);
 }
 
+/*!
+ \brief Writes a label piece by piece over its previous rendering.
+ Pieces matching the previous rendering are only compared, the buffer is only
+ written from the first piece that differs.
+ */
+class CGUIInfoLabel::CLabelWriter
+{
+public:
+  CLabelWriter(std::string &label) : m_label(label), m_length(0), m_changed(false) {}
+
+  void Write(const char *text, size_t length)
+  {
+    if (!m_changed && m_label.compare(m_length, length, text, length) == 0)
+    {
+      m_length += length;
+      return;
+    }
+    m_changed = true;
+    m_label.replace(m_length, std::string::npos, text, length);
+    m_length += length;
+  }
+
+  void Write(const std::string &text) { Write(text.c_str(), text.size()); }
+
+  bool IsEmpty() const { return m_length == 0; }
+
+  /*! \brief Cuts off what is left of the previous rendering.
+   \return true if the label changed.
+   */
+  bool Finish()
+  {
+    if (m_length < m_label.size())
+    {
+      m_label.erase(m_length);
+      m_changed = true;
+    }
+    return m_changed;
+  }
+
+private:
+  std::string &m_label;
+  size_t m_length;
+  bool m_changed;
+};
+
 CStdString CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage, CStdString *fallback /*= NULL*/) const
 {
   CStdString label;
+  UpdateLabel(label, contextWindow, preferImage, fallback);
+  return label;
+}
+
+CStdString CGUIInfoLabel::GetItemLabel(const CGUIListItem *item, bool preferImages, CStdString *fallback /*= NULL*/) const
+{
+  CStdString label;
+  UpdateItemLabel(label, item, preferImages, fallback);
+  return label;
+}
+
+bool CGUIInfoLabel::UpdateLabel(CStdString &label, int contextWindow, bool preferImage, CStdString *fallback /*= NULL*/) const
+{
+  CLabelWriter writer(label);
   for (unsigned int i = 0; i < m_info.size(); i++)
   {
     const CInfoPortion &portion = m_info[i];
@@ -150,43 +215,45 @@ CStdString CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage, CStdStri
       if (infoLabel.empty())
         infoLabel = g_infoManager.GetLabel(portion.m_info, contextWindow, fallback);
       if (!infoLabel.empty())
-        label += portion.GetLabel(infoLabel);
+        WritePortion(writer, portion, infoLabel);
     }
     else
     { // no info, so just append the prefix
-      label += portion.m_prefix;
+      writer.Write(m_text.c_str() + portion.m_prefix, portion.m_prefixLength);
     }
   }
-  if (label.empty())  // empty label, use the fallback
-    return m_fallback;
-  return label;
+  if (writer.IsEmpty())  // empty label, use the fallback
+    writer.Write(m_fallback);
+  return writer.Finish();
 }
 
-CStdString CGUIInfoLabel::GetItemLabel(const CGUIListItem *item, bool preferImages, CStdString *fallback /*= NULL*/) const
+bool CGUIInfoLabel::UpdateItemLabel(CStdString &label, const CGUIListItem *item, bool preferImages, CStdString *fallback /*= NULL*/) const
 {
-  if (!item->IsFileItem()) return "";
-  CStdString label;
-  for (unsigned int i = 0; i < m_info.size(); i++)
+  CLabelWriter writer(label);
+  if (item->IsFileItem())
   {
-    const CInfoPortion &portion = m_info[i];
-    if (portion.m_info)
+    for (unsigned int i = 0; i < m_info.size(); i++)
     {
-      CStdString infoLabel;
-      if (preferImages)
-        infoLabel = g_infoManager.GetItemImage((const CFileItem *)item, portion.m_info, fallback);
+      const CInfoPortion &portion = m_info[i];
+      if (portion.m_info)
+      {
+        CStdString infoLabel;
+        if (preferImages)
+          infoLabel = g_infoManager.GetItemImage((const CFileItem *)item, portion.m_info, fallback);
+        else
+          infoLabel = g_infoManager.GetItemLabel((const CFileItem *)item, portion.m_info, fallback);
+        if (!infoLabel.empty())
+          WritePortion(writer, portion, infoLabel);
+      }
       else
-        infoLabel = g_infoManager.GetItemLabel((const CFileItem *)item, portion.m_info, fallback);
-      if (!infoLabel.empty())
-        label += portion.GetLabel(infoLabel);
-    }
-    else
-    { // no info, so just append the prefix
-      label += portion.m_prefix;
+      { // no info, so just append the prefix
+        writer.Write(m_text.c_str() + portion.m_prefix, portion.m_prefixLength);
+      }
     }
+    if (writer.IsEmpty())
+      writer.Write(m_fallback);
   }
-  if (label.empty())
-    return m_fallback;
-  return label;
+  return writer.Finish();
 }
 
 bool CGUIInfoLabel::IsEmpty() const
@@ -247,19 +314,110 @@ CStdString NumberReplacer(const CStdString &str)
   return str;
 }
 
+/*!
+ \brief Markup with $str[param] blocks, split once into the text around the blocks and their parameters.
+ The blocks are replaced whenever the template is rendered, so the result
+ follows changes to what the replacer returns.
+ */
+class CReplaceTemplate
+{
+public:
+  CReplaceTemplate(const std::string &work, const std::string &str)
+  {
+    std::string block = "$" + str + "[";
+    size_t pos = 0;
+    size_t pos1 = work.find(block);
+    while (pos1 != std::string::npos)
+    {
+      size_t pos2 = pos1 + block.size();
+      size_t pos3 = StringUtils::FindEndBracket(work, '[', ']', pos2);
+      if (pos3 == std::string::npos)
+      {
+        CLog::Log(LOGERROR, "Error parsing label - missing ']' in \"%s\"", work.c_str());
+        break;
+      }
+      m_text.push_back(work.substr(pos, pos1 - pos));
+      m_params.push_back(work.substr(pos2, pos3 - pos2));
+      pos = pos3 + 1;
+      pos1 = work.find(block, pos);
+    }
+    m_text.push_back(work.substr(pos));
+  }
+
+  /*!
+   \brief Renders the template with the given replacer.
+   \return false if a replacement contained markup, which needs the label to be parsed again.
+   */
+  bool Render(CStdString &work, StringReplacerFunc func) const
+  {
+    work = m_text[0];
+    for (unsigned int i = 0; i < m_params.size(); i++)
+    {
+      CStdString replace = func(m_params[i]);
+      if (replace.find('$') != std::string::npos)
+        return false;
+      work += replace;
+      work += m_text[i + 1];
+    }
+    return true;
+  }
+
+private:
+  std::vector<std::string> m_text;   ///< text before each block and after the last one
+  std::vector<std::string> m_params;
+};
+
+typedef boost::shared_ptr<const CReplaceTemplate> ReplaceTemplatePtr;
+typedef std::map<std::string, ReplaceTemplatePtr> ReplaceTemplates;
+
+static CCriticalSection g_replaceTemplatesSection;
+static ReplaceTemplates g_localizeTemplates;
+static ReplaceTemplates g_addonTemplates;
+
+/*!
+ \brief Replaces all $str[param] blocks of a label using its compiled template.
+ Falls back to parsing the label when a replacement holds markup itself.
+ */
+static CStdString ReplaceCompiled(const CStdString &label, ReplaceTemplates &templates, const std::string &str, StringReplacerFunc func)
+{
+  CStdString work;
+  if (label.find('$') == std::string::npos)
+    return label;
+
+  ReplaceTemplatePtr compiled;
+  {
+    CSingleLock lock(g_replaceTemplatesSection);
+    ReplaceTemplates::const_iterator i = templates.find(label);
+    if (i != templates.end())
+      compiled = i->second;
+  }
+  if (!compiled)
+  {
+    compiled.reset(new CReplaceTemplate(label, str));
+    CSingleLock lock(g_replaceTemplatesSection);
+    if (templates.size() >= MAX_CACHED_LABELS)
+      templates.clear();
+    templates.insert(make_pair(label, compiled));
+  }
+
+  if (!compiled->Render(work, func))
+  {
+    work = label;
+    ReplaceString(work, str, func);
+  }
+  return work;
+}
+
 CStdString CGUIInfoLabel::ReplaceLocalize(const CStdString &label)
 {
-  CStdString work(label);
-  ReplaceString(work, "LOCALIZE", LocalizeReplacer);
+  CStdString work = ReplaceCompiled(label, g_localizeTemplates, "LOCALIZE", LocalizeReplacer);
   ReplaceString(work, "NUMBER", NumberReplacer);
   return work;
 }
 
 CStdString CGUIInfoLabel::ReplaceAddonStrings(const CStdString &label)
 {
-  CStdString work(label);
-  ReplaceString(work, "ADDON", AddonReplacer);
-  return work;
+  return ReplaceCompiled(label, g_addonTemplates, "ADDON", AddonReplacer);
 }
 
 enum EINFOFORMAT { NONE = 0, FORMATINFO, FORMATESCINFO, FORMATVAR };
@@ -277,6 +435,7 @@ const static infoformat infoformatmap[] = {{ "$INFO[",    FORMATINFO },
 void CGUIInfoLabel::Parse(const CStdString &label, int context)
 {
   m_info.clear();
+  m_text.clear();
   // Step 1: Replace all $LOCALIZE[number] with the real string
   CStdString work = ReplaceLocalize(label);
   // Step 2: Replace all $ADDON[id number] with the real string
@@ -303,7 +462,7 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
     if (format != NONE)
     {
       if (pos1 > 0)
-        m_info.push_back(CInfoPortion(0, work.substr(0, pos1), ""));
+        AddPortion(0, work.substr(0, pos1), "");
 
       pos2 = StringUtils::FindEndBracket(work, '[', ']', pos1 + len);
       if (pos2 != std::string::npos)
@@ -328,7 +487,7 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
           prefix = params[1];
         if (params.size() > 2)
           postfix = params[2];
-        m_info.push_back(CInfoPortion(info, prefix, postfix, format == FORMATESCINFO));
+        AddPortion(info, prefix, postfix, format == FORMATESCINFO);
         // and delete it from our work string
         work = work.substr(pos2 + 1);
       }
@@ -342,36 +501,81 @@ void CGUIInfoLabel::Parse(const CStdString &label, int context)
   while (format != NONE);
 
   if (!work.empty())
-    m_info.push_back(CInfoPortion(0, work, ""));
+    AddPortion(0, work, "");
 }
 
-CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped /*= false */)
+void CGUIInfoLabel::AddPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped /*= false */)
 {
-  m_info = info;
-  m_prefix = prefix;
-  m_postfix = postfix;
-  m_escaped = escaped;
   // filter our prefix and postfix for comma's
-  StringUtils::Replace(m_prefix, "$COMMA", ",");
-  StringUtils::Replace(m_postfix, "$COMMA", ",");
-  StringUtils::Replace(m_prefix, "$LBRACKET", "["); StringUtils::Replace(m_prefix, "$RBRACKET", "]");
-  StringUtils::Replace(m_postfix, "$LBRACKET", "["); StringUtils::Replace(m_postfix, "$RBRACKET", "]");
+  CStdString filteredPrefix(prefix), filteredPostfix(postfix);
+  StringUtils::Replace(filteredPrefix, "$COMMA", ",");
+  StringUtils::Replace(filteredPostfix, "$COMMA", ",");
+  StringUtils::Replace(filteredPrefix, "$LBRACKET", "["); StringUtils::Replace(filteredPrefix, "$RBRACKET", "]");
+  StringUtils::Replace(filteredPostfix, "$LBRACKET", "["); StringUtils::Replace(filteredPostfix, "$RBRACKET", "]");
+
+  unsigned int prefixStart = m_text.size();
+  m_text += filteredPrefix;
+  unsigned int postfixStart = m_text.size();
+  m_text += filteredPostfix;
+  m_info.push_back(CInfoPortion(info, prefixStart, filteredPrefix.size(), postfixStart, filteredPostfix.size(), escaped));
 }
 
-CStdString CGUIInfoLabel::CInfoPortion::GetLabel(const CStdString &info) const
+void CGUIInfoLabel::WritePortion(CLabelWriter &writer, const CInfoPortion &portion, const CStdString &info) const
 {
-  CStdString label = m_prefix + info + m_postfix;
-  if (m_escaped) // escape all quotes and backslashes, then quote
+  if (portion.m_escaped) // escape all quotes and backslashes, then quote
   {
+    CStdString label = m_text.substr(portion.m_prefix, portion.m_prefixLength) + info + m_text.substr(portion.m_postfix, portion.m_postfixLength);
     StringUtils::Replace(label, "\\", "\\\\");
     StringUtils::Replace(label, "\"", "\\\"");
-    return "\"" + label + "\"";
+    writer.Write("\"", 1);
+    writer.Write(label);
+    writer.Write("\"", 1);
+    return;
   }
-  return label;
+  writer.Write(m_text.c_str() + portion.m_prefix, portion.m_prefixLength);
+  writer.Write(info);
+  writer.Write(m_text.c_str() + portion.m_postfix, portion.m_postfixLength);
+}
+
+CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, unsigned int prefix, unsigned int prefixLength, unsigned int postfix, unsigned int postfixLength, bool escaped)
+  : m_info(info),
+    m_prefix(prefix),
+    m_prefixLength(prefixLength),
+    m_postfix(postfix),
+    m_postfixLength(postfixLength),
+    m_escaped(escaped)
+{
 }
 
+typedef boost::shared_ptr<const CGUIInfoLabel> InfoLabelPtr;
+typedef std::map<std::pair<int, std::string>, InfoLabelPtr> InfoLabels;
+
+static CCriticalSection g_infoLabelsSection;
+static InfoLabels g_infoLabels;
+
 CStdString CGUIInfoLabel::GetLabel(const CStdString &label, int contextWindow /*= 0*/, bool preferImage /*= false */)
-{ // translate the label
-  CGUIInfoLabel info(label, "", contextWindow);
-  return info.GetLabel(contextWindow, preferImage);
+{ // translate the label, compiling it only the first time it is seen in this context
+  InfoLabels::key_type key(contextWindow, label);
+  InfoLabelPtr info;
+  {
+    CSingleLock lock(g_infoLabelsSection);
+    InfoLabels::const_iterator i = g_infoLabels.find(key);
+    if (i != g_infoLabels.end())
+      info = i->second;
+  }
+  if (!info)
+  {
+    info.reset(new CGUIInfoLabel(label, "", contextWindow));
+    CSingleLock lock(g_infoLabelsSection);
+    if (g_infoLabels.size() >= MAX_CACHED_LABELS)
+      g_infoLabels.clear();
+    g_infoLabels.insert(make_pair(key, info));
+  }
+  return info->GetLabel(contextWindow, preferImage);
+}
+
+void CGUIInfoLabel::ClearCache()
+{
+  CSingleLock lock(g_infoLabelsSection);
+  g_infoLabels.clear();
 }
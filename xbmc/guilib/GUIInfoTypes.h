@@ -94,13 +94,49 @@ public:
    */
   CStdString GetItemLabel(const CGUIListItem *item, bool preferImage = false, CStdString *fallback = NULL) const;
 
+  /*!
+   \brief Renders the label (or image) for a given window context into a buffer, reusing its storage.
+   \param label buffer holding the previous rendering of the label, replaced with the current one.
+   \param contextWindow the context in which to evaluate the expression.
+   \param preferImage caller is specifically wanting an image rather than a label. Defaults to false.
+   \param fallback if non-NULL, is set to an alternate value to use should the actual value be not appropriate. Defaults to NULL.
+   \return true if the label changed, false if the buffer already held it.
+   \sa GetLabel
+   */
+  bool UpdateLabel(CStdString &label, int contextWindow, bool preferImage = false, CStdString *fallback = NULL) const;
+
+  /*!
+   \brief Renders the label (or image) for a given listitem into a buffer, reusing its storage.
+   \param label buffer holding the previous rendering of the label, replaced with the current one.
+   \param item listitem in question.
+   \param preferImage caller is specifically wanting an image rather than a label. Defaults to false.
+   \param fallback if non-NULL, is set to an alternate value to use should the actual value be not appropriate. Defaults to NULL.
+   \return true if the label changed, false if the buffer already held it.
+   \sa GetItemLabel
+   */
+  bool UpdateItemLabel(CStdString &label, const CGUIListItem *item, bool preferImage = false, CStdString *fallback = NULL) const;
+
   bool IsConstant() const;
   bool IsEmpty() const;
 
   const CStdString GetFallback() const { return m_fallback; };
 
+  /*!
+   \brief Gets a label (or image) from label markup for a given window context.
+   The markup is compiled once per context window and kept until ClearCache() is called.
+   \param label markup of the label.
+   \param contextWindow the context in which to evaluate the expression.
+   \param preferImage caller is specifically wanting an image rather than a label. Defaults to false.
+   \return label (or image).
+   */
   static CStdString GetLabel(const CStdString &label, int contextWindow = 0, bool preferImage = false);
 
+  /*!
+   \brief Drops the labels compiled by GetLabel(const CStdString &, int, bool).
+   Needs to be called whenever info labels, skin variables or localized strings are reloaded.
+   */
+  static void ClearCache();
+
   /*!
    \brief Replaces instances of $LOCALIZE[number] with the appropriate localized string
    \param label text to replace
@@ -118,19 +154,29 @@ public:
 private:
   void Parse(const CStdString &label, int context);
 
+  class CLabelWriter;
+
+  /*!
+   \brief Part of a label, either an info with its prefix and postfix or just text (as the prefix).
+   The prefix and postfix are ranges of the text of the label.
+   */
   class CInfoPortion
   {
   public:
-    CInfoPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped = false);
-    CStdString GetLabel(const CStdString &info) const;
+    CInfoPortion(int info, unsigned int prefix, unsigned int prefixLength, unsigned int postfix, unsigned int postfixLength, bool escaped);
     int m_info;
-    CStdString m_prefix;
-    CStdString m_postfix;
-  private:
+    unsigned int m_prefix;
+    unsigned int m_prefixLength;
+    unsigned int m_postfix;
+    unsigned int m_postfixLength;
     bool m_escaped;
   };
 
+  void AddPortion(int info, const CStdString &prefix, const CStdString &postfix, bool escaped = false);
+  void WritePortion(CLabelWriter &writer, const CInfoPortion &portion, const CStdString &info) const;
+
   CStdString m_fallback;
+  CStdString m_text;                 ///< text of all portions
   std::vector<CInfoPortion> m_info;
 };
 
@@ -193,6 +193,18 @@ bool CGUILabel::SetTextW(const CStdStringW &label)
     return false;
 }
 
+bool CGUILabel::SetInfoText(const CGUIInfoLabel &info, int contextWindow, bool preferImage /*= false*/)
+{
+  info.UpdateLabel(m_infoText, contextWindow, preferImage);
+  return SetText(m_infoText);
+}
+
+bool CGUILabel::SetInfoText(const CGUIInfoLabel &info, const CGUIListItem *item)
+{
+  info.UpdateItemLabel(m_infoText, item);
+  return SetText(m_infoText);
+}
+
 void CGUILabel::UpdateRenderRect()
 {
   // recalculate our text layout
@@ -129,6 +129,22 @@ public:
    */
   bool SetTextW(const CStdStringW &label);
 
+  /*! \brief Set the text to be displayed in the label from an info label
+   Renders the info label into a buffer kept by the label instead of a new string
+   \param info info label to render
+   \param contextWindow the context in which to evaluate the info label
+   \param preferImage whether images are preferred over labels in the info label
+   \sa SetText
+   */
+  bool SetInfoText(const CGUIInfoLabel &info, int contextWindow, bool preferImage = false);
+
+  /*! \brief Set the text to be displayed in the label from an info label of a list item
+   \param info info label to render
+   \param item the list item to evaluate the info label for
+   \sa SetText
+   */
+  bool SetInfoText(const CGUIInfoLabel &info, const CGUIListItem *item);
+
   /*! \brief Set styled text to be displayed in the label
    Updates the label control and recomputes final position and size
    \param text styled text to set.
@@ -241,5 +257,6 @@ private:
   CRect          m_renderRect;   ///< actual sizing of text
   CRect          m_maxRect;      ///< maximum sizing of text
   bool           m_invalid;      ///< if true, the label needs recomputing
+  CStdString     m_infoText;     ///< last rendering of an info label \sa SetInfoText
   COLOR          m_color;        ///< color to render text \sa SetColor, GetColor
 };
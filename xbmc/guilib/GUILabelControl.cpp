@@ -129,11 +129,10 @@ typedef struct InsertPointInfo
 
 void CGUILabelControl::UpdateInfo(const CGUIListItem *item)
 {
-  CStdString label(m_infoLabel.GetLabel(m_parentID));
-
   bool changed = false;
   if (m_startHighlight < m_endHighlight || m_startSelection < m_endSelection || m_bShowCursor)
   {
+    CStdString label(m_infoLabel.GetLabel(m_parentID));
     CStdStringW utf16;
     g_charsetConverter.utf8ToW(label, utf16);
     vecText text; text.reserve(utf16.size()+1);
@@ -164,13 +163,15 @@ void CGUILabelControl::UpdateInfo(const CGUIListItem *item)
     changed |= m_label.SetMaxRect(m_posX, m_posY, GetMaxWidth(), m_height);
     changed |= m_label.SetStyledText(text, colors);
   }
+  else if (m_bHasPath)
+  {
+    changed |= m_label.SetMaxRect(m_posX, m_posY, GetMaxWidth(), m_height);
+    changed |= m_label.SetText(ShortenPath(m_infoLabel.GetLabel(m_parentID)));
+  }
   else
   {
-    if (m_bHasPath)
-      label = ShortenPath(label);
-
     changed |= m_label.SetMaxRect(m_posX, m_posY, GetMaxWidth(), m_height);
-    changed |= m_label.SetText(label);
+    changed |= m_label.SetInfoText(m_infoLabel, m_parentID);
   }
   if (changed)
     MarkDirtyRegion();
@@ -371,6 +371,18 @@ void CGUIListItem::FreeMemory(bool immediately)
   }
 }
 
+void CGUIListItem::ReleaseLayouts(CGUIListItemLayout *&layout, CGUIListItemLayout *&focusedLayout, bool immediately)
+{
+  if (m_layout)
+    m_layout->FreeResources(immediately);
+  if (m_focusedLayout)
+    m_focusedLayout->FreeResources(immediately);
+  layout = m_layout;
+  focusedLayout = m_focusedLayout;
+  m_layout = NULL;
+  m_focusedLayout = NULL;
+}
+
 void CGUIListItem::SetLayout(CGUIListItemLayout *layout)
 {
   delete m_layout;
@@ -147,6 +147,11 @@ public:
 
   void FreeIcons();
   void FreeMemory(bool immediately = false);
+  /*! \brief Free the resources of the layouts and hand them to the caller rather than deleting them
+   \param layout [out] the item layout, or NULL if the item had none
+   \param focusedLayout [out] the focused item layout, or NULL if the item had none
+   */
+  void ReleaseLayouts(CGUIListItemLayout *&layout, CGUIListItemLayout *&focusedLayout, bool immediately = false);
   void SetInvalid();
 
   bool m_bIsFolder;     ///< is item a folder or a file
@@ -36,6 +36,7 @@ CGUIListItemLayout::CGUIListItemLayout()
   m_height = 0;
   m_focused = false;
   m_invalidated = true;
+  m_source = NULL;
   m_group.SetPushUpdates(true);
 }
 
@@ -47,6 +48,7 @@ CGUIListItemLayout::CGUIListItemLayout(const CGUIListItemLayout &from)
   m_focused = from.m_focused;
   m_condition = from.m_condition;
   m_invalidated = true;
+  m_source = &from;
 }
 
 CGUIListItemLayout::~CGUIListItemLayout()
@@ -95,6 +97,14 @@ void CGUIListItemLayout::Render(CGUIListItem *item, int parentID)
   m_group.DoRender();
 }
 
+void CGUIListItemLayout::Recycle()
+{
+  m_group.ResetAnimations();
+  m_group.ResetVisibility();
+  m_group.SetFocusedItem(0);
+  m_invalidated = true;
+}
+
 void CGUIListItemLayout::SetFocusedItem(unsigned int focus)
 {
   m_group.SetFocusedItem(focus);
@@ -231,3 +241,78 @@ void CGUIListItemLayout::DumpTextureUse()
   m_group.DumpTextureUse();
 }
 #endif
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool()
+{
+  m_capacity = 0;
+  m_allocated = 0;
+  m_recycled = 0;
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from)
+{
+  m_capacity = from.m_capacity;
+  m_allocated = 0;
+  m_recycled = 0;
+}
+
+CGUIListItemLayoutPool &CGUIListItemLayoutPool::operator=(const CGUIListItemLayoutPool &from)
+{
+  if (this != &from)
+  {
+    Clear();
+    m_capacity = from.m_capacity;
+  }
+  return *this;
+}
+
+CGUIListItemLayoutPool::~CGUIListItemLayoutPool()
+{
+  Clear();
+}
+
+CGUIListItemLayout *CGUIListItemLayoutPool::Acquire(const CGUIListItemLayout &source)
+{
+  while (!m_free.empty())
+  {
+    CGUIListItemLayout *layout = m_free.back();
+    m_free.pop_back();
+    if (layout->GetSource() == &source)
+    {
+      layout->Recycle();
+      m_recycled++;
+      return layout;
+    }
+    // copied from a layout the container no longer uses
+    delete layout;
+  }
+  m_allocated++;
+  return new CGUIListItemLayout(source);
+}
+
+void CGUIListItemLayoutPool::Release(CGUIListItemLayout *layout, const CGUIListItemLayout *source)
+{
+  if (!layout)
+    return;
+  if (source && layout->GetSource() == source && m_free.size() < m_capacity)
+    m_free.push_back(layout);
+  else
+    delete layout;
+}
+
+void CGUIListItemLayoutPool::SetCapacity(unsigned int capacity)
+{
+  m_capacity = capacity;
+  while (m_free.size() > m_capacity)
+  {
+    delete m_free.back();
+    m_free.pop_back();
+  }
+}
+
+void CGUIListItemLayoutPool::Clear()
+{
+  for (vector<CGUIListItemLayout *>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
+  m_free.clear();
+}
@@ -24,6 +24,8 @@
 #include "GUITexture.h"
 #include "GUIInfoTypes.h"
 
+#include <vector>
+
 class CGUIListItem;
 class CFileItem;
 class CLabelInfo;
@@ -45,6 +47,20 @@ public:
   void SetInvalid() { m_invalidated = true; };
   void FreeResources(bool immediately = false);
 
+  /*! \brief Layout this one was copied from, NULL for default constructed layouts.
+   Only used as an identity by CGUIListItemLayoutPool and never dereferenced: the
+   layouts a container keeps are copies themselves, so theirs points at the
+   temporary they were loaded into.
+   */
+  const CGUIListItemLayout *GetSource() const { return m_source; };
+
+  /*! \brief Prepare a layout released by one item to be bound to another.
+   Resets animations, sub-item focus and conditional visibility to the state of
+   a fresh copy of the source layout, and forces the info to be updated on the
+   next Process().
+   */
+  void Recycle();
+
 //#ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
   void CreateListControlLayouts(float width, float height, bool focused, const CLabelInfo &labelInfo, const CLabelInfo &labelInfo2, const CTextureInfo &texture, const CTextureInfo &textureFocus, float texHeight, float iconWidth, float iconHeight, const CStdString &nofocusCondition, const CStdString &focusCondition);
 //#endif
@@ -72,5 +88,47 @@ protected:
 
   INFO::InfoPtr m_condition;
   CGUIInfoBool m_isPlaying;
+
+  const CGUIListItemLayout *m_source;
+};
+
+/*!
+ \brief Free list of item layouts copied from the layouts of a container
+
+ Layouts of items that leave the visible area of a container are released
+ here rather than deleted, and handed to the next item that scrolls into view
+ as long as they were copied from the same layout. The number of free layouts
+ is bounded by SetCapacity(), anything past that is deleted.
+
+ Pools are owned by a single container, copying a pool gives an empty one.
+ */
+class CGUIListItemLayoutPool
+{
+public:
+  CGUIListItemLayoutPool();
+  CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from);
+  CGUIListItemLayoutPool &operator=(const CGUIListItemLayoutPool &from);
+  ~CGUIListItemLayoutPool();
+
+  /*! \brief Get a layout copied from source, recycled if one is free */
+  CGUIListItemLayout *Acquire(const CGUIListItemLayout &source);
+
+  /*! \brief Return a layout that is no longer bound to an item.
+   The layout is deleted if it wasn't copied from source or the pool is full.
+   */
+  void Release(CGUIListItemLayout *layout, const CGUIListItemLayout *source);
+
+  void SetCapacity(unsigned int capacity);
+  void Clear();
+
+  unsigned int GetFree() const { return m_free.size(); };
+  unsigned int GetAllocated() const { return m_allocated; };
+  unsigned int GetRecycled() const { return m_recycled; };
+
+private:
+  std::vector<CGUIListItemLayout *> m_free;
+  unsigned int m_capacity;
+  unsigned int m_allocated;
+  unsigned int m_recycled;
 };
 
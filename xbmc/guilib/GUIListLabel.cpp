@@ -92,9 +92,9 @@ void CGUIListLabel::UpdateInfo(const CGUIListItem *item)
     return; // nothing to do
 
   if (item)
-    SetLabel(m_info.GetItemLabel(item));
+    m_label.SetInfoText(m_info, item);
   else
-    SetLabel(m_info.GetLabel(m_parentID, true));
+    m_label.SetInfoText(m_info, m_parentID, true);
 }
 
 void CGUIListLabel::SetInvalid()
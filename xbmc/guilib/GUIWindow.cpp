@@ -43,9 +43,7 @@
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
 
-#ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
-#endif
 
 using namespace std;
 
@@ -83,9 +81,7 @@ CGUIWindow::~CGUIWindow(void)
 
 bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 {
-#ifdef HAS_PERFORMANCE_SAMPLE
-  CPerformanceSample aSample("WindowLoad-" + strFileName, true);
-#endif
+  MEASURE_DYNAMIC_SCOPE("WindowLoad-" + strFileName);
 
   if (m_windowLoaded || g_SkinInfo == NULL)
     return true;      // no point loading if it's already there
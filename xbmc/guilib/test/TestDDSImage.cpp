@@ -0,0 +1,120 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "guilib/DDSImage.h"
+#include "guilib/XBTF.h"
+#include "libsquish/squish.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+#include <vector>
+
+// smooth gradients with some noise, alpha being either opaque or a gradient as well
+static void FillImage(std::vector<unsigned char> &brga, unsigned int width, unsigned int height, bool alpha)
+{
+  unsigned int seed = 1;
+  brga.resize(width * height * 4);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      seed = seed * 1103515245 + 12345;
+      unsigned char noise = (seed >> 16) & 0x7;
+      unsigned char *pixel = &brga[(y * width + x) * 4];
+      pixel[0] = (unsigned char)(x * 255 / width) ^ noise;
+      pixel[1] = (unsigned char)(y * 255 / height) ^ noise;
+      pixel[2] = (unsigned char)((x + y) * 127 / (width + height)) ^ noise;
+      pixel[3] = alpha ? (unsigned char)((x ^ y) & 0xff) : 0xff;
+    }
+  }
+}
+
+static int GetSquishFlags(unsigned int format)
+{
+  if (format == XB_FMT_DXT3)
+    return squish::kDxt3 | squish::kSourceBGRA;
+  if (format == XB_FMT_DXT5)
+    return squish::kDxt5 | squish::kSourceBGRA;
+  return squish::kDxt1 | squish::kSourceBGRA;
+}
+
+class TestDDSImage : public testing::Test
+{
+protected:
+  TestDDSImage() : m_file(NULL) {}
+
+  virtual void SetUp()
+  {
+    m_file = XBMC_CREATETEMPFILE(".dds");
+    ASSERT_TRUE(m_file != NULL);
+    m_file->Close();
+    m_path = XBMC_TEMPFILEPATH(m_file);
+  }
+
+  virtual void TearDown()
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  /*! \brief Check the image against a single threaded compression of the whole image in its format.
+   */
+  void ExpectSingleThreaded(const CDDSImage &dds, const std::vector<unsigned char> &brga, unsigned int width, unsigned int height)
+  {
+    ASSERT_TRUE((dds.GetFormat() & XB_FMT_DXT_MASK) != 0);
+    int flags = GetSquishFlags(dds.GetFormat());
+    std::vector<unsigned char> expected(squish::GetStorageRequirements(width, height, flags));
+    ASSERT_EQ(expected.size(), dds.GetSize());
+    squish::CompressImage(&brga[0], width, height, width * 4, &expected[0], flags);
+    EXPECT_EQ(0, memcmp(&expected[0], dds.GetData(), expected.size()));
+  }
+
+  XFILE::CFile *m_file;
+  std::string m_path;
+};
+
+TEST_F(TestDDSImage, IdenticalToSingleThreaded)
+{
+  // sizes that aren't a multiple of the blocks or bands, sampled completely and partially
+  static const unsigned int sizes[][2] = { { 37, 23 }, { 130, 75 }, { 301, 517 } };
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    for (int alpha = 0; alpha < 2; alpha++)
+    {
+      unsigned int width = sizes[i][0], height = sizes[i][1];
+      std::vector<unsigned char> brga;
+      FillImage(brga, width, height, alpha != 0);
+
+      CDDSImage dds;
+      ASSERT_TRUE(dds.Create(m_path, width, height, width * 4, &brga[0]));
+      EXPECT_EQ((unsigned int)XB_FMT_DXT1, dds.GetFormat());
+      ExpectSingleThreaded(dds, brga, width, height);
+
+      // with an error limit the format is picked from a sample of the image
+      CDDSImage limited;
+      ASSERT_TRUE(limited.Create(m_path, width, height, width * 4, &brga[0], 40));
+      if (limited.GetFormat() & XB_FMT_DXT_MASK)
+        ExpectSingleThreaded(limited, brga, width, height);
+    }
+  }
+}
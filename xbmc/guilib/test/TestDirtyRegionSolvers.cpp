@@ -0,0 +1,213 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DirtyRegionSolvers.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static bool Contains(const CRect &outer, const CRect &inner)
+{
+  return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 && outer.x2 >= inner.x2 && outer.y2 >= inner.y2;
+}
+
+// every input region must be rendered by one of the passes
+static bool Covers(const CDirtyRegionList &output, const CDirtyRegionList &input)
+{
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    bool covered = false;
+    for (unsigned int j = 0; j < output.size() && !covered; j++)
+      covered = Contains(output[j], input[i]);
+    if (!covered)
+      return false;
+  }
+  return true;
+}
+
+static float Area(const CDirtyRegionList &regions)
+{
+  float area = 0.0f;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    area += regions[i].Area();
+  return area;
+}
+
+TEST(TestDirtyRegionSolvers, SpatialEmpty)
+{
+  CSpatialDirtyRegionSolver solver;
+  CDirtyRegionList input, output;
+  solver.Solve(input, output);
+  EXPECT_TRUE(output.empty());
+
+  input.push_back(CDirtyRegion(10, 10, 10, 50));
+  solver.Solve(input, output);
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(TestDirtyRegionSolvers, SpatialMerge)
+{
+  CSpatialDirtyRegionSolver solver(1000.0f, 0);
+  CDirtyRegionList input, output;
+
+  // far apart regions are rendered separately
+  input.push_back(CDirtyRegion(0, 0, 100, 100));
+  input.push_back(CDirtyRegion(500, 500, 600, 600));
+  solver.Solve(input, output);
+  ASSERT_EQ(2U, output.size());
+  EXPECT_TRUE(Covers(output, input));
+
+  // contained and overlapping regions are merged
+  input.push_back(CDirtyRegion(10, 10, 50, 50));
+  input.push_back(CDirtyRegion(550, 520, 640, 600));
+  output.clear();
+  solver.Solve(input, output);
+  ASSERT_EQ(2U, output.size());
+  EXPECT_TRUE(Covers(output, input));
+  EXPECT_FLOAT_EQ(100 * 100 + 140 * 100, Area(output));
+
+  // as are neighbours when the gap is cheaper than a pass
+  input.push_back(CDirtyRegion(105, 0, 205, 100));
+  output.clear();
+  solver.Solve(input, output);
+  ASSERT_EQ(2U, output.size());
+  EXPECT_TRUE(Covers(output, input));
+  EXPECT_FLOAT_EQ(205 * 100 + 140 * 100, Area(output));
+
+  // merging one pair may make merging with the next worthwhile
+  input.clear();
+  for (int i = 0; i < 10; i++)
+    input.push_back(CDirtyRegion(i * 12.0f, 0, i * 12.0f + 10, 10));
+  output.clear();
+  solver.Solve(input, output);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_TRUE(Contains(CRect(0, 0, 118, 10), output[0]));
+  EXPECT_TRUE(Covers(output, input));
+}
+
+TEST(TestDirtyRegionSolvers, SpatialLimit)
+{
+  CDirtyRegionList input;
+  for (int y = 0; y < 10; y++)
+  {
+    for (int x = 0; x < 10; x++)
+      input.push_back(CDirtyRegion(x * 128.0f, y * 72.0f, x * 128.0f + 16, y * 72.0f + 16));
+  }
+
+  CSpatialDirtyRegionSolver unlimited(0.0f, 0);
+  CDirtyRegionList output;
+  unlimited.Solve(input, output);
+  EXPECT_EQ(input.size(), output.size());
+  EXPECT_TRUE(Covers(output, input));
+
+  for (unsigned int limit = 1; limit <= 16; limit *= 2)
+  {
+    CSpatialDirtyRegionSolver solver(0.0f, limit);
+    output.clear();
+    solver.Solve(input, output);
+    EXPECT_EQ(limit, output.size());
+    EXPECT_TRUE(Covers(output, input));
+  }
+}
+
+// replays DirtyRegionTrace.txt, a synthetic trace modelling a busy home window
+class TestDirtyRegionTrace : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    FILE *file = fopen(XBMC_REF_FILE_PATH("/xbmc/guilib/test/DirtyRegionTrace.txt"), "r");
+    ASSERT_TRUE(file != NULL);
+    char line[16384];
+    while (fgets(line, sizeof(line), file))
+    {
+      if (line[0] == '#')
+        continue;
+      CDirtyRegionList frame;
+      for (char *rect = strtok(line, " \n"); rect; rect = strtok(NULL, " \n"))
+      {
+        float x1, y1, x2, y2;
+        if (sscanf(rect, "%f,%f,%f,%f", &x1, &y1, &x2, &y2) == 4)
+          frame.push_back(CDirtyRegion(x1, y1, x2, y2));
+      }
+      m_frames.push_back(frame);
+    }
+    fclose(file);
+  }
+
+  // renders the trace, returns the filled area and the number of passes
+  void Replay(IDirtyRegionSolver &solver, float &area, unsigned int &passes, unsigned int maxPasses = 0)
+  {
+    area = 0.0f;
+    passes = 0;
+    for (unsigned int i = 0; i < m_frames.size(); i++)
+    {
+      CDirtyRegionList output;
+      solver.Solve(m_frames[i], output);
+      EXPECT_TRUE(Covers(output, m_frames[i])) << "frame " << i;
+      if (maxPasses)
+      {
+        EXPECT_GE(maxPasses, output.size()) << "frame " << i;
+      }
+      area += Area(output);
+      passes += output.size();
+    }
+  }
+
+  std::vector<CDirtyRegionList> m_frames;
+};
+
+TEST_F(TestDirtyRegionTrace, Replay)
+{
+  ASSERT_EQ(120U, m_frames.size());
+
+  float unionArea, greedyArea, spatialArea;
+  unsigned int unionPasses, greedyPasses, spatialPasses;
+  CUnionDirtyRegionSolver unionSolver;
+  Replay(unionSolver, unionArea, unionPasses, 1);
+  CGreedyDirtyRegionSolver greedySolver;
+  Replay(greedySolver, greedyArea, greedyPasses);
+  CSpatialDirtyRegionSolver spatialSolver(16384.0f, 8);
+  Replay(spatialSolver, spatialArea, spatialPasses, 8);
+
+  // the spatial solver fills less than the union, without the many passes of the greedy one
+  EXPECT_LT(spatialArea, unionArea);
+  EXPECT_LT(spatialPasses, greedyPasses);
+}
+
+TEST(TestDirtyRegionSolvers, SpatialManyRegions)
+{
+  // a wall of small animated thumbs is still rendered in a few passes
+  CDirtyRegionList input;
+  for (int y = 0; y < 20; y++)
+  {
+    for (int x = 0; x < 30; x++)
+      input.push_back(CDirtyRegion(x * 64.0f, y * 54.0f, x * 64.0f + 24, y * 54.0f + 24));
+  }
+
+  CSpatialDirtyRegionSolver spatialSolver;
+  CDirtyRegionList output;
+  spatialSolver.Solve(input, output);
+  EXPECT_TRUE(Covers(output, input));
+  EXPECT_GE(8U, output.size());
+}
@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "guilib/GUIListContainer.h"
+#include "guilib/GUIListItemLayout.h"
+#include "guilib/GUIMessage.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+// no textures or labels, so the layouts can be processed without a renderer or fonts
+static const char *layouts =
+  "<layouts>"
+  "  <itemlayout width=\"400\" height=\"40\">"
+  "    <control type=\"group\">"
+  "      <visible>!IsEmpty(ListItem.Label2)</visible>"
+  "      <animation effect=\"fade\" start=\"0\" end=\"100\" time=\"200\">Visible</animation>"
+  "      <animation effect=\"fade\" start=\"100\" end=\"0\" time=\"200\">Hidden</animation>"
+  "      <control type=\"group\"><posx>10</posx></control>"
+  "      <control type=\"group\"><posx>20</posx></control>"
+  "    </control>"
+  "  </itemlayout>"
+  "  <focusedlayout width=\"400\" height=\"40\">"
+  "    <control type=\"group\">"
+  "      <animation effect=\"zoom\" start=\"100\" end=\"110\" time=\"200\">Focus</animation>"
+  "      <control type=\"group\"><posx>10</posx></control>"
+  "    </control>"
+  "  </focusedlayout>"
+  "</layouts>";
+
+class CTestListContainer : public CGUIListContainer
+{
+public:
+  CTestListContainer(int preloadItems)
+    : CGUIListContainer(0, 1, 0, 0, 400, 400, VERTICAL, CScroller(0), preloadItems)
+  {
+    LoadLayouts();
+  }
+
+  void LoadLayouts()
+  {
+    CXBMCTinyXML doc;
+    doc.Parse(layouts);
+    LoadLayout(doc.RootElement());
+  }
+
+  unsigned int GetItemsPerPage() const { return m_itemsPerPage; }
+  const CGUIListItemLayoutPool &GetLayoutPool() const { return m_layoutPool; }
+
+  unsigned int GetBoundLayouts() const
+  {
+    unsigned int bound = 0;
+    for (unsigned int i = 0; i < m_items.size(); i++)
+    {
+      if (m_items[i]->GetLayout())
+        bound++;
+    }
+    return bound;
+  }
+};
+
+static void FillList(CFileItemList &items, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    CFileItemPtr item(new CFileItem(StringUtils::Format("Item %u", i)));
+    if (i % 2)
+      item->SetLabel2("odd");
+    items.Add(item);
+  }
+}
+
+TEST(TestGUIBaseContainer, RecycleResetsState)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(layouts);
+  CGUIListItemLayout source;
+  source.LoadLayout(doc.RootElement()->FirstChildElement("itemlayout"), 0, false);
+
+  CGUIListItemLayoutPool pool;
+  pool.SetCapacity(1);
+  CDirtyRegionList dirty;
+
+  // no label2, so the group starts its hidden animation
+  CGUIListItem hidden("hidden");
+  CGUIListItemLayout *layout = pool.Acquire(source);
+  EXPECT_TRUE(layout->GetSource() == &source);
+  layout->Process(&hidden, 0, 0, dirty);
+  EXPECT_TRUE(layout->IsAnimating(ANIM_TYPE_HIDDEN));
+
+  pool.Release(layout, &source);
+  EXPECT_EQ(1u, pool.GetFree());
+
+  // the recycled layout must behave like a fresh copy: nothing left of the
+  // hidden animation, and no visible animation as the group never was hidden
+  CGUIListItem visible("visible");
+  visible.SetLabel2("label2");
+  CGUIListItemLayout *recycled = pool.Acquire(source);
+  EXPECT_EQ(layout, recycled);
+  EXPECT_EQ(1u, pool.GetRecycled());
+  EXPECT_FALSE(recycled->IsAnimating(ANIM_TYPE_HIDDEN));
+  recycled->Process(&visible, 0, 0, dirty);
+  EXPECT_FALSE(recycled->IsAnimating(ANIM_TYPE_VISIBLE));
+  EXPECT_FALSE(recycled->IsAnimating(ANIM_TYPE_HIDDEN));
+
+  // layouts copied from another layout, or past the capacity, are not kept
+  CGUIListItemLayout other;
+  pool.Release(recycled, &other);
+  EXPECT_EQ(0u, pool.GetFree());
+  CGUIListItemLayout *first = pool.Acquire(source);
+  CGUIListItemLayout *second = pool.Acquire(source);
+  pool.Release(first, &source);
+  pool.Release(second, &source);
+  EXPECT_EQ(1u, pool.GetFree());
+  EXPECT_EQ(3u, pool.GetAllocated());
+}
+
+TEST(TestGUIBaseContainer, LoadLayoutClearsPool)
+{
+  CFileItemList items;
+  FillList(items, 100);
+
+  CTestListContainer container(2);
+  CGUIMessage msg(GUI_MSG_LABEL_BIND, 0, container.GetID(), 0, 0, &items);
+  ASSERT_TRUE(container.OnMessage(msg));
+
+  CDirtyRegionList dirty;
+  unsigned int currentTime = 0;
+  container.DoProcess(currentTime, dirty);
+  for (unsigned int i = 0; i < 20; i++)
+  {
+    container.OnDown();
+    currentTime += 16;
+    container.DoProcess(currentTime, dirty);
+  }
+  ASSERT_GT(container.GetLayoutPool().GetFree(), 0u);
+  ASSERT_GT(container.GetBoundLayouts(), 0u);
+
+  // layouts copied from the old ones must neither be recycled nor stay bound,
+  // the new layouts may well reuse the old addresses
+  container.LoadLayouts();
+  EXPECT_EQ(0u, container.GetLayoutPool().GetFree());
+  EXPECT_EQ(0u, container.GetBoundLayouts());
+}
+
+TEST(TestGUIBaseContainer, ScrollRecyclesLayouts)
+{
+  static const unsigned int count = 500;
+  static const int preload = 2;
+
+  CFileItemList items;
+  FillList(items, count);
+
+  CTestListContainer container(preload);
+  CGUIMessage msg(GUI_MSG_LABEL_BIND, 0, container.GetID(), 0, 0, &items);
+  ASSERT_TRUE(container.OnMessage(msg));
+
+  CDirtyRegionList dirty;
+  unsigned int currentTime = 0;
+  container.DoProcess(currentTime, dirty);
+  ASSERT_EQ(10u, container.GetItemsPerPage());
+
+  // one item per frame, top to bottom and back up again
+  unsigned int maxBound = 0;
+  for (int direction = 0; direction < 2; direction++)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      if (direction == 0)
+        container.OnDown();
+      else
+        container.OnUp();
+      currentTime += 16;
+      dirty.clear();
+      container.DoProcess(currentTime, dirty);
+      maxBound = std::max(maxBound, container.GetBoundLayouts());
+    }
+  }
+
+  // only the page plus the cache margin ever holds a layout, and every
+  // other item scrolling into view reuses one
+  const CGUIListItemLayoutPool &pool = container.GetLayoutPool();
+  unsigned int window = container.GetItemsPerPage() + 2 * preload + 2;
+  EXPECT_LE(maxBound, window);
+  EXPECT_LE(pool.GetAllocated(), 2 * window);
+  EXPECT_GT(pool.GetRecycled(), count);
+  EXPECT_LE(pool.GetFree(), window);
+}
@@ -0,0 +1,161 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "guilib/GUIInfoTypes.h"
+#include "settings/SkinSettings.h"
+#include "test/TestUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestGUIInfoTypes, UpdateLabel)
+{
+  int setting = CSkinSettings::Get().TranslateString("testinfolabel");
+  CSkinSettings::Get().SetString(setting, "value");
+
+  CGUIInfoLabel info("[B]$INFO[Skin.String(testinfolabel),pre$COMMA , post][/B]", "fallback");
+  CStdString label;
+  EXPECT_TRUE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ("[B]pre, value post[/B]", label.c_str());
+  EXPECT_FALSE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ(label.c_str(), info.GetLabel(0).c_str());
+
+  // changes at the end, in the middle and in length are all picked up
+  CSkinSettings::Get().SetString(setting, "valuf");
+  EXPECT_TRUE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ("[B]pre, valuf post[/B]", label.c_str());
+  CSkinSettings::Get().SetString(setting, "v");
+  EXPECT_TRUE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ("[B]pre, v post[/B]", label.c_str());
+  label = "[B]pre, v post[/B] and more";
+  EXPECT_TRUE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ("[B]pre, v post[/B]", label.c_str());
+
+  // the prefix and postfix are only used with the info
+  CSkinSettings::Get().SetString(setting, "");
+  EXPECT_TRUE(info.UpdateLabel(label, 0));
+  EXPECT_STREQ("[B][/B]", label.c_str());
+
+  CGUIInfoLabel fallback("$INFO[Skin.String(testinfolabel)]", "fallback");
+  EXPECT_TRUE(fallback.UpdateLabel(label, 0));
+  EXPECT_STREQ("fallback", label.c_str());
+  EXPECT_FALSE(fallback.UpdateLabel(label, 0));
+}
+
+TEST(TestGUIInfoTypes, EscapedInfo)
+{
+  int setting = CSkinSettings::Get().TranslateString("testinfolabel");
+  CSkinSettings::Get().SetString(setting, "a \"quoted\\\" value");
+
+  CGUIInfoLabel info("play($ESCINFO[Skin.String(testinfolabel),$LBRACKET,$RBRACKET])");
+  EXPECT_STREQ("play(\"[a \\\"quoted\\\\\\\" value]\")", info.GetLabel(0).c_str());
+  CSkinSettings::Get().SetString(setting, "");
+}
+
+TEST(TestGUIInfoTypes, ReplaceLocalize)
+{
+  EXPECT_STREQ("no markup", CGUIInfoLabel::ReplaceLocalize("no markup").c_str());
+  EXPECT_STREQ("5 of 7", CGUIInfoLabel::ReplaceLocalize("$NUMBER[5] of $NUMBER[7]").c_str());
+  // compiled markup gives the same result the second time
+  for (int i = 0; i < 2; i++)
+  {
+    EXPECT_STREQ("[] nested [1]", CGUIInfoLabel::ReplaceLocalize("[$LOCALIZE[999999]] nested $NUMBER[[1]]").c_str());
+    EXPECT_STREQ("$LOCALIZE[12", CGUIInfoLabel::ReplaceLocalize("$LOCALIZE[12").c_str());
+    EXPECT_STREQ("$ADDON[broken", CGUIInfoLabel::ReplaceAddonStrings("$ADDON[broken").c_str());
+  }
+}
+
+TEST(TestGUIInfoTypes, StaticGetLabel)
+{
+  int setting = CSkinSettings::Get().TranslateString("testinfolabel");
+  CSkinSettings::Get().SetString(setting, "first");
+  EXPECT_STREQ("is first", CGUIInfoLabel::GetLabel("is $INFO[Skin.String(testinfolabel)]").c_str());
+  // the compiled label is kept, the info is evaluated every time
+  CSkinSettings::Get().SetString(setting, "second");
+  EXPECT_STREQ("is second", CGUIInfoLabel::GetLabel("is $INFO[Skin.String(testinfolabel)]").c_str());
+  CGUIInfoLabel::ClearCache();
+  EXPECT_STREQ("is second", CGUIInfoLabel::GetLabel("is $INFO[Skin.String(testinfolabel)]").c_str());
+  CSkinSettings::Get().SetString(setting, "");
+}
+
+static void CollectLabels(const TiXmlElement *element, std::vector<std::string> &labels)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    if (child->FirstChildElement())
+    {
+      CollectLabels(child, labels);
+      continue;
+    }
+    if (!child->FirstChild() || !child->FirstChild()->ToText())
+      continue;
+    std::string value = child->FirstChild()->Value();
+    std::string name = child->ValueStr();
+    if (name != "label" && name != "label2" && name != "altlabel" &&
+        value.find("$INFO[") == std::string::npos && value.find("$LOCALIZE[") == std::string::npos)
+      continue;
+    // skin variables need the skin loaded, and system, network and weather infos
+    // test the info providers rather than the labels
+    if (value.find("$VAR[") != std::string::npos || value.find("System.") != std::string::npos ||
+        value.find("Network.") != std::string::npos || value.find("Weather.") != std::string::npos)
+      continue;
+    labels.push_back(value);
+  }
+}
+
+TEST(TestGUIInfoTypes, SkinLabels)
+{
+  std::vector<std::string> markup;
+  CFileItemList files;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(XBMC_REF_FILE_PATH("addons/skin.confluence/720p/"), files, ".xml"));
+  for (int i = 0; i < files.Size(); i++)
+  {
+    CXBMCTinyXML doc;
+    if (doc.LoadFile(files[i]->GetPath()))
+      CollectLabels(doc.RootElement(), markup);
+  }
+  ASSERT_FALSE(markup.empty());
+
+  std::vector<CGUIInfoLabel> labels;
+  for (unsigned int i = 0; i < markup.size(); i++)
+    labels.push_back(CGUIInfoLabel(markup[i]));
+  std::vector<CStdString> buffers(labels.size());
+
+  // the compiled labels render what parsing the markup on each call did
+  for (unsigned int i = 0; i < markup.size(); i++)
+    EXPECT_STREQ(CGUIInfoLabel(markup[i]).GetLabel(0).c_str(), CGUIInfoLabel::GetLabel(markup[i]).c_str());
+
+  unsigned int changed = 0;
+  for (unsigned int frame = 0; frame < 2; frame++)
+  {
+    for (unsigned int i = 0; i < labels.size(); i++)
+    {
+      if (labels[i].UpdateLabel(buffers[i], 0))
+        changed++;
+    }
+  }
+
+  for (unsigned int i = 0; i < labels.size(); i++)
+    EXPECT_STREQ(labels[i].GetLabel(0).c_str(), buffers[i].c_str());
+  // only the first frame renders anything new
+  EXPECT_GE(labels.size(), changed);
+}
@@ -60,8 +60,10 @@
 #include "settings/MediaSourceSettings.h"
 #include "settings/SkinSettings.h"
 #include "utils/StringUtils.h"
+#include "utils/TraceRecorder.h"
 #include "utils/URIUtils.h"
 #include "Util.h"
+#include "XBDateTime.h"
 #include "URL.h"
 #include "music/MusicDatabase.h"
 #include "cores/IPlayer.h"
@@ -225,6 +227,7 @@ const BUILT_IN commands[] = {
   { "ToggleDebug",                false,  "Enables/disables debug mode" },
   { "StartPVRManager",            false,  "(Re)Starts the PVR manager" },
   { "StopPVRManager",             false,  "Stops the PVR manager" },
+  { "TraceCapture",               true,   "Captures a timeline of the playback pipeline. Params can be: start, stop (which also saves it) or dump (saves it and keeps capturing)" },
 #if defined(TARGET_ANDROID)
   { "StartAndroidActivity",       true,   "Launch an Android native app with the given package name.  Optional parms (in order): intent, dataType, dataURI." },
 #endif
@@ -1765,6 +1768,25 @@ int CBuiltins::Execute(const CStdString& execString)
   {
     g_application.StopPVRManager();
   }
+  else if (execute.Equals("tracecapture") && !parameter.empty())
+  {
+    CTraceRecorder &recorder = CTraceRecorder::Get();
+    if (parameter.Equals("start"))
+      recorder.Start();
+    else if (parameter.Equals("stop") || parameter.Equals("dump"))
+    {
+      if (parameter.Equals("stop"))
+        recorder.Stop();
+      CStdString path = "special://temp/trace-" + CDateTime::GetCurrentDateTime().GetAsSaveString() + ".json";
+      if (!recorder.Write(path))
+        return -2;
+    }
+    else
+    {
+      CLog::Log(LOGERROR,"Builtin 'TraceCapture' called with unknown parameter: %s", parameter.c_str());
+      return -2;
+    }
+  }
   else if (execute.Equals("StartAndroidActivity") && params.size() > 0)
   {
     CApplicationMessenger::Get().StartAndroidActivity(params);
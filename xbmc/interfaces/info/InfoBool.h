@@ -27,6 +27,24 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief Categories of state an info bool can depend on.
+ Info bools are only marked dirty when one of the categories they depend on
+ has changed. \sa CGUIInfoManager::ResetChangedCache
+ */
+enum InfoCategory
+{
+  CATEGORY_PLAYER   = 0x01, ///< player state and time, the playing item
+  CATEGORY_PLAYLIST = 0x02, ///< playlist contents, position, shuffle and repeat
+  CATEGORY_LIBRARY  = 0x04, ///< library content and scanning
+  CATEGORY_WINDOW   = 0x08, ///< windows, controls, containers and focus
+  CATEGORY_SYSTEM   = 0x10, ///< system state not covered by any other category
+  CATEGORY_SKIN     = 0x20, ///< skin settings
+  CATEGORY_TIME     = 0x40, ///< time of day and date
+  CATEGORY_ALL      = 0x7f
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -44,6 +62,16 @@ public:
   {
     m_dirty = true;
   }
+  /*! \brief Set the info bool dirty if it depends on any of the given categories
+   \param categories bitmask of INFO::InfoCategory values that have changed
+   \return true if the info bool is dirty
+   */
+  bool SetDirty(unsigned int categories)
+  {
+    if (m_categories & categories)
+      m_dirty = true;
+    return m_dirty;
+  }
   /*! \brief Get the value of this info bool
    This is called to update (if dirty) and fetch the value of the info bool
    \param item the item used to evaluate the bool
@@ -73,11 +101,13 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+  unsigned int GetCategories() const { return m_categories; }
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_categories;   ///< categories of state the value depends on
 
 private:
   std::string  m_expression;   ///< original expression
@@ -30,6 +30,7 @@ InfoSingle::InfoSingle(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_categories = g_infoManager.GetBoolCategories(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -40,6 +41,8 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
+  // depends on whatever its operands depend on
+  m_categories = 0;
   Parse(expression);
 }
 
@@ -85,6 +88,7 @@ void InfoExpression::Parse(const std::string &expression)
         if (info)
         {
           m_listItemDependent |= info->ListItemDependent();
+          m_categories |= info->GetCategories();
           m_postfix.push_back(m_operands.size());
           m_operands.push_back(info);
         }
@@ -132,6 +136,7 @@ void InfoExpression::Parse(const std::string &expression)
     if (info)
     {
       m_listItemDependent |= info->ListItemDependent();
+      m_categories |= info->GetCategories();
       m_postfix.push_back(m_operands.size());
       m_operands.push_back(info);
     }
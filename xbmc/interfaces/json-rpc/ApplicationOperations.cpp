@@ -102,6 +102,28 @@ JSONRPC_STATUS CApplicationOperations::SetMute(const CStdString &method, ITransp
   return GetPropertyValue("muted", result);
 }
 
+JSONRPC_STATUS CApplicationOperations::GetPerformanceStatistics(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  std::vector<PerformanceCounter> stats;
+  g_application.GetPerformanceStats().GetStats(stats);
+
+  result["counters"] = CVariant(CVariant::VariantTypeArray);
+  for (std::vector<PerformanceCounter>::const_iterator it = stats.begin(); it != stats.end(); ++it)
+  {
+    CVariant counter(CVariant::VariantTypeObject);
+    counter["name"] = it->m_name;
+    counter["samples"] = it->m_samples;
+    counter["average"] = it->m_average / 1000.0;
+    counter["p50"] = it->m_p50 / 1000.0;
+    counter["p90"] = it->m_p90 / 1000.0;
+    counter["p99"] = it->m_p99 / 1000.0;
+    counter["maximum"] = it->m_max / 1000.0;
+    result["counters"].push_back(counter);
+  }
+
+  return OK;
+}
+
 JSONRPC_STATUS CApplicationOperations::Quit(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   CApplicationMessenger::Get().Quit();
@@ -82,6 +82,8 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   { "Player.SetAudioStream",                        CPlayerOperations::SetAudioStream },
   { "Player.SetSubtitle",                           CPlayerOperations::SetSubtitle },
 
+  { "Player.GetFrameStatistics",                    CPlayerOperations::GetFrameStatistics },
+
 // Playlist
   { "Playlist.GetPlaylists",                        CPlaylistOperations::GetPlaylists },
   { "Playlist.GetProperties",                       CPlaylistOperations::GetProperties },
@@ -210,6 +212,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   { "Application.GetProperties",                    CApplicationOperations::GetProperties },
   { "Application.SetVolume",                        CApplicationOperations::SetVolume },
   { "Application.SetMute",                          CApplicationOperations::SetMute },
+  { "Application.GetPerformanceStatistics",         CApplicationOperations::GetPerformanceStatistics },
   { "Application.Quit",                             CApplicationOperations::Quit },
 
 // Favourites operations
@@ -43,7 +43,10 @@
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
 #include "cores/IPlayer.h"
+#include "cores/VideoRenderers/RenderManager.h"
+#include "filesystem/SpecialProtocol.h"
 #include "settings/MediaSettings.h"
+#include "XBDateTime.h"
 
 using namespace JSONRPC;
 using namespace PLAYLIST;
@@ -836,6 +839,68 @@ JSONRPC_STATUS CPlayerOperations::SetAudioStream(const CStdString &method, ITran
   return ACK;
 }
 
+static CVariant SerializeHistogram(const CRenderHistogram &histogram)
+{
+  CVariant result(CVariant::VariantTypeObject);
+  result["count"] = histogram.GetCount();
+  result["minimum"] = histogram.GetMinimum();
+  result["maximum"] = histogram.GetMaximum();
+  result["average"] = histogram.GetAverage();
+  result["p50"] = histogram.GetPercentile(50);
+  result["p90"] = histogram.GetPercentile(90);
+  result["p95"] = histogram.GetPercentile(95);
+  result["p99"] = histogram.GetPercentile(99);
+  return result;
+}
+
+JSONRPC_STATUS CPlayerOperations::GetFrameStatistics(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  if (GetPlayer(parameterObject["playerid"]) != Video)
+    return FailedToExecute;
+
+  CRenderStats stats = g_renderManager.GetFrameStatistics();
+
+  result["enabled"] = stats.IsEnabled();
+  result["queued"] = stats.GetCount(RENDER_FRAME_QUEUED);
+  result["presented"] = stats.GetCount(RENDER_FRAME_PRESENTED);
+  result["skipped"] = stats.GetCount(RENDER_FRAME_SKIPPED);
+  result["discarded"] = stats.GetCount(RENDER_FRAME_DISCARDED);
+  result["dropped"] = stats.GetCount(RENDER_FRAME_DROPPED);
+  result["lateness"] = SerializeHistogram(stats.GetLateness());
+  result["interval"] = SerializeHistogram(stats.GetInterval());
+  result["queuetime"] = SerializeHistogram(stats.GetQueueTime());
+  result["avoffset"] = SerializeHistogram(stats.GetAVOffset());
+  result["vsyncerror"] = SerializeHistogram(stats.GetVSyncError());
+
+  std::vector<SRenderFrameRecord> frames;
+  stats.GetFrames(frames, (unsigned int)parameterObject["frames"].asUnsignedInteger());
+  result["frames"] = CVariant(CVariant::VariantTypeArray);
+  for (std::vector<SRenderFrameRecord>::const_iterator it = frames.begin(); it != frames.end(); ++it)
+  {
+    CVariant frame(CVariant::VariantTypeObject);
+    frame["sequence"] = it->sequence;
+    frame["result"] = CRenderStats::GetResultName(it->result);
+    frame["pts"] = it->pts;
+    frame["clock"] = it->clock;
+    frame["queued"] = it->queued;
+    frame["due"] = it->due;
+    frame["presented"] = it->presented;
+    frame["synced"] = it->synced;
+    frame["vsyncerror"] = it->error;
+    result["frames"].push_back(frame);
+  }
+
+  if (parameterObject["dump"].asBoolean())
+  {
+    std::string file = "special://temp/framestatistics-" + CDateTime::GetCurrentDateTime().GetAsSaveString() + ".csv";
+    if (!stats.WriteCSV(file))
+      return InternalError;
+    result["file"] = CSpecialProtocol::TranslatePath(file);
+  }
+
+  return OK;
+}
+
 JSONRPC_STATUS CPlayerOperations::SetSubtitle(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   switch (GetPlayer(parameterObject["playerid"]))
@@ -51,12 +51,17 @@ namespace XBMCAddon
         const String& url = pItem->first();
         const XBMCAddon::xbmcgui::ListItem *pListItem = pItem->second();
         bool bIsFolder = pItem->GetNumValuesSet() > 2 ? pItem->third() : false;
-        pListItem->item->SetPath(url);
-        pListItem->item->m_bIsFolder = bIsFolder;
-        fitems.Add(pListItem->item);
+        // the directory shares the item of the list item. Changes the script makes
+        // later on are done under the gui lock like the rendering of the item.
+        // Only items someone else holds already (e.g. a list item the script reuses
+        // for several entries) are copied so the earlier entries keep their path.
+        CFileItemPtr fitem = pListItem->item.unique() ? pListItem->item : CFileItemPtr(new CFileItem(*pListItem->item));
+        fitem->SetPath(url);
+        fitem->m_bIsFolder = bIsFolder;
+        fitems.Add(fitem);
       }
 
-      // call the directory class to add our items
+      // call the directory class to add our items, it takes them over as they are
       return XFILE::CPluginDirectory::AddItems(handle, &fitems, totalItems);
     }
 
@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
+  #include "config.h"
+#endif
+
+// python.h should always be included first before any other includes
+#include <Python.h>
+
+#include "system.h"
+#include "PythonInterpreterPool.h"
+#include "interfaces/python/LanguageHook.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+using namespace std;
+
+// more than this many idle interpreters of one add-on are of no use as
+// invocations of the same add-on rarely overlap
+#define MAX_IDLE_PER_ADDON 2
+
+CPythonInterpreterPool::CPythonInterpreterPool()
+  : m_idleCount(0)
+{ }
+
+CPythonInterpreterPool::~CPythonInterpreterPool()
+{ }
+
+void* CPythonInterpreterPool::Acquire(const std::string &key)
+{
+  CSingleLock lock(m_critSection);
+  map<string, InterpreterList>::iterator it = m_idle.find(key);
+  if (it == m_idle.end() || it->second.empty())
+    return NULL;
+
+  // the most recently used one is the most likely to be warm in the caches
+  Interpreter interpreter = it->second.back();
+  it->second.pop_back();
+  if (it->second.empty())
+    m_idle.erase(it);
+  m_idleCount--;
+  lock.Leave();
+
+  return PyThreadState_New((PyInterpreterState*)interpreter.interp);
+}
+
+bool CPythonInterpreterPool::Release(const std::string &key, void* threadState)
+{
+  unsigned int maxIdle = g_advancedSettings.m_pythonInterpreterPoolSize;
+  if (threadState == NULL || maxIdle == 0)
+    return false;
+
+  PyThreadState* state = (PyThreadState*)threadState;
+  if (state->next != NULL || state->interp->tstate_head != state)
+  {
+    CLog::Log(LOGDEBUG, "CPythonInterpreterPool: not keeping the interpreter of %s which still runs other threads", key.c_str());
+    return false;
+  }
+
+  vector<void*> evicted;
+  unsigned int total;
+  {
+    CSingleLock lock(m_critSection);
+    InterpreterList &interpreters = m_idle[key];
+    if (interpreters.size() >= MAX_IDLE_PER_ADDON)
+      return false;
+
+    // make room by ending the interpreters which have been idle for longest
+    while (m_idleCount >= maxIdle)
+    {
+      map<string, InterpreterList>::iterator oldest = m_idle.end();
+      for (map<string, InterpreterList>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+      {
+        if (!it->second.empty() && (oldest == m_idle.end() || (int)(it->second.front().idleSince - oldest->second.front().idleSince) < 0))
+          oldest = it;
+      }
+      if (oldest == m_idle.end())
+        break;
+
+      evicted.push_back(oldest->second.front().interp);
+      m_idleCount--;
+      oldest->second.pop_front();
+    }
+
+    Interpreter interpreter = { state->interp, XbmcThreads::SystemClockMillis() };
+    interpreters.push_back(interpreter);
+    m_idleCount++;
+    total = m_idleCount;
+
+    for (map<string, InterpreterList>::iterator it = m_idle.begin(); it != m_idle.end(); )
+    {
+      if (it->second.empty())
+        m_idle.erase(it++);
+      else
+        ++it;
+    }
+  }
+
+  // the interpreter lives on without any thread state
+  PyThreadState_Clear(state);
+  PyThreadState_Swap(NULL);
+  PyThreadState_Delete(state);
+
+  for (vector<void*>::const_iterator it = evicted.begin(); it != evicted.end(); ++it)
+    EndInterpreter(*it);
+
+  CLog::Log(LOGDEBUG, "CPythonInterpreterPool: keeping the interpreter of %s (%u idle)", key.c_str(), total);
+  return true;
+}
+
+void CPythonInterpreterPool::Process()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  unsigned int timeout = g_advancedSettings.m_pythonInterpreterIdleTimeout * 1000;
+
+  vector<void*> expired;
+  {
+    CSingleLock lock(m_critSection);
+    for (map<string, InterpreterList>::iterator it = m_idle.begin(); it != m_idle.end(); )
+    {
+      InterpreterList &interpreters = it->second;
+      while (!interpreters.empty() && now - interpreters.front().idleSince >= timeout)
+      {
+        CLog::Log(LOGDEBUG, "CPythonInterpreterPool: ending the idle interpreter of %s", it->first.c_str());
+        expired.push_back(interpreters.front().interp);
+        m_idleCount--;
+        interpreters.pop_front();
+      }
+
+      if (interpreters.empty())
+        m_idle.erase(it++);
+      else
+        ++it;
+    }
+  }
+
+  EndInterpreters(expired);
+}
+
+void CPythonInterpreterPool::Clear()
+{
+  vector<void*> interps;
+  {
+    CSingleLock lock(m_critSection);
+    for (map<string, InterpreterList>::const_iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+    {
+      for (InterpreterList::const_iterator interpreter = it->second.begin(); interpreter != it->second.end(); ++interpreter)
+        interps.push_back(interpreter->interp);
+    }
+    m_idle.clear();
+    m_idleCount = 0;
+  }
+
+  EndInterpreters(interps);
+}
+
+bool CPythonInterpreterPool::IsEmpty() const
+{
+  CSingleLock lock(m_critSection);
+  return m_idle.empty();
+}
+
+unsigned int CPythonInterpreterPool::GetIdleCount() const
+{
+  CSingleLock lock(m_critSection);
+  return m_idleCount;
+}
+
+void CPythonInterpreterPool::EndInterpreter(void* interp)
+{
+  PyThreadState* state = PyThreadState_New((PyInterpreterState*)interp);
+  PyThreadState* old = PyThreadState_Swap(state);
+
+  XBMCAddon::Python::PythonLanguageHook::GetIfExists(state->interp)->UnregisterMe();
+  Py_EndInterpreter(state);
+
+  PyThreadState_Swap(old);
+}
+
+void CPythonInterpreterPool::EndInterpreters(const std::vector<void*> &interps)
+{
+  if (interps.empty())
+    return;
+
+  PyEval_AcquireLock();
+  for (vector<void*>::const_iterator it = interps.begin(); it != interps.end(); ++it)
+    EndInterpreter(*it);
+  PyEval_ReleaseLock();
+}
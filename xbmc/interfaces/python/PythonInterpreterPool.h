@@ -0,0 +1,96 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief Keeps the sub-interpreters of python plugins alive between invocations
+
+ Creating a sub-interpreter and importing the xbmc modules and the modules of
+ the add-on makes up most of the time a short plugin invocation takes. Plugins
+ which opt in by setting reuseinterpreter="true" on their extension point hand
+ their interpreter back to the pool when they are done, and the next invocation
+ of the same add-on version continues in it.
+
+ Idle interpreters are ended after the configured idle timeout, and the
+ longest idle ones make room when the configured number of idle interpreters
+ is reached. Python 2 has no per-interpreter allocation accounting, so the
+ pool is limited by count rather than by memory.
+ */
+class CPythonInterpreterPool
+{
+public:
+  CPythonInterpreterPool();
+  ~CPythonInterpreterPool();
+
+  /*!
+   \brief Take an idle interpreter out of the pool
+   Must be called with the GIL held.
+   \param key the add-on (and version) the interpreter was created for
+   \return a new thread state of the interpreter or NULL if none is idle
+   */
+  void* Acquire(const std::string &key);
+
+  /*!
+   \brief Hand an interpreter back to the pool
+   Must be called with the GIL held and the given thread state being the
+   current one. If the interpreter is kept, the thread state is deleted and
+   no thread state is current afterwards.
+   \param key the add-on (and version) the interpreter was created for
+   \param threadState the only thread state of the interpreter
+   \return true if the interpreter was kept, false if it has to be ended by the caller
+   */
+  bool Release(const std::string &key, void* threadState);
+
+  /*!
+   \brief End the interpreters which have been idle for too long
+   Must be called without holding the GIL.
+   */
+  void Process();
+
+  /*!
+   \brief End all idle interpreters
+   Must be called without holding the GIL.
+   */
+  void Clear();
+
+  bool IsEmpty() const;
+  unsigned int GetIdleCount() const;
+
+private:
+  typedef struct {
+    void* interp;
+    unsigned int idleSince;
+  } Interpreter;
+  typedef std::list<Interpreter> InterpreterList;
+
+  static void EndInterpreter(void* interp);
+  void EndInterpreters(const std::vector<void*> &interps);
+
+  std::map<std::string, InterpreterList> m_idle;
+  unsigned int m_idleCount;
+  CCriticalSection m_critSection;
+};
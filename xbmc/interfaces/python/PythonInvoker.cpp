@@ -39,9 +39,11 @@
 #include "interfaces/legacy/Addon.h"
 #include "interfaces/python/LanguageHook.h"
 #include "interfaces/python/PyContext.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 #include "interfaces/python/pythreadstate.h"
 #include "interfaces/python/swig.h"
 #include "interfaces/python/XBPython.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #if defined(TARGET_WINDOWS)
 #include "utils/CharsetConverter.h"
@@ -160,7 +162,16 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   // get the global lock
   PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
+
+  // continue in an interpreter a previous invocation of the add-on left
+  // behind if it wants us to
+  bool reuse = canReuseInterpreter();
+  PyThreadState* state = NULL;
+  if (reuse)
+    state = (PyThreadState*)g_pythonParser.GetInterpreterPool().Acquire(getInterpreterKey());
+  bool reused = state != NULL;
+  if (!reused)
+    state = Py_NewInterpreter();
   if (state == NULL)
   {
     PyEval_ReleaseLock();
@@ -170,10 +181,19 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // swap in my thread state
   PyThreadState_Swap(state);
 
-  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook(new XBMCAddon::Python::PythonLanguageHook(state->interp));
-  languageHook->RegisterMe();
-
-  onInitialization();
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook;
+  if (reused)
+  {
+    languageHook = XBMCAddon::Python::PythonLanguageHook::GetIfExists(state->interp);
+    CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): reusing the interpreter of a previous invocation", GetId(), m_sourceFile.c_str());
+    onReuse();
+  }
+  else
+  {
+    languageHook = new XBMCAddon::Python::PythonLanguageHook(state->interp);
+    languageHook->RegisterMe();
+    onInitialization();
+  }
   setState(InvokerStateInitialized);
 
   std::string realFilename(CSpecialProtocol::TranslatePath(m_sourceFile));
@@ -376,6 +396,20 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   onDeinitialization();
 
+  // hand the interpreter over to the next invocation if the script ended
+  // normally, otherwise there's no telling what state it was left in
+  if (reuse && !m_stop && stateToSet == InvokerStateDone)
+  {
+    resetInterpreter(moduleDict);
+
+    if (g_pythonParser.GetInterpreterPool().Release(getInterpreterKey(), state))
+    {
+      PyEval_ReleaseLock();
+      setState(stateToSet);
+      return true;
+    }
+  }
+
   // run the gc before finishing
   //
   // if the script exited by throwing a SystemExit excepton then going back
@@ -528,6 +562,15 @@ void CPythonInvoker::onInitialization()
   }
 }
 
+void CPythonInvoker::onReuse()
+{
+  XBMC_TRACE;
+  // the previous invocation ended by flagging an abort
+  PyObject *m = PyImport_AddModule((char*)"xbmc");
+  if (m == NULL || PyObject_SetAttrString(m, (char*)"abortRequested", PyBool_FromLong(0)))
+    CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): failed to reset abortRequested", GetId(), m_sourceFile.c_str());
+}
+
 void CPythonInvoker::onPythonModuleInitialization(void* moduleDict)
 {
   if (m_addon.get() == NULL || moduleDict == NULL)
@@ -603,6 +646,54 @@ bool CPythonInvoker::initializeModule(PythonModuleInitialization module)
   return true;
 }
 
+bool CPythonInvoker::canReuseInterpreter() const
+{
+  // only plugins are invoked often enough and end on their own
+  if (m_addon.get() == NULL || m_addon->Type() != ADDON::ADDON_PLUGIN ||
+      g_advancedSettings.m_pythonInterpreterPoolSize == 0)
+    return false;
+
+  ADDON::InfoMap::const_iterator reuse = m_addon->ExtraInfo().find("reuseinterpreter");
+  return reuse != m_addon->ExtraInfo().end() && reuse->second == "true";
+}
+
+std::string CPythonInvoker::getInterpreterKey() const
+{
+  // an updated add-on must not continue with the modules of the old version
+  return m_addon->ID() + "-" + m_addon->Version().asString();
+}
+
+void CPythonInvoker::resetInterpreter(void* moduleDict)
+{
+  // the interpreter keeps everything the script imported but the globals of
+  // the script itself are dropped, except for the ones the add-on asks for
+  std::set<std::string> keep;
+  ADDON::InfoMap::const_iterator keepGlobals = m_addon->ExtraInfo().find("keepglobals");
+  if (keepGlobals != m_addon->ExtraInfo().end())
+  {
+    std::vector<std::string> names = StringUtils::Split(keepGlobals->second, " ");
+    keep.insert(names.begin(), names.end());
+  }
+  keep.insert("__builtins__");
+  keep.insert("__name__");
+  keep.insert("__doc__");
+  keep.insert("__package__");
+
+  PyObject *moduleDictionary = (PyObject *)moduleDict;
+  PyObject *keys = PyDict_Keys(moduleDictionary);
+  for (Py_ssize_t i = 0; keys != NULL && i < PyList_Size(keys); i++)
+  {
+    PyObject *key = PyList_GetItem(keys, i); // borrowed ref, no need to delete
+    if (!PyString_Check(key) || keep.find(PyString_AsString(key)) == keep.end())
+      PyDict_DelItem(moduleDictionary, key);
+  }
+  Py_XDECREF(keys);
+  PyErr_Clear();
+
+  // collect what the dropped globals were holding on to
+  PyGC_Collect();
+}
+
 void CPythonInvoker::addPath(const std::string& path)
 {
 #if defined(TARGET_WINDOWS)
@@ -48,6 +48,8 @@ protected:
   virtual std::map<std::string, PythonModuleInitialization> getModules() const;
   virtual const char* getInitializationScript() const;
   virtual void onInitialization();
+  // called instead of onInitialization() when continuing in a pooled interpreter
+  virtual void onReuse();
   // actually a PyObject* but don't wanna draw Python.h include into the header
   virtual void onPythonModuleInitialization(void* moduleDict);
   virtual void onDeinitialization();
@@ -66,6 +68,10 @@ private:
   bool initializeModule(PythonModuleInitialization module);
   void addPath(const std::string& path); // add path in UTF-8 encoding
   void addNativePath(const std::string& path); // add path in system/Python encoding
+  bool canReuseInterpreter() const;
+  std::string getInterpreterKey() const;
+  // actually a PyObject* but don't wanna draw Python.h include into the header
+  void resetInterpreter(void* moduleDict);
 
   std::string m_pythonPath;
   void *m_threadState;
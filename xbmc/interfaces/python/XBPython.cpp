@@ -576,6 +576,8 @@ void XBPython::Uninitialize()
 
   // cleanup threads that are still running
   tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls FinalizeScript
+
+  m_interpreterPool.Clear();
 }
 
 void XBPython::Process()
@@ -600,8 +602,11 @@ void XBPython::Process()
     //delete scripts which are done
     tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls FinalizeScript
 
+    // end the interpreters nobody reused for a while
+    m_interpreterPool.Process();
+
     CSingleLock l2(m_critSection);
-    if(m_iDllScriptCounter == 0 && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
+    if(m_iDllScriptCounter == 0 && m_interpreterPool.IsEmpty() && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
     {
       Finalize();
     }
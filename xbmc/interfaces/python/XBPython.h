@@ -26,6 +26,7 @@
 #include "threads/Thread.h"
 #include "interfaces/IAnnouncer.h"
 #include "interfaces/generic/ILanguageInvocationHandler.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 #include "addons/IAddon.h"
 
 #include <boost/shared_ptr.hpp>
@@ -97,6 +98,8 @@ public:
   bool InitializeEngine();
   void FinalizeScript();
 
+  CPythonInterpreterPool& GetInterpreterPool() { return m_interpreterPool; }
+
   void PulseGlobalEvent();
   bool WaitForEvent(CEvent& hEvent, unsigned int milliseconds);
 
@@ -122,6 +125,9 @@ private:
   MonitorCallbackList m_vecMonitorCallbackList;
   LibraryLoader*      m_pDll;
 
+  // idle interpreters of plugins which are reused, these keep the engine loaded
+  CPythonInterpreterPool m_interpreterPool;
+
   // any global events that scripts should be using
   CEvent m_globalEvent;
 
@@ -0,0 +1,162 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addons/PluginSource.h"
+#include "filesystem/File.h"
+#include "interfaces/python/AddonPythonInvoker.h"
+#include "interfaces/python/XBPython.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+
+using namespace ADDON;
+
+class TestPythonInterpreterPool : public testing::Test
+{
+protected:
+  TestPythonInterpreterPool() : m_file(NULL), m_id(0) {}
+
+  virtual void SetUp()
+  {
+    m_poolSize = g_advancedSettings.m_pythonInterpreterPoolSize;
+    m_idleTimeout = g_advancedSettings.m_pythonInterpreterIdleTimeout;
+    g_advancedSettings.m_pythonInterpreterPoolSize = 4;
+    g_advancedSettings.m_pythonInterpreterIdleTimeout = 120;
+
+    m_script = XBMC_REF_FILE_PATH("/xbmc/interfaces/python/test/plugin.test.interpreterpool/default.py");
+
+    m_addon = CreateAddon("plugin.test.interpreterpool");
+
+    m_file = XBMC_CREATETEMPFILE(".txt");
+    ASSERT_TRUE(m_file != NULL);
+    m_file->Close();
+    m_output = XBMC_TEMPFILEPATH(m_file);
+  }
+
+  virtual void TearDown()
+  {
+    g_pythonParser.GetInterpreterPool().Clear();
+    g_advancedSettings.m_pythonInterpreterPoolSize = m_poolSize;
+    g_advancedSettings.m_pythonInterpreterIdleTimeout = m_idleTimeout;
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  // as read from the addon.xml next to the script
+  static AddonPtr CreateAddon(const std::string &id)
+  {
+    AddonProps props(id, ADDON_PLUGIN, "1.0.0", "");
+    props.path = XBMC_REF_FILE_PATH("/xbmc/interfaces/python/test/plugin.test.interpreterpool/");
+    props.extrainfo.insert(std::make_pair("reuseinterpreter", "true"));
+    props.extrainfo.insert(std::make_pair("keepglobals", "runs"));
+    return AddonPtr(new CPluginSource(props));
+  }
+
+  // runs the plugin as CPluginDirectory does and returns what it wrote
+  std::string Invoke(int handle)
+  {
+    return Invoke(m_addon, handle);
+  }
+
+  std::string Invoke(const AddonPtr &addon, int handle)
+  {
+    std::vector<std::string> argv;
+    argv.push_back("plugin://plugin.test.interpreterpool/");
+    argv.push_back(StringUtils::Format("%i", handle));
+    argv.push_back("?out=" + m_output);
+
+    {
+      CAddonPythonInvoker invoker(NULL);
+      invoker.SetId(m_id++);
+      invoker.SetAddon(addon);
+      EXPECT_TRUE(invoker.Execute(m_script, argv));
+      EXPECT_EQ(InvokerStateDone, invoker.GetState());
+    }
+
+    std::string result;
+    FILE *file = fopen(m_output.c_str(), "r");
+    if (file != NULL)
+    {
+      char buffer[256];
+      size_t read = fread(buffer, 1, sizeof(buffer), file);
+      result.assign(buffer, read);
+      fclose(file);
+    }
+    return result;
+  }
+
+  std::string m_script;
+  std::string m_output;
+  AddonPtr m_addon;
+  XFILE::CFile *m_file;
+  int m_id;
+  unsigned int m_poolSize;
+  unsigned int m_idleTimeout;
+};
+
+TEST_F(TestPythonInterpreterPool, Reuse)
+{
+  CPythonInterpreterPool &pool = g_pythonParser.GetInterpreterPool();
+  ASSERT_TRUE(pool.IsEmpty());
+
+  EXPECT_EQ("1 False False 1", Invoke(1));
+  EXPECT_EQ(1U, pool.GetIdleCount());
+
+  // the kept globals survive, the others and the handle don't
+  EXPECT_EQ("2 False False 2", Invoke(2));
+  EXPECT_EQ("3 False False 3", Invoke(3));
+  EXPECT_EQ(1U, pool.GetIdleCount());
+
+  // idle interpreters are ended after the timeout
+  g_advancedSettings.m_pythonInterpreterIdleTimeout = 0;
+  pool.Process();
+  EXPECT_TRUE(pool.IsEmpty());
+  EXPECT_EQ("1 False False 4", Invoke(4));
+}
+
+TEST_F(TestPythonInterpreterPool, Disabled)
+{
+  g_advancedSettings.m_pythonInterpreterPoolSize = 0;
+  EXPECT_EQ("1 False False 1", Invoke(1));
+  EXPECT_TRUE(g_pythonParser.GetInterpreterPool().IsEmpty());
+  EXPECT_EQ("1 False False 2", Invoke(2));
+}
+
+TEST_F(TestPythonInterpreterPool, Limit)
+{
+  CPythonInterpreterPool &pool = g_pythonParser.GetInterpreterPool();
+  AddonPtr other = CreateAddon("plugin.test.interpreterpool.other");
+  g_advancedSettings.m_pythonInterpreterPoolSize = 1;
+
+  EXPECT_EQ("1 False False 1", Invoke(1));
+  EXPECT_EQ(1U, pool.GetIdleCount());
+
+  // the other add-on's interpreter takes the place of the longest idle one
+  EXPECT_EQ("1 False False 2", Invoke(other, 2));
+  EXPECT_EQ(1U, pool.GetIdleCount());
+  EXPECT_EQ("1 False False 3", Invoke(3));
+  EXPECT_EQ("1 False False 4", Invoke(other, 4));
+  EXPECT_EQ(1U, pool.GetIdleCount());
+}
@@ -0,0 +1,25 @@
+# stand-ins for what a typical video add-on imports before listing anything
+import sys
+import json
+import re
+import urllib
+import urlparse
+import xml.dom.minidom
+import xbmc
+import xbmcgui
+import xbmcplugin
+
+# kept across invocations as the add-on asks for it
+try:
+  runs += 1
+except NameError:
+  runs = 1
+
+# dropped between invocations
+leftover = 'scratch' in globals()
+scratch = [i for i in range(1000)]
+
+params = dict(urlparse.parse_qsl(sys.argv[2].lstrip('?')))
+out = open(params['out'], 'w')
+out.write('%d %s %s %s' % (runs, leftover, xbmc.abortRequested, sys.argv[1]))
+out.close()
@@ -117,6 +117,14 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      for (std::set<std::string>::const_iterator it = m_pathsToRemove.begin(); it != m_pathsToRemove.end(); ++it)
+      {
+        MAPSONGS songs;
+        CLog::Log(LOGDEBUG, "%s Removing songs from '%s' as it no longer exists", __FUNCTION__, it->c_str());
+        if (m_musicDatabase.RemoveSongsFromPath(*it, songs, false))
+          m_needsCleanup = true;
+      }
+
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); it++)
       {
@@ -253,6 +261,7 @@ void CMusicInfoScanner::Start(const CStdString& strDirectory, int flags)
   m_fileCountReader.StopThread();
   StopThread();
   m_pathsToScan.clear();
+  m_pathsToRemove.clear();
   m_flags = flags;
 
   if (strDirectory.empty())
@@ -271,6 +280,40 @@ void CMusicInfoScanner::Start(const CStdString& strDirectory, int flags)
   m_bRunning = true;
 }
 
+void CMusicInfoScanner::Start(const std::set<std::string>& directories, int flags)
+{
+  m_fileCountReader.StopThread();
+  StopThread();
+  m_pathsToScan.clear();
+  m_pathsToRemove.clear();
+  m_flags = flags;
+
+  for (std::set<std::string>::const_iterator it = directories.begin(); it != directories.end(); ++it)
+  {
+    if (CDirectory::Exists(*it))
+      m_pathsToScan.insert(*it);
+    else
+      m_pathsToRemove.insert(*it);
+  }
+
+  // DoScan() recurses, so drop folders that are below another one
+  for (std::set<std::string>::iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); )
+  {
+    std::set<std::string>::iterator parent = m_pathsToScan.begin();
+    while (parent != m_pathsToScan.end() && (parent == it || !URIUtils::IsInPath(*it, *parent)))
+      ++parent;
+    if (parent != m_pathsToScan.end())
+      m_pathsToScan.erase(it++);
+    else
+      ++it;
+  }
+  m_bClean = g_advancedSettings.m_bMusicLibraryCleanOnUpdate;
+
+  m_scanType = 0;
+  Create();
+  m_bRunning = true;
+}
+
 void CMusicInfoScanner::FetchAlbumInfo(const CStdString& strDirectory,
                                        bool refresh)
 {
@@ -55,6 +55,12 @@ public:
   virtual ~CMusicInfoScanner();
 
   void Start(const CStdString& strDirectory, int flags);
+  /*! \brief Scan only the given folders, e.g. those reported by CLibraryWatcher.
+   Songs in folders that no longer exist are removed from the library.
+   \param directories folders that changed, with trailing slashes
+   \param flags the scan flags
+   */
+  void Start(const std::set<std::string>& directories, int flags);
   void FetchAlbumInfo(const CStdString& strDirectory, bool refresh=false);
   void FetchArtistInfo(const CStdString& strDirectory, bool refresh=false);
   bool IsScanning();
@@ -216,6 +222,7 @@ protected:
   std::map<CArtistCredit, CArtist> m_artistCache;
 
   std::set<std::string> m_pathsToScan;
+  std::set<std::string> m_pathsToRemove;
   int m_flags;
   CThread m_fileCountReader;
 };
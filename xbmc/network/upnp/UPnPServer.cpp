@@ -641,11 +641,19 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
 
     items.SetPath(CStdString(parent_id));
 
+    // only the requested page ends up in the response, the other cached items
+    // just have to be counted. library nodes drop hidden items before paging,
+    // so they need every item
+    NPT_UInt32 page_count = (requested_count == 0)?m_MaxReturnedItems:min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
+
     // guard against loading while saving to the same cache file
     // as CArchive currently performs no locking itself
     bool load;
     { NPT_AutoLock lock(m_CacheMutex);
-      load = items.Load();
+      if (StringUtils::StartsWith(items.GetPath(), "library"))
+        load = items.Load();
+      else
+        load = items.LoadPage(starting_index, page_count);
     }
 
     if (!load) {
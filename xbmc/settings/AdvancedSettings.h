@@ -188,12 +188,14 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
     bool m_videoDisableBackgroundDeinterlace;
+    bool m_videoFrameStatistics;
     int  m_videoCaptureUseOcclusionQuery;
     bool m_DXVACheckCompatibility;
     bool m_DXVACheckCompatibilityPresent;
     bool m_DXVAForceProcessorRenderer;
     bool m_DXVANoDeintProcForProgressive;
     int  m_videoFpsDetect;
+    int  m_videoThumbCandidates;
     int  m_videoBusyDialogDelay_ms;
     bool m_videoDisableSWMultithreading;
     StagefrightConfig m_stagefrightConfig;
@@ -267,6 +269,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryAlbumsSortByArtistThenYear;
     bool m_bMusicLibraryCleanOnUpdate;
+    bool m_bMusicLibraryWatchSources;
+    int m_iMusicLibraryWatchFullScan;
     CStdString m_strMusicLibraryAlbumFormat;
     CStdString m_strMusicLibraryAlbumFormatRight;
     bool m_prioritiseAPEv2tags;
@@ -279,6 +283,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iVideoLibraryRecentlyAddedItems;
     bool m_bVideoLibraryHideEmptySeries;
     bool m_bVideoLibraryCleanOnUpdate;
+    bool m_bVideoLibraryWatchSources;
+    int m_iVideoLibraryWatchFullScan;
     bool m_bVideoLibraryExportAutoThumbs;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
@@ -378,6 +384,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    float m_guiDirtyRegionPassCost; ///< \brief what a rendering pass costs in filled pixels (spatial solver)
+    int  m_guiDirtyRegionMaxPasses; ///< \brief the maximal number of rendering passes, 0 for no limit (spatial solver)
+    bool m_guiRecordDirtyRegions; ///< \brief write the regions of every frame to special://temp/dirtyregions.txt
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
@@ -387,6 +396,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    unsigned int m_pythonInterpreterIdleTimeout; ///< \brief seconds an idle add-on interpreter is kept around for reuse
+    unsigned int m_pythonInterpreterPoolSize; ///< \brief number of idle add-on interpreters kept for reuse, 0 disables reuse
+
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
@@ -477,6 +477,35 @@ CSettingSection* CSettings::GetSection(const std::string &section) const
   return m_settingsManager->GetSection(section);
 }
 
+CSettingHandle CSettings::GetHandle(const std::string &id) const
+{
+  // Backward compatibility (skins use this setting)
+  if (StringUtils::EqualsNoCase(id, "lookandfeel.enablemouse"))
+    return GetHandle("input.enablemouse");
+
+  return m_settingsManager->GetHandle(id);
+}
+
+bool CSettings::GetBool(const CSettingHandle &handle) const
+{
+  return m_settingsManager->GetBool(handle);
+}
+
+int CSettings::GetInt(const CSettingHandle &handle) const
+{
+  return m_settingsManager->GetInt(handle);
+}
+
+double CSettings::GetNumber(const CSettingHandle &handle) const
+{
+  return m_settingsManager->GetNumber(handle);
+}
+
+std::string CSettings::GetString(const CSettingHandle &handle) const
+{
+  return m_settingsManager->GetString(handle);
+}
+
 bool CSettings::GetBool(const std::string &id) const
 {
   // Backward compatibility (skins use this setting)
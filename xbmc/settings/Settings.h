@@ -28,6 +28,7 @@
 #include "settings/SettingControl.h"
 #include "settings/SettingCreator.h"
 #include "settings/lib/ISettingCallback.h"
+#include "settings/lib/SettingHandle.h"
 #include "threads/CriticalSection.h"
 #include "utils/Variant.h"
 
@@ -164,6 +165,46 @@ public:
    */
   CSettingSection* GetSection(const std::string &section) const;
 
+  /*!
+   \brief Gets a handle to the setting with the given identifier.
+
+   Reading a setting through its handle avoids looking up the identifier and
+   doesn't take any locks, which makes it the preferred way to read settings
+   on hot paths.
+
+   \param id Setting identifier
+   \return Handle to the setting or an invalid handle if the identifier is unknown
+   */
+  CSettingHandle GetHandle(const std::string &id) const;
+  /*!
+   \brief Gets the boolean value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Boolean value of the setting with the given handle
+   */
+  bool GetBool(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the integer value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Integer value of the setting with the given handle
+   */
+  int GetInt(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the real number value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Real number value of the setting with the given handle
+   */
+  double GetNumber(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the string value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return String value of the setting with the given handle
+   */
+  std::string GetString(const CSettingHandle &handle) const;
+
   /*!
    \brief Gets the boolean value of the setting with the given identifier.
 
@@ -87,6 +87,7 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    g_infoManager.SetCategoriesChanged(INFO::CATEGORY_SKIN);
     return;
   }
 
@@ -134,6 +135,7 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    g_infoManager.SetCategoriesChanged(INFO::CATEGORY_SKIN);
     return;
   }
 
@@ -152,6 +154,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      g_infoManager.SetCategoriesChanged(INFO::CATEGORY_SKIN);
       return;
     }
   }
@@ -162,6 +165,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      g_infoManager.SetCategoriesChanged(INFO::CATEGORY_SKIN);
       return;
     }
   }
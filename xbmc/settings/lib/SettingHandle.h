@@ -0,0 +1,58 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+
+class CSettingsManager;
+
+/*!
+ \ingroup settings
+ \brief Handle to a setting, resolved once through CSettingsManager::GetHandle().
+
+ The settings manager keeps an immutable snapshot of the value of every
+ setting and publishes a new one whenever the setting changes. Reading a
+ setting through its handle neither looks up the identifier nor takes a lock.
+ Handles are cheap to copy and stay valid until the settings manager is
+ cleared.
+ */
+class CSettingHandle
+{
+public:
+  CSettingHandle() : m_slot(NULL) { }
+
+  /*!
+   \brief Whether the handle refers to a known setting.
+   */
+  bool IsValid() const { return m_slot != NULL; }
+
+  bool operator==(const CSettingHandle &rhs) const { return m_slot == rhs.m_slot; }
+  bool operator!=(const CSettingHandle &rhs) const { return m_slot != rhs.m_slot; }
+
+private:
+  friend class CSettingsManager;
+
+  struct Value;
+  struct Slot;
+
+  explicit CSettingHandle(Slot *slot) : m_slot(slot) { }
+
+  Slot *m_slot;
+};
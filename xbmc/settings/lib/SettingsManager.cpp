@@ -22,14 +22,33 @@
 #include "SettingDefinitions.h"
 #include "SettingSection.h"
 #include "Setting.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/XBMCTinyXML.h"
 
 
+// immutable once published
+struct CSettingHandle::Value
+{
+  bool boolean;
+  int integer;
+  double number;
+  std::string string;
+};
+
+struct CSettingHandle::Slot
+{
+  int type;
+  const Value * volatile value;
+};
+
 CSettingsManager::CSettingsManager()
-  : m_initialized(false), m_loaded(false)
-{ }
+  : m_initialized(false), m_loaded(false), m_epoch(0)
+{
+  m_readers[0] = m_readers[1] = 0;
+}
 
 CSettingsManager::~CSettingsManager()
 {
@@ -153,6 +172,8 @@ void CSettingsManager::Unload()
   for (SettingMap::iterator setting = m_settings.begin(); setting != m_settings.end(); ++setting)
     setting->second.setting->Reset();
 
+  ReleaseRetiredValues(false);
+
   OnSettingsUnloaded();
 }
 
@@ -161,7 +182,18 @@ void CSettingsManager::Clear()
   CExclusiveLock lock(m_critical);
   Unload();
 
+  for (SettingMap::iterator setting = m_settings.begin(); setting != m_settings.end(); ++setting)
+  {
+    if (setting->second.slot != NULL)
+    {
+      delete setting->second.slot->value;
+      delete setting->second.slot;
+    }
+  }
   m_settings.clear();
+
+  ReleaseRetiredValues(true);
+
   for (SettingSectionMap::iterator section = m_sections.begin(); section != m_sections.end(); ++section)
     delete section->second;
   m_sections.clear();
@@ -235,6 +267,16 @@ void CSettingsManager::SetInitialized()
   }
 }
 
+void CSettingsManager::SetLoaded()
+{
+  CExclusiveLock lock(m_settingsCritical);
+  m_loaded = true;
+
+  // default values may have been changed without a change notification
+  for (SettingMap::iterator setting = m_settings.begin(); setting != m_settings.end(); ++setting)
+    PublishValue(setting->second.slot, setting->second.setting);
+}
+
 void CSettingsManager::AddSection(CSettingSection *section)
 {
   if (section == NULL)
@@ -267,6 +309,12 @@ void CSettingsManager::AddSection(CSettingSection *section)
         {
           setting->second.setting = *settingIt;
           (*settingIt)->SetCallback(this);
+
+          CSettingHandle::Slot *slot = new CSettingHandle::Slot;
+          slot->type = (*settingIt)->GetType();
+          slot->value = NULL;
+          setting->second.slot = slot;
+          PublishValue(slot, *settingIt);
         }
       }
     }
@@ -501,14 +549,36 @@ SettingDependencyMap CSettingsManager::GetDependencies(const CSetting *setting)
   return GetDependencies(setting->GetId());
 }
 
-bool CSettingsManager::GetBool(const std::string &id) const
+CSettingHandle CSettingsManager::GetHandle(const std::string &id) const
 {
   CSharedLock lock(m_settingsCritical);
-  CSetting *setting = GetSetting(id);
-  if (setting == NULL || setting->GetType() != SettingTypeBool)
+  if (id.empty())
+    return CSettingHandle();
+
+  std::string settingId = id;
+  StringUtils::ToLower(settingId);
+
+  SettingMap::const_iterator setting = m_settings.find(settingId);
+  if (setting != m_settings.end())
+    return CSettingHandle(setting->second.slot);
+
+  CLog::Log(LOGDEBUG, "CSettingsManager: requested setting (%s) was not found.", id.c_str());
+  return CSettingHandle();
+}
+
+bool CSettingsManager::GetBool(const std::string &id) const
+{
+  return GetBool(GetHandle(id));
+}
+
+bool CSettingsManager::GetBool(const CSettingHandle &handle) const
+{
+  CValueReader reader(*this);
+  const CSettingHandle::Value *value = GetValue(handle, SettingTypeBool);
+  if (value == NULL)
     return false;
 
-  return ((CSettingBool*)setting)->GetValue();
+  return value->boolean;
 }
 
 bool CSettingsManager::SetBool(const std::string &id, bool value)
@@ -533,12 +603,17 @@ bool CSettingsManager::ToggleBool(const std::string &id)
 
 int CSettingsManager::GetInt(const std::string &id) const
 {
-  CSharedLock lock(m_settingsCritical);
-  CSetting *setting = GetSetting(id);
-  if (setting == NULL || setting->GetType() != SettingTypeInteger)
+  return GetInt(GetHandle(id));
+}
+
+int CSettingsManager::GetInt(const CSettingHandle &handle) const
+{
+  CValueReader reader(*this);
+  const CSettingHandle::Value *value = GetValue(handle, SettingTypeInteger);
+  if (value == NULL)
     return 0;
 
-  return ((CSettingInt*)setting)->GetValue();
+  return value->integer;
 }
 
 bool CSettingsManager::SetInt(const std::string &id, int value)
@@ -553,12 +628,17 @@ bool CSettingsManager::SetInt(const std::string &id, int value)
 
 double CSettingsManager::GetNumber(const std::string &id) const
 {
-  CSharedLock lock(m_settingsCritical);
-  CSetting *setting = GetSetting(id);
-  if (setting == NULL || setting->GetType() != SettingTypeNumber)
+  return GetNumber(GetHandle(id));
+}
+
+double CSettingsManager::GetNumber(const CSettingHandle &handle) const
+{
+  CValueReader reader(*this);
+  const CSettingHandle::Value *value = GetValue(handle, SettingTypeNumber);
+  if (value == NULL)
     return 0.0;
 
-  return ((CSettingNumber*)setting)->GetValue();
+  return value->number;
 }
 
 bool CSettingsManager::SetNumber(const std::string &id, double value)
@@ -573,12 +653,17 @@ bool CSettingsManager::SetNumber(const std::string &id, double value)
 
 std::string CSettingsManager::GetString(const std::string &id) const
 {
-  CSharedLock lock(m_settingsCritical);
-  CSetting *setting = GetSetting(id);
-  if (setting == NULL || setting->GetType() != SettingTypeString)
+  return GetString(GetHandle(id));
+}
+
+std::string CSettingsManager::GetString(const CSettingHandle &handle) const
+{
+  CValueReader reader(*this);
+  const CSettingHandle::Value *value = GetValue(handle, SettingTypeString);
+  if (value == NULL)
     return "";
 
-  return ((CSettingString*)setting)->GetValue();
+  return value->string;
 }
 
 bool CSettingsManager::SetString(const std::string &id, const std::string &value)
@@ -729,13 +814,21 @@ bool CSettingsManager::OnSettingChanging(const CSetting *setting)
 void CSettingsManager::OnSettingChanged(const CSetting *setting)
 {
   CSharedLock lock(m_settingsCritical);
-  if (!m_loaded || setting == NULL)
+  if (setting == NULL)
     return;
     
   SettingMap::const_iterator settingIt = m_settings.find(setting->GetId());
   if (settingIt == m_settings.end())
     return;
 
+  // publish the new value before notifying anyone so that callbacks
+  // reading the setting through its handle see the value they are told
+  // about. Values rejected in OnSettingChanging() are never published.
+  PublishValue(settingIt->second.slot, setting);
+
+  if (!m_loaded)
+    return;
+
   Setting settingData = settingIt->second;
   // now that we have a copy of the setting's data, we can leave the lock
   lock.Leave();
@@ -1062,6 +1155,95 @@ void CSettingsManager::UpdateSettingByDependency(const std::string &settingId, c
   }
 }
 
+const CSettingHandle::Value* CSettingsManager::GetValue(const CSettingHandle &handle, int type) const
+{
+  if (handle.m_slot == NULL || handle.m_slot->type != type)
+    return NULL;
+
+  return handle.m_slot->value;
+}
+
+void CSettingsManager::PublishValue(CSettingHandle::Slot *slot, const CSetting *setting)
+{
+  if (slot == NULL || setting == NULL)
+    return;
+
+  CSettingHandle::Value *value = new CSettingHandle::Value();
+  switch (slot->type)
+  {
+    case SettingTypeBool:
+      value->boolean = ((const CSettingBool*)setting)->GetValue();
+      break;
+
+    case SettingTypeInteger:
+      value->integer = ((const CSettingInt*)setting)->GetValue();
+      break;
+
+    case SettingTypeNumber:
+      value->number = ((const CSettingNumber*)setting)->GetValue();
+      break;
+
+    case SettingTypeString:
+      value->string = ((const CSettingString*)setting)->GetValue();
+      break;
+
+    default:
+      delete value;
+      return;
+  }
+
+  // publishing is serialized by the lock, the casptr() only provides the
+  // barrier making the new value visible before the pointer to it
+  CSingleLock lock(m_valuesCritical);
+  const CSettingHandle::Value *oldValue = slot->value;
+  casptr((void* volatile*)&slot->value, (void*)oldValue, (void*)value);
+  if (oldValue != NULL)
+    m_retiredValues[m_epoch & 1].push_back(oldValue);
+
+  ReleaseRetiredValues(false);
+}
+
+void CSettingsManager::ReleaseRetiredValues(bool all)
+{
+  CSingleLock lock(m_valuesCritical);
+  if (all)
+  {
+    for (int epoch = 0; epoch < 2; epoch++)
+    {
+      for (std::vector<const CSettingHandle::Value*>::iterator value = m_retiredValues[epoch].begin(); value != m_retiredValues[epoch].end(); ++value)
+        delete *value;
+      m_retiredValues[epoch].clear();
+    }
+    return;
+  }
+
+  // the values retired during the previous epoch were replaced before the
+  // current one started, so only readers counted for the previous epoch can
+  // still hold on to them. Once those are gone the values are freed and a new
+  // epoch starts, counting its readers where the previous one did.
+  int previous = (m_epoch + 1) & 1;
+  if (AtomicAdd(&m_readers[previous], 0) != 0)
+    return;
+
+  for (std::vector<const CSettingHandle::Value*>::iterator value = m_retiredValues[previous].begin(); value != m_retiredValues[previous].end(); ++value)
+    delete *value;
+  m_retiredValues[previous].clear();
+  AtomicIncrement(&m_epoch);
+}
+
+CSettingsManager::CValueReader::CValueReader(const CSettingsManager &manager)
+  : m_readers(&manager.m_readers[manager.m_epoch & 1])
+{
+  // the value is read after registering, so any value retired before this
+  // can't be seen anymore
+  AtomicIncrement(m_readers);
+}
+
+CSettingsManager::CValueReader::~CValueReader()
+{
+  AtomicDecrement(m_readers);
+}
+
 void CSettingsManager::RegisterSettingOptionsFiller(const std::string &identifier, void *filler, SettingOptionsFillerType type)
 {
   CExclusiveLock lock(m_critical);
@@ -33,6 +33,8 @@
 #include "SettingConditions.h"
 #include "SettingDefinitions.h"
 #include "SettingDependency.h"
+#include "SettingHandle.h"
+#include "threads/CriticalSection.h"
 #include "threads/SharedSection.h"
 
 class CSettingSection;
@@ -127,7 +129,7 @@ public:
    This manual trigger is necessary to enable the ISettingCallback methods
    being executed.
    */
-  void SetLoaded() { m_loaded = true; }
+  void SetLoaded();
 
   void AddSection(CSettingSection *section);
 
@@ -273,6 +275,47 @@ public:
    */
   SettingDependencyMap GetDependencies(const CSetting *setting) const;
 
+  /*!
+   \brief Gets a handle to the setting with the given identifier.
+
+   The handle can be used to read the value of the setting without looking
+   up the identifier again and without taking any locks. It stays valid until
+   the settings manager is cleared.
+
+   \param id Setting identifier
+   \return Handle to the setting or an invalid handle if the identifier is unknown
+   */
+  CSettingHandle GetHandle(const std::string &id) const;
+
+  /*!
+   \brief Gets the boolean value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Boolean value of the setting with the given handle
+   */
+  bool GetBool(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the integer value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Integer value of the setting with the given handle
+   */
+  int GetInt(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the real number value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return Real number value of the setting with the given handle
+   */
+  double GetNumber(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the string value of the setting with the given handle.
+
+   \param handle Setting handle
+   \return String value of the setting with the given handle
+   */
+  std::string GetString(const CSettingHandle &handle) const;
+
   /*!
    \brief Gets the boolean value of the setting with the given identifier.
 
@@ -418,11 +461,30 @@ private:
 
   void RegisterSettingOptionsFiller(const std::string &identifier, void *filler, SettingOptionsFillerType type);
 
+  /*!
+   \brief Registers the current thread as a reader of published values for its lifetime.
+   Values retired while a reader is registered aren't freed until it is gone.
+   */
+  class CValueReader
+  {
+  public:
+    CValueReader(const CSettingsManager &manager);
+    ~CValueReader();
+  private:
+    volatile long *m_readers;
+  };
+  friend class CValueReader;
+
+  const CSettingHandle::Value* GetValue(const CSettingHandle &handle, int type) const;
+  void PublishValue(CSettingHandle::Slot *slot, const CSetting *setting);
+  void ReleaseRetiredValues(bool all);
+
   typedef std::set<ISettingCallback *> CallbackSet;
   typedef struct {
     CSetting *setting;
     SettingDependencyMap dependencies;
     CallbackSet callbacks;
+    CSettingHandle::Slot *slot;
   } Setting;
 
   bool m_initialized;
@@ -452,6 +514,15 @@ private:
   typedef std::map<std::string, SettingOptionsFiller> SettingOptionsFillerMap;
   SettingOptionsFillerMap m_optionsFillers;
 
+  // values replaced by a newer snapshot, readers may still hold on to them.
+  // Readers register in the counter of the current epoch. The values retired
+  // during an epoch are freed when the epoch after the next one starts, which
+  // only happens once no reader of the epoch in between is left.
+  std::vector<const CSettingHandle::Value*> m_retiredValues[2];
+  mutable volatile long m_readers[2];
+  volatile long m_epoch;
+  CCriticalSection m_valuesCritical;
+
   CSharedSection m_critical;
   CSharedSection m_settingsCritical;
 };
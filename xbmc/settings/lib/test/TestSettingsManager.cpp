@@ -0,0 +1,214 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "settings/lib/SettingsManager.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+static const char *definitions =
+  "<settings>"
+  "  <section id=\"test\">"
+  "    <category id=\"test\">"
+  "      <group id=\"1\">"
+  "        <setting id=\"test.bool\" type=\"boolean\"><default>true</default></setting>"
+  "        <setting id=\"test.int\" type=\"integer\"><default>42</default></setting>"
+  "        <setting id=\"test.number\" type=\"number\"><default>1.5</default></setting>"
+  "        <setting id=\"test.string\" type=\"string\"><default>default</default></setting>"
+  "      </group>"
+  "    </category>"
+  "  </section>"
+  "</settings>";
+
+class TestSettingsManager : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    CXBMCTinyXML doc;
+    doc.Parse(definitions);
+    ASSERT_TRUE(m_settingsManager.Initialize(doc.RootElement()));
+    m_settingsManager.SetInitialized();
+    m_settingsManager.SetLoaded();
+  }
+
+  CSettingsManager m_settingsManager;
+};
+
+TEST_F(TestSettingsManager, Handles)
+{
+  CSettingHandle boolHandle = m_settingsManager.GetHandle("test.bool");
+  CSettingHandle intHandle = m_settingsManager.GetHandle("Test.Int");
+  CSettingHandle numberHandle = m_settingsManager.GetHandle("test.number");
+  CSettingHandle stringHandle = m_settingsManager.GetHandle("test.string");
+  ASSERT_TRUE(boolHandle.IsValid());
+  ASSERT_TRUE(intHandle.IsValid());
+  EXPECT_TRUE(intHandle == m_settingsManager.GetHandle("test.int"));
+  EXPECT_FALSE(m_settingsManager.GetHandle("test.unknown").IsValid());
+
+  EXPECT_TRUE(m_settingsManager.GetBool(boolHandle));
+  EXPECT_EQ(42, m_settingsManager.GetInt(intHandle));
+  EXPECT_EQ(1.5, m_settingsManager.GetNumber(numberHandle));
+  EXPECT_STREQ("default", m_settingsManager.GetString(stringHandle).c_str());
+
+  EXPECT_TRUE(m_settingsManager.SetBool("test.bool", false));
+  EXPECT_TRUE(m_settingsManager.SetInt("test.int", 7));
+  EXPECT_TRUE(m_settingsManager.SetNumber("test.number", 2.5));
+  EXPECT_TRUE(m_settingsManager.SetString("test.string", "changed"));
+  EXPECT_FALSE(m_settingsManager.GetBool(boolHandle));
+  EXPECT_EQ(7, m_settingsManager.GetInt(intHandle));
+  EXPECT_EQ(2.5, m_settingsManager.GetNumber(numberHandle));
+  EXPECT_STREQ("changed", m_settingsManager.GetString(stringHandle).c_str());
+  EXPECT_STREQ("changed", m_settingsManager.GetString("test.string").c_str());
+
+  // wrong types and invalid handles read as the type's default
+  EXPECT_EQ(0, m_settingsManager.GetInt(boolHandle));
+  EXPECT_STREQ("", m_settingsManager.GetString(intHandle).c_str());
+  EXPECT_FALSE(m_settingsManager.GetBool(CSettingHandle()));
+
+  // unloading resets the published values as well
+  m_settingsManager.Unload();
+  EXPECT_TRUE(m_settingsManager.GetBool(boolHandle));
+  EXPECT_STREQ("default", m_settingsManager.GetString(stringHandle).c_str());
+}
+
+class CChangeOrderCallback : public ISettingCallback
+{
+public:
+  CChangeOrderCallback(CSettingsManager &settingsManager)
+    : m_settingsManager(settingsManager),
+      m_handle(settingsManager.GetHandle("test.string"))
+  { }
+
+  virtual bool OnSettingChanging(const CSetting *setting)
+  {
+    const std::string &value = ((const CSettingString*)setting)->GetValue();
+    m_events.push_back(StringUtils::Format("changing %s, handle %s", value.c_str(), m_settingsManager.GetString(m_handle).c_str()));
+    return value != "rejected";
+  }
+
+  virtual void OnSettingChanged(const CSetting *setting)
+  {
+    const std::string &value = ((const CSettingString*)setting)->GetValue();
+    m_events.push_back(StringUtils::Format("changed %s, handle %s", value.c_str(), m_settingsManager.GetString(m_handle).c_str()));
+  }
+
+  CSettingsManager &m_settingsManager;
+  CSettingHandle m_handle;
+  std::vector<std::string> m_events;
+};
+
+TEST_F(TestSettingsManager, ChangeNotificationOrder)
+{
+  CChangeOrderCallback callback(m_settingsManager);
+  std::set<std::string> settings;
+  settings.insert("test.string");
+  m_settingsManager.RegisterCallback(&callback, settings);
+
+  // a change is only visible through the handle once it has been accepted,
+  // and it is visible to every callback notified about it
+  EXPECT_TRUE(m_settingsManager.SetString("test.string", "first"));
+  EXPECT_FALSE(m_settingsManager.SetString("test.string", "rejected"));
+  EXPECT_STREQ("first", m_settingsManager.GetString(callback.m_handle).c_str());
+  EXPECT_TRUE(m_settingsManager.SetString("test.string", "second"));
+
+  m_settingsManager.UnregisterCallback(&callback);
+
+  const char *expected[] = {
+    "changing first, handle default",
+    "changed first, handle first",
+    "changing rejected, handle first",
+    // the rejected value is rolled back and the callbacks are told so
+    "changing first, handle first",
+    "changing second, handle first",
+    "changed second, handle second"
+  };
+  ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), callback.m_events.size());
+  for (unsigned int i = 0; i < callback.m_events.size(); i++)
+    EXPECT_STREQ(expected[i], callback.m_events[i].c_str());
+}
+
+class CSettingReader : public CThread
+{
+public:
+  CSettingReader(const CSettingsManager &settingsManager, unsigned int reads)
+    : CThread("SettingReader"),
+      m_errors(0),
+      m_settingsManager(settingsManager),
+      m_reads(reads)
+  { }
+
+  unsigned int m_errors;
+
+protected:
+  virtual void Process()
+  {
+    CSettingHandle intHandle = m_settingsManager.GetHandle("test.int");
+    CSettingHandle stringHandle = m_settingsManager.GetHandle("test.string");
+    for (unsigned int i = 0; i < m_reads; i++)
+    {
+      // the writer keeps the string in step with the int, both values must
+      // be whole and one of the values written
+      int value = m_settingsManager.GetInt(intHandle);
+      std::string text = m_settingsManager.GetString(stringHandle);
+      if (value < 0 || (text != "default" && text.compare(0, 6, "value ") != 0))
+        m_errors++;
+      if (m_settingsManager.GetInt("test.int") < 0)
+        m_errors++;
+    }
+  }
+
+  const CSettingsManager &m_settingsManager;
+  unsigned int m_reads;
+};
+
+TEST_F(TestSettingsManager, ConcurrentReads)
+{
+  static const unsigned int threads = 4;
+  static const unsigned int reads = 20000;
+
+  std::vector<CSettingReader*> readers;
+  for (unsigned int i = 0; i < threads; i++)
+    readers.push_back(new CSettingReader(m_settingsManager, reads));
+  for (unsigned int i = 0; i < threads; i++)
+    readers[i]->Create();
+
+  // keep changing the settings while the readers are busy
+  int writes = 0;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    while (!readers[i]->WaitForThreadExit(1))
+    {
+      writes++;
+      m_settingsManager.SetInt("test.int", writes);
+      m_settingsManager.SetString("test.string", StringUtils::Format("value %i", writes));
+    }
+  }
+
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    EXPECT_EQ(0u, readers[i]->m_errors);
+    delete readers[i];
+  }
+  if (writes > 0)
+    EXPECT_STREQ(StringUtils::Format("value %i", writes).c_str(), m_settingsManager.GetString("test.string").c_str());
+}
@@ -0,0 +1,227 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "FileItemListSnapshot.h"
+#include "filesystem/File.h"
+#include "utils/Archive.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+#include "video/VideoInfoTag.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+static void FillList(CFileItemList &items, unsigned int count)
+{
+  items.SetPath("videodb://movies/titles/");
+  items.SetContent("movies");
+  items.AddSortMethod(SortByLabel, 551, LABEL_MASKS("%T", "%R"));
+
+  CFileItemPtr parent(new CFileItem(".."));
+  parent->SetPath("videodb://movies/");
+  items.Add(parent);
+
+  for (unsigned int i = 0; i < count; i++)
+  {
+    CVideoInfoTag tag;
+    tag.m_strTitle = StringUtils::Format("Movie %u", i);
+    tag.m_strPlot = StringUtils::Format("Plot of movie %u, long enough to matter when decoding a few thousand of them.", i);
+    tag.m_genre.push_back(i % 2 ? "Drama" : "Comedy");
+    tag.m_iYear = 1950 + i % 60;
+    tag.m_strFileNameAndPath = StringUtils::Format("/media/movies/movie%05u.mkv", i);
+
+    CFileItemPtr item(new CFileItem(tag));
+    item->SetPath(tag.m_strFileNameAndPath);
+    item->SetLabel(tag.m_strTitle);
+    item->SetLabel2(StringUtils::Format("%i", tag.m_iYear));
+    item->SetIconImage("DefaultVideo.png");
+    item->SetArt("thumb", StringUtils::Format("image://movie%05u.jpg/", i));
+    item->SetProperty("index", (int)i);
+    items.Add(item);
+  }
+}
+
+class TestFileItemListSnapshot : public testing::Test
+{
+protected:
+  TestFileItemListSnapshot() : m_file(NULL) {}
+
+  virtual void SetUp()
+  {
+    m_file = XBMC_CREATETEMPFILE(".fi");
+    ASSERT_TRUE(m_file != NULL);
+    m_file->Close();
+    m_path = XBMC_TEMPFILEPATH(m_file);
+  }
+
+  virtual void TearDown()
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  XFILE::CFile *m_file;
+  std::string m_path;
+};
+
+TEST_F(TestFileItemListSnapshot, RoundTrip)
+{
+  CFileItemList items;
+  FillList(items, 100);
+  ASSERT_TRUE(CFileItemListSnapshot::Save(items, m_path));
+
+  CFileItemListSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Open(m_path));
+  EXPECT_EQ(100u, snapshot.Size());
+
+  CFileItemPtr summary = snapshot.GetSummary(42);
+  ASSERT_TRUE(summary != NULL);
+  EXPECT_STREQ("/media/movies/movie00042.mkv", summary->GetPath().c_str());
+  EXPECT_STREQ("Movie 42", summary->GetLabel().c_str());
+  EXPECT_STREQ("1992", summary->GetLabel2().c_str());
+  EXPECT_STREQ("DefaultVideo.png", summary->GetIconImage().c_str());
+  EXPECT_EQ("image://movie00042.jpg/", summary->GetArt("thumb"));
+  EXPECT_FALSE(summary->HasVideoInfoTag());
+  EXPECT_TRUE(snapshot.GetSummary(100) == NULL);
+
+  CFileItemPtr item = snapshot.Get(42);
+  ASSERT_TRUE(item != NULL);
+  ASSERT_TRUE(item->HasVideoInfoTag());
+  EXPECT_STREQ("Movie 42", item->GetVideoInfoTag()->m_strTitle.c_str());
+  EXPECT_EQ(42, item->GetProperty("index").asInteger());
+  EXPECT_TRUE(snapshot.Get(42) == item);
+
+  // loading keeps the parent folder of the list it replaces
+  CFileItemList loaded;
+  CFileItemPtr parent(new CFileItem(".."));
+  loaded.Add(parent);
+  ASSERT_TRUE(snapshot.Load(loaded));
+  ASSERT_EQ(101, loaded.Size());
+  EXPECT_TRUE(loaded[0]->IsParentFolder());
+  EXPECT_STREQ("movies", loaded.GetContent().c_str());
+  EXPECT_STREQ("videodb://movies/titles/", loaded.GetPath().c_str());
+  ASSERT_EQ(1u, loaded.GetSortDetails().size());
+  EXPECT_EQ(SortByLabel, loaded.GetSortDetails()[0].m_sortDescription.sortBy);
+  for (int i = 1; i < loaded.Size(); i++)
+    EXPECT_STREQ(items[i]->GetPath().c_str(), loaded[i]->GetPath().c_str());
+}
+
+TEST_F(TestFileItemListSnapshot, Page)
+{
+  CFileItemList items;
+  FillList(items, 100);
+  ASSERT_TRUE(CFileItemListSnapshot::Save(items, m_path));
+
+  // only the page is decoded, everything else is a summary
+  CFileItemListSnapshot snapshot;
+  CFileItemList loaded;
+  ASSERT_TRUE(snapshot.Open(m_path));
+  ASSERT_TRUE(snapshot.Load(loaded, 10, 5));
+  ASSERT_EQ(100, loaded.Size());
+  for (int i = 0; i < loaded.Size(); i++)
+  {
+    EXPECT_STREQ(items[i + 1]->GetPath().c_str(), loaded[i]->GetPath().c_str());
+    EXPECT_EQ(i >= 10 && i < 15, loaded[i]->HasVideoInfoTag()) << "item " << i;
+  }
+
+  // a page past the end decodes nothing
+  ASSERT_TRUE(snapshot.Load(loaded, 200, 5));
+  EXPECT_EQ(100, loaded.Size());
+  EXPECT_FALSE(loaded[99]->HasVideoInfoTag());
+}
+
+TEST_F(TestFileItemListSnapshot, SameProperties)
+{
+  CFileItemList items;
+  FillList(items, 10);
+  items.SetCacheToDisc(CFileItemList::CACHE_ALWAYS);
+  items.SetSortIgnoreFolders(true);
+  items.AddSortMethod(SortByYear, 562, LABEL_MASKS("%T", "%Y"));
+  ASSERT_TRUE(CFileItemListSnapshot::Save(items, m_path));
+
+  // list properties are written by CFileItemList::Archive itself
+  std::vector<uint8_t> buffer;
+  {
+    CArchive ar(buffer);
+    ar << items;
+  }
+  CFileItemList archived;
+  {
+    CArchive ar(&buffer[0], buffer.size());
+    ar >> archived;
+  }
+
+  CFileItemListSnapshot snapshot;
+  CFileItemList loaded;
+  ASSERT_TRUE(snapshot.Open(m_path));
+  ASSERT_TRUE(snapshot.Load(loaded));
+
+  EXPECT_EQ(archived.Size(), loaded.Size());
+  EXPECT_STREQ(archived.GetContent().c_str(), loaded.GetContent().c_str());
+  EXPECT_EQ(archived.CacheToDiscAlways(), loaded.CacheToDiscAlways());
+  ASSERT_EQ(archived.GetSortDetails().size(), loaded.GetSortDetails().size());
+  for (unsigned int i = 0; i < loaded.GetSortDetails().size(); i++)
+  {
+    const SORT_METHOD_DETAILS &a = archived.GetSortDetails()[i];
+    const SORT_METHOD_DETAILS &b = loaded.GetSortDetails()[i];
+    EXPECT_EQ(a.m_sortDescription.sortBy, b.m_sortDescription.sortBy);
+    EXPECT_EQ(a.m_buttonLabel, b.m_buttonLabel);
+    EXPECT_STREQ(a.m_labelMasks.m_strLabel2File.c_str(), b.m_labelMasks.m_strLabel2File.c_str());
+  }
+}
+
+TEST_F(TestFileItemListSnapshot, RejectsArchive)
+{
+  CFileItemList items;
+  FillList(items, 10);
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(m_path, true));
+  CArchive ar(&file, CArchive::store);
+  ar << items;
+  ar.Close();
+  file.Close();
+
+  CFileItemListSnapshot snapshot;
+  EXPECT_FALSE(snapshot.Open(m_path));
+  EXPECT_FALSE(snapshot.IsOpen());
+  EXPECT_EQ(0u, snapshot.Size());
+}
+
+TEST_F(TestFileItemListSnapshot, RejectsTruncated)
+{
+  CFileItemList items;
+  FillList(items, 10);
+  ASSERT_TRUE(CFileItemListSnapshot::Save(items, m_path));
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(m_path));
+  std::vector<uint8_t> data((size_t)file.GetLength());
+  file.Read(&data[0], data.size());
+  file.Close();
+
+  ASSERT_TRUE(file.OpenForWrite(m_path, true));
+  file.Write(&data[0], data.size() / 2);
+  file.Close();
+
+  CFileItemListSnapshot snapshot;
+  EXPECT_FALSE(snapshot.Open(m_path));
+}
@@ -0,0 +1,110 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "settings/SkinSettings.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+using namespace INFO;
+
+TEST(TestGUIInfoManager, Categories)
+{
+  InfoPtr skin = g_infoManager.Register("Skin.HasSetting(testcategories)", 0);
+  InfoPtr player = g_infoManager.Register("Player.HasVideo", 0);
+  InfoPtr time = g_infoManager.Register("System.Time(00:00-23:59)", 0);
+  InfoPtr window = g_infoManager.Register("Window.IsActive(home)", 0);
+  InfoPtr mixed = g_infoManager.Register("Skin.HasSetting(testcategories) + !Player.HasVideo", 0);
+  InfoPtr constant = g_infoManager.Register("true", 0);
+
+  EXPECT_EQ((unsigned int)CATEGORY_SKIN, skin->GetCategories());
+  EXPECT_EQ((unsigned int)CATEGORY_PLAYER, player->GetCategories());
+  EXPECT_EQ((unsigned int)CATEGORY_TIME, time->GetCategories());
+  EXPECT_EQ((unsigned int)CATEGORY_WINDOW, window->GetCategories());
+  EXPECT_EQ((unsigned int)(CATEGORY_SKIN | CATEGORY_PLAYER), mixed->GetCategories());
+  EXPECT_EQ(0u, constant->GetCategories());
+
+  // skin settings are picked up on the next frame
+  int setting = CSkinSettings::Get().TranslateBool("testcategories");
+  CSkinSettings::Get().SetBool(setting, false);
+  g_infoManager.ResetChangedCache();
+  EXPECT_FALSE(skin->Get());
+  EXPECT_FALSE(mixed->Get());
+
+  CSkinSettings::Get().SetBool(setting, true);
+  EXPECT_FALSE(skin->Get());
+  g_infoManager.ResetChangedCache();
+  EXPECT_TRUE(skin->Get());
+  EXPECT_TRUE(mixed->Get());
+}
+
+TEST(TestGUIInfoManager, ResetChangedCache)
+{
+  static const unsigned int frames = 20;
+
+  // the mix of conditions of a large skin: mostly skin settings and player
+  // state, a good share of window and focus conditions, a few on the library
+  // and time of day. The context keeps otherwise equal conditions apart, as
+  // they are in windows of a real skin.
+  g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, true);
+  g_infoManager.SetLibraryBool(LIBRARY_HAS_TVSHOWS, false);
+  std::vector<InfoPtr> bools;
+  for (int i = 0; i < 200; i++)
+  {
+    int context = 10000 + i % 50;
+    bools.push_back(g_infoManager.Register(StringUtils::Format("Skin.HasSetting(testchanged%i)", i), context));
+    bools.push_back(g_infoManager.Register(StringUtils::Format("!Skin.HasSetting(testchanged%i) + Player.HasVideo", i), context));
+    bools.push_back(g_infoManager.Register(StringUtils::Format("Skin.String(testchanged%i)", i % 100), context));
+    if (i % 2)
+      bools.push_back(g_infoManager.Register(StringUtils::Format("[Player.HasAudio | Player.Paused] + !Skin.HasSetting(testchanged%i)", i), context));
+    if (i % 3)
+      bools.push_back(g_infoManager.Register(StringUtils::Format("Control.HasFocus(%i)", i % 300), context));
+    if (i % 4 == 0)
+      bools.push_back(g_infoManager.Register("Window.IsActive(home) | Window.IsActive(videos)", context));
+    if (i % 10 == 0)
+    {
+      bools.push_back(g_infoManager.Register("Library.HasContent(movies) | Library.HasContent(tvshows)", context));
+      bools.push_back(g_infoManager.Register("System.Time(06:00-18:00) + Playlist.IsRandom", context));
+    }
+  }
+
+  unsigned int dirty[2] = { 0, 0 };
+  for (int changedOnly = 0; changedOnly < 2; changedOnly++)
+  {
+    // start both runs from a fully evaluated cache
+    g_infoManager.ResetCache();
+    g_infoManager.ResetChangedCache();
+    for (unsigned int j = 0; j < bools.size(); j++)
+      bools[j]->Get();
+
+    for (unsigned int i = 0; i < frames; i++)
+    {
+      if (changedOnly)
+        dirty[changedOnly] += g_infoManager.ResetChangedCache();
+      else
+        dirty[changedOnly] += g_infoManager.ResetCache();
+      for (unsigned int j = 0; j < bools.size(); j++)
+        bools[j]->Get();
+    }
+  }
+
+  EXPECT_LT(dirty[1], dirty[0] / 2);
+}
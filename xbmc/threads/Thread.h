@@ -79,6 +79,8 @@ public:
   int64_t GetAbsoluteUsage();
   // -----------------------------------------------------------------------------------
 
+  const std::string& GetName() const { return m_ThreadName; }
+
   static bool IsCurrentThread(const ThreadIdentifier tid);
   static ThreadIdentifier GetCurrentThreadId();
   static CThread* GetCurrentThread();
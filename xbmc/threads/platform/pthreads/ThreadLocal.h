@@ -26,13 +26,14 @@ namespace XbmcThreads
 {
   /**
    * A thin wrapper around pthreads thread specific storage
-   * functionality.
+   * functionality. The cleanup function, if given, is called with the
+   * value of a thread when the thread exits.
    */
   template <typename T> class ThreadLocal
   {
     pthread_key_t key;
   public:
-    inline ThreadLocal() : key(0) { pthread_key_create(&key,NULL); }
+    inline ThreadLocal(void (*cleanup)(T*) = NULL) : key(0) { pthread_key_create(&key,(void (*)(void*))cleanup); }
 
     inline ~ThreadLocal() { pthread_key_delete(key); }
 
@@ -27,31 +27,76 @@ namespace XbmcThreads
 {
   /**
    * A thin wrapper around windows thread specific storage
-   * functionality.
+   * functionality. The cleanup function, if given, is called with the
+   * value of a thread when the thread exits. Only fiber local storage
+   * calls back on exit, so these keep the value in a holder which knows
+   * the function.
    */
   template <typename T> class ThreadLocal
   {
+    struct Holder
+    {
+      T* val;
+      ThreadLocal* owner;
+    };
+
     DWORD key;
+    void (*cleanup)(T*);
+    bool destroying;
+
+    static void NTAPI Release(PVOID data)
+    {
+      Holder* holder = (Holder*)data;
+      // FlsFree() calls back for every thread, which isn't exiting
+      if (holder->val && !holder->owner->destroying)
+        holder->owner->cleanup(holder->val);
+      delete holder;
+    }
+
   public:
-    inline ThreadLocal()
+    inline ThreadLocal(void (*cleanup_)(T*) = NULL) : cleanup(cleanup_), destroying(false)
     {
-       if ((key = TlsAlloc()) == TLS_OUT_OF_INDEXES)
+       if ((key = cleanup ? FlsAlloc(Release) : TlsAlloc()) == TLS_OUT_OF_INDEXES)
           throw XbmcCommons::UncheckedException("Ran out of Windows TLS Indexes. Windows Error Code %d",(int)GetLastError());
     }
 
     inline ~ThreadLocal() 
     {
-       if (!TlsFree(key))
+       destroying = true;
+       if (!(cleanup ? FlsFree(key) : TlsFree(key)))
           throw XbmcCommons::UncheckedException("Failed to free Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
     }
 
     inline void set(T* val)
     {
-       if (!TlsSetValue(key,(LPVOID)val))
+       if (cleanup)
+       {
+          Holder* holder = (Holder*)FlsGetValue(key);
+          if (holder == NULL)
+          {
+             holder = new Holder;
+             holder->owner = this;
+             if (!FlsSetValue(key,(PVOID)holder))
+             {
+                delete holder;
+                throw XbmcCommons::UncheckedException("Failed to set Fls %d, Windows Error Code %d",(int)key, (int)GetLastError());
+             }
+          }
+          holder->val = val;
+       }
+       else if (!TlsSetValue(key,(LPVOID)val))
           throw XbmcCommons::UncheckedException("Failed to set Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
     }
 
-    inline T* get() { return (T*)TlsGetValue(key); }
+    inline T* get()
+    {
+       if (cleanup)
+       {
+          Holder* holder = (Holder*)FlsGetValue(key);
+          return holder ? holder->val : NULL;
+       }
+       return (T*)TlsGetValue(key);
+    }
   };
 }
 
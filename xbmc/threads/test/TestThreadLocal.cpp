@@ -166,3 +166,35 @@ TEST(TestThreadLocal, HeapDestroyed)
   cleanup();
 }
 
+
+CEvent cleanedUp;
+void deleteThinggy(Thinggy* thinggy)
+{
+  delete thinggy;
+  cleanedUp.Set();
+}
+
+class CleanupThreadLocal : public IRunnable
+{
+public:
+  ThreadLocal<Thinggy> threadLocal;
+  inline CleanupThreadLocal() : threadLocal(deleteThinggy) {}
+  inline void Run()
+  {
+    threadLocal.set(new Thinggy);
+    threadLocal.set(threadLocal.get());
+  }
+};
+
+TEST(TestThreadLocal, Cleanup)
+{
+  CleanupThreadLocal runnable;
+  thread t(runnable);
+  t.join();
+
+  // the value of the thread is cleaned up once it exits
+  EXPECT_TRUE(cleanedUp.WaitMSec(10000));
+  EXPECT_TRUE(destructorCalled);
+  EXPECT_TRUE(runnable.threadLocal.get() == NULL);
+  destructorCalled = false;
+}
@@ -34,6 +34,7 @@ using namespace XFILE;
 CArchive::CArchive(CFile* pFile, int mode)
 {
   m_pFile = pFile;
+  m_pMemory = NULL;
   m_iMode = mode;
 
   m_pBuffer = new uint8_t[CARCHIVE_BUFFER_MAX];
@@ -50,6 +51,29 @@ CArchive::CArchive(CFile* pFile, int mode)
   }
 }
 
+CArchive::CArchive(const uint8_t *data, size_t size)
+{
+  m_pFile = NULL;
+  m_pMemory = NULL;
+  m_iMode = load;
+
+  // read straight from the caller's memory, there is nothing to refill
+  m_pBuffer = NULL;
+  m_BufferPos = const_cast<uint8_t*>(data);
+  m_BufferRemain = size;
+}
+
+CArchive::CArchive(std::vector<uint8_t> &buffer)
+{
+  m_pFile = NULL;
+  m_pMemory = &buffer;
+  m_iMode = store;
+
+  m_pBuffer = new uint8_t[CARCHIVE_BUFFER_MAX];
+  m_BufferPos = m_pBuffer;
+  m_BufferRemain = CARCHIVE_BUFFER_MAX;
+}
+
 CArchive::~CArchive()
 {
   FlushBuffer();
@@ -377,7 +401,10 @@ void CArchive::FlushBuffer()
 {
   if (m_iMode == store && m_BufferPos != m_pBuffer)
   {
-    m_pFile->Write(m_pBuffer, m_BufferPos - m_pBuffer);
+    if (m_pMemory)
+      m_pMemory->insert(m_pMemory->end(), m_pBuffer, m_BufferPos);
+    else
+      m_pFile->Write(m_pBuffer, m_BufferPos - m_pBuffer);
     m_BufferPos = m_pBuffer;
     m_BufferRemain = CARCHIVE_BUFFER_MAX;
   }
@@ -400,7 +427,7 @@ CArchive &CArchive::streamout_bufferwrap(const uint8_t *ptr, size_t size)
 
 void CArchive::FillBuffer()
 {
-  if (m_iMode == load && m_BufferRemain == 0)
+  if (m_iMode == load && m_BufferRemain == 0 && m_pFile)
   {
     m_BufferRemain = m_pFile->Read(m_pBuffer, CARCHIVE_BUFFER_MAX);
     m_BufferPos = m_pBuffer;
@@ -32,6 +32,12 @@
 
 #include <errno.h>
 #include <iconv.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #if !defined(TARGET_WINDOWS) && defined(HAVE_CONFIG_H)
   #include "config.h"
@@ -101,7 +107,11 @@ public:
   CConverterType(const CConverterType& other);
   ~CConverterType();
 
-  iconv_t GetConverter(CSingleLock& converterLock);
+  /* Handles are taken from a pool, so conversions of the same type can run
+     concurrently. A handle is only used by the thread that acquired it and
+     has to be given back with the generation it was acquired with. */
+  iconv_t AcquireConverter(unsigned int& generation);
+  void ReleaseConverter(iconv_t converter, unsigned int generation);
 
   void Reset(void);
   void ReinitTo(const std::string& sourceCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen = 1);
@@ -116,7 +126,8 @@ private:
   std::string         m_sourceCharset;
   enum SpecialCharset m_targetSpecialCharset;
   std::string         m_targetCharset;
-  iconv_t             m_iconv;
+  std::vector<iconv_t> m_freeIconvs;
+  unsigned int        m_generation;
   unsigned int        m_targetSingleCharMaxLen;
 };
 
@@ -125,7 +136,7 @@ CConverterType::CConverterType(const std::string& sourceCharset, const std::stri
   m_sourceCharset(sourceCharset),
   m_targetSpecialCharset(NotSpecialCharset),
   m_targetCharset(targetCharset),
-  m_iconv(NO_ICONV),
+  m_generation(0),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
@@ -135,7 +146,7 @@ CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, const s
   m_sourceCharset(),
   m_targetSpecialCharset(NotSpecialCharset),
   m_targetCharset(targetCharset),
-  m_iconv(NO_ICONV),
+  m_generation(0),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
@@ -145,7 +156,7 @@ CConverterType::CConverterType(const std::string& sourceCharset, enum SpecialCha
   m_sourceCharset(sourceCharset),
   m_targetSpecialCharset(targetSpecialCharset),
   m_targetCharset(),
-  m_iconv(NO_ICONV),
+  m_generation(0),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
@@ -155,7 +166,7 @@ CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, enum Sp
   m_sourceCharset(),
   m_targetSpecialCharset(targetSpecialCharset),
   m_targetCharset(),
-  m_iconv(NO_ICONV),
+  m_generation(0),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
@@ -165,7 +176,7 @@ CConverterType::CConverterType(const CConverterType& other) : CCriticalSection()
   m_sourceCharset(other.m_sourceCharset),
   m_targetSpecialCharset(other.m_targetSpecialCharset),
   m_targetCharset(other.m_targetCharset),
-  m_iconv(NO_ICONV),
+  m_generation(0),
   m_targetSingleCharMaxLen(other.m_targetSingleCharMaxLen)
 {
 }
@@ -174,44 +185,58 @@ CConverterType::CConverterType(const CConverterType& other) : CCriticalSection()
 CConverterType::~CConverterType()
 {
   CSingleLock lock(*this);
-  if (m_iconv != NO_ICONV)
-    iconv_close(m_iconv);
+  for (std::vector<iconv_t>::iterator it = m_freeIconvs.begin(); it != m_freeIconvs.end(); ++it)
+    iconv_close(*it);
+  m_freeIconvs.clear();
   lock.Leave(); // ensure unlocking before final destruction
 }
 
 
-iconv_t CConverterType::GetConverter(CSingleLock& converterLock)
+iconv_t CConverterType::AcquireConverter(unsigned int& generation)
 {
-  // ensure that this unique instance is locked externally
-  if (&converterLock.get_underlying() != this)
-    return NO_ICONV;
-
-  if (m_iconv == NO_ICONV)
+  CSingleLock lock(*this);
+  generation = m_generation;
+  if (!m_freeIconvs.empty())
   {
-    if (m_sourceSpecialCharset)
-      m_sourceCharset = ResolveSpecialCharset(m_sourceSpecialCharset);
-    if (m_targetSpecialCharset)
-      m_targetCharset = ResolveSpecialCharset(m_targetSpecialCharset);
-
-    m_iconv = iconv_open(m_targetCharset.c_str(), m_sourceCharset.c_str());
-    
-    if (m_iconv == NO_ICONV)
-      CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
-                __FUNCTION__, m_sourceCharset.c_str(), m_targetCharset.c_str(), errno, strerror(errno));
+    iconv_t converter = m_freeIconvs.back();
+    m_freeIconvs.pop_back();
+    return converter;
   }
 
-  return m_iconv;
+  if (m_sourceSpecialCharset && m_sourceCharset.empty())
+    m_sourceCharset = ResolveSpecialCharset(m_sourceSpecialCharset);
+  if (m_targetSpecialCharset && m_targetCharset.empty())
+    m_targetCharset = ResolveSpecialCharset(m_targetSpecialCharset);
+
+  iconv_t converter = iconv_open(m_targetCharset.c_str(), m_sourceCharset.c_str());
+  if (converter == NO_ICONV)
+    CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
+              __FUNCTION__, m_sourceCharset.c_str(), m_targetCharset.c_str(), errno, strerror(errno));
+
+  return converter;
+}
+
+void CConverterType::ReleaseConverter(iconv_t converter, unsigned int generation)
+{
+  if (converter == NO_ICONV)
+    return;
+
+  CSingleLock lock(*this);
+  // handles acquired before a reset convert from or to the old charsets
+  if (generation == m_generation)
+    m_freeIconvs.push_back(converter);
+  else
+    iconv_close(converter);
 }
 
 
 void CConverterType::Reset(void)
 {
   CSingleLock lock(*this);
-  if (m_iconv != NO_ICONV)
-  {
-    iconv_close(m_iconv);
-    m_iconv = NO_ICONV;
-  }
+  for (std::vector<iconv_t>::iterator it = m_freeIconvs.begin(); it != m_freeIconvs.end(); ++it)
+    iconv_close(*it);
+  m_freeIconvs.clear();
+  m_generation++;
 
   if (m_sourceSpecialCharset)
     m_sourceCharset.clear();
@@ -225,11 +250,10 @@ void CConverterType::ReinitTo(const std::string& sourceCharset, const std::strin
   CSingleLock lock(*this);
   if (sourceCharset != m_sourceCharset || targetCharset != m_targetCharset)
   {
-    if (m_iconv != NO_ICONV)
-    {
-      iconv_close(m_iconv);
-      m_iconv = NO_ICONV;
-    }
+    for (std::vector<iconv_t>::iterator it = m_freeIconvs.begin(); it != m_freeIconvs.end(); ++it)
+      iconv_close(*it);
+    m_freeIconvs.clear();
+    m_generation++;
 
     m_sourceSpecialCharset = NotSpecialCharset;
     m_sourceCharset = sourceCharset;
@@ -287,6 +311,52 @@ enum StdConversionType /* Keep it in sync with CCharsetConverter::CInnerConverte
 };
 
 
+/* Unicode encodings which are converted without iconv and without any locking */
+enum NativeEncoding
+{
+  NoNativeEncoding = 0,
+  NativeUtf8,
+  NativeUtf16LE,
+  NativeUtf16BE,
+  NativeUcs2LE,
+  NativeUtf32,   /* host byte order */
+  NativeWchar    /* UTF-32 or UTF-16 in host byte order, depending on size of wchar_t */
+};
+
+struct SNativeConversion
+{
+  NativeEncoding source;
+  NativeEncoding target;
+};
+
+/* UTF-8-MAC composes decomposed characters, which is left to iconv */
+#if defined(TARGET_DARWIN)
+  #define NATIVE_UTF8_SOURCE NoNativeEncoding
+#else
+  #define NATIVE_UTF8_SOURCE NativeUtf8
+#endif
+
+static const SNativeConversion g_nativeConversions[NumberOfStdConversionTypes] = /* keep it in sync with enum StdConversionType */
+{
+  /* Utf8ToUtf32 */         { NATIVE_UTF8_SOURCE, NativeUtf32 },
+  /* Utf32ToUtf8 */         { NativeUtf32,        NativeUtf8 },
+  /* Utf32ToW */            { NativeUtf32,        NativeWchar },
+  /* WToUtf32 */            { NativeWchar,        NativeUtf32 },
+  /* SubtitleCharsetToUtf8*/{ NoNativeEncoding,   NoNativeEncoding },
+  /* Utf8ToUserCharset */   { NoNativeEncoding,   NoNativeEncoding },
+  /* UserCharsetToUtf8 */   { NoNativeEncoding,   NoNativeEncoding },
+  /* Utf32ToUserCharset */  { NoNativeEncoding,   NoNativeEncoding },
+  /* WtoUtf8 */             { NativeWchar,        NativeUtf8 },
+  /* Utf16LEtoW */          { NativeUtf16LE,      NativeWchar },
+  /* Utf16BEtoUtf8 */       { NativeUtf16BE,      NativeUtf8 },
+  /* Utf16LEtoUtf8 */       { NativeUtf16LE,      NativeUtf8 },
+  /* Utf8toW */             { NATIVE_UTF8_SOURCE, NativeWchar },
+  /* Utf8ToSystem */        { NoNativeEncoding,   NoNativeEncoding },
+  /* SystemToUtf8 */        { NoNativeEncoding,   NoNativeEncoding },
+  /* Ucs2CharsetToUtf8 */   { NativeUcs2LE,       NativeUtf8 }
+};
+
+
 /* We don't want to pollute header file with many additional includes and definitions, so put 
    here all staff that require usage of types defined in this file or in additional headers */
 class CCharsetConverter::CInnerConverter
@@ -302,6 +372,9 @@ public:
   template<class INPUT,class OUTPUT>
   static bool convert(iconv_t type, int multiplier, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar = false);
 
+  template<class INPUT,class OUTPUT>
+  static bool nativeConvert(NativeEncoding sourceEncoding, NativeEncoding targetEncoding, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar = false);
+
   static CConverterType m_stdConversion[NumberOfStdConversionTypes];
   static CCriticalSection m_critSectionFriBiDi;
 };
@@ -344,10 +417,17 @@ bool CCharsetConverter::CInnerConverter::stdConvert(StdConversionType convertTyp
   if (convertType < 0 || convertType >= NumberOfStdConversionTypes)
     return false;
 
+  const SNativeConversion& native = g_nativeConversions[convertType];
+  if (native.source != NoNativeEncoding)
+    return nativeConvert(native.source, native.target, strSource, strDest, failOnInvalidChar);
+
   CConverterType& convType = m_stdConversion[convertType];
-  CSingleLock converterLock(convType);
+  unsigned int generation;
+  iconv_t converter = convType.AcquireConverter(generation);
+  const bool result = convert(converter, convType.GetTargetSingleCharMaxLen(), strSource, strDest, failOnInvalidChar);
+  convType.ReleaseConverter(converter, generation);
 
-  return convert(convType.GetConverter(converterLock), convType.GetTargetSingleCharMaxLen(), strSource, strDest, failOnInvalidChar);
+  return result;
 }
 
 template<class INPUT,class OUTPUT>
@@ -491,6 +571,338 @@ bool CCharsetConverter::CInnerConverter::convert(iconv_t type, int multiplier, c
   return true;
 }
 
+/* Native transcoding between the Unicode encodings. Invalid input is handled
+   like iconv does: with failOnInvalidChar the conversion fails on the first
+   invalid character, otherwise the invalid code unit is skipped and an
+   incomplete character at the end of the input is dropped. */
+namespace
+{
+  enum DecodeResult
+  {
+    DecodeOk,
+    DecodeInvalid,
+    DecodeIncomplete
+  };
+
+  inline uint32_t CodeUnit(char c) { return (unsigned char)c; }
+  template<class CHAR>
+  inline uint32_t CodeUnit(CHAR c) { return (uint32_t)c; }
+
+  inline bool IsValidCodePoint(uint32_t cp)
+  {
+    return cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF);
+  }
+
+  /* length of the run of US-ASCII code units at the start of str */
+  inline size_t AsciiRun(const char* str, size_t len)
+  {
+    size_t pos = 0;
+#ifdef __SSE2__
+    for (; pos + 16 <= len; pos += 16)
+    {
+      if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(str + pos))) != 0)
+        break;
+    }
+#else
+    for (; pos + 8 <= len; pos += 8)
+    {
+      uint64_t word;
+      memcpy(&word, str + pos, sizeof(word));
+      if (word & UINT64_C(0x8080808080808080))
+        break;
+    }
+#endif
+    while (pos < len && (str[pos] & 0x80) == 0)
+      pos++;
+
+    return pos;
+  }
+
+  template<class CHAR>
+  inline size_t AsciiRun(const CHAR* str, size_t len)
+  {
+    size_t pos = 0;
+    while (pos < len && (uint32_t)str[pos] < 0x80)
+      pos++;
+
+    return pos;
+  }
+
+  struct Utf8Decoder
+  {
+    bool AsciiCompatible() const { return true; }
+
+    template<class CHAR>
+    DecodeResult operator()(const CHAR* str, size_t len, size_t& pos, uint32_t& cp) const
+    {
+      const uint32_t lead = CodeUnit(str[pos]);
+      size_t trail;
+      uint32_t minimum;
+      if (lead < 0x80)
+      {
+        cp = lead;
+        pos++;
+        return DecodeOk;
+      }
+      else if (lead >= 0xC2 && lead <= 0xDF)
+      {
+        trail = 1;
+        minimum = 0x80;
+        cp = lead & 0x1F;
+      }
+      else if ((lead & 0xF0) == 0xE0)
+      {
+        trail = 2;
+        minimum = 0x800;
+        cp = lead & 0x0F;
+      }
+      else if (lead >= 0xF0 && lead <= 0xF4)
+      {
+        trail = 3;
+        minimum = 0x10000;
+        cp = lead & 0x07;
+      }
+      else
+        return DecodeInvalid;
+
+      for (size_t i = 1; i <= trail; i++)
+      {
+        if (pos + i >= len)
+          return DecodeIncomplete;
+
+        const uint32_t c = CodeUnit(str[pos + i]);
+        if ((c & 0xC0) != 0x80)
+          return DecodeInvalid;
+        cp = (cp << 6) | (c & 0x3F);
+      }
+
+      // overlong forms, surrogates and values beyond U+10FFFF
+      if (cp < minimum || !IsValidCodePoint(cp))
+        return DecodeInvalid;
+
+      pos += trail + 1;
+      return DecodeOk;
+    }
+  };
+
+  struct Utf16Decoder
+  {
+    Utf16Decoder(bool swapBytes, bool allowSurrogates) : m_swapBytes(swapBytes), m_allowSurrogates(allowSurrogates) { }
+
+    bool AsciiCompatible() const { return !m_swapBytes; }
+
+    template<class CHAR>
+    uint32_t Unit(CHAR c) const
+    {
+      const uint32_t u = CodeUnit(c) & 0xFFFF;
+      return m_swapBytes ? ((u >> 8) | ((u & 0xFF) << 8)) : u;
+    }
+
+    template<class CHAR>
+    DecodeResult operator()(const CHAR* str, size_t len, size_t& pos, uint32_t& cp) const
+    {
+      const uint32_t high = Unit(str[pos]);
+      if (high < 0xD800 || high > 0xDFFF)
+      {
+        cp = high;
+        pos++;
+        return DecodeOk;
+      }
+
+      // UCS-2 has no surrogate pairs, and a pair can't start with a low surrogate
+      if (!m_allowSurrogates || high > 0xDBFF)
+        return DecodeInvalid;
+      if (pos + 1 >= len)
+        return DecodeIncomplete;
+
+      const uint32_t low = Unit(str[pos + 1]);
+      if (low < 0xDC00 || low > 0xDFFF)
+        return DecodeInvalid;
+
+      cp = 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+      pos += 2;
+      return DecodeOk;
+    }
+
+    bool m_swapBytes;
+    bool m_allowSurrogates;
+  };
+
+  struct Utf32Decoder
+  {
+    bool AsciiCompatible() const { return true; }
+
+    template<class CHAR>
+    DecodeResult operator()(const CHAR* str, size_t len, size_t& pos, uint32_t& cp) const
+    {
+      cp = CodeUnit(str[pos]);
+      if (!IsValidCodePoint(cp))
+        return DecodeInvalid;
+
+      pos++;
+      return DecodeOk;
+    }
+  };
+
+  /* encoders write to a buffer sized for the worst case, at most
+     MaxUnits code units per code point */
+  struct Utf8Encoder
+  {
+    static const size_t MaxUnits = 4;
+
+    template<class CHAR>
+    CHAR* operator()(uint32_t cp, CHAR* dst) const
+    {
+      if (cp < 0x80)
+        *dst++ = (CHAR)cp;
+      else if (cp < 0x800)
+      {
+        *dst++ = (CHAR)(0xC0 | (cp >> 6));
+        *dst++ = (CHAR)(0x80 | (cp & 0x3F));
+      }
+      else if (cp < 0x10000)
+      {
+        *dst++ = (CHAR)(0xE0 | (cp >> 12));
+        *dst++ = (CHAR)(0x80 | ((cp >> 6) & 0x3F));
+        *dst++ = (CHAR)(0x80 | (cp & 0x3F));
+      }
+      else
+      {
+        *dst++ = (CHAR)(0xF0 | (cp >> 18));
+        *dst++ = (CHAR)(0x80 | ((cp >> 12) & 0x3F));
+        *dst++ = (CHAR)(0x80 | ((cp >> 6) & 0x3F));
+        *dst++ = (CHAR)(0x80 | (cp & 0x3F));
+      }
+      return dst;
+    }
+  };
+
+  struct Utf16Encoder
+  {
+    static const size_t MaxUnits = 2;
+
+    template<class CHAR>
+    CHAR* operator()(uint32_t cp, CHAR* dst) const
+    {
+      if (cp < 0x10000)
+        *dst++ = (CHAR)cp;
+      else
+      {
+        cp -= 0x10000;
+        *dst++ = (CHAR)(0xD800 + (cp >> 10));
+        *dst++ = (CHAR)(0xDC00 + (cp & 0x3FF));
+      }
+      return dst;
+    }
+  };
+
+  struct Utf32Encoder
+  {
+    static const size_t MaxUnits = 1;
+
+    template<class CHAR>
+    CHAR* operator()(uint32_t cp, CHAR* dst) const
+    {
+      *dst++ = (CHAR)cp;
+      return dst;
+    }
+  };
+
+  template<class DECODER, class ENCODER, class INPUT, class OUTPUT>
+  bool Transcode(const DECODER& decoder, const ENCODER& encoder, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar)
+  {
+    typedef typename OUTPUT::value_type OUTCHAR;
+    const typename INPUT::value_type* str = strSource.data();
+    const size_t len = strSource.length();
+    const bool asciiCompatible = decoder.AsciiCompatible();
+
+    // every code point takes at least one input code unit
+    strDest.resize(len * ENCODER::MaxUnits);
+    OUTCHAR* const dstStart = &strDest[0];
+    OUTCHAR* dst = dstStart;
+    size_t pos = 0;
+    while (pos < len)
+    {
+      // US-ASCII is the same in every encoding, copy runs of it without decoding
+      if (asciiCompatible)
+      {
+        const size_t run = AsciiRun(str + pos, len - pos);
+        for (size_t i = 0; i < run; i++)
+          dst[i] = (OUTCHAR)CodeUnit(str[pos + i]);
+        dst += run;
+        pos += run;
+        if (pos >= len)
+          break;
+      }
+
+      uint32_t cp;
+      const DecodeResult result = decoder(str, len, pos, cp);
+      if (result == DecodeOk)
+        dst = encoder(cp, dst);
+      else if (failOnInvalidChar)
+      {
+        strDest.clear();
+        return false;
+      }
+      else if (result == DecodeInvalid)
+        pos++;
+      else
+        break; // incomplete character at the end of input
+    }
+
+    strDest.resize(dst - dstStart);
+    return true;
+  }
+
+  template<class DECODER, class INPUT, class OUTPUT>
+  bool TranscodeTo(NativeEncoding targetEncoding, const DECODER& decoder, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar)
+  {
+    switch (targetEncoding)
+    {
+    case NativeUtf8:
+      return Transcode(decoder, Utf8Encoder(), strSource, strDest, failOnInvalidChar);
+    case NativeUtf32:
+      return Transcode(decoder, Utf32Encoder(), strSource, strDest, failOnInvalidChar);
+    case NativeWchar:
+      if (sizeof(wchar_t) == 2)
+        return Transcode(decoder, Utf16Encoder(), strSource, strDest, failOnInvalidChar);
+      return Transcode(decoder, Utf32Encoder(), strSource, strDest, failOnInvalidChar);
+    default:
+      return false;
+    }
+  }
+}
+
+template<class INPUT,class OUTPUT>
+bool CCharsetConverter::CInnerConverter::nativeConvert(NativeEncoding sourceEncoding, NativeEncoding targetEncoding, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar /*= false*/)
+{
+#ifdef WORDS_BIGENDIAN
+  static const bool bigEndian = true;
+#else
+  static const bool bigEndian = false;
+#endif
+
+  switch (sourceEncoding)
+  {
+  case NativeUtf8:
+    return TranscodeTo(targetEncoding, Utf8Decoder(), strSource, strDest, failOnInvalidChar);
+  case NativeUtf16LE:
+    return TranscodeTo(targetEncoding, Utf16Decoder(bigEndian, true), strSource, strDest, failOnInvalidChar);
+  case NativeUtf16BE:
+    return TranscodeTo(targetEncoding, Utf16Decoder(!bigEndian, true), strSource, strDest, failOnInvalidChar);
+  case NativeUcs2LE:
+    return TranscodeTo(targetEncoding, Utf16Decoder(bigEndian, false), strSource, strDest, failOnInvalidChar);
+  case NativeUtf32:
+    return TranscodeTo(targetEncoding, Utf32Decoder(), strSource, strDest, failOnInvalidChar);
+  case NativeWchar:
+    if (sizeof(wchar_t) == 2)
+      return TranscodeTo(targetEncoding, Utf16Decoder(false, true), strSource, strDest, failOnInvalidChar);
+    return TranscodeTo(targetEncoding, Utf32Decoder(), strSource, strDest, failOnInvalidChar);
+  default:
+    return false;
+  }
+}
+
 bool CCharsetConverter::CInnerConverter::logicalToVisualBiDi(const std::u32string& stringSrc, std::u32string& stringDst, FriBidiCharType base /*= FRIBIDI_TYPE_LTR*/, const bool failOnBadString /*= false*/)
 {
   stringDst.clear();
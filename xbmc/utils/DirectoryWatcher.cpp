@@ -0,0 +1,348 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "DirectoryWatcher.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#ifdef HAVE_INOTIFY
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#endif
+
+static bool IsBelow(const std::string &path, const std::string &base)
+{
+  return path.size() >= base.size() && path.compare(0, base.size(), base) == 0;
+}
+
+static std::string WithSlash(const std::string &path)
+{
+  if (!path.empty() && path[path.size() - 1] != '/')
+    return path + '/';
+  return path;
+}
+
+CDirectoryWatcher::CDirectoryWatcher()
+  : m_fd(-1),
+    m_overflowed(false)
+{
+#ifdef HAVE_INOTIFY
+  m_fd = inotify_init();
+  if (m_fd >= 0)
+  {
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+  }
+  else
+    CLog::Log(LOGERROR, "CDirectoryWatcher: unable to initialize inotify (%s)", strerror(errno));
+#endif
+}
+
+CDirectoryWatcher::~CDirectoryWatcher()
+{
+#ifdef HAVE_INOTIFY
+  if (m_fd >= 0)
+    close(m_fd);
+#endif
+}
+
+bool CDirectoryWatcher::IsSupported()
+{
+#ifdef HAVE_INOTIFY
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryWatcher::Watch(const std::string &path)
+{
+  if (m_fd < 0 || path.empty())
+    return false;
+
+  std::string root = WithSlash(path);
+  if (m_roots.find(root) != m_roots.end())
+    return true;
+
+  // a directory below another watched one is watched already
+  if (m_paths.find(root) == m_paths.end() && !AddWatch(root, false))
+    return false;
+
+  m_roots.insert(root);
+  return true;
+}
+
+void CDirectoryWatcher::Unwatch(const std::string &path)
+{
+  std::string root = WithSlash(path);
+  if (m_roots.erase(root) == 0)
+    return;
+
+  for (std::set<std::string>::const_iterator it = m_roots.begin(); it != m_roots.end(); ++it)
+  {
+    if (IsBelow(root, *it))
+      return;
+  }
+
+  RemoveWatches(root);
+
+  // keep watching the roots that were below this one
+  for (std::set<std::string>::const_iterator it = m_roots.begin(); it != m_roots.end(); ++it)
+  {
+    if (IsBelow(*it, root))
+      AddWatch(*it, false);
+  }
+}
+
+void CDirectoryWatcher::UnwatchAll()
+{
+  RemoveWatches("");
+  m_roots.clear();
+  m_changes.clear();
+  m_moves.clear();
+}
+
+bool CDirectoryWatcher::Poll(unsigned int timeout)
+{
+#ifdef HAVE_INOTIFY
+  if (m_fd < 0)
+    return false;
+
+  struct pollfd fds;
+  fds.fd = m_fd;
+  fds.events = POLLIN;
+  fds.revents = 0;
+  if (poll(&fds, 1, timeout) <= 0)
+    return false;
+
+  // read until the queue is drained, so both halves of a rename are seen
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  bool changed = false;
+  while (true)
+  {
+    ssize_t length = read(m_fd, buffer, sizeof(buffer));
+    if (length <= 0)
+      break;
+
+    for (char *ptr = buffer; ptr < buffer + length; )
+    {
+      const struct inotify_event *event = (const struct inotify_event *)ptr;
+      HandleEvent(event->wd, event->mask, event->cookie, event->len ? event->name : NULL);
+      ptr += sizeof(struct inotify_event) + event->len;
+    }
+    changed = true;
+  }
+
+  // directories moved out of the watched trees
+  for (std::map<unsigned int, std::string>::const_iterator it = m_moves.begin(); it != m_moves.end(); ++it)
+    RemoveWatches(it->second);
+  m_moves.clear();
+
+  return changed;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryWatcher::GetChanges(std::set<std::string> &directories, unsigned int settleTime)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  bool found = false;
+  for (std::map<std::string, unsigned int>::iterator it = m_changes.begin(); it != m_changes.end(); )
+  {
+    if (now - it->second >= settleTime)
+    {
+      directories.insert(it->first);
+      m_changes.erase(it++);
+      found = true;
+    }
+    else
+      ++it;
+  }
+  return found;
+}
+
+bool CDirectoryWatcher::HasOverflowed()
+{
+  bool overflowed = m_overflowed;
+  m_overflowed = false;
+  return overflowed;
+}
+
+bool CDirectoryWatcher::AddWatch(const std::string &path, bool report)
+{
+#ifdef HAVE_INOTIFY
+  int wd = inotify_add_watch(m_fd, path.c_str(), WATCH_MASK);
+  if (wd < 0)
+  {
+    if (errno == ENOSPC)
+    {
+      CLog::Log(LOGWARNING, "CDirectoryWatcher: out of inotify watches at %s, consider raising fs.inotify.max_user_watches", path.c_str());
+      m_overflowed = true;
+    }
+    else if (errno != ENOENT && errno != ENOTDIR)
+      CLog::Log(LOGWARNING, "CDirectoryWatcher: unable to watch %s (%s)", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  // the same directory may still be known under the path it was moved from
+  std::map<int, std::string>::iterator old = m_watches.find(wd);
+  if (old != m_watches.end() && old->second != path)
+    m_paths.erase(old->second);
+  m_watches[wd] = path;
+  m_paths[path] = wd;
+
+  // anything created before the watch was in place is picked up by reporting
+  // the new directory itself
+  if (report)
+    MarkChanged(path);
+
+  DIR *dir = opendir(path.c_str());
+  if (dir == NULL)
+    return true;
+
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL)
+  {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+
+    std::string child = path + entry->d_name;
+    bool isDir = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_UNKNOWN)
+    {
+      struct stat st;
+      isDir = lstat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+    if (isDir)
+      AddWatch(child + '/', report);
+  }
+  closedir(dir);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CDirectoryWatcher::RemoveWatches(const std::string &path)
+{
+  std::map<std::string, int>::iterator it = m_paths.lower_bound(path);
+  while (it != m_paths.end() && IsBelow(it->first, path))
+  {
+#ifdef HAVE_INOTIFY
+    inotify_rm_watch(m_fd, it->second);
+#endif
+    m_watches.erase(it->second);
+    m_paths.erase(it++);
+  }
+}
+
+void CDirectoryWatcher::MoveWatches(const std::string &from, const std::string &to)
+{
+  std::map<std::string, int> moved;
+  std::map<std::string, int>::iterator it = m_paths.lower_bound(from);
+  while (it != m_paths.end() && IsBelow(it->first, from))
+  {
+    moved[to + it->first.substr(from.size())] = it->second;
+    m_paths.erase(it++);
+  }
+
+  for (it = moved.begin(); it != moved.end(); ++it)
+  {
+    m_paths[it->first] = it->second;
+    m_watches[it->second] = it->first;
+  }
+}
+
+void CDirectoryWatcher::HandleEvent(int wd, unsigned int mask, unsigned int cookie, const char *name)
+{
+#ifdef HAVE_INOTIFY
+  if (mask & IN_Q_OVERFLOW)
+  {
+    CLog::Log(LOGWARNING, "CDirectoryWatcher: event queue overflowed, changes were lost");
+    m_overflowed = true;
+    return;
+  }
+
+  std::map<int, std::string>::iterator watch = m_watches.find(wd);
+  if (watch == m_watches.end())
+    return;
+  const std::string dir = watch->second;
+
+  if (mask & IN_IGNORED)
+  { // the directory is gone (or was unmounted)
+    std::map<std::string, int>::iterator path = m_paths.find(dir);
+    if (path != m_paths.end() && path->second == wd)
+      m_paths.erase(path);
+    m_watches.erase(watch);
+    return;
+  }
+
+  if (mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+  { // other directories are reported through their parent
+    if (m_roots.find(dir) != m_roots.end())
+      MarkChanged(dir);
+    return;
+  }
+
+  if (name == NULL)
+    return;
+
+  if (mask & IN_ISDIR)
+  {
+    // a directory that was added, removed or renamed is reported by itself,
+    // its parent only changed in a way the scanners don't care about
+    std::string child = dir + name + '/';
+    if (mask & IN_MOVED_FROM)
+      m_moves[cookie] = child;
+    else if (mask & IN_MOVED_TO)
+    {
+      std::map<unsigned int, std::string>::iterator move = m_moves.find(cookie);
+      if (move != m_moves.end())
+      {
+        MoveWatches(move->second, child);
+        m_moves.erase(move);
+      }
+      else
+        AddWatch(child, true);
+    }
+    else if (mask & IN_CREATE)
+      AddWatch(child, true);
+    MarkChanged(child);
+  }
+  else if (mask & (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))
+    MarkChanged(dir);
+#endif
+}
+
+void CDirectoryWatcher::MarkChanged(const std::string &path)
+{
+  m_changes[path] = XbmcThreads::SystemClockMillis();
+}
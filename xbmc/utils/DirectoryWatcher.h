@@ -0,0 +1,108 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+/*!
+ \brief Watches local directory trees for changes using inotify.
+
+ Events are coalesced per directory: a directory is reported once it has had
+ no further changes for a given settle time. A directory is reported when
+ files in it are written, removed or renamed, and when a subdirectory is
+ created, removed or renamed the subdirectory is reported as well. Removed
+ directories are reported with their old path so that the library can drop
+ what it knew about them.
+
+ The watcher is not thread safe, it is meant to be driven by a single thread
+ calling Poll() and GetChanges(). Only local paths are supported and all
+ directories are returned with a trailing slash.
+ */
+class CDirectoryWatcher
+{
+public:
+  CDirectoryWatcher();
+  ~CDirectoryWatcher();
+
+  /*!
+   \brief Whether watching directories is supported on this platform.
+   */
+  static bool IsSupported();
+
+  /*!
+   \brief Watch a directory and everything below it.
+   \param path the local directory to watch.
+   \return true if the directory is being watched.
+   */
+  bool Watch(const std::string &path);
+
+  /*!
+   \brief Stop watching a directory that was passed to Watch().
+   */
+  void Unwatch(const std::string &path);
+  void UnwatchAll();
+
+  /*!
+   \brief Get the directories passed to Watch().
+   */
+  const std::set<std::string> &GetWatched() const { return m_roots; }
+
+  /*!
+   \brief Wait for and process changes.
+   \param timeout the time in milliseconds to wait for changes.
+   \return true if any changes were processed.
+   */
+  bool Poll(unsigned int timeout);
+
+  /*!
+   \brief Get the directories that changed and have settled since.
+   \param directories the set to add the changed directories to.
+   \param settleTime the time in milliseconds a directory must have had no changes.
+   \return true if any directories were added.
+   */
+  bool GetChanges(std::set<std::string> &directories, unsigned int settleTime);
+
+  /*!
+   \brief Whether changes were lost since the last call.
+   Changes are lost when the kernel event queue overflowed or a directory could
+   not be watched, so the watched trees should be scanned in full.
+   */
+  bool HasOverflowed();
+
+private:
+  CDirectoryWatcher(const CDirectoryWatcher&);
+  CDirectoryWatcher& operator=(const CDirectoryWatcher&);
+
+  bool AddWatch(const std::string &path, bool report);
+  void RemoveWatches(const std::string &path);
+  void MoveWatches(const std::string &from, const std::string &to);
+  void HandleEvent(int wd, unsigned int mask, unsigned int cookie, const char *name);
+  void MarkChanged(const std::string &path);
+
+  int m_fd;
+  bool m_overflowed;
+  std::set<std::string> m_roots;
+  std::map<int, std::string> m_watches;
+  std::map<std::string, int> m_paths;
+  std::map<std::string, unsigned int> m_changes; ///< changed directory -> time of the last change
+  std::map<unsigned int, std::string> m_moves;   ///< rename cookie -> directory moved away
+};
@@ -0,0 +1,234 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LibraryWatcher.h"
+#include "Application.h"
+#include "DirectoryWatcher.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/MediaSourceSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+
+using namespace std;
+
+// how long a directory must be left alone before it is scanned, so that
+// copies and batches of renames are picked up in one go
+static const unsigned int settle_time = 5000;
+// how often the sources are checked for changes
+static const unsigned int source_check_interval = 60000;
+
+static void GetLocalPaths(const string &type, vector<string> &paths)
+{
+  VECSOURCES *sources = CMediaSourceSettings::Get().GetSources(type);
+  if (sources == NULL)
+    return;
+
+  for (VECSOURCES::const_iterator source = sources->begin(); source != sources->end(); ++source)
+  {
+    vector<CStdString> sourcePaths = source->vecPaths;
+    if (sourcePaths.empty())
+      sourcePaths.push_back(source->strPath);
+
+    for (vector<CStdString>::const_iterator it = sourcePaths.begin(); it != sourcePaths.end(); ++it)
+    {
+      // only local filesystems deliver change notifications
+      if (it->empty() || (*it)[0] != '/' || !URIUtils::IsHD(*it))
+        continue;
+      CStdString path(*it);
+      URIUtils::AddSlashAtEnd(path);
+      paths.push_back(path);
+    }
+  }
+}
+
+static bool IsBelowAny(const string &path, const vector<string> &roots)
+{
+  for (vector<string>::const_iterator it = roots.begin(); it != roots.end(); ++it)
+  {
+    if (path.compare(0, it->size(), *it) == 0)
+      return true;
+  }
+  return false;
+}
+
+CLibraryWatcher::CLibraryWatcher()
+  : CThread("LibraryWatcher"),
+    m_videoFullScan(false),
+    m_musicFullScan(false),
+    m_videoLastFullScan(0),
+    m_musicLastFullScan(0)
+{
+}
+
+CLibraryWatcher::~CLibraryWatcher()
+{
+  StopThread();
+}
+
+CLibraryWatcher &CLibraryWatcher::Get()
+{
+  static CLibraryWatcher sWatcher;
+  return sWatcher;
+}
+
+void CLibraryWatcher::Start()
+{
+  if (!g_advancedSettings.m_bVideoLibraryWatchSources && !g_advancedSettings.m_bMusicLibraryWatchSources)
+    return;
+
+  if (!CDirectoryWatcher::IsSupported())
+  {
+    CLog::Log(LOGWARNING, "CLibraryWatcher: watching sources is not supported on this platform");
+    return;
+  }
+
+  if (!IsRunning())
+    Create();
+}
+
+void CLibraryWatcher::Stop()
+{
+  StopThread();
+}
+
+void CLibraryWatcher::Process()
+{
+  CDirectoryWatcher watcher;
+  m_videoChanges.clear();
+  m_musicChanges.clear();
+  m_videoFullScan = m_musicFullScan = false;
+  m_videoLastFullScan = m_musicLastFullScan = XbmcThreads::SystemClockMillis();
+  unsigned int lastSourceCheck = m_videoLastFullScan - source_check_interval;
+
+  while (!m_bStop)
+  {
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    if (now - lastSourceCheck >= source_check_interval)
+    {
+      UpdateSources(watcher);
+      lastSourceCheck = now;
+    }
+
+    if (watcher.GetWatched().empty())
+    {
+      Sleep(1000);
+      continue;
+    }
+
+    watcher.Poll(1000);
+    if (watcher.HasOverflowed())
+    {
+      m_videoFullScan = !m_videoRoots.empty();
+      m_musicFullScan = !m_musicRoots.empty();
+    }
+
+    set<string> changes;
+    if (watcher.GetChanges(changes, settle_time))
+    {
+      for (set<string>::const_iterator it = changes.begin(); it != changes.end(); ++it)
+      {
+        if (IsBelowAny(*it, m_videoRoots))
+          m_videoChanges.insert(*it);
+        if (IsBelowAny(*it, m_musicRoots))
+          m_musicChanges.insert(*it);
+      }
+    }
+
+    // changes may still have been missed, so fall back to a full update now and then
+    now = XbmcThreads::SystemClockMillis();
+    unsigned int videoInterval = (unsigned int)g_advancedSettings.m_iVideoLibraryWatchFullScan * 3600000U;
+    if (videoInterval > 0 && !m_videoRoots.empty() && now - m_videoLastFullScan >= videoInterval)
+      m_videoFullScan = true;
+    unsigned int musicInterval = (unsigned int)g_advancedSettings.m_iMusicLibraryWatchFullScan * 3600000U;
+    if (musicInterval > 0 && !m_musicRoots.empty() && now - m_musicLastFullScan >= musicInterval)
+      m_musicFullScan = true;
+
+    Dispatch();
+  }
+
+  watcher.UnwatchAll();
+}
+
+void CLibraryWatcher::UpdateSources(CDirectoryWatcher &watcher)
+{
+  m_videoRoots.clear();
+  m_musicRoots.clear();
+  if (g_advancedSettings.m_bVideoLibraryWatchSources)
+    GetLocalPaths("video", m_videoRoots);
+  if (g_advancedSettings.m_bMusicLibraryWatchSources)
+    GetLocalPaths("music", m_musicRoots);
+
+  set<string> roots(m_videoRoots.begin(), m_videoRoots.end());
+  roots.insert(m_musicRoots.begin(), m_musicRoots.end());
+
+  set<string> watched = watcher.GetWatched();
+  for (set<string>::const_iterator it = watched.begin(); it != watched.end(); ++it)
+  {
+    if (roots.find(*it) == roots.end())
+    {
+      CLog::Log(LOGDEBUG, "CLibraryWatcher: no longer watching %s", it->c_str());
+      watcher.Unwatch(*it);
+    }
+  }
+
+  for (set<string>::const_iterator it = roots.begin(); it != roots.end(); ++it)
+  {
+    if (watched.find(*it) == watched.end() && watcher.Watch(*it))
+      CLog::Log(LOGDEBUG, "CLibraryWatcher: watching %s", it->c_str());
+  }
+}
+
+void CLibraryWatcher::Dispatch()
+{
+  if ((m_videoFullScan || !m_videoChanges.empty()) && !g_application.IsVideoScanning())
+  {
+    if (m_videoFullScan)
+    {
+      CLog::Log(LOGNOTICE, "CLibraryWatcher: updating the video library");
+      g_application.StartVideoScan("");
+      m_videoLastFullScan = XbmcThreads::SystemClockMillis();
+    }
+    else
+    {
+      CLog::Log(LOGDEBUG, "CLibraryWatcher: updating %u changed video directories", (unsigned int)m_videoChanges.size());
+      g_application.StartVideoScan(m_videoChanges);
+    }
+    m_videoChanges.clear();
+    m_videoFullScan = false;
+  }
+
+  if ((m_musicFullScan || !m_musicChanges.empty()) && !g_application.IsMusicScanning())
+  {
+    if (m_musicFullScan)
+    {
+      CLog::Log(LOGNOTICE, "CLibraryWatcher: updating the music library");
+      g_application.StartMusicScan("");
+      m_musicLastFullScan = XbmcThreads::SystemClockMillis();
+    }
+    else
+    {
+      CLog::Log(LOGDEBUG, "CLibraryWatcher: updating %u changed music directories", (unsigned int)m_musicChanges.size());
+      g_application.StartMusicScan(m_musicChanges);
+    }
+    m_musicChanges.clear();
+    m_musicFullScan = false;
+  }
+}
@@ -0,0 +1,65 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Thread.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+class CDirectoryWatcher;
+
+/*!
+ \brief Keeps the libraries up to date by watching local sources.
+
+ Enabled through the <watchsources> advanced setting of the video and music
+ libraries. The local paths of the sources are watched with CDirectoryWatcher
+ and only the directories that changed are passed to the scanners. As changes
+ can be missed (queue overflows, changes while XBMC wasn't running) a full
+ library update still runs every <watchfullscan> hours.
+ */
+class CLibraryWatcher : protected CThread
+{
+public:
+  static CLibraryWatcher &Get();
+
+  void Start();
+  void Stop();
+
+protected:
+  CLibraryWatcher();
+  virtual ~CLibraryWatcher();
+
+  virtual void Process();
+
+private:
+  void UpdateSources(CDirectoryWatcher &watcher);
+  void Dispatch();
+
+  std::vector<std::string> m_videoRoots;
+  std::vector<std::string> m_musicRoots;
+  std::set<std::string> m_videoChanges;
+  std::set<std::string> m_musicChanges;
+  bool m_videoFullScan;
+  bool m_musicFullScan;
+  unsigned int m_videoLastFullScan;
+  unsigned int m_musicLastFullScan;
+};
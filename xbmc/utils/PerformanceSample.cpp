@@ -36,6 +36,17 @@ int64_t CPerformanceSample::m_tmFreq;
 CPerformanceSample::CPerformanceSample(const string &statName, bool bCheckWhenDone)
 {
   m_statName = statName;
+  m_counter = Register(statName);
+  m_bCheckWhenDone = bCheckWhenDone;
+  if (m_tmFreq == 0LL)
+    m_tmFreq = CurrentHostFrequency();
+
+  Reset();
+}
+
+CPerformanceSample::CPerformanceSample(int counter, bool bCheckWhenDone)
+{
+  m_counter = counter;
   m_bCheckWhenDone = bCheckWhenDone;
   if (m_tmFreq == 0LL)
     m_tmFreq = CurrentHostFrequency();
@@ -52,37 +63,20 @@ CPerformanceSample::~CPerformanceSample()
 void CPerformanceSample::Reset()
 {
   m_tmStart = CurrentHostCounter();
-#ifdef TARGET_POSIX
-  if (getrusage(RUSAGE_SELF, &m_usage) == -1)
-    CLog::Log(LOGERROR,"error %d in getrusage", errno);
-#endif
 }
 
 void CPerformanceSample::CheckPoint()
 {
-#ifdef HAS_PERFORMANCE_SAMPLE
-  int64_t tmNow;
-  tmNow = CurrentHostCounter();
-  double elapsed = (double)(tmNow - m_tmStart) / (double)m_tmFreq.QuadPart;
+  int64_t tmNow = CurrentHostCounter();
+  double elapsed = (double)(tmNow - m_tmStart) * 1000000.0 / (double)m_tmFreq;
+  g_application.GetPerformanceStats().AddSample(m_counter, (int64_t)elapsed);
 
-  double dUser=0.0, dSys=0.0;
-#ifdef TARGET_POSIX
-  struct rusage usage;
-  if (getrusage(RUSAGE_SELF, &usage) == -1)
-    CLog::Log(LOGERROR,"error %d in getrusage", errno);
-  else
-  {
-    dUser = ( ((double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1000000.0) -
-              ((double)m_usage.ru_utime.tv_sec + (double)m_usage.ru_utime.tv_usec / 1000000.0) );
-    dSys  = ( ((double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1000000.0) -
-              ((double)m_usage.ru_stime.tv_sec + (double)m_usage.ru_stime.tv_usec / 1000000.0) );
-  }
-#endif
-
-  g_application.GetPerformanceStats().AddSample(m_statName, PerformanceCounter(elapsed,dUser,dSys));
-#endif
+  m_tmStart = tmNow;
+}
 
-  Reset();
+int CPerformanceSample::Register(const string &statName)
+{
+  return g_application.GetPerformanceStats().Register(statName);
 }
 
 double CPerformanceSample::GetEstimatedError()
@@ -23,20 +23,26 @@
 
 #ifdef TARGET_POSIX
 #include "linux/PlatformDefs.h"
-#include <sys/time.h>
-#include <sys/times.h>
-#include <sys/resource.h>
 #elif TARGET_WINDOWS
 #include "win32/PlatformDefs.h"
 #endif
 
 #include <string>
 
+// the counter is registered on the first pass, so n has to be the same on every pass.
+// MEASURE_DYNAMIC_SCOPE looks up the counter on every pass, for names built at run time.
 #ifndef NO_PERFORMANCE_MEASURE
-#define MEASURE_FUNCTION CPerformanceSample aSample(__FUNCTION__,true);
-#define BEGIN_MEASURE_BLOCK(n) { CPerformanceSample aSample(n,true);
+#define MEASURE_CONCAT2(a, b) a##b
+#define MEASURE_CONCAT(a, b) MEASURE_CONCAT2(a, b)
+#define MEASURE_SCOPE(n) static const int MEASURE_CONCAT(perfCounter, __LINE__) = CPerformanceSample::Register(n); \
+                         CPerformanceSample MEASURE_CONCAT(perfSample, __LINE__)(MEASURE_CONCAT(perfCounter, __LINE__))
+#define MEASURE_DYNAMIC_SCOPE(n) CPerformanceSample MEASURE_CONCAT(perfSample, __LINE__)(n)
+#define MEASURE_FUNCTION MEASURE_SCOPE(__FUNCTION__)
+#define BEGIN_MEASURE_BLOCK(n) { MEASURE_SCOPE(n);
 #define END_MEASURE_BLOCK }
 #else
+#define MEASURE_SCOPE(n)
+#define MEASURE_DYNAMIC_SCOPE(n)
 #define MEASURE_FUNCTION
 #define BEGIN_MEASURE_BLOCK(n)
 #define END_MEASURE_BLOCK
@@ -46,21 +52,21 @@ class CPerformanceSample
 {
 public:
   CPerformanceSample(const std::string &statName, bool bCheckWhenDone=true);
+  CPerformanceSample(int counter, bool bCheckWhenDone=true);
   virtual ~CPerformanceSample();
 
   void Reset();
   void CheckPoint(); // will add a sample to stats and restart counting.
 
+  /* the handle of a counter of the application's CPerformanceStats */
+  static int Register(const std::string &statName);
   static double GetEstimatedError();
 
 protected:
   std::string m_statName;
+  int m_counter;
   bool m_bCheckWhenDone;
 
-#ifdef TARGET_POSIX
-  struct rusage m_usage;
-#endif
-
   int64_t m_tmStart;
   static int64_t m_tmFreq;
 };
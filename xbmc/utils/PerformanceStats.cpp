@@ -20,59 +20,256 @@
 
 #include "PerformanceStats.h"
 #include "PerformanceSample.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/ThreadImpl.h"
 #include "log.h"
 
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
 using namespace std;
 
+CPerformanceHistogram::CPerformanceHistogram()
+  : m_sequence(0)
+  , m_count(0)
+  , m_total(0)
+  , m_maximum(0)
+{
+  memset(m_counts, 0, sizeof(m_counts));
+}
+
+unsigned int CPerformanceHistogram::GetBucket(int64_t value)
+{
+  // below two sub bucket ranges every value has a bucket of its own
+  if (value < (2 << PERFSTATS_SUB_BUCKET_BITS))
+    return value > 0 ? (unsigned int)value : 0;
+  if (value >> PERFSTATS_MAX_BITS)
+    return PERFSTATS_BUCKETS - 1;
+
+  // the highest bit set, PERFSTATS_MAX_BITS is at most 32
+  uint32_t v = (uint32_t)value;
+  unsigned int bit = 0;
+  if (v >> 16) { v >>= 16; bit += 16; }
+  if (v >> 8)  { v >>= 8;  bit += 8; }
+  if (v >> 4)  { v >>= 4;  bit += 4; }
+  if (v >> 2)  { v >>= 2;  bit += 2; }
+  if (v >> 1)  { bit += 1; }
+
+  unsigned int shift = bit - PERFSTATS_SUB_BUCKET_BITS;
+  return ((shift + 1) << PERFSTATS_SUB_BUCKET_BITS) + (unsigned int)(value >> shift) - (1 << PERFSTATS_SUB_BUCKET_BITS);
+}
+
+int64_t CPerformanceHistogram::GetUpperBound(unsigned int bucket)
+{
+  if (bucket < (2 << PERFSTATS_SUB_BUCKET_BITS))
+    return bucket;
+
+  unsigned int shift = (bucket >> PERFSTATS_SUB_BUCKET_BITS) - 1;
+  int64_t mantissa = (bucket & ((1 << PERFSTATS_SUB_BUCKET_BITS) - 1)) + (1 << PERFSTATS_SUB_BUCKET_BITS);
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void CPerformanceHistogram::Add(int64_t value)
+{
+  if (value < 0)
+    value = 0;
+
+  AtomicIncrement(&m_sequence);
+  m_counts[GetBucket(value)]++;
+  m_count++;
+  m_total += value;
+  if (value > m_maximum)
+    m_maximum = value;
+  AtomicIncrement(&m_sequence);
+}
+
+void CPerformanceHistogram::Merge(const CPerformanceHistogram &other)
+{
+  // copy the histogram while its thread isn't adding to it. Adding takes a
+  // few instructions, so retrying rarely happens. A thread preempted in the
+  // middle of it has to get to run again first, so give it the time.
+  CPerformanceHistogram copy;
+  for (int retry = 0; ; retry++)
+  {
+    long sequence = AtomicAdd(&other.m_sequence, 0);
+    if (!(sequence & 1))
+    {
+      memcpy(copy.m_counts, other.m_counts, sizeof(copy.m_counts));
+      copy.m_count   = other.m_count;
+      copy.m_total   = other.m_total;
+      copy.m_maximum = other.m_maximum;
+      if (AtomicAdd(&other.m_sequence, 0) == sequence)
+        break;
+    }
+    if (retry >= 100)
+      XbmcThreads::ThreadSleep(0);
+  }
+
+  for (unsigned int i = 0; i < PERFSTATS_BUCKETS; i++)
+    m_counts[i] += copy.m_counts[i];
+  m_count += copy.m_count;
+  m_total += copy.m_total;
+  if (copy.m_maximum > m_maximum)
+    m_maximum = copy.m_maximum;
+}
+
+int64_t CPerformanceHistogram::GetPercentile(double percentile) const
+{
+  if (m_count == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)ceil(percentile / 100.0 * m_count);
+  if (rank < 1)
+    rank = 1;
+
+  uint64_t count = 0;
+  for (unsigned int i = 0; i < PERFSTATS_BUCKETS; i++)
+  {
+    count += m_counts[i];
+    if (count >= rank)
+      return min(GetUpperBound(i), m_maximum);
+  }
+  return m_maximum;
+}
+
 CPerformanceStats::CPerformanceStats()
+  : m_thread(ReleaseThread)
 {
+  m_retired.stats = this;
+  memset(m_retired.histograms, 0, sizeof(m_retired.histograms));
 }
 
 
 CPerformanceStats::~CPerformanceStats()
 {
-  map<string, PerformanceCounter*>::iterator iter = m_mapStats.begin();
-  while (iter != m_mapStats.end())
+  for (vector<ThreadStats*>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
   {
-    delete iter->second;
-    iter++;
+    for (unsigned int i = 0; i < PERFSTATS_MAX_COUNTERS; i++)
+      delete (*it)->histograms[i];
+    delete *it;
   }
-  m_mapStats.clear();
+  m_threads.clear();
+  for (unsigned int i = 0; i < PERFSTATS_MAX_COUNTERS; i++)
+    delete m_retired.histograms[i];
 }
 
-void CPerformanceStats::AddSample(const string &strStatName, const PerformanceCounter &perf)
+int CPerformanceStats::Register(const string &strStatName)
 {
-  map<string, PerformanceCounter*>::iterator iter = m_mapStats.find(strStatName);
-  if (iter == m_mapStats.end())
-    m_mapStats[strStatName] = new PerformanceCounter(perf);
-  else
+  CSingleLock lock(m_lock);
+  map<string, int>::const_iterator it = m_counters.find(strStatName);
+  if (it != m_counters.end())
+    return it->second;
+
+  if (m_names.size() >= PERFSTATS_MAX_COUNTERS)
   {
-    iter->second->m_time += perf.m_time;
-    iter->second->m_samples += perf.m_samples;
+    CLog::Log(LOGERROR, "%s - too many counters, not measuring <%s>", __FUNCTION__, strStatName.c_str());
+    return -1;
   }
+
+  int counter = m_names.size();
+  m_names.push_back(strStatName);
+  m_counters[strStatName] = counter;
+  return counter;
+}
+
+void CPerformanceStats::AddSample(int counter, int64_t duration)
+{
+  if (counter < 0 || counter >= PERFSTATS_MAX_COUNTERS)
+    return;
+
+  ThreadStats* thread = m_thread.get();
+  CPerformanceHistogram* histogram = thread ? thread->histograms[counter] : NULL;
+  if (histogram == NULL)
+    histogram = AddHistogram(counter);
+  histogram->Add(duration);
 }
 
 void CPerformanceStats::AddSample(const string &strStatName, double dTime)
 {
-  AddSample(strStatName, PerformanceCounter(dTime));
+  AddSample(Register(strStatName), (int64_t)(dTime * 1000000.0));
+}
+
+CPerformanceHistogram* CPerformanceStats::AddHistogram(int counter)
+{
+  // the histograms are only added while holding the lock, so GetStats()
+  // never sees one which is under construction
+  CSingleLock lock(m_lock);
+  ThreadStats* thread = m_thread.get();
+  if (thread == NULL)
+  {
+    thread = new ThreadStats;
+    thread->stats = this;
+    memset(thread->histograms, 0, sizeof(thread->histograms));
+    m_threads.push_back(thread);
+    m_thread.set(thread);
+  }
+
+  CPerformanceHistogram* histogram = new CPerformanceHistogram;
+  thread->histograms[counter] = histogram;
+  return histogram;
+}
+
+void CPerformanceStats::ReleaseThread(ThreadStats* thread)
+{
+  // called by the exiting thread, nothing adds to its histograms any more
+  CPerformanceStats* stats = thread->stats;
+  CSingleLock lock(stats->m_lock);
+  for (unsigned int i = 0; i < PERFSTATS_MAX_COUNTERS; i++)
+  {
+    if (thread->histograms[i] == NULL)
+      continue;
+    if (stats->m_retired.histograms[i] == NULL)
+      stats->m_retired.histograms[i] = new CPerformanceHistogram;
+    stats->m_retired.histograms[i]->Merge(*thread->histograms[i]);
+    delete thread->histograms[i];
+  }
+  stats->m_threads.erase(find(stats->m_threads.begin(), stats->m_threads.end(), thread));
+  delete thread;
+}
+
+void CPerformanceStats::GetStats(vector<PerformanceCounter> &stats)
+{
+  stats.clear();
+
+  CSingleLock lock(m_lock);
+  for (unsigned int i = 0; i < m_names.size(); i++)
+  {
+    CPerformanceHistogram histogram;
+    if (m_retired.histograms[i])
+      histogram.Merge(*m_retired.histograms[i]);
+    for (vector<ThreadStats*>::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+    {
+      if ((*it)->histograms[i])
+        histogram.Merge(*(*it)->histograms[i]);
+    }
+    if (histogram.GetCount() == 0)
+      continue;
+
+    PerformanceCounter counter;
+    counter.m_name    = m_names[i];
+    counter.m_samples = histogram.GetCount();
+    counter.m_average = histogram.GetAverage();
+    counter.m_p50     = histogram.GetPercentile(50);
+    counter.m_p90     = histogram.GetPercentile(90);
+    counter.m_p99     = histogram.GetPercentile(99);
+    counter.m_max     = histogram.GetMaximum();
+    stats.push_back(counter);
+  }
 }
 
 void CPerformanceStats::DumpStats()
 {
   double dError = CPerformanceSample::GetEstimatedError();
   CLog::Log(LOGINFO, "%s - estimated error: %f", __FUNCTION__, dError);
-  CLog::Log(LOGINFO, "%s - ignore user/sys values when sample count is low", __FUNCTION__);
 
-  map<string, PerformanceCounter*>::iterator iter = m_mapStats.begin();
-  while (iter != m_mapStats.end())
+  vector<PerformanceCounter> stats;
+  GetStats(stats);
+  for (vector<PerformanceCounter>::const_iterator it = stats.begin(); it != stats.end(); ++it)
   {
-    double dAvg = iter->second->m_time / (double)iter->second->m_samples;
-    double dAvgUser = iter->second->m_user / (double)iter->second->m_samples;
-    double dAvgSys  = iter->second->m_sys / (double)iter->second->m_samples;
-    CLog::Log(LOGINFO, "%s - counter <%s>. avg duration: <%f sec>, avg user: <%f>, avg sys: <%f> (%"PRIu64" samples)",
-      __FUNCTION__, iter->first.c_str(), dAvg, dAvgUser, dAvgSys, iter->second->m_samples);
-    iter++;
+    CLog::Log(LOGINFO, "%s - counter <%s>. avg: <%.3f ms>, p50: <%.3f ms>, p90: <%.3f ms>, p99: <%.3f ms>, max: <%.3f ms> (%"PRIu64" samples)",
+      __FUNCTION__, it->m_name.c_str(), it->m_average / 1000.0, it->m_p50 / 1000.0, it->m_p90 / 1000.0,
+      it->m_p99 / 1000.0, it->m_max / 1000.0, it->m_samples);
   }
 }
-
-
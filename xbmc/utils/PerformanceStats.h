@@ -23,36 +23,104 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "PlatformDefs.h"
 #include "threads/CriticalSection.h"
+#include "threads/ThreadLocal.h"
+
+// counters which can be registered, further ones are refused
+#define PERFSTATS_MAX_COUNTERS    512
+// linear buckets per power of two, which keeps a percentile within 1/32 of the sample
+#define PERFSTATS_SUB_BUCKET_BITS 5
+// samples are in microseconds, longer ones than 2^32 (71 minutes) are counted as that
+#define PERFSTATS_MAX_BITS        32
+#define PERFSTATS_BUCKETS         ((PERFSTATS_MAX_BITS - PERFSTATS_SUB_BUCKET_BITS + 1) << PERFSTATS_SUB_BUCKET_BITS)
 
 class PerformanceCounter
 {
 public:
-  double     m_time;
-  double     m_user;
-  double     m_sys;
-  int64_t    m_samples;
-
-  PerformanceCounter(double dTime=0.0, double dUser=0.0, double dSys=0.0, int64_t nSamples=1LL) :
-     m_time(dTime), m_user(dUser), m_sys(dSys), m_samples(nSamples) { }
-  virtual ~PerformanceCounter() { }
+  std::string m_name;
+  uint64_t    m_samples;
+  double      m_average;    // all in microseconds
+  int64_t     m_p50;
+  int64_t     m_p90;
+  int64_t     m_p99;
+  int64_t     m_max;
+
+  PerformanceCounter() : m_samples(0), m_average(0.0), m_p50(0), m_p90(0), m_p99(0), m_max(0) { }
+};
+
+/**
+ * Log-linear histogram of durations in the manner of HdrHistogram: every
+ * power of two is split into 2^PERFSTATS_SUB_BUCKET_BITS buckets, so the
+ * relative error is the same for short and long samples.
+ *
+ * Only one thread may Add() to a histogram, any other thread may Merge() it
+ * at the same time.
+ */
+class CPerformanceHistogram
+{
+public:
+  CPerformanceHistogram();
+
+  void Add(int64_t value);
+  void Merge(const CPerformanceHistogram &other);
+
+  uint64_t GetCount() const   { return m_count; }
+  int64_t  GetMaximum() const { return m_maximum; }
+  double   GetAverage() const { return m_count ? (double)m_total / m_count : 0.0; }
+  /* the highest value of the bucket the percentile falls into */
+  int64_t  GetPercentile(double percentile) const;
+
+  static unsigned int GetBucket(int64_t value);
+  static int64_t GetUpperBound(unsigned int bucket);
+
+private:
+  mutable volatile long m_sequence;  // odd while Add() is updating the histogram
+  unsigned int m_counts[PERFSTATS_BUCKETS];
+  uint64_t     m_count;
+  int64_t      m_total;
+  int64_t      m_maximum;
 };
 
 /**
+ * Counters are registered once and then referred to by their handle. Every
+ * thread records into histograms of its own without locking, which are only
+ * added up when the statistics are read. The histograms of a thread which
+ * exits are added to the retired ones and freed.
 */
 class CPerformanceStats{
 public:
   CPerformanceStats();
   virtual ~CPerformanceStats();
 
-  void AddSample(const std::string &strStatName, const PerformanceCounter &perf);
-  void AddSample(const std::string &strStatName, double dTime);
+  /**
+   * The handle of the counter with the given name, it is registered on first use.
+   * Returns -1 if PERFSTATS_MAX_COUNTERS are registered already.
+   */
+  int Register(const std::string &strStatName);
+
+  void AddSample(int counter, int64_t duration); // in microseconds
+  void AddSample(const std::string &strStatName, double dTime); // in seconds
+  void GetStats(std::vector<PerformanceCounter> &stats);
   void DumpStats();
 
 protected:
-  CCriticalSection                            m_lock;
-  std::map<std::string, PerformanceCounter*>  m_mapStats;
+  struct ThreadStats
+  {
+    CPerformanceStats*     stats;
+    CPerformanceHistogram* histograms[PERFSTATS_MAX_COUNTERS];
+  };
+
+  CPerformanceHistogram* AddHistogram(int counter);
+  static void ReleaseThread(ThreadStats* thread);
+
+  CCriticalSection                         m_lock;
+  std::map<std::string, int>               m_counters;
+  std::vector<std::string>                 m_names;
+  std::vector<ThreadStats*>                m_threads;
+  ThreadStats                              m_retired;  // samples of the threads which have exited
+  XbmcThreads::ThreadLocal<ThreadStats>    m_thread;
 };
 
 #endif
@@ -31,14 +31,183 @@
 #include "CharsetConverter.h"
 #include "utils/StringUtils.h"
 #include "utils/XSLTUtils.h"
+#include "threads/SingleLock.h"
 #include <sstream>
 #include <cstring>
+#include <map>
 
 using namespace std;
 using namespace ADDON;
 using namespace XFILE;
 
+/*!
+ \brief Compiled expressions of a scraper.
+
+ Expressions are compiled on their first use, and studied (and JIT compiled
+ where supported) once they are used again, so the one-off expressions built
+ from buffer contents stay cheap. As a CRegExp also holds the state of its
+ last match each user gets one to itself until it is released. Idle ones are
+ kept per pattern, and another one is compiled when concurrent scrapers use
+ the same pattern at the same time.
+ */
+class CScraperRegExpCache
+{
+public:
+  CScraperRegExpCache() : m_idle(0) { }
+
+  ~CScraperRegExpCache()
+  {
+    Clear();
+  }
+
+  CRegExp *Acquire(const string &pattern, bool caseless, CRegExp::utf8Mode utf8, bool &pooled)
+  {
+    Key key(pattern, caseless, utf8);
+    {
+      CSingleLock lock(m_section);
+      if (m_entries.size() >= max_patterns && m_entries.find(key) == m_entries.end())
+        Prune();
+
+      Entry &entry = m_entries[key];
+      if (!entry.idle.empty())
+      {
+        CRegExp *regExp = entry.idle.back();
+        entry.idle.pop_back();
+        m_idle--;
+        pooled = true;
+        return regExp;
+      }
+      pooled = ++entry.uses > 1;
+    }
+
+    CRegExp *regExp = new CRegExp(caseless, utf8);
+    if (!regExp->RegComp(pattern, pooled ? CRegExp::StudyWithJitComp : CRegExp::NoStudy))
+    {
+      delete regExp;
+      return NULL;
+    }
+    return regExp;
+  }
+
+  void Release(CRegExp *regExp, bool caseless, CRegExp::utf8Mode utf8, bool pooled)
+  {
+    if (pooled)
+    {
+      CSingleLock lock(m_section);
+      map<Key, Entry>::iterator it = m_entries.find(Key(regExp->GetPattern(), caseless, utf8));
+      if (it != m_entries.end() && it->second.idle.size() < max_idle_per_pattern && m_idle < max_idle)
+      {
+        it->second.idle.push_back(regExp);
+        m_idle++;
+        return;
+      }
+    }
+    delete regExp;
+  }
+
+private:
+  // every studied expression may reserve a JIT stack of its own, so keep the
+  // number of idle ones bounded
+  static const size_t max_patterns = 1024;
+  static const size_t max_idle_per_pattern = 4;
+  static const size_t max_idle = 128;
+
+  struct Key
+  {
+    Key(const string &pattern, bool caseless, CRegExp::utf8Mode utf8)
+      : pattern(pattern), caseless(caseless), utf8(utf8)
+    { }
+
+    bool operator<(const Key &rhs) const
+    {
+      if (caseless != rhs.caseless)
+        return caseless < rhs.caseless;
+      if (utf8 != rhs.utf8)
+        return utf8 < rhs.utf8;
+      return pattern < rhs.pattern;
+    }
+
+    string pattern;
+    bool caseless;
+    CRegExp::utf8Mode utf8;
+  };
+
+  struct Entry
+  {
+    Entry() : uses(0) { }
+
+    unsigned int uses;
+    vector<CRegExp*> idle;
+  };
+
+  void Prune()
+  {
+    // forget the patterns that aren't pooled, and everything if that isn't enough
+    for (map<Key, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); )
+    {
+      if (it->second.idle.empty())
+        m_entries.erase(it++);
+      else
+        ++it;
+    }
+    if (m_entries.size() >= max_patterns)
+      Clear();
+  }
+
+  void Clear()
+  {
+    for (map<Key, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      for (vector<CRegExp*>::iterator regExp = it->second.idle.begin(); regExp != it->second.idle.end(); ++regExp)
+        delete *regExp;
+    }
+    m_entries.clear();
+    m_idle = 0;
+  }
+
+  CCriticalSection m_section;
+  map<Key, Entry> m_entries;
+  size_t m_idle;
+};
+
+/*!
+ \brief An expression taken from the cache, returned to it when going out of scope.
+ */
+class CScraperRegExp
+{
+public:
+  CScraperRegExp(CScraperRegExpCache &cache, const string &pattern,
+                 bool caseless = false, CRegExp::utf8Mode utf8 = CRegExp::asciiOnly)
+    : m_cache(cache),
+      m_caseless(caseless),
+      m_utf8(utf8),
+      m_pooled(false)
+  {
+    m_regExp = m_cache.Acquire(pattern, caseless, utf8, m_pooled);
+  }
+
+  ~CScraperRegExp()
+  {
+    if (m_regExp)
+      m_cache.Release(m_regExp, m_caseless, m_utf8, m_pooled);
+  }
+
+  bool IsCompiled() const { return m_regExp != NULL; }
+  CRegExp *operator->() const { return m_regExp; }
+
+private:
+  CScraperRegExp(const CScraperRegExp&);
+  CScraperRegExp& operator=(const CScraperRegExp&);
+
+  CScraperRegExpCache &m_cache;
+  CRegExp *m_regExp;
+  bool m_caseless;
+  CRegExp::utf8Mode m_utf8;
+  bool m_pooled;
+};
+
 CScraperParser::CScraperParser()
+  : m_regExps(new CScraperRegExpCache)
 {
   m_pRootElement = NULL;
   m_document = NULL;
@@ -48,6 +217,7 @@ CScraperParser::CScraperParser()
 }
 
 CScraperParser::CScraperParser(const CScraperParser& parser)
+  : m_regExps(parser.m_regExps)
 {
   m_pRootElement = NULL;
   m_document = NULL;
@@ -62,6 +232,7 @@ CScraperParser &CScraperParser::operator=(const CScraperParser &parser)
   if (this != &parser)
   {
     Clear();
+    m_regExps = parser.m_regExps;
     if (parser.m_document)
     {
       m_scraper = parser.m_scraper;
@@ -216,7 +387,6 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
         eUtf8 = CRegExp::autoUtf8;
     }
 
-    CRegExp reg(bInsensitive, eUtf8);
     CStdString strExpression;
     if (pExpression->FirstChild())
       strExpression = pExpression->FirstChild()->Value();
@@ -225,7 +395,8 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
     ReplaceBuffers(strExpression);
     ReplaceBuffers(strOutput);
 
-    if (!reg.RegComp(strExpression.c_str()))
+    CScraperRegExp reg(*m_regExps, strExpression, bInsensitive, eUtf8);
+    if (!reg.IsCompiled())
     {
       return;
     }
@@ -272,7 +443,7 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
       if (bEncode[iBuf])
         InsertToken(strOutput,iBuf+1,"!!!ENCODE!!!");
     }
-    int i = reg.RegFind(curInput.c_str());
+    int i = reg->RegFind(curInput.c_str());
     while (i > -1 && (i < (int)curInput.size() || curInput.size() == 0))
     {
       if (!bAppend)
@@ -286,13 +457,12 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
       {
         char temp[4];
         sprintf(temp,"\\%i",iOptional);
-        std::string szParam = reg.GetReplaceString(temp);
-        CRegExp reg2;
-        reg2.RegComp("(.*)(\\\\\\(.*\\\\2.*)\\\\\\)(.*)");
-        int i2=reg2.RegFind(strCurOutput.c_str());
+        std::string szParam = reg->GetReplaceString(temp);
+        CScraperRegExp reg2(*m_regExps, "(.*)(\\\\\\(.*\\\\2.*)\\\\\\)(.*)");
+        int i2=reg2->RegFind(strCurOutput.c_str());
         while (i2 > -1)
         {
-          std::string szRemove(reg2.GetMatch(2));
+          std::string szRemove(reg2->GetMatch(2));
           int iRemove = szRemove.size();
           int i3 = strCurOutput.find(szRemove);
           if (!szParam.empty())
@@ -303,14 +473,14 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
           else
             strCurOutput.replace(strCurOutput.begin()+i3,strCurOutput.begin()+i3+iRemove+2,"");
 
-          i2 = reg2.RegFind(strCurOutput.c_str());
+          i2 = reg2->RegFind(strCurOutput.c_str());
         }
       }
 
-      int iLen = reg.GetFindLen();
+      int iLen = reg->GetFindLen();
       // nasty hack #1 - & means \0 in a replace string
       StringUtils::Replace(strCurOutput, "&","!!!AMPAMP!!!");
-      std::string result = reg.GetReplaceString(strCurOutput.c_str());
+      std::string result = reg->GetReplaceString(strCurOutput.c_str());
       if (!result.empty())
       {
         CStdString strResult(result);
@@ -330,7 +500,7 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
       if (bRepeat && iLen > 0)
       {
         curInput.erase(0,i+iLen>(int)curInput.size()?curInput.size():i+iLen);
-        i = reg.RegFind(curInput.c_str());
+        i = reg->RegFind(curInput.c_str());
       }
       else
         i = -1;
@@ -540,27 +710,25 @@ void CScraperParser::Clean(CStdString& strDirty)
 
 void CScraperParser::ConvertJSON(CStdString &string)
 {
-  CRegExp reg;
-  reg.RegComp("\\\\u([0-f]{4})");
-  while (reg.RegFind(string.c_str()) > -1)
+  CScraperRegExp reg(*m_regExps, "\\\\u([0-f]{4})");
+  while (reg->RegFind(string.c_str()) > -1)
   {
-    int pos = reg.GetSubStart(1);
-    std::string szReplace(reg.GetMatch(1));
+    int pos = reg->GetSubStart(1);
+    std::string szReplace(reg->GetMatch(1));
 
     CStdString replace = StringUtils::Format("&#x%s;", szReplace.c_str());
     string.replace(string.begin()+pos-2, string.begin()+pos+4, replace);
   }
 
-  CRegExp reg2;
-  reg2.RegComp("\\\\x([0-9]{2})([^\\\\]+;)");
-  while (reg2.RegFind(string.c_str()) > -1)
+  CScraperRegExp reg2(*m_regExps, "\\\\x([0-9]{2})([^\\\\]+;)");
+  while (reg2->RegFind(string.c_str()) > -1)
   {
-    int pos1 = reg2.GetSubStart(1);
-    int pos2 = reg2.GetSubStart(2);
-    std::string szHexValue(reg2.GetMatch(1));
+    int pos1 = reg2->GetSubStart(1);
+    int pos2 = reg2->GetSubStart(2);
+    std::string szHexValue(reg2->GetMatch(1));
 
     CStdString replace = StringUtils::Format("%c", strtol(szHexValue.c_str(), NULL, 16));
-    string.replace(string.begin()+pos1-2, string.begin()+pos2+reg2.GetSubLength(2), replace);
+    string.replace(string.begin()+pos1-2, string.begin()+pos2+reg2->GetSubLength(2), replace);
   }
 
   StringUtils::Replace(string, "\\\"","\"");
@@ -22,6 +22,7 @@
  */
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include "StdString.h"
 #include "addons/IAddon.h"
 
@@ -36,6 +37,7 @@ class TiXmlElement;
 class CXBMCTinyXML;
 
 class CScraperSettings;
+class CScraperRegExpCache;
 
 class CScraperParser
 {
@@ -88,6 +90,9 @@ private:
 
   CStdString m_strFile;
   ADDON::CScraper* m_scraper;
+
+  /*! \brief compiled expressions, shared with the copies of this parser */
+  boost::shared_ptr<CScraperRegExpCache> m_regExps;
 };
 
 #endif
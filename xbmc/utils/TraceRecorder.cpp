@@ -0,0 +1,272 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "TraceRecorder.h"
+#include "filesystem/File.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+using namespace std;
+
+volatile bool CTraceRecorder::m_enabled = false;
+
+CTraceRecorder::CTraceRecorder()
+  : m_capture(0)
+  , m_start(0)
+  , m_stop(0)
+  , m_dropped(0)
+{
+  m_overflow.id = 0;
+  m_overflow.owned = false;
+  m_overflow.capture = 0;
+  m_overflow.written = 0;
+}
+
+CTraceRecorder::~CTraceRecorder()
+{
+  m_enabled = false;
+  for (vector<Buffer*>::iterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+    delete *it;
+}
+
+CTraceRecorder& CTraceRecorder::Get()
+{
+  static CTraceRecorder recorder;
+  return recorder;
+}
+
+void CTraceRecorder::Start()
+{
+  CSingleLock lock(m_critSection);
+
+  // the buffers of threads which didn't record in the last capture go to new
+  // threads. A running capture may have writers in the middle of an event,
+  // so only a stopped one gives up the buffers used in it.
+  long last = m_enabled ? m_capture : m_capture + 1;
+  for (vector<Buffer*>::iterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    if ((*it)->owned && (*it)->capture < last)
+    {
+      (*it)->owned = false;
+      m_free.push_back(*it);
+    }
+  }
+  m_buffers.clear();
+  m_capture++;
+
+  m_start   = CurrentHostCounter();
+  m_stop    = 0;
+  m_dropped = 0;
+  m_enabled = true;
+  CLog::Log(LOGNOTICE, "CTraceRecorder: capture started");
+}
+
+void CTraceRecorder::Stop()
+{
+  CSingleLock lock(m_critSection);
+  if (!m_enabled)
+    return;
+  m_enabled = false;
+  m_stop    = CurrentHostCounter();
+  CLog::Log(LOGNOTICE, "CTraceRecorder: capture stopped");
+}
+
+const char* CTraceRecorder::Intern(const string &name)
+{
+  CSingleLock lock(m_critSection);
+  return m_names.insert(name).first->c_str();
+}
+
+void CTraceRecorder::Record(char phase, const char* name, int64_t value)
+{
+  // a thread takes its buffer up again in every capture, and needs another
+  // one if its buffer went to a new thread meanwhile
+  Buffer* buffer = m_buffer.get();
+  if (buffer == NULL || buffer->capture != m_capture ||
+      (buffer != &m_overflow && !CThread::IsCurrentThread(buffer->owner)))
+    buffer = AddBuffer(buffer);
+
+  if (buffer->events.empty())
+  {
+    AtomicIncrement(&m_dropped);
+    return;
+  }
+
+  Event &event = buffer->events[buffer->written % TRACE_BUFFER_EVENTS];
+  event.time  = CurrentHostCounter();
+  event.name  = name;
+  event.value = value;
+  event.phase = phase;
+
+  // the increment is a full barrier, so a reader seeing the new count also
+  // sees the event
+  AtomicIncrement(&buffer->written);
+}
+
+CTraceRecorder::Buffer* CTraceRecorder::AddBuffer(Buffer* previous)
+{
+  CSingleLock lock(m_critSection);
+  if (previous && previous->capture == m_capture && previous != &m_overflow &&
+      previous->owned && CThread::IsCurrentThread(previous->owner))
+    return previous;
+
+  string name;
+  CThread* thread = CThread::GetCurrentThread();
+  if (thread)
+    name = thread->GetName();
+
+  Buffer* buffer = NULL;
+  if (previous && previous != &m_overflow && CThread::IsCurrentThread(previous->owner))
+  {
+    // our own buffer of an earlier capture, which no other thread took
+    buffer = previous;
+    if (!buffer->owned)
+      m_free.erase(find(m_free.begin(), m_free.end(), buffer));
+  }
+  else if (!m_free.empty())
+  {
+    buffer = m_free.back();
+    m_free.pop_back();
+    buffer->written = 0;
+  }
+  else if (m_allocated.size() < TRACE_MAX_THREADS)
+  {
+    buffer = new Buffer;
+    buffer->id = m_allocated.size() + 1;
+    buffer->events.resize(TRACE_BUFFER_EVENTS);
+    buffer->written = 0;
+    m_allocated.push_back(buffer);
+  }
+  else
+  {
+    CLog::Log(LOGWARNING, "CTraceRecorder: all %d buffers are in use, dropping the events of thread %s",
+              TRACE_MAX_THREADS, name.empty() ? "without a name" : name.c_str());
+    m_overflow.capture = m_capture;
+    m_buffer.set(&m_overflow);
+    return &m_overflow;
+  }
+
+  buffer->owner = CThread::GetCurrentThreadId();
+  buffer->owned = true;
+  buffer->capture = m_capture;
+  buffer->thread = name.empty() ? StringUtils::Format("Thread %d", buffer->id) : name;
+
+  m_buffers.push_back(buffer);
+  m_buffer.set(buffer);
+  return buffer;
+}
+
+void CTraceRecorder::Snapshot(Buffer &buffer, vector<Event> &events)
+{
+  long written = AtomicAdd(&buffer.written, 0);
+  long first = max(0L, written - TRACE_BUFFER_EVENTS);
+  events.clear();
+  for (long i = first; i < written; i++)
+    events.push_back(buffer.events[i % TRACE_BUFFER_EVENTS]);
+
+  // the writer may have gone on and overwritten the oldest of the copied
+  // events, including the one it's writing now
+  long valid = AtomicAdd(&buffer.written, 0) + 1 - TRACE_BUFFER_EVENTS;
+  if (valid > first)
+    events.erase(events.begin(), events.begin() + min((long)events.size(), valid - first));
+}
+
+static string Escape(const char* name)
+{
+  string escaped;
+  for (const char* c = name; *c; c++)
+  {
+    if (*c == '"' || *c == '\\')
+      escaped += '\\';
+    if ((unsigned char)*c >= 0x20)
+      escaped += *c;
+  }
+  return escaped;
+}
+
+bool CTraceRecorder::Write(const string &path)
+{
+  vector<Buffer*> buffers;
+  int64_t start, stop;
+  {
+    CSingleLock lock(m_critSection);
+    buffers = m_buffers;
+    start = m_start;
+    stop  = m_enabled ? CurrentHostCounter() : m_stop;
+  }
+  if (start == 0)
+    return false;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGERROR, "CTraceRecorder: unable to write %s", path.c_str());
+    return false;
+  }
+
+  double scale = 1000000.0 / CurrentHostFrequency();
+  string json = "{\"traceEvents\":[";
+  bool written = true;
+  bool first = true;
+  unsigned int count = 0;
+  vector<Event> events;
+  for (vector<Buffer*>::const_iterator buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+  {
+    Snapshot(**buffer, events);
+
+    json += StringUtils::Format("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                                first ? "" : ",", (*buffer)->id, Escape((*buffer)->thread.c_str()).c_str());
+    first = false;
+
+    for (vector<Event>::const_iterator event = events.begin(); event != events.end(); ++event)
+    {
+      if (event->time < start || event->time > stop)
+        continue;
+
+      double ts = (event->time - start) * scale;
+      if (event->phase == 'C')
+        json += StringUtils::Format(",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%" PRId64 "}}",
+                                    Escape(event->name).c_str(), ts, (*buffer)->id, event->value);
+      else
+        json += StringUtils::Format(",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                                    Escape(event->name).c_str(), event->phase, ts, (*buffer)->id);
+      count++;
+
+      if (json.size() > 65536)
+      {
+        written &= file.Write(json.c_str(), json.size()) == (int)json.size();
+        json.clear();
+      }
+    }
+  }
+  json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  written &= file.Write(json.c_str(), json.size()) == (int)json.size();
+  file.Close();
+
+  CLog::Log(LOGNOTICE, "CTraceRecorder: wrote %u events of %u threads to %s", count, (unsigned int)buffers.size(), path.c_str());
+  return written;
+}
@@ -0,0 +1,150 @@
+#pragma once
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/ThreadImpl.h"
+#include "threads/ThreadLocal.h"
+
+#ifndef NO_TRACE_CAPTURE
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) CTraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if (CTraceRecorder::IsEnabled()) CTraceRecorder::Get().Counter(name, value); } while (0)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_COUNTER(name, value)
+#endif
+
+// events kept per thread, the oldest are overwritten
+#define TRACE_BUFFER_EVENTS 16384
+// buffers which are allocated, events of any further threads are dropped
+#define TRACE_MAX_THREADS   64
+
+/*!
+ \brief Records begin, end and counter events of any thread, for a timeline
+ of the playback pipeline in the trace viewer of Chrome (about:tracing).
+
+ Every thread writes into a ring buffer of its own, without any locking, so
+ the capture hardly disturbs the timing it's looking at. While no capture
+ is running the macros cost a test of a flag.
+
+ A thread keeps its buffer from one capture to the next. Start() hands the
+ buffers of threads which didn't record during the last capture, mostly
+ threads which have exited since, on to new threads.
+
+ Event names are not copied, they have to be string literals or come from
+ Intern().
+ */
+class CTraceRecorder
+{
+public:
+  static CTraceRecorder& Get();
+  static inline bool IsEnabled() { return m_enabled; }
+
+  void Start();
+  void Stop();
+
+  /*!
+   \brief Write the events recorded since Start() as Chrome trace event JSON
+   Can be called while the capture is running.
+   */
+  bool Write(const std::string &path);
+
+  /*!
+   \brief A copy of the name which lives as long as the recorder, for names
+   which aren't literals
+   */
+  const char* Intern(const std::string &name);
+
+  void Begin(const char* name)                  { Record('B', name, 0); }
+  void End(const char* name)                    { Record('E', name, 0); }
+  void Counter(const char* name, int64_t value) { Record('C', name, value); }
+
+  /* events not recorded as no buffer was left for their thread */
+  unsigned int GetDropped() const               { return (unsigned int)m_dropped; }
+
+private:
+  CTraceRecorder();
+  ~CTraceRecorder();
+
+  struct Event
+  {
+    int64_t     time;
+    const char* name;
+    int64_t     value;
+    char        phase;
+  };
+
+  struct Buffer
+  {
+    int                id;
+    std::string        thread;
+    ThreadIdentifier   owner;
+    bool               owned;      // false while the buffer waits for a new thread
+    long               capture;    // last capture the owner recorded in
+    std::vector<Event> events;
+    volatile long      written;    // events written since the buffer was handed out
+  };
+
+  void Record(char phase, const char* name, int64_t value);
+  Buffer* AddBuffer(Buffer* previous);
+  static void Snapshot(Buffer &buffer, std::vector<Event> &events);
+
+  static volatile bool m_enabled;
+
+  CCriticalSection m_critSection;
+  XbmcThreads::ThreadLocal<Buffer> m_buffer;
+  std::vector<Buffer*> m_allocated;
+  std::vector<Buffer*> m_buffers;   // buffers of the threads recording in this capture
+  std::vector<Buffer*> m_free;
+  Buffer m_overflow;
+  long m_capture;
+  std::set<std::string> m_names;
+  int64_t m_start;
+  int64_t m_stop;
+  volatile long m_dropped;
+};
+
+class CTraceScope
+{
+public:
+  CTraceScope(const char* name) : m_name(NULL)
+  {
+    if (CTraceRecorder::IsEnabled())
+    {
+      m_name = name;
+      CTraceRecorder::Get().Begin(name);
+    }
+  }
+  ~CTraceScope()
+  {
+    if (m_name)
+      CTraceRecorder::Get().End(m_name);
+  }
+
+private:
+  const char* m_name;
+};
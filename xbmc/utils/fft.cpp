@@ -29,6 +29,10 @@
 
 #include "fft.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI  3.1415926535897932384626433832795
 #endif
@@ -172,3 +176,160 @@ void twochanwithwindow(float data[], int n)
   }
 }
 
+
+CRealFFT::CRealFFT(int size, bool windowed)
+  : m_size(size)
+{
+  const int half = size / 2;
+
+  m_bitReverse.resize(half);
+  int bits = 0;
+  while ((1 << bits) < half)
+    bits++;
+  for (int i = 0; i < half; i++)
+  {
+    int reversed = 0;
+    for (int b = 0; b < bits; b++)
+    {
+      if (i & (1 << b))
+        reversed |= 1 << (bits - 1 - b);
+    }
+    m_bitReverse[i] = reversed;
+  }
+
+  // the twiddles of the stage combining blocks of h start at 2*(h-1)
+  m_twiddles.resize(2 * half);
+  for (int h = 1; h < half; h <<= 1)
+  {
+    for (int j = 0; j < h; j++)
+    {
+      const double theta = -M_PI * j / h;
+      m_twiddles[2 * (h - 1 + j)] = (float)cos(theta);
+      m_twiddles[2 * (h - 1 + j) + 1] = (float)sin(theta);
+    }
+  }
+
+  m_split.resize(2 * half);
+  for (int k = 0; k < half; k++)
+  {
+    const double theta = -2.0 * M_PI * k / size;
+    m_split[2 * k] = (float)cos(theta);
+    m_split[2 * k + 1] = (float)sin(theta);
+  }
+
+  m_window.assign(size, 1.0f);
+  if (windowed)
+  {
+    for (int i = 0; i < size; i++)
+      m_window[i] = (float)(0.5 * (1 - cos(2.0 * M_PI * i / size)));
+  }
+
+  m_work.resize(2 * half);
+  m_spectrum.resize(size + 2);
+}
+
+void CRealFFT::Calc(const float *input, float *output)
+{
+  Transform(input, 1, output);
+}
+
+void CRealFFT::CalcStereoPower(const float *input, float *output)
+{
+  const int half = m_size / 2;
+  for (int channel = 0; channel < 2; channel++)
+  {
+    Transform(input + channel, 2, &m_spectrum[0]);
+
+    // twochanwithwindow() returns the squared DC and Nyquist bins and twice
+    // the power of all other bins
+    const float *bin = &m_spectrum[0];
+    output[channel] = bin[0] * bin[0];
+    output[m_size + channel] = bin[m_size] * bin[m_size];
+    for (int k = 1; k < half; k++)
+      output[2 * k + channel] = 2 * (bin[2 * k] * bin[2 * k] + bin[2 * k + 1] * bin[2 * k + 1]);
+  }
+}
+
+void CRealFFT::Transform(const float *input, int stride, float *output)
+{
+  const int half = m_size / 2;
+  float *work = &m_work[0];
+  const float *window = &m_window[0];
+
+  // pack even and odd samples into a complex signal of half the size,
+  // windowed and in bit reversed order
+  for (int k = 0; k < half; k++)
+  {
+    float *z = work + 2 * m_bitReverse[k];
+    z[0] = input[2 * k * stride] * window[2 * k];
+    z[1] = input[(2 * k + 1) * stride] * window[2 * k + 1];
+  }
+
+  // first stage, all twiddles are 1
+  for (int i = 0; i < 2 * half; i += 4)
+  {
+    const float re = work[i + 2], im = work[i + 3];
+    work[i + 2] = work[i] - re;
+    work[i + 3] = work[i + 1] - im;
+    work[i] += re;
+    work[i + 1] += im;
+  }
+
+  for (int h = 2; h < half; h <<= 1)
+  {
+    const float *twiddles = &m_twiddles[2 * (h - 1)];
+    for (int group = 0; group < half; group += 2 * h)
+    {
+      float *a = work + 2 * group;
+      float *b = a + 2 * h;
+#ifdef __SSE2__
+      // two butterflies at a time, h is even from here on
+      const __m128 sign = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f);
+      for (int j = 0; j < 2 * h; j += 4)
+      {
+        const __m128 w = _mm_loadu_ps(twiddles + j);
+        const __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+        const __m128 vb = _mm_loadu_ps(b + j);
+        const __m128 swapped = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+        // (br*wr - bi*wi, bi*wr + br*wi)
+        const __m128 t = _mm_add_ps(_mm_mul_ps(vb, wr), _mm_mul_ps(_mm_mul_ps(swapped, wi), sign));
+        const __m128 va = _mm_loadu_ps(a + j);
+        _mm_storeu_ps(b + j, _mm_sub_ps(va, t));
+        _mm_storeu_ps(a + j, _mm_add_ps(va, t));
+      }
+#else
+      for (int j = 0; j < 2 * h; j += 2)
+      {
+        const float wr = twiddles[j], wi = twiddles[j + 1];
+        const float re = b[j] * wr - b[j + 1] * wi;
+        const float im = b[j + 1] * wr + b[j] * wi;
+        b[j] = a[j] - re;
+        b[j + 1] = a[j + 1] - im;
+        a[j] += re;
+        a[j + 1] += im;
+      }
+#endif
+    }
+  }
+
+  // split into the spectrum of the real signal:
+  // X[k] = E[k] + exp(-2*pi*i*k/size) * O[k], with the spectra of the even
+  // and odd samples E[k] = (Z[k] + conj(Z[half-k])) / 2 and
+  // O[k] = -i * (Z[k] - conj(Z[half-k])) / 2
+  output[0] = work[0] + work[1];
+  output[1] = 0.0f;
+  output[m_size] = work[0] - work[1];
+  output[m_size + 1] = 0.0f;
+  const float *split = &m_split[0];
+  for (int k = 1; k < half; k++)
+  {
+    const float zr = work[2 * k], zi = work[2 * k + 1];
+    const float cr = work[2 * (half - k)], ci = -work[2 * (half - k) + 1];
+    const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+    const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+    const float wr = split[2 * k], wi = split[2 * k + 1];
+    output[2 * k] = er + wr * or_ - wi * oi;
+    output[2 * k + 1] = ei + wr * oi + wi * or_;
+  }
+}
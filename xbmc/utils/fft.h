@@ -48,5 +48,56 @@ void fft( float data[], int nn, int isign );
 void twochannelrfft(float data[], int n);
 void twochanwithwindow(float data[], int n); // test
 
+#include <vector>
+
+/*!
+ \brief Real input FFT of a fixed size.
+
+ Bit reversal, twiddle factors and the optional Hann window are computed once
+ on construction, so transforming a block only costs the butterflies. The n
+ real samples are transformed as a complex FFT of size n/2 which is then split
+ into the n/2+1 bins of the real signal. The transform isn't scaled and uses
+ the exp(-2*pi*i*j*k/n) kernel.
+
+ Not reentrant, every thread needs its own instance.
+ */
+class CRealFFT
+{
+public:
+  /*!
+   \param size number of real samples per transform, a power of 2 of at least 4
+   \param windowed whether to apply a Hann window to the samples
+   */
+  CRealFFT(int size, bool windowed);
+
+  int GetSize() const { return m_size; }
+
+  /*!
+   \brief Spectrum of a real signal.
+   \param input size samples
+   \param output size/2+1 complex bins as interleaved real and imaginary parts, size+2 floats
+   */
+  void Calc(const float *input, float *output);
+
+  /*!
+   \brief Power spectrum of two interleaved channels, scaled like twochanwithwindow().
+   \param input size frames of interleaved left and right samples
+   \param output power of the left and right channel for each of the size/2+1
+                 bins, interleaved, size+2 floats
+   */
+  void CalcStereoPower(const float *input, float *output);
+
+private:
+  void Transform(const float *input, int stride, float *output);
+
+  int m_size;
+  std::vector<int> m_bitReverse;
+  std::vector<float> m_twiddles;   // per butterfly stage, interleaved complex
+  std::vector<float> m_split;      // exp(-2*pi*i*k/size) for splitting the real spectrum
+  std::vector<float> m_window;
+  std::vector<float> m_work;
+  std::vector<float> m_spectrum;
+};
+
 
 #endif
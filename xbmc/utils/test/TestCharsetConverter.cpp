@@ -19,6 +19,7 @@
  */
 
 #include "settings/Settings.h"
+#include "threads/Thread.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StdString.h"
 #include "utils/Utf8Utils.h"
@@ -405,3 +406,156 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_InvalidSequences)
+{
+  static const struct
+  {
+    const char *utf8;
+    const char *skipped; /* result with invalid characters skipped, as UTF-8 */
+  } sequences[] = {
+    { "a\x80" "b",                 "ab" },   /* lone continuation byte */
+    { "a\xC0\x80" "b",             "ab" },   /* overlong NUL */
+    { "a\xE0\x80\xAF" "b",         "ab" },   /* overlong '/' */
+    { "a\xED\xA0\x80" "b",         "ab" },   /* UTF-16 surrogate */
+    { "a\xF4\x90\x80\x80" "b",     "ab" },   /* beyond U+10FFFF */
+    { "a\xF5\x80\x80\x80" "b",     "ab" },   /* invalid lead byte */
+    { "a\xFF" "b",                 "ab" },
+    { "a\xE3\x81" "b",             "ab" },   /* truncated in the middle */
+    { "ab\xE3\x81",               "ab" },   /* truncated at the end */
+    { "ab\xF0\x9F\x90",           "ab" }
+  };
+
+  for (unsigned int i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++)
+  {
+    std::u32string utf32;
+    EXPECT_FALSE(g_charsetConverter.utf8ToUtf32(sequences[i].utf8, utf32, true)) << "sequence " << i;
+    EXPECT_TRUE(utf32.empty()) << "sequence " << i;
+
+    EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(sequences[i].utf8, utf32, false)) << "sequence " << i;
+    EXPECT_EQ(g_charsetConverter.utf8ToUtf32(sequences[i].skipped), utf32) << "sequence " << i;
+  }
+
+  // boundaries of the valid ranges
+  std::u32string utf32;
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32("\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF", utf32));
+  static const char32_t boundaries[] = { 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000, 0x10FFFF };
+  EXPECT_EQ(std::u32string(boundaries, sizeof(boundaries) / sizeof(boundaries[0])), utf32);
+}
+
+TEST_F(TestCharsetConverter, utf32ToUtf8_InvalidCodePoints)
+{
+  static const char32_t invalid[] = { 'a', 0xD800, 0xDFFF, 0x110000, 0xFFFFFFFF, 'b' };
+  std::u32string utf32(invalid, sizeof(invalid) / sizeof(invalid[0]));
+  std::string utf8;
+  EXPECT_FALSE(g_charsetConverter.utf32ToUtf8(utf32, utf8, true));
+  EXPECT_TRUE(utf8.empty());
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, utf8, false));
+  EXPECT_STREQ("ab", utf8.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf16ToUTF8_Surrogates)
+{
+  static const uint16_t pair[] = { 'a', 0xD83D, 0xDC2D, 'b', 0x0 };
+  static const uint16_t unpairedHigh[] = { 'a', 0xD83D, 'b', 0x0 };
+  static const uint16_t unpairedLow[] = { 'a', 0xDC2D, 'b', 0x0 };
+  static const uint16_t truncated[] = { 'a', 'b', 0xD83D, 0x0 };
+
+  refstr16_1.assign(pair);
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(refstr16_1, varstra1));
+  EXPECT_STREQ("a\xF0\x9F\x90\xAD" "b", varstra1.c_str());
+  EXPECT_TRUE(g_charsetConverter.ucs2ToUTF8(refstr16_1, varstra1));
+  EXPECT_STREQ("ab", varstra1.c_str());
+
+  refstr16_1.assign(unpairedHigh);
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(refstr16_1, varstra1));
+  EXPECT_STREQ("ab", varstra1.c_str());
+
+  refstr16_1.assign(unpairedLow);
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(refstr16_1, varstra1));
+  EXPECT_STREQ("ab", varstra1.c_str());
+
+  refstr16_1.assign(truncated);
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(refstr16_1, varstra1));
+  EXPECT_STREQ("ab", varstra1.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_RoundTrip)
+{
+  std::u32string all;
+  for (char32_t c = 1; c <= 0x10FFFF; c += (c < 0x800 ? 1 : 7))
+  {
+    if (c < 0xD800 || c > 0xDFFF)
+      all.push_back(c);
+  }
+
+  std::string utf8;
+  std::u32string utf32;
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(all, utf8, true));
+  EXPECT_TRUE(CUtf8Utils::isValidUtf8(utf8));
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(utf8, utf32, true));
+  EXPECT_EQ(all, utf32);
+
+  std::wstring wide;
+  EXPECT_TRUE(g_charsetConverter.utf8ToW(utf8, wide, false, false, true));
+  EXPECT_TRUE(g_charsetConverter.wToUTF8(wide, varstra1, true));
+  EXPECT_EQ(utf8, varstra1);
+}
+
+class CCharsetConverterThread : public CThread
+{
+public:
+  CCharsetConverterThread(const std::string &text, unsigned int iterations)
+    : CThread("CharsetConverter"), m_errors(0), m_text(text), m_iterations(iterations)
+  { }
+
+  unsigned int m_errors;
+
+protected:
+  virtual void Process()
+  {
+    std::u32string utf32;
+    std::string utf8, system;
+    for (unsigned int i = 0; i < m_iterations; i++)
+    {
+      if (!g_charsetConverter.utf8ToUtf32(m_text, utf32) ||
+          !g_charsetConverter.utf32ToUtf8(utf32, utf8) ||
+          utf8 != m_text)
+        m_errors++;
+
+      // legacy charsets still go through iconv
+      if (!g_charsetConverter.systemToUtf8("plain ascii title", system) ||
+          system != "plain ascii title")
+        m_errors++;
+    }
+  }
+
+  std::string m_text;
+  unsigned int m_iterations;
+};
+
+TEST_F(TestCharsetConverter, ConcurrentConversions)
+{
+  static const unsigned int threads = 4;
+  static const unsigned int iterations = 200;
+
+  // a typical label: mostly ASCII with some accented and CJK characters
+  std::string text;
+  for (int i = 0; i < 8; i++)
+    text += "The Movie Title (2014) - ｔｅｓｔ caf\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC ";
+
+  std::vector<CCharsetConverterThread*> workers;
+  for (unsigned int i = 0; i < threads; i++)
+    workers.push_back(new CCharsetConverterThread(text, iterations));
+
+  for (unsigned int i = 0; i < threads; i++)
+    workers[i]->Create();
+  for (unsigned int i = 0; i < threads; i++)
+    workers[i]->StopThread(true);
+
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    EXPECT_EQ(0u, workers[i]->m_errors);
+    delete workers[i];
+  }
+}
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "utils/DirectoryWatcher.h"
+
+#ifdef HAVE_INOTIFY
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+static int RemoveEntry(const char *path, const struct stat *, int, struct FTW *)
+{
+  return remove(path);
+}
+
+class TestDirectoryWatcher : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    char path[] = "/tmp/xbmc-dirwatch-XXXXXX";
+    ASSERT_TRUE(mkdtemp(path) != NULL);
+    m_root = std::string(path) + "/";
+
+    // library/movies/a/a.mkv, library/movies/b/b.mkv, library/music/album/01.mp3
+    MakeDir("library");
+    MakeDir("library/movies");
+    MakeDir("library/movies/a");
+    WriteFile("library/movies/a/a.mkv");
+    MakeDir("library/movies/b");
+    WriteFile("library/movies/b/b.mkv");
+    MakeDir("library/music");
+    MakeDir("library/music/album");
+    WriteFile("library/music/album/01.mp3");
+    MakeDir("outside");
+
+    ASSERT_TRUE(m_watcher.Watch(m_root + "library"));
+  }
+
+  virtual void TearDown()
+  {
+    m_watcher.UnwatchAll();
+    nftw(m_root.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  void MakeDir(const std::string &path)
+  {
+    ASSERT_EQ(0, mkdir((m_root + path).c_str(), 0755));
+  }
+
+  void WriteFile(const std::string &path)
+  {
+    FILE *file = fopen((m_root + path).c_str(), "w");
+    ASSERT_TRUE(file != NULL);
+    fputs("test", file);
+    fclose(file);
+  }
+
+  void Rename(const std::string &from, const std::string &to)
+  {
+    ASSERT_EQ(0, rename((m_root + from).c_str(), (m_root + to).c_str()));
+  }
+
+  void Remove(const std::string &path)
+  {
+    ASSERT_EQ(0, nftw((m_root + path).c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS));
+  }
+
+  // the settled changes as a comma separated list of paths relative to the root
+  std::string Changes(unsigned int settleTime = 0)
+  {
+    while (m_watcher.Poll(50))
+      ;
+
+    std::set<std::string> changes;
+    m_watcher.GetChanges(changes, settleTime);
+    std::string result;
+    for (std::set<std::string>::const_iterator it = changes.begin(); it != changes.end(); ++it)
+    {
+      if (!result.empty())
+        result += ",";
+      result += it->substr(m_root.size());
+    }
+    return result;
+  }
+
+  std::string m_root;
+  CDirectoryWatcher m_watcher;
+};
+
+TEST_F(TestDirectoryWatcher, Files)
+{
+  EXPECT_EQ("", Changes());
+
+  WriteFile("library/movies/a/c.mkv");
+  EXPECT_EQ("library/movies/a/", Changes());
+
+  ASSERT_EQ(0, unlink((m_root + "library/movies/a/a.mkv").c_str()));
+  WriteFile("library/music/album/02.mp3");
+  EXPECT_EQ("library/movies/a/,library/music/album/", Changes());
+
+  Rename("library/movies/b/b.mkv", "library/movies/a/b.mkv");
+  EXPECT_EQ("library/movies/a/,library/movies/b/", Changes());
+
+  // files coming from or going outside the library count as added or removed
+  WriteFile("outside/d.mkv");
+  EXPECT_EQ("", Changes());
+  Rename("outside/d.mkv", "library/movies/b/d.mkv");
+  EXPECT_EQ("library/movies/b/", Changes());
+  Rename("library/music/album/01.mp3", "outside/01.mp3");
+  EXPECT_EQ("library/music/album/", Changes());
+}
+
+TEST_F(TestDirectoryWatcher, Directories)
+{
+  // new directories are reported and watched along with what was created
+  // in them before the watch was in place
+  MakeDir("library/movies/d");
+  MakeDir("library/movies/d/e");
+  WriteFile("library/movies/d/e/f.mkv");
+  EXPECT_EQ("library/movies/d/,library/movies/d/e/", Changes());
+  WriteFile("library/movies/d/e/g.mkv");
+  EXPECT_EQ("library/movies/d/e/", Changes());
+
+  // renames report both the old and the new path and keep watching
+  Rename("library/movies/d", "library/movies/h");
+  EXPECT_EQ("library/movies/d/,library/movies/h/", Changes());
+  WriteFile("library/movies/h/e/i.mkv");
+  EXPECT_EQ("library/movies/h/e/", Changes());
+
+  // removals report the removed directories
+  Remove("library/movies/h");
+  EXPECT_EQ("library/movies/h/,library/movies/h/e/", Changes());
+
+  // moving a directory out of the library removes it
+  Rename("library/movies/a", "outside/a");
+  EXPECT_EQ("library/movies/a/", Changes());
+  WriteFile("outside/a/j.mkv");
+  EXPECT_EQ("", Changes());
+
+  // and moving it back adds it again
+  Rename("outside/a", "library/music/a");
+  EXPECT_EQ("library/music/a/", Changes());
+  WriteFile("library/music/a/k.mp3");
+  EXPECT_EQ("library/music/a/", Changes());
+  EXPECT_FALSE(m_watcher.HasOverflowed());
+}
+
+TEST_F(TestDirectoryWatcher, Settle)
+{
+  WriteFile("library/movies/a/c.mkv");
+  EXPECT_EQ("", Changes(60000));
+
+  // further changes keep the directory from settling
+  WriteFile("library/movies/a/d.mkv");
+  EXPECT_EQ("", Changes(60000));
+  EXPECT_EQ("library/movies/a/", Changes());
+}
+
+TEST_F(TestDirectoryWatcher, Unwatch)
+{
+  ASSERT_TRUE(m_watcher.Watch(m_root + "library/movies/"));
+  EXPECT_EQ(2U, m_watcher.GetWatched().size());
+
+  // nested roots keep being watched when the outer one goes away
+  m_watcher.Unwatch(m_root + "library/");
+  WriteFile("library/music/album/02.mp3");
+  WriteFile("library/movies/b/c.mkv");
+  EXPECT_EQ("library/movies/b/", Changes());
+
+  m_watcher.Unwatch(m_root + "library/movies");
+  EXPECT_TRUE(m_watcher.GetWatched().empty());
+  WriteFile("library/movies/b/d.mkv");
+  EXPECT_EQ("", Changes());
+}
+#endif
@@ -19,9 +19,15 @@
  */
 
 #include "utils/PerformanceSample.h"
+#include "utils/PerformanceStats.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 class MyCPerformanceSample : public CPerformanceSample
 {
 public:
@@ -51,3 +57,234 @@ TEST(TestPerformanceSample, General)
   std::cout << "Start: " << testing::PrintToString(a.getStart()) << std::endl;
   std::cout << "Frequency: " << testing::PrintToString(a.getFreq()) << std::endl;
 }
+
+TEST(TestPerformanceSample, Counter)
+{
+  int counter = CPerformanceSample::Register("TestPerformanceSample");
+  EXPECT_LE(0, counter);
+  EXPECT_EQ(counter, CPerformanceSample::Register("TestPerformanceSample"));
+
+  { CPerformanceSample a(counter); }
+
+  // more than one in a scope
+  {
+    MEASURE_SCOPE("TestPerformanceSample");
+    MEASURE_SCOPE("TestPerformanceSample-Second");
+    MEASURE_DYNAMIC_SCOPE(StringUtils::Format("TestPerformanceSample-%i", counter));
+    MEASURE_DYNAMIC_SCOPE(std::string("TestPerformanceSample-Dynamic"));
+  }
+  EXPECT_NE(counter, CPerformanceSample::Register("TestPerformanceSample-Second"));
+  EXPECT_NE(counter, CPerformanceSample::Register("TestPerformanceSample-Dynamic"));
+}
+
+TEST(TestPerformanceHistogram, Buckets)
+{
+  // small values are exact
+  for (int64_t i = 0; i < 64; i++)
+  {
+    EXPECT_EQ((unsigned int)i, CPerformanceHistogram::GetBucket(i));
+    EXPECT_EQ(i, CPerformanceHistogram::GetUpperBound(i));
+  }
+  EXPECT_EQ(0U, CPerformanceHistogram::GetBucket(-5));
+
+  // larger ones within 1/32, and the buckets follow each other without gaps
+  unsigned int last = 63;
+  for (int64_t value = 64; value < ((int64_t)1 << PERFSTATS_MAX_BITS); value += value / 7 + 1)
+  {
+    unsigned int bucket = CPerformanceHistogram::GetBucket(value);
+    ASSERT_LT(bucket, (unsigned int)PERFSTATS_BUCKETS);
+    EXPECT_LE(last, bucket);
+    last = bucket;
+
+    int64_t upper = CPerformanceHistogram::GetUpperBound(bucket);
+    EXPECT_LE(value, upper);
+    EXPECT_GE(value + value / 32, upper);
+    EXPECT_EQ(bucket, CPerformanceHistogram::GetBucket(upper));
+    if (bucket < PERFSTATS_BUCKETS - 1)
+      EXPECT_EQ(bucket + 1, CPerformanceHistogram::GetBucket(upper + 1));
+  }
+
+  // values beyond the range end up in the last bucket
+  EXPECT_EQ((unsigned int)PERFSTATS_BUCKETS - 1, CPerformanceHistogram::GetBucket((int64_t)1 << PERFSTATS_MAX_BITS));
+  EXPECT_EQ((unsigned int)PERFSTATS_BUCKETS - 1, CPerformanceHistogram::GetBucket(((int64_t)1 << PERFSTATS_MAX_BITS) - 1));
+}
+
+TEST(TestPerformanceHistogram, Percentiles)
+{
+  CPerformanceHistogram histogram;
+  EXPECT_EQ(0U, histogram.GetCount());
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+
+  for (int64_t i = 1; i <= 10000; i++)
+    histogram.Add(i);
+  EXPECT_EQ(10000U, histogram.GetCount());
+  EXPECT_EQ(10000, histogram.GetMaximum());
+  EXPECT_DOUBLE_EQ(5000.5, histogram.GetAverage());
+  EXPECT_NEAR(5000, histogram.GetPercentile(50), 5000 / 32);
+  EXPECT_NEAR(9000, histogram.GetPercentile(90), 9000 / 32);
+  EXPECT_NEAR(9900, histogram.GetPercentile(99), 9900 / 32);
+  EXPECT_EQ(10000, histogram.GetPercentile(100));
+  EXPECT_EQ(1, histogram.GetPercentile(0));
+
+  // a single outlier shows in the maximum, not in the percentiles
+  histogram.Add(5000000);
+  EXPECT_EQ(5000000, histogram.GetMaximum());
+  EXPECT_NEAR(9900, histogram.GetPercentile(99), 9900 / 32);
+  EXPECT_EQ(5000000, histogram.GetPercentile(100));
+
+  CPerformanceHistogram merged;
+  merged.Merge(histogram);
+  merged.Merge(histogram);
+  EXPECT_EQ(20002U, merged.GetCount());
+  EXPECT_EQ(5000000, merged.GetMaximum());
+  EXPECT_EQ(histogram.GetPercentile(90), merged.GetPercentile(90));
+}
+
+TEST(TestPerformanceStats, Register)
+{
+  CPerformanceStats stats;
+  int a = stats.Register("a");
+  int b = stats.Register("b");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, stats.Register("a"));
+
+  stats.AddSample(a, 10);
+  stats.AddSample(a, 30);
+  stats.AddSample("b", 0.002);
+  stats.AddSample(-1, 100);
+  stats.Register("unused");
+
+  std::vector<PerformanceCounter> counters;
+  stats.GetStats(counters);
+  ASSERT_EQ(2U, counters.size());
+  EXPECT_EQ("a", counters[0].m_name);
+  EXPECT_EQ(2U, counters[0].m_samples);
+  EXPECT_DOUBLE_EQ(20.0, counters[0].m_average);
+  EXPECT_EQ(10, counters[0].m_p50);
+  EXPECT_EQ(30, counters[0].m_max);
+  EXPECT_EQ("b", counters[1].m_name);
+  EXPECT_EQ(1U, counters[1].m_samples);
+  EXPECT_EQ(2000, counters[1].m_max);
+
+  for (int i = 3; i < PERFSTATS_MAX_COUNTERS; i++)
+    EXPECT_LE(0, stats.Register(StringUtils::Format("counter%i", i)));
+  EXPECT_EQ(-1, stats.Register("one too many"));
+}
+
+class CTestPerformanceStats : public CPerformanceStats
+{
+public:
+  // threads release their histograms after they signalled to be done
+  bool WaitForThreads(size_t threads)
+  {
+    for (int i = 0; i < 1000; i++)
+    {
+      {
+        CSingleLock lock(m_lock);
+        if (m_threads.size() <= threads)
+          return true;
+      }
+      XbmcThreads::ThreadSleep(10);
+    }
+    return false;
+  }
+};
+
+class CSampleThread : public CThread
+{
+public:
+  CSampleThread(CPerformanceStats &stats, int first, int second, int samples)
+    : CThread("PerformanceStats"),
+      m_stats(stats),
+      m_first(first),
+      m_second(second),
+      m_samples(samples)
+  { }
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < m_samples; i++)
+    {
+      m_stats.AddSample(m_first, i % 1000);
+      m_stats.AddSample(m_second, 1000000);
+    }
+  }
+
+  CPerformanceStats &m_stats;
+  int m_first;
+  int m_second;
+  int m_samples;
+};
+
+TEST(TestPerformanceStats, Concurrent)
+{
+  static const int threads = 8;
+  static const int samples = 100000;
+
+  CTestPerformanceStats stats;
+  int first = stats.Register("first");
+  int second = stats.Register("second");
+
+  std::vector<CSampleThread*> workers;
+  for (int i = 0; i < threads; i++)
+    workers.push_back(new CSampleThread(stats, first, second, samples));
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i]->Create();
+
+  // reading while the threads record never sees more than was recorded,
+  // nor less than before
+  uint64_t last = 0;
+  std::vector<PerformanceCounter> counters;
+  for (int i = 0; i < 100; i++)
+  {
+    stats.GetStats(counters);
+    if (counters.empty())
+      continue;
+    EXPECT_LE(last, counters[0].m_samples);
+    EXPECT_GE((uint64_t)threads * samples, counters[0].m_samples);
+    EXPECT_GT(1000, counters[0].m_max);
+    last = counters[0].m_samples;
+  }
+
+  for (size_t i = 0; i < workers.size(); i++)
+  {
+    workers[i]->StopThread();
+    delete workers[i];
+  }
+
+  stats.GetStats(counters);
+  EXPECT_TRUE(stats.WaitForThreads(0));
+  ASSERT_EQ(2U, counters.size());
+  EXPECT_EQ((uint64_t)threads * samples, counters[0].m_samples);
+  EXPECT_EQ(999, counters[0].m_max);
+  EXPECT_DOUBLE_EQ(499.5, counters[0].m_average);
+  EXPECT_NEAR(500, counters[0].m_p50, 500 / 32);
+  EXPECT_NEAR(990, counters[0].m_p99, 990 / 32);
+  EXPECT_EQ((uint64_t)threads * samples, counters[1].m_samples);
+  EXPECT_EQ(1000000, counters[1].m_p50);
+  EXPECT_EQ(1000000, counters[1].m_max);
+}
+
+TEST(TestPerformanceStats, ExitedThreads)
+{
+  CTestPerformanceStats stats;
+  int first = stats.Register("first");
+  int second = stats.Register("second");
+
+  // the samples of the threads which have exited are kept
+  for (int i = 0; i < 20; i++)
+  {
+    CSampleThread worker(stats, first, second, 100);
+    worker.Create();
+    worker.StopThread();
+  }
+  EXPECT_TRUE(stats.WaitForThreads(0));
+
+  std::vector<PerformanceCounter> counters;
+  stats.GetStats(counters);
+  ASSERT_EQ(2U, counters.size());
+  EXPECT_EQ(2000U, counters[0].m_samples);
+  EXPECT_EQ(99, counters[0].m_max);
+  EXPECT_EQ(2000U, counters[1].m_samples);
+}
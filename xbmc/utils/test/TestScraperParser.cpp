@@ -19,11 +19,16 @@
  */
 
 #include "utils/ScraperParser.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
 
 #include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+#include <vector>
+
 TEST(TestScraperParser, General)
 {
   CScraperParser a;
@@ -37,3 +42,123 @@ TEST(TestScraperParser, General)
     a.GetFilename().c_str());
   EXPECT_STREQ("UTF-8", a.GetSearchStringEncoding().c_str());
 }
+
+static const char *series_url = "http://thetvdb.com/api/1D62F2F90030C444/series/12345/all/en.zip";
+
+// scrape the episode guide and the details of every episode as the video scanner does
+static void Replay(CScraperParser &parser, const std::string &series, const std::vector<std::string> &episodes,
+                 std::vector<std::string> &results)
+{
+  results.clear();
+  parser.m_param[0] = series;
+  parser.m_param[1] = series_url;
+  results.push_back(parser.Parse("GetEpisodeList", NULL));
+  for (std::vector<std::string>::const_iterator it = episodes.begin(); it != episodes.end(); ++it)
+  {
+    parser.m_param[0] = series;
+    parser.m_param[1] = *it;
+    results.push_back(parser.Parse("GetEpisodeDetails", NULL));
+  }
+}
+
+class TestScraperParserReplay : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    ASSERT_TRUE(m_parser.Load(XBMC_REF_FILE_PATH("/addons/metadata.tvdb.com/tvdb.xml")));
+
+    FILE *f = fopen(XBMC_REF_FILE_PATH("/xbmc/utils/test/ScraperParser-tvdb.xml"), "r");
+    ASSERT_TRUE(f != NULL);
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+      m_series.append(buffer, read);
+    fclose(f);
+
+    for (size_t pos = m_series.find("<Episode>"); pos != std::string::npos; pos = m_series.find("<Episode>", pos + 1))
+    {
+      size_t start = m_series.find("<id>", pos) + 4;
+      m_episodes.push_back(m_series.substr(start, m_series.find("</id>", start) - start));
+    }
+  }
+
+  CScraperParser m_parser;
+  std::string m_series;
+  std::vector<std::string> m_episodes;
+};
+
+TEST_F(TestScraperParserReplay, Episodes)
+{
+  ASSERT_EQ(22U, m_episodes.size());
+
+  std::vector<std::string> results;
+  Replay(m_parser, m_series, m_episodes, results);
+  ASSERT_EQ(23U, results.size());
+  EXPECT_EQ(22, StringUtils::FindNumber(results[0], "<episode>"));
+  EXPECT_NE(std::string::npos, results[0].find("<title>Episode 14 &amp; the"));
+  EXPECT_NE(std::string::npos, results[0].find("<url cache=\"12345-en.xml\">"));
+
+  EXPECT_NE(std::string::npos, results[3].find("<uniqueid>" + m_episodes[2] + "</uniqueid>"));
+  EXPECT_NE(std::string::npos, results[3].find("<title>Episode 3 &amp; the"));
+  EXPECT_NE(std::string::npos, results[3].find("<season>1</season><episode>3</episode>"));
+  EXPECT_NE(std::string::npos, results[3].find("<director>Jon Reyes</director>"));
+  EXPECT_NE(std::string::npos, results[3].find("<runtime>45</runtime>"));
+
+  // once the expressions are cached the results are the same, also for copies
+  // of the parser which share the cache
+  std::vector<std::string> again;
+  Replay(m_parser, m_series, m_episodes, again);
+  EXPECT_TRUE(results == again);
+  CScraperParser copy(m_parser);
+  Replay(copy, m_series, m_episodes, again);
+  EXPECT_TRUE(results == again);
+}
+
+class CReplayThread : public CThread
+{
+public:
+  CReplayThread(const CScraperParser &parser, const std::string &series, const std::vector<std::string> &episodes)
+    : CThread("ScraperReplay"),
+      m_parser(parser),
+      m_series(series),
+      m_episodes(episodes)
+  { }
+
+  std::vector<std::string> m_results;
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < 5; i++)
+    {
+      std::vector<std::string> results;
+      Replay(m_parser, m_series, m_episodes, results);
+      if (i > 0 && results != m_results)
+        break;
+      m_results.swap(results);
+    }
+  }
+
+  CScraperParser m_parser;
+  const std::string &m_series;
+  const std::vector<std::string> &m_episodes;
+};
+
+TEST_F(TestScraperParserReplay, ConcurrentScrapers)
+{
+  std::vector<std::string> expected;
+  Replay(m_parser, m_series, m_episodes, expected);
+
+  std::vector<CReplayThread*> threads;
+  for (int i = 0; i < 4; i++)
+    threads.push_back(new CReplayThread(m_parser, m_series, m_episodes));
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i]->Create();
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i]->StopThread();
+    EXPECT_TRUE(expected == threads[i]->m_results);
+    delete threads[i];
+  }
+}
@@ -0,0 +1,286 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/TraceRecorder.h"
+#include "filesystem/File.h"
+#include "threads/Thread.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/Variant.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+class TestTraceRecorder : public testing::Test
+{
+protected:
+  TestTraceRecorder() : m_file(NULL) {}
+
+  virtual void SetUp()
+  {
+    m_file = XBMC_CREATETEMPFILE(".json");
+    ASSERT_TRUE(m_file != NULL);
+    m_file->Close();
+    m_path = XBMC_TEMPFILEPATH(m_file);
+  }
+
+  virtual void TearDown()
+  {
+    CTraceRecorder::Get().Stop();
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  // writes the capture and returns its events, without the thread names
+  CVariant Dump(std::map<int, std::string> &threads)
+  {
+    EXPECT_TRUE(CTraceRecorder::Get().Write(m_path));
+
+    std::string json;
+    FILE *file = fopen(m_path.c_str(), "r");
+    if (file != NULL)
+    {
+      char buffer[4096];
+      size_t read;
+      while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        json.append(buffer, read);
+      fclose(file);
+    }
+
+    CVariant trace = CJSONVariantParser::Parse((const unsigned char*)json.c_str(), json.size());
+    EXPECT_TRUE(trace["traceEvents"].isArray());
+
+    CVariant events(CVariant::VariantTypeArray);
+    for (CVariant::const_iterator_array it = trace["traceEvents"].begin_array(); it != trace["traceEvents"].end_array(); ++it)
+    {
+      if ((*it)["ph"].asString() == "M")
+        threads[(int)(*it)["tid"].asInteger()] = (*it)["args"]["name"].asString();
+      else
+        events.push_back(*it);
+    }
+    return events;
+  }
+
+  CVariant Dump()
+  {
+    std::map<int, std::string> threads;
+    return Dump(threads);
+  }
+
+  static unsigned int Count(const CVariant &events, const std::string &name, const std::string &phase)
+  {
+    unsigned int count = 0;
+    for (CVariant::const_iterator_array it = events.begin_array(); it != events.end_array(); ++it)
+    {
+      if ((*it)["name"].asString() == name && (*it)["ph"].asString() == phase)
+        count++;
+    }
+    return count;
+  }
+
+  XFILE::CFile *m_file;
+  std::string m_path;
+};
+
+TEST_F(TestTraceRecorder, Disabled)
+{
+  EXPECT_FALSE(CTraceRecorder::IsEnabled());
+  { TRACE_SCOPE("TestTraceRecorder::Before"); }
+
+  CTraceRecorder::Get().Start();
+  EXPECT_TRUE(CTraceRecorder::IsEnabled());
+  { TRACE_SCOPE("TestTraceRecorder::During"); }
+  TRACE_COUNTER("TestTraceRecorder::Counter", 42);
+  CTraceRecorder::Get().Stop();
+  EXPECT_FALSE(CTraceRecorder::IsEnabled());
+
+  { TRACE_SCOPE("TestTraceRecorder::After"); }
+  TRACE_COUNTER("TestTraceRecorder::Counter", 43);
+
+  CVariant events = Dump();
+  EXPECT_EQ(0U, Count(events, "TestTraceRecorder::Before", "B"));
+  EXPECT_EQ(1U, Count(events, "TestTraceRecorder::During", "B"));
+  EXPECT_EQ(1U, Count(events, "TestTraceRecorder::During", "E"));
+  EXPECT_EQ(0U, Count(events, "TestTraceRecorder::After", "B"));
+  ASSERT_EQ(1U, Count(events, "TestTraceRecorder::Counter", "C"));
+  for (CVariant::const_iterator_array it = events.begin_array(); it != events.end_array(); ++it)
+  {
+    if ((*it)["name"].asString() == "TestTraceRecorder::Counter")
+      EXPECT_EQ(42, (*it)["args"]["value"].asInteger());
+  }
+
+  // a new capture leaves out what was recorded before
+  CTraceRecorder::Get().Start();
+  events = Dump();
+  EXPECT_EQ(0U, Count(events, "TestTraceRecorder::During", "B"));
+}
+
+TEST_F(TestTraceRecorder, Intern)
+{
+  const char* name;
+  {
+    std::string temp = "MessageQueue(test)";
+    name = CTraceRecorder::Get().Intern(temp);
+  }
+  EXPECT_STREQ("MessageQueue(test)", name);
+  EXPECT_EQ(name, CTraceRecorder::Get().Intern("MessageQueue(test)"));
+  EXPECT_NE(name, CTraceRecorder::Get().Intern("MessageQueue(other)"));
+}
+
+class CTraceThread : public CThread
+{
+public:
+  CTraceThread(int events)
+    : CThread("TraceTest"),
+      m_events(events)
+  { }
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < m_events; i++)
+    {
+      TRACE_SCOPE("TraceThread::Outer");
+      TRACE_SCOPE("TraceThread::Inner");
+      TRACE_COUNTER("TraceThread::Counter", i);
+    }
+  }
+
+  int m_events;
+};
+
+TEST_F(TestTraceRecorder, Threads)
+{
+  static const int events = 1000;
+
+  CTraceRecorder::Get().Start();
+  std::vector<CTraceThread*> threads;
+  for (int i = 0; i < 4; i++)
+    threads.push_back(new CTraceThread(events));
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i]->Create();
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i]->StopThread();
+    delete threads[i];
+  }
+  CTraceRecorder::Get().Stop();
+
+  std::map<int, std::string> names;
+  CVariant trace = Dump(names);
+
+  // every thread has its own track, on which the scopes nest
+  std::map<int, std::vector<std::string> > stacks;
+  std::map<int, unsigned int> counters;
+  std::map<int, double> times;
+  for (CVariant::const_iterator_array it = trace.begin_array(); it != trace.end_array(); ++it)
+  {
+    int tid = (int)(*it)["tid"].asInteger();
+    std::string phase = (*it)["ph"].asString();
+    std::string name = (*it)["name"].asString();
+    if (name.find("TraceThread::") != 0)
+      continue;
+
+    EXPECT_EQ("TraceTest", names[tid]);
+    std::vector<std::string> &stack = stacks[tid];
+    if (phase == "B")
+      stack.push_back(name);
+    else if (phase == "E")
+    {
+      ASSERT_FALSE(stack.empty());
+      EXPECT_EQ(stack.back(), name);
+      stack.pop_back();
+    }
+    else if (phase == "C")
+    {
+      EXPECT_EQ(counters[tid], (*it)["args"]["value"].asUnsignedInteger());
+      counters[tid]++;
+    }
+
+    double ts = (*it)["ts"].asDouble();
+    EXPECT_LE(times[tid], ts);
+    times[tid] = ts;
+  }
+
+  EXPECT_EQ(4U, stacks.size());
+  for (std::map<int, std::vector<std::string> >::const_iterator it = stacks.begin(); it != stacks.end(); ++it)
+  {
+    EXPECT_TRUE(it->second.empty());
+    EXPECT_EQ((unsigned int)events, counters[it->first]);
+  }
+  EXPECT_EQ(0U, CTraceRecorder::Get().GetDropped());
+}
+
+TEST_F(TestTraceRecorder, ReuseBuffers)
+{
+  // more threads than buffers, one after another, in a single capture
+  CTraceRecorder::Get().Start();
+  for (int i = 0; i < TRACE_MAX_THREADS + 10; i++)
+  {
+    CTraceThread thread(1);
+    thread.Create();
+    thread.StopThread();
+  }
+  CTraceRecorder::Get().Stop();
+  EXPECT_LT(0U, CTraceRecorder::Get().GetDropped());
+
+  // the following captures hand the buffers of the exited threads on
+  for (int capture = 0; capture < 3; capture++)
+  {
+    CTraceRecorder::Get().Start();
+    for (int i = 0; i < TRACE_MAX_THREADS / 2; i++)
+    {
+      CTraceThread thread(1);
+      thread.Create();
+      thread.StopThread();
+    }
+    CTraceRecorder::Get().Stop();
+    EXPECT_EQ(0U, CTraceRecorder::Get().GetDropped());
+
+    std::map<int, std::string> names;
+    CVariant trace = Dump(names);
+    EXPECT_EQ((unsigned int)TRACE_MAX_THREADS / 2, Count(trace, "TraceThread::Counter", "C"));
+    EXPECT_GE((size_t)TRACE_MAX_THREADS / 2, names.size());
+  }
+}
+
+TEST_F(TestTraceRecorder, Wraparound)
+{
+  static const int events = 3 * TRACE_BUFFER_EVENTS + 100;
+
+  CTraceRecorder::Get().Start();
+  for (int i = 0; i < events; i++)
+    TRACE_COUNTER("TestTraceRecorder::Wraparound", i);
+
+  // dumping while capturing, the newest events are kept
+  CVariant trace = Dump();
+  int64_t expected = events - Count(trace, "TestTraceRecorder::Wraparound", "C");
+  EXPECT_LT(events - TRACE_BUFFER_EVENTS, expected);
+  for (CVariant::const_iterator_array it = trace.begin_array(); it != trace.end_array(); ++it)
+  {
+    if ((*it)["name"].asString() == "TestTraceRecorder::Wraparound")
+      EXPECT_EQ(expected++, (*it)["args"]["value"].asInteger());
+  }
+  EXPECT_EQ(events, expected);
+}
@@ -21,9 +21,14 @@
 #include "utils/fft.h"
 #include "utils/StdString.h"
 #include "utils/StringUtils.h"
+#include "utils/Stopwatch.h"
 
 #include "gtest/gtest.h"
 
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
 /* refdata[] below was generated using the following Python script.
 
 import math
@@ -317,3 +322,90 @@ TEST(Testfft, twochanwithwindow)
     EXPECT_STREQ(refstr.c_str(), varstr.c_str());
   }
 }
+
+static void referencedft(const std::vector<float> &input, std::vector<double> &output)
+{
+  int size = input.size();
+  output.assign(size + 2, 0.0);
+  for (int k = 0; k <= size / 2; k++)
+  {
+    for (int i = 0; i < size; i++)
+    {
+      double angle = -2.0 * M_PI * (double)k * i / size;
+      output[2 * k] += input[i] * cos(angle);
+      output[2 * k + 1] += input[i] * sin(angle);
+    }
+  }
+}
+
+TEST(Testfft, realfft)
+{
+  srand(1);
+  for (int size = 4; size <= 1024; size *= 2)
+  {
+    std::vector<float> input(size);
+    for (int i = 0; i < size; i++)
+      input[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+
+    std::vector<double> expected;
+    referencedft(input, expected);
+
+    CRealFFT transform(size, false);
+    std::vector<float> output(size + 2);
+    transform.Calc(&input[0], &output[0]);
+
+    // white noise of unit amplitude sums up to around sqrt(size) per bin
+    double tolerance = 1e-5 * size;
+    for (int i = 0; i < size + 2; i++)
+      EXPECT_NEAR(expected[i], output[i], tolerance) << "size " << size << ", index " << i;
+  }
+}
+
+TEST(Testfft, realfftstereopower)
+{
+  float vardata[REFDATA_NUMELEMENTS];
+  float output[REFDATA_NUMELEMENTS / 2 + 2];
+
+  memcpy(vardata, refdata, sizeof(refdata));
+  twochanwithwindow(vardata, REFDATA_NUMELEMENTS/2);
+
+  CRealFFT transform(REFDATA_NUMELEMENTS/2, true);
+  transform.CalcStereoPower(refdata, output);
+  for (int i = 0; i < REFDATA_NUMELEMENTS / 2 + 2; i++)
+    EXPECT_NEAR(vardata[i], output[i], 1e-5f + fabs(vardata[i]) * 1e-4f) << "index " << i;
+}
+
+TEST(Testfft, realfftbenchmark)
+{
+  // the block size and scaling CVisualisation::OnAudioData works with
+  static const int size = 512;
+  static const int callbacks = 2000;
+
+  std::vector<float> samples(2 * size);
+  for (int i = 0; i < 2 * size; i++)
+    samples[i] = sinf(i * 0.05f) * 0.5f + (float)rand() / RAND_MAX * 0.1f;
+
+  std::vector<float> data(2 * size);
+  CStopWatch watch;
+  watch.StartZero();
+  for (int i = 0; i < callbacks; i++)
+  {
+    memcpy(&data[0], &samples[0], 2 * size * sizeof(float));
+    twochanwithwindow(&data[0], size);
+  }
+  float twochanElapsed = watch.GetElapsedMilliseconds();
+
+  CRealFFT transform(size, true);
+  std::vector<float> output(size + 2);
+  watch.StartZero();
+  for (int i = 0; i < callbacks; i++)
+    transform.CalcStereoPower(&samples[0], &output[0]);
+  float realElapsed = watch.GetElapsedMilliseconds();
+
+  for (int i = 0; i < size + 2; i++)
+    EXPECT_NEAR(data[i], output[i], 1e-2f + fabs(data[i]) * 1e-4f);
+
+  RecordProperty("Callbacks", callbacks);
+  RecordProperty("TwoChanWithWindowNs", (int)(twochanElapsed * 1000000 / callbacks));
+  RecordProperty("RealFFTNs", (int)(realElapsed * 1000000 / callbacks));
+}
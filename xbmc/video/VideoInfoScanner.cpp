@@ -189,6 +189,84 @@ namespace VIDEO
     m_bRunning = true;
   }
 
+  void CVideoInfoScanner::Start(const set<string>& directories)
+  {
+    m_strStartDir.clear();
+    m_scanAll = false;
+    m_pathsToScan.clear();
+    m_pathsToClean.clear();
+
+    m_database.Open();
+    for (set<string>::const_iterator it = directories.begin(); it != directories.end(); ++it)
+    {
+      if (!CDirectory::Exists(*it))
+      { // clean what we knew about the folder and everything below it
+        int idPath = m_database.GetPathId(*it);
+        if (idPath >= 0)
+          m_pathsToClean.insert(idPath);
+        vector< pair<int, string> > subpaths;
+        m_database.GetSubPaths(*it, subpaths);
+        for (vector< pair<int, string> >::const_iterator i = subpaths.begin(); i != subpaths.end(); ++i)
+          m_pathsToClean.insert(i->first);
+        continue;
+      }
+
+      // episodes are scanned per show, so find the show folder (the child of
+      // the folder the tv show content was set on) for anything below it
+      CStdString path = *it;
+      CStdString child;
+      while (true)
+      {
+        SScanSettings settings;
+        bool foundDirectly = false;
+        ScraperPtr info = m_database.GetScraperForPath(path, settings, foundDirectly);
+        if (!info || info->Content() == CONTENT_NONE)
+          path.clear();
+        else if (info->Content() == CONTENT_TVSHOWS && !foundDirectly)
+        {
+          CStdString parent;
+          if (URIUtils::GetParentPath(path, parent) && parent != path)
+          {
+            child = path;
+            path = parent;
+            continue;
+          }
+          path.clear();
+        }
+        else if (info->Content() == CONTENT_TVSHOWS)
+        { // a single show folder is scanned as a whole
+          if (!settings.parent_name_root && !child.empty())
+            path = child;
+        }
+        else
+          path = *it;
+        break;
+      }
+      if (!path.empty())
+        m_pathsToScan.insert(path);
+    }
+    m_database.Close();
+
+    // drop folders that are scanned as part of one of their parents anyway
+    for (set<CStdString>::iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); )
+    {
+      set<CStdString>::iterator parent = m_pathsToScan.begin();
+      while (parent != m_pathsToScan.end() && (parent == it || !URIUtils::IsInPath(*it, *parent)))
+        ++parent;
+      if (parent != m_pathsToScan.end())
+        m_pathsToScan.erase(it++);
+      else
+        ++it;
+    }
+
+    // the clean is limited to the paths touched by this scan
+    m_bClean = true;
+
+    StopThread();
+    Create();
+    m_bRunning = true;
+  }
+
   bool CVideoInfoScanner::IsScanning()
   {
     return m_bRunning;
@@ -59,6 +59,13 @@ namespace VIDEO
      \param scanAll whether to scan everything not already scanned (regardless of whether the user normally doesn't want a folder scanned.) Defaults to false.
      */
     void Start(const CStdString& strDirectory, bool scanAll = false);
+
+    /*! \brief Scan only the given folders, e.g. those reported by CLibraryWatcher
+     Folders inside a tv show are scanned as the whole show. Items of folders
+     that no longer exist are cleaned from the library.
+     \param directories folders that changed, with trailing slashes
+     */
+    void Start(const std::set<std::string>& directories);
     bool IsScanning();
     void CleanDatabase(CGUIDialogProgressBarHandle* handle=NULL, const std::set<int>* paths=NULL, bool showProgress=true);
     void Stop();
@@ -101,7 +101,11 @@ bool CThumbExtractor::DoWork()
     // construct the thumb cache file
     CTextureDetails details;
     details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, &m_item.GetVideoInfoTag()->m_streamDetails);
+    // background extraction, keyframes are good enough and let the decoder be reused for the next episode
+    if (g_advancedSettings.m_videoThumbCandidates > 1)
+      result = CDVDFileInfo::ExtractBestThumb(m_item.GetPath(), details, &m_item.GetVideoInfoTag()->m_streamDetails, g_advancedSettings.m_videoThumbCandidates, true);
+    else
+      result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, &m_item.GetVideoInfoTag()->m_streamDetails, true);
     if(result)
     {
       CTextureCache::Get().AddCachedTexture(m_target, details);
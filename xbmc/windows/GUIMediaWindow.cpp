@@ -66,6 +66,8 @@
 #include "dialogs/GUIDialogKaiToast.h"
 #include "dialogs/GUIDialogMediaFilter.h"
 #include "filesystem/SmartPlaylistDirectory.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
 #if defined(TARGET_ANDROID)
 #include "xbmc/android/activity/XBMCApp.h"
 #endif
@@ -82,27 +84,93 @@
 #define PROPERTY_SORT_ORDER         "sort.order"
 #define PROPERTY_SORT_ASCENDING     "sort.ascending"
 
+// number of items of a cached directory decoded before it is first shown
+#define CACHED_ITEMS_FIRST_PAGE     50
+
 using namespace std;
 using namespace ADDON;
 
+/*!
+  \brief Loads the disc cache of a directory in a job
+  */
+class CLoadCachedItems
+{
+private:
+  struct CResult
+  {
+    CResult(const CStdString &path) : m_event(true), m_items(path), m_result(false) {}
+    CEvent        m_event;
+    CFileItemList m_items;
+    bool          m_result;
+  };
+
+  struct CLoadJob : CJob
+  {
+    CLoadJob(boost::shared_ptr<CResult> &result, int windowID) : m_result(result), m_windowID(windowID) {}
+
+    virtual bool DoWork()
+    {
+      m_result->m_result = m_result->m_items.Load(m_windowID);
+      m_result->m_event.Set();
+      return m_result->m_result;
+    }
+
+    boost::shared_ptr<CResult> m_result;
+    int m_windowID;
+  };
+
+public:
+  CLoadCachedItems(const CStdString &path, int windowID)
+    : m_result(new CResult(path))
+  {
+    m_id = CJobManager::GetInstance().AddJob(new CLoadJob(m_result, windowID), NULL, CJob::PRIORITY_HIGH);
+  }
+
+  ~CLoadCachedItems()
+  {
+    CJobManager::GetInstance().CancelJob(m_id);
+  }
+
+  bool Wait(unsigned int timeout)
+  {
+    return m_result->m_event.WaitMSec(timeout);
+  }
+
+  bool GetItems(CFileItemList &items)
+  {
+    if (!m_result->m_event.WaitMSec(0) || !m_result->m_result)
+      return false;
+
+    items.Assign(m_result->m_items);
+    return true;
+  }
+
+private:
+  boost::shared_ptr<CResult> m_result;
+  unsigned int               m_id;
+};
+
 CGUIMediaWindow::CGUIMediaWindow(int id, const char *xmlFile)
     : CGUIWindow(id, xmlFile)
 {
   m_loadType = KEEP_IN_MEMORY;
   m_vecItems = new CFileItemList;
   m_unfilteredItems = new CFileItemList;
+  m_partialItems = new CFileItemList;
   m_vecItems->SetPath("?");
   m_iLastControl = -1;
   m_iSelectedItem = -1;
   m_canFilterAdvanced = false;
 
   m_guiState.reset(CGUIViewState::GetViewState(GetID(), *m_vecItems));
+  m_rootDir.SetPartialDirectoryCallback(this);
 }
 
 CGUIMediaWindow::~CGUIMediaWindow()
 {
   delete m_vecItems;
   delete m_unfilteredItems;
+  delete m_partialItems;
 }
 
 #define CONTROL_VIEW_START        50
@@ -556,6 +624,71 @@ void CGUIMediaWindow::UpdateButtons()
   SET_CONTROL_LABEL2(CONTROL_BTN_FILTER, GetProperty("filter").asString());
 }
 
+/*!
+  \brief Shows the items of a slow directory while they are still being retrieved
+  The items are shown in the order the directory delivers them. They are
+  formatted and sorted once the directory is complete.
+  \param items All items retrieved so far
+  */
+void CGUIMediaWindow::OnPartialDirectory(const CFileItemList &items)
+{
+  if (!IsActive())
+    return;
+
+  m_partialItems->Assign(items);
+  m_partialItems->FillInDefaultIcons();
+  m_viewControl.SetItems(*m_partialItems);
+}
+
+void CGUIMediaWindow::ClearPartialItems()
+{
+  // the complete listing is sorted and shown by our caller, until then
+  // the view shows what it showed before we started
+  if (m_partialItems->Size())
+  {
+    m_viewControl.SetItems(*m_vecItems);
+    m_partialItems->Clear();
+  }
+}
+
+/*!
+  \brief Loads a directory from its disc cache
+  Decoding a large cache takes a while, so only its first page of items is
+  decoded right away and shown while the rest is decoded in a job.
+  \param items the list to load, its path is the directory to load
+  \return true if the directory was cached, false otherwise
+  */
+bool CGUIMediaWindow::LoadCachedItems(CFileItemList &items)
+{
+  if (!IsActive() || !g_application.IsCurrentThread())
+    return items.Load(GetID());
+
+  CFileItemList firstPage(items.GetPath());
+  if (!firstPage.LoadPage(0, CACHED_ITEMS_FIRST_PAGE, GetID()))
+    return false;
+
+  if (firstPage.Size() <= CACHED_ITEMS_FIRST_PAGE)
+  { // that was all of it
+    items.Assign(firstPage);
+    return true;
+  }
+
+  OnPartialDirectory(firstPage);
+
+  bool result;
+  {
+    CSingleExit ex(g_graphicsContext);
+
+    CLoadCachedItems load(items.GetPath(), GetID());
+    while (!load.Wait(10))
+      g_windowManager.ProcessRenderLoop(false);
+    result = load.GetItems(items);
+  }
+
+  ClearPartialItems();
+  return result;
+}
+
 void CGUIMediaWindow::ClearFileItems()
 {
   m_viewControl.Clear();
@@ -653,7 +786,7 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
 
   // see if we can load a previously cached folder
   CFileItemList cachedItems(strDirectory);
-  if (!strDirectory.empty() && cachedItems.Load(GetID()))
+  if (!strDirectory.empty() && LoadCachedItems(cachedItems))
   {
     items.Assign(cachedItems);
   }
@@ -664,7 +797,9 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
     if (strDirectory.empty())
       SetupShares();
 
-    if (!m_rootDir.GetDirectory(strDirectory, items))
+    bool result = m_rootDir.GetDirectory(strDirectory, items);
+    ClearPartialItems();
+    if (!result)
       return false;
 
     // took over a second, and not normally cached, so cache it
@@ -31,7 +31,7 @@
 class CFileItemList;
 
 // base class for all media windows
-class CGUIMediaWindow : public CGUIWindow
+class CGUIMediaWindow : public CGUIWindow, public XFILE::IPartialDirectoryCallback
 {
 public:
   CGUIMediaWindow(int id, const char *xmlFile);
@@ -52,6 +52,8 @@ public:
   virtual bool CanFilterAdvanced() { return m_canFilterAdvanced; }
   virtual bool IsFiltered();
 
+  virtual void OnPartialDirectory(const CFileItemList &items);
+
 protected:
   virtual void LoadAdditionalTags(TiXmlElement *root);
   CGUIControl *GetFirstFocusableControl(int id);
@@ -92,6 +94,8 @@ protected:
   virtual void GetGroupedItems(CFileItemList &items) { }
 
   void ClearFileItems();
+  void ClearPartialItems();
+  bool LoadCachedItems(CFileItemList &items);
   virtual void SortItems(CFileItemList &items);
 
   /*! \brief Check if the given list can be advance filtered or not
@@ -163,6 +167,7 @@ protected:
   // current path and history
   CFileItemList* m_vecItems;
   CFileItemList* m_unfilteredItems;        ///< \brief items prior to filtering using FilterItems()
+  CFileItemList* m_partialItems;           ///< \brief items shown while a slow or cached directory is still being retrieved
   CDirectoryHistory m_history;
   std::auto_ptr<CGUIViewState> m_guiState;
 